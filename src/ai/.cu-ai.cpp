@@ -10,4 +10,5 @@
 #include "airampantrhino.cpp"
 #include "aitutorialturtle.cpp"
 #include "bot.cpp"
+#include "neuralnewtbrain.cpp"
 #include "newtbrain.cpp"
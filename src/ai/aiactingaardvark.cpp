@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 AIActingAardvark::Tile AIActingAardvark::makeTile(Cell index) const
 {
@@ -497,7 +498,7 @@ void AIActingAardvark::doFarming()
 	if (_myFarms.size() > 0)
 	{
 		std::vector<Tile> farms = _myFarms;
-		std::random_shuffle(farms.begin(), farms.end());
+		Randomness::shuffle(farms.begin(), farms.end());
 		std::sort(farms.begin(), farms.end(),
 			[&](const Tile& lhs, const Tile& rhs) {
 
@@ -555,7 +556,7 @@ void AIActingAardvark::doFarming()
 			enemyThreats.execute();
 			if (enemyThreats.steps(index) <= 5) continue;
 			float expected = expectedSoil(index)
-					+ 0.001f * (rand() % 1000);
+					+ 0.001f * (Randomness::next() % 1000);
 			if (bestExpected < expected)
 			{
 				bestCell = index;
@@ -595,7 +596,7 @@ void AIActingAardvark::doFarming()
 //			_myTowns.end());
 //		settlerProducers.insert(settlerProducers.end(), _myCities.begin(),
 //			_myCities.end());
-//		std::random_shuffle(settlerProducers.begin(), settlerProducers.end());
+//		Randomness::shuffle(settlerProducers.begin(), settlerProducers.end());
 //		for (Tile& tile : settlerProducers)
 //		{
 //			if (tile.unfinished.type != Order::Type::NONE) continue;
@@ -920,7 +921,7 @@ void AIActingAardvark::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 1) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& myUnit : surrounding)
 		{
 			if (surrounding.size() ==1)
@@ -1108,7 +1109,7 @@ void AIActingAardvark::process()
 		if ((_myIndustry.size() + _queuedIndustry == 0) || ((_myBarracks.size()+_queuedBarracks == 1) && (_myIndustry.size() + _queuedIndustry < 3) && (_myGunners.size() + _queuedGunners>0)) || (_myGunners.size()+_queuedGunners>0 && _myBarracks.size()>1))
 		{
 			std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(directions.begin(), directions.end());
+			Randomness::shuffle(directions.begin(), directions.end());
 			if (cityNiceness(at)<4 && city.power < 4 && alliedbarracks.steps(at) < 2) continue;
 			for (const Move& move : directions)
 			{
@@ -1128,7 +1129,7 @@ void AIActingAardvark::process()
 		else if ((_myBarracks.size() + _queuedBarracks == 0) || (_myIndustry.size() + _queuedIndustry > 2 && _myBarracks.size() + _queuedBarracks == 1 && _myGunners.size() + _queuedGunners > 0))
 		{
 			std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(directions.begin(), directions.end());
+			Randomness::shuffle(directions.begin(), directions.end());
 			for (const Move& move : directions)
 			{
 				Cell to = at + move;
@@ -1238,7 +1239,7 @@ void AIActingAardvark::process()
 
 	// select orders
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 AIActingAlbatross::Tile AIActingAlbatross::makeTile(Cell index) const
 {
@@ -647,7 +648,7 @@ void AIActingAlbatross::process()
 				surrounding.emplace_back(makeAir(to));
 			}
 			if (surrounding.size() < 1) continue;
-			std::random_shuffle(surrounding.begin(), surrounding.end());
+			Randomness::shuffle(surrounding.begin(), surrounding.end());
 			for (auto& myUnit : surrounding)
 			{
 				if (surrounding.size() > 0)
@@ -679,7 +680,7 @@ void AIActingAlbatross::process()
 
 	// select orders
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
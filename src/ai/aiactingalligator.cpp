@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 AIActingAlligator::Tile AIActingAlligator::makeTile(Cell index) const
 {
@@ -570,7 +571,7 @@ void AIActingAlligator::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 1) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& myUnit : surrounding)
 		{
 			if (surrounding.size() > 0)
@@ -684,7 +685,7 @@ void AIActingAlligator::process()
 
 	// select orders
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 AIActingAlpaca::Tile AIActingAlpaca::makeTile(Cell index) const
 {
@@ -703,7 +704,7 @@ void AIActingAlpaca::process()
 				surrounding.emplace_back(makeGround(to));
 			}
 			if (surrounding.size() < 1) continue;
-			std::random_shuffle(surrounding.begin(), surrounding.end());
+			Randomness::shuffle(surrounding.begin(), surrounding.end());
 			for (auto& myUnit : surrounding)
 			{
 				if (surrounding.size() > 0)
@@ -730,7 +731,7 @@ void AIActingAlpaca::process()
 
 	// select orders
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 AIActingArmadillo::Tile AIActingArmadillo::makeTile(Cell index) const
 {
@@ -788,7 +789,7 @@ void AIActingArmadillo::process()
 				surrounding.emplace_back(makeGround(to));
 			}
 			if (surrounding.size() < 1) continue;
-			std::random_shuffle(surrounding.begin(), surrounding.end());
+			Randomness::shuffle(surrounding.begin(), surrounding.end());
 			for (auto& myUnit : surrounding)
 			{
 				if (surrounding.size() > 0)
@@ -904,7 +905,7 @@ void AIActingArmadillo::process()
 
 	// select orders
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -33,6 +33,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 
 AIChargingCheetah::Tile AIChargingCheetah::makeTile(Cell index) const
@@ -448,7 +449,7 @@ void AIChargingCheetah::doFarming()
 	if (_myFarms.size() > 0)
 	{
 		std::vector<Tile> farms = _myFarms;
-		std::random_shuffle(farms.begin(), farms.end());
+		Randomness::shuffle(farms.begin(), farms.end());
 		std::sort(farms.begin(), farms.end(),
 			[&](const Tile& lhs, const Tile& rhs) {
 
@@ -494,19 +495,21 @@ void AIChargingCheetah::doFarming()
 		for (Cell index : _board)
 		{
 			if (!_bible.tileBuildable(_board.tile(index).type)) continue;
-			TileFloodfill citiesTowns(_bible, _board);
-			citiesTowns.include({_citytype, _towntype});
-			citiesTowns.include({_player});
-			citiesTowns.execute();
+			TileFloodfill::Filter citiestownsfilter;
+			citiestownsfilter.include({_citytype, _towntype});
+			citiestownsfilter.include({_player});
+			const TileFloodfill& citiesTowns = _floodfills.get(
+				citiestownsfilter);
 			if (citiesTowns.steps(index) <= 3
 				|| citiesTowns.steps(index) > 6) continue;
-			TileFloodfill enemyThreats(_bible, _board);
-			enemyThreats.exclude({_soiltype, _cropstype});
-			enemyThreats.exclude({_player, Player::NONE});
-			enemyThreats.execute();
+			TileFloodfill::Filter enemythreatsfilter;
+			enemythreatsfilter.exclude({_soiltype, _cropstype});
+			enemythreatsfilter.exclude({_player, Player::NONE});
+			const TileFloodfill& enemyThreats = _floodfills.get(
+				enemythreatsfilter);
 			if (enemyThreats.steps(index) <= 5) continue;
 			float expected = expectedSoil(index)
-					+ 0.001f * (rand() % 1000);
+					+ 0.001f * (Randomness::next() % 1000);
 			if (bestExpected < expected)
 			{
 				bestCell = index;
@@ -515,10 +518,10 @@ void AIChargingCheetah::doFarming()
 		}
 		if (bestCell != Cell::undefined())
 		{
-			UnitFloodfill settlers(_bible, _board);
-			settlers.include({_settlertype});
-			settlers.include({_player});
-			settlers.execute();
+			UnitFloodfill::Filter settlersfilter;
+			settlersfilter.include({_settlertype});
+			settlersfilter.include({_player});
+			const UnitFloodfill& settlers = _floodfills.get(settlersfilter);
 			if (settlers.reached(bestCell) && settlers.steps(bestCell) > 0)
 			{
 				std::vector<Move> moves;
@@ -546,7 +549,7 @@ void AIChargingCheetah::doFarming()
 //			_myTowns.end());
 //		settlerProducers.insert(settlerProducers.end(), _myCities.begin(),
 //			_myCities.end());
-//		std::random_shuffle(settlerProducers.begin(), settlerProducers.end());
+//		Randomness::shuffle(settlerProducers.begin(), settlerProducers.end());
 //		for (Tile& tile : settlerProducers)
 //		{
 //			if (tile.unfinished.type != Order::Type::NONE) continue;
@@ -566,10 +569,10 @@ void AIChargingCheetah::doFarming()
 void AIChargingCheetah::doFirstTurn()
 {
 
-	TileFloodfill enemycities(_bible, _board);
-	enemycities.include({_citytype});
-	enemycities.exclude({_player});
-	enemycities.execute();
+	TileFloodfill::Filter enemycitiesfilter;
+	enemycitiesfilter.include({_citytype});
+	enemycitiesfilter.exclude({_player});
+	const TileFloodfill& enemycities = _floodfills.get(enemycitiesfilter);
 
 	float minenemydist = 1000000000;
 	Move bestMove = Move::X;
@@ -606,10 +609,10 @@ void AIChargingCheetah::doFirstTurn()
 		}
 	}
 
-	TileFloodfill alliedcities(_bible, _board);
-	alliedcities.include({_citytype});
-	alliedcities.include({_player});
-	alliedcities.execute();
+	TileFloodfill::Filter alliedcitiesfilter;
+	alliedcitiesfilter.include({_citytype});
+	alliedcitiesfilter.include({_player});
+	const TileFloodfill& alliedcities = _floodfills.get(alliedcitiesfilter);
 
 	for (Ground& militia : _myMilitia)
 	{
@@ -673,7 +676,7 @@ std::string AIChargingCheetah::authors() const
 
 
 // this is the part where I start shuffling things around and changing things
-void AIChargingCheetah::process()
+void AIChargingCheetah::preprocess()
 {
 	determineState();
 
@@ -686,25 +689,57 @@ void AIChargingCheetah::process()
 
 	checkUnfinished();
 
-	bool defense=false;
-	for (Tile& city : _myCities)
+	_stage = Stage::COMBAT;
+}
+
+void AIChargingCheetah::process()
+{
+	switch (_stage)
 	{
-		Cell at = _board.cell(city.descriptor.position);
-		if (cityOccupied(at) && _board.ground(at).owner != _player)
+		case Stage::COMBAT:
 		{
-			defense=true;
+			planCombat();
 		}
-	}
+		break;
 
+		case Stage::MOVEMENT:
+		{
+			planMovement();
+		}
+		break;
+
+		case Stage::ECONOMY:
+		{
+			planEconomy();
+		}
+		break;
+
+		case Stage::SELECTION:
+		{
+			selectOrders();
+		}
+		break;
+	}
+}
 
+bool AIChargingCheetah::postprocess()
+{
+	if (_stage == Stage::SELECTION) return true;
 
+	// Make sure an interrupted planner still has something to submit.
+	pickOrders(_options);
 
+	_stage = (Stage) ((uint8_t) _stage + 1);
+	return false;
+}
 
-	TileFloodfill occupiedcities(_bible, _board);
-	occupiedcities.include({_citytype});
-	occupiedcities.include({_player});
-	occupiedcities.includeOccupied();
-	occupiedcities.execute();
+void AIChargingCheetah::planCombat()
+{
+	TileFloodfill::Filter occupiedcitiesfilter;
+	occupiedcitiesfilter.include({_citytype});
+	occupiedcitiesfilter.include({_player});
+	occupiedcitiesfilter.includeOccupied = true;
+	const TileFloodfill& occupiedcities = _floodfills.get(occupiedcitiesfilter);
 
 	// Go to defend a city if you are in range
 	for (Ground& gunner : _myGunners)
@@ -725,17 +760,11 @@ void AIChargingCheetah::process()
 
 
 
-	TileFloodfill targets(_bible, _board);
-	targets.include(
-		{_citytype, _farmtype, _outposttype, _towntype, _industrytype, _barrackstype});
-	targets.exclude({_player});
-	targets.execute();
-
-	TileFloodfill cities(_bible, _board);
-	cities.include({_citytype});
-	cities.exclude({_player});
-	cities.excludeOccupied();
-	cities.execute();
+	TileFloodfill::Filter citiesfilter;
+	citiesfilter.include({_citytype});
+	citiesfilter.exclude({_player});
+	citiesfilter.excludeOccupied = true;
+	const TileFloodfill& cities = _floodfills.get(citiesfilter);
 
 	// Move sappers within range of cities. Then bombard them. Also bombard units or other buildings along the way.
 	for (Ground& sapper : _mySappers)
@@ -869,7 +898,7 @@ void AIChargingCheetah::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 1) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& myUnit : surrounding)
 		{
 			if (surrounding.size() ==1)
@@ -898,11 +927,20 @@ void AIChargingCheetah::process()
 			}
 		}
 	}
+}
 
-	TileFloodfill alliedcities(_bible, _board);
-	alliedcities.include({_citytype});
-	alliedcities.include({_player});
-	alliedcities.execute();
+void AIChargingCheetah::planMovement()
+{
+	TileFloodfill::Filter citiesfilter;
+	citiesfilter.include({_citytype});
+	citiesfilter.exclude({_player});
+	citiesfilter.excludeOccupied = true;
+	const TileFloodfill& cities = _floodfills.get(citiesfilter);
+
+	TileFloodfill::Filter alliedcitiesfilter;
+	alliedcitiesfilter.include({_citytype});
+	alliedcitiesfilter.include({_player});
+	const TileFloodfill& alliedcities = _floodfills.get(alliedcitiesfilter);
 
 	// move militia to targets
 	for (Ground& militia : _myMilitia)
@@ -996,7 +1034,7 @@ void AIChargingCheetah::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 1) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& enemyUnit : surrounding)
 		{
 			Order order(Order::Type::SHELL, tank.descriptor,
@@ -1005,9 +1043,19 @@ void AIChargingCheetah::process()
 			break;
 		}
 	}
+}
 
-
-
+void AIChargingCheetah::planEconomy()
+{
+	bool defense=false;
+	for (Tile& city : _myCities)
+	{
+		Cell at = _board.cell(city.descriptor.position);
+		if (cityOccupied(at) && _board.ground(at).owner != _player)
+		{
+			defense=true;
+		}
+	}
 
 	// Make 1 industry and barracks until we have 1 industry and 1 barracks. Then make more industry, but only if we have at least 1 gunner. Stop to make a second barracks when we have 4 industry
 	for (Tile& barracks : _myBarracks)
@@ -1102,10 +1150,10 @@ void AIChargingCheetah::process()
 		_queuedMoney = _queuedMoney + _militiaCost;
 	}
 
-	TileFloodfill alliedbarracks(_bible, _board);
-	alliedbarracks.include({_barrackstype});
-	alliedbarracks.include({_player});
-	alliedbarracks.execute();
+	TileFloodfill::Filter alliedbarracksfilter;
+	alliedbarracksfilter.include({_barrackstype});
+	alliedbarracksfilter.include({_player});
+	const TileFloodfill& alliedbarracks = _floodfills.get(alliedbarracksfilter);
 
 
 	for (Tile& city : _myCities)
@@ -1135,7 +1183,7 @@ void AIChargingCheetah::process()
 		if ((_myIndustry.size() + _queuedIndustry == 0) || ((_myBarracks.size()+_queuedBarracks == 1) && (_myIndustry.size() + _queuedIndustry < 3) && (_myGunners.size() + _queuedGunners>0)) || (_myGunners.size()+_queuedGunners>0 && _myBarracks.size()>1))
 		{
 			std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(directions.begin(), directions.end());
+			Randomness::shuffle(directions.begin(), directions.end());
 			if (cityNiceness(at)<4 && city.power < 4 && alliedbarracks.steps(at) < 2) continue;
 			for (const Move& move : directions)
 			{
@@ -1155,7 +1203,7 @@ void AIChargingCheetah::process()
 		else if ((_myBarracks.size() + _queuedBarracks == 0) || (_myIndustry.size() + _queuedIndustry > 2 && _myBarracks.size() + _queuedBarracks == 1 && _myGunners.size() + _queuedGunners > 0))
 		{
 			std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(directions.begin(), directions.end());
+			Randomness::shuffle(directions.begin(), directions.end());
 			for (const Move& move : directions)
 			{
 				Cell to = at + move;
@@ -1190,11 +1238,14 @@ void AIChargingCheetah::process()
 		}
 		}
 	}
+}
 
-
-	// select orders
+void AIChargingCheetah::selectOrders()
+{
+	// select orders, discarding the provisional pick
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	_newOrders.clear();
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -1211,7 +1262,7 @@ void AIChargingCheetah::process()
 	if (_difficulty == Difficulty::EASY)
 	{
 		// Throw away all but one order
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 1)
 		{
 			_newOrders = {_newOrders[0]};
@@ -1220,7 +1271,7 @@ void AIChargingCheetah::process()
 	else if (_difficulty == Difficulty::MEDIUM)
 	{
 		// Throw away all but three orders
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 3)
 		{
 			_newOrders = {_newOrders[0], _newOrders[1], _newOrders[2]};
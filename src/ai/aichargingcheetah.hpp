@@ -43,6 +43,15 @@ public:
 	virtual ~AIChargingCheetah() = default;
 
 private:
+	// Planning is split into stages so a partial plan can be submitted.
+	enum class Stage : uint8_t
+	{
+		COMBAT,
+		MOVEMENT,
+		ECONOMY,
+		SELECTION,
+	};
+
 	struct Option
 	{
 		Order order;
@@ -118,6 +127,7 @@ private:
 	int _queuedPlows = 0;
 	int _queuedMoney = 0;
 	int _turnNumber = 0;
+	Stage _stage = Stage::COMBAT;
 
 	Tile makeTile(Cell index) const;
 	Ground makeGround(Cell index) const;
@@ -128,10 +138,16 @@ private:
 	void doFarming();
 	void checkUnfinished();
 	void doFirstTurn();
+	void planCombat();
+	void planMovement();
+	void planEconomy();
+	void selectOrders();
 
 protected:
 	virtual std::string ainame() const override;
 	virtual std::string authors() const override;
 
+	virtual void preprocess() override;
 	virtual void process() override;
+	virtual bool postprocess() override;
 };
\ No newline at end of file
@@ -25,9 +25,11 @@
 #include "source.hpp"
 
 #include "library.hpp"
+#include "clock.hpp"
 #include "difficulty.hpp"
 #include "change.hpp"
 #include "notice.hpp"
+#include "profiler.hpp"
 
 
 const std::vector<std::string> NAMEPOOL = {"Alice", "Bob", "Carol", "Dave", "Emma", "Frank",
@@ -37,11 +39,13 @@ const std::vector<std::string> NAMEPOOL = {"Alice", "Bob", "Carol", "Dave", "Emm
 
 AICommander::AICommander(const Player& player, const Difficulty& difficulty,
 		const std::string& rulesetname, char x) :
-	_bible(Library::getBible(rulesetname)),
+	_sharedbible(Library::shareBible(rulesetname)),
+	_bible(*_sharedbible),
 	_player(player),
 	_difficulty(difficulty),
 	_character(std::max('A', std::min(x, 'Z'))),
 	_board(_bible),
+	_floodfills(_bible, _board),
 	_money(0),
 	_year(0),
 	_season(Season::SPRING),
@@ -50,7 +54,8 @@ AICommander::AICommander(const Player& player, const Difficulty& difficulty,
 	_score(0),
 	_gameover(false),
 	_defeated(false),
-	_finished(false)
+	_finished(false),
+	_processing(false)
 {
 	DEBUG_ASSERT(x >= 'A' && x <= 'Z');
 }
@@ -75,6 +80,11 @@ Order AICommander::hasNew(const Descriptor& subject) const
 
 void AICommander::receiveChanges(const std::vector<Change>& changes)
 {
+	if (!changes.empty())
+	{
+		_floodfills.clear();
+	}
+
 	for (auto& change : changes)
 	{
 		switch (change.type)
@@ -94,6 +104,8 @@ void AICommander::receiveChanges(const std::vector<Change>& changes)
 				{
 					_newOrders.clear();
 					_finished = false;
+					_processing = false;
+					publishBestOrders();
 				}
 				else if (_phase == Phase::ACTION)
 				{
@@ -171,6 +183,20 @@ void AICommander::receiveChanges(const std::vector<Change>& changes)
 	}
 }
 
+void AICommander::receiveChanges(const std::vector<Change>& changes,
+	const TypeNamer& namer)
+{
+	// We can skip the detour through JSON if our types are the same.
+	if (namer.sameTypesAs(_bible))
+	{
+		receiveChanges(changes);
+	}
+	else
+	{
+		AILibrary::receiveChanges(changes, namer);
+	}
+}
+
 void AICommander::receiveChangesAsJson(const Json::Value& changes)
 {
 	receiveChanges(Change::parseChanges(_bible, changes));
@@ -189,23 +215,91 @@ bool AICommander::wantsToPrepareOrders() const
 
 void AICommander::prepareOrders()
 {
-	if (_finished) return;
+	while (step())
+	{
+		// Keep refining until the AI is satisfied.
+	}
+}
 
-	_newOrders.clear();
-	if (_gameover || _defeated)
+void AICommander::prepareOrdersFor(uint32_t budget)
+{
+	uint64_t deadline = SteadyClock::milliseconds() + budget;
+
+	// Always take at least one step, so that there is something to send.
+	while (step() && SteadyClock::milliseconds() < deadline)
+	{
+		// Keep refining until the AI is satisfied or out of time.
+	}
+
+	if (_processing)
 	{
+		LOGD << "Stopped refining orders after " << budget << "ms";
+		_processing = false;
 		_finished = true;
-		return;
 	}
+}
+
+bool AICommander::step()
+{
+	if (_finished) return false;
 
-	bool processed = false;
-	preprocess();
-	while (!processed)
+	if (!_processing)
 	{
+		_newOrders.clear();
+		publishBestOrders();
+		if (_gameover || _defeated)
+		{
+			_finished = true;
+			return false;
+		}
+
+		{
+			PROFILE_ZONE("AICommander::preprocess");
+			preprocess();
+		}
+		_processing = true;
+	}
+
+	bool processed;
+	{
+		PROFILE_ZONE("AICommander::process");
 		process();
+	}
+	{
+		PROFILE_ZONE("AICommander::postprocess");
 		processed = postprocess();
 	}
-	_finished = true;
+	publishBestOrders();
+
+	if (processed)
+	{
+		_processing = false;
+		_finished = true;
+	}
+	return !processed;
+}
+
+void AICommander::publishBestOrders()
+{
+	std::lock_guard<std::mutex> lock(_bestOrdersMutex);
+	_bestOrders = _newOrders;
+}
+
+size_t AICommander::pickLimit() const
+{
+	size_t limit = _bible.newOrderLimit();
+	if (_difficulty == Difficulty::EASY) limit = std::min(limit, (size_t) 1);
+	else if (_difficulty == Difficulty::MEDIUM)
+	{
+		limit = std::min(limit, (size_t) 3);
+	}
+	return limit;
+}
+
+std::vector<Order> AICommander::bestSoFar() const
+{
+	std::lock_guard<std::mutex> lock(_bestOrdersMutex);
+	return _bestOrders;
 }
 
 std::vector<Order> AICommander::orders()
@@ -214,6 +308,19 @@ std::vector<Order> AICommander::orders()
 	return orders;
 }
 
+std::vector<Order> AICommander::orders(const TypeNamer& namer)
+{
+	// We can skip the detour through JSON if our types are the same.
+	if (namer.sameTypesAs(_bible))
+	{
+		return orders();
+	}
+	else
+	{
+		return AILibrary::orders(namer);
+	}
+}
+
 std::string AICommander::ordersAsString()
 {
 	std::stringstream strm;
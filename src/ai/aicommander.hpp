@@ -24,9 +24,12 @@
 #pragma once
 #include "header.hpp"
 
+#include <mutex>
+
 #include "ailibrary.hpp"
 #include "bible.hpp"
 #include "board.hpp"
+#include "floodfillcache.hpp"
 #include "cycle.hpp"
 #include "order.hpp"
 
@@ -47,12 +50,14 @@ public:
 	virtual ~AICommander() = default;
 
 protected:
-	Bible _bible;
+	const std::shared_ptr<const Bible> _sharedbible;
+	const Bible& _bible;
 	const Player _player;
 	const Difficulty _difficulty;
 	const char _character;
 
 	Board _board;
+	FloodfillCache _floodfills; // (cleared whenever _board changes)
 	int _money;
 	int _year;
 	Season _season;
@@ -62,11 +67,42 @@ protected:
 	bool _gameover;
 	bool _defeated;
 	bool _finished;
+	bool _processing;
 
 	std::vector<Order> _unfinishedOrders;
 	std::vector<Order> _newOrders;
 	size_t _newOrdersConfirmed;
 
+	// A copy of _newOrders as it was after the latest step, which can be
+	// read from another thread while this AI is still refining its orders.
+	std::vector<Order> _bestOrders;
+	mutable std::mutex _bestOrdersMutex;
+
+	void publishBestOrders();
+
+	// Picks the options with the highest priority as provisional new orders,
+	// without shuffling or calling rand() so that the final selection of an
+	// AI that runs to completion is not affected.
+	template <class Option>
+	void pickOrders(std::vector<Option> options)
+	{
+		std::stable_sort(options.begin(), options.end(),
+			[](const Option& lhs, const Option& rhs) {
+
+			return lhs.priority > rhs.priority;
+		});
+
+		size_t limit = pickLimit();
+		_newOrders.clear();
+		for (size_t i = 0; i < options.size() && _newOrders.size() < limit; i++)
+		{
+			if (hasNew(options[i].order.subject).type != Order::Type::NONE)
+				continue;
+			_newOrders.emplace_back(options[i].order);
+		}
+	}
+	size_t pickLimit() const;
+
 	friend class NewtBrain;
 	friend class NeuralNewtBrain;
 
@@ -78,17 +114,25 @@ public:
 
 	// hiding AILibrary::receiveChanges()
 	void receiveChanges(const std::vector<Change>& changes);
+	virtual void receiveChanges(const std::vector<Change>& changes,
+		const TypeNamer& namer) override;
 	void receiveChangesAsJson(const Json::Value& json);
 	virtual void receiveChangesAsString(const std::string& changes) override;
 
+	// Each call to process() should leave a valid set of new orders, that
+	// later calls refine further until postprocess() returns true.
 	virtual void preprocess() {};
 	virtual void process() = 0;
 	virtual bool postprocess() { return true; }
 
 	virtual void prepareOrders() override;
+	void prepareOrdersFor(uint32_t budget); // ms
+	bool step();
+	std::vector<Order> bestSoFar() const;
 
 	// hiding AILibrary::orders()
 	std::vector<Order> orders();
+	virtual std::vector<Order> orders(const TypeNamer& namer) override;
 	virtual std::string ordersAsString() override;
 
 	bool wantsToPrepareOrders() const;
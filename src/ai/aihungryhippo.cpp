@@ -26,6 +26,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 
 AIHungryHippo::Tile AIHungryHippo::makeTile(Cell index) const
@@ -362,7 +363,7 @@ void AIHungryHippo::doFarming()
 	if (_myFarms.size() > 0)
 	{
 		std::vector<Tile> farms = _myFarms;
-		std::random_shuffle(farms.begin(), farms.end());
+		Randomness::shuffle(farms.begin(), farms.end());
 		std::sort(farms.begin(), farms.end(),
 			[&](const Tile& lhs, const Tile& rhs) {
 
@@ -407,19 +408,21 @@ void AIHungryHippo::doFarming()
 		for (Cell index : _board)
 		{
 			if (!_bible.tileBuildable(_board.tile(index).type)) continue;
-			TileFloodfill citiesTowns(_bible, _board);
-			citiesTowns.include({_citytype, _towntype});
-			citiesTowns.include({_player});
-			citiesTowns.execute();
+			TileFloodfill::Filter citiestownsfilter;
+			citiestownsfilter.include({_citytype, _towntype});
+			citiestownsfilter.include({_player});
+			const TileFloodfill& citiesTowns = _floodfills.get(
+				citiestownsfilter);
 			if (citiesTowns.steps(index) <= 3
 				|| citiesTowns.steps(index) > 6) continue;
-			TileFloodfill enemyThreats(_bible, _board);
-			enemyThreats.exclude({_soiltype, _cropstype});
-			enemyThreats.exclude({_player, Player::NONE});
-			enemyThreats.execute();
+			TileFloodfill::Filter enemythreatsfilter;
+			enemythreatsfilter.exclude({_soiltype, _cropstype});
+			enemythreatsfilter.exclude({_player, Player::NONE});
+			const TileFloodfill& enemyThreats = _floodfills.get(
+				enemythreatsfilter);
 			if (enemyThreats.steps(index) <= 5) continue;
 			float expected = expectedSoil(index)
-					+ 0.001f * (rand() % 1000);
+					+ 0.001f * (Randomness::next() % 1000);
 			if (bestExpected < expected)
 			{
 				bestCell = index;
@@ -428,10 +431,10 @@ void AIHungryHippo::doFarming()
 		}
 		if (bestCell != Cell::undefined())
 		{
-			UnitFloodfill settlers(_bible, _board);
-			settlers.include({_settlertype});
-			settlers.include({_player});
-			settlers.execute();
+			UnitFloodfill::Filter settlersfilter;
+			settlersfilter.include({_settlertype});
+			settlersfilter.include({_player});
+			const UnitFloodfill& settlers = _floodfills.get(settlersfilter);
 			if (settlers.reached(bestCell) && settlers.steps(bestCell) > 0)
 			{
 				std::vector<Move> moves;
@@ -459,7 +462,7 @@ void AIHungryHippo::doFarming()
 			_myTowns.end());
 		settlerProducers.insert(settlerProducers.end(), _myCities.begin(),
 			_myCities.end());
-		std::random_shuffle(settlerProducers.begin(), settlerProducers.end());
+		Randomness::shuffle(settlerProducers.begin(), settlerProducers.end());
 		for (Tile& tile : settlerProducers)
 		{
 			if (tile.unfinished.type != Order::Type::NONE) continue;
@@ -484,12 +487,58 @@ std::string AIHungryHippo::authors() const
 	return "Daan Mulder";
 }
 
-void AIHungryHippo::process()
+void AIHungryHippo::preprocess()
 {
 	determineState();
 
 	doFarming();
 
+	_stage = Stage::COMBAT;
+}
+
+void AIHungryHippo::process()
+{
+	switch (_stage)
+	{
+		case Stage::COMBAT:
+		{
+			planCombat();
+		}
+		break;
+
+		case Stage::MOVEMENT:
+		{
+			planMovement();
+		}
+		break;
+
+		case Stage::ECONOMY:
+		{
+			planEconomy();
+		}
+		break;
+
+		case Stage::SELECTION:
+		{
+			selectOrders();
+		}
+		break;
+	}
+}
+
+bool AIHungryHippo::postprocess()
+{
+	if (_stage == Stage::SELECTION) return true;
+
+	// Until the final selection, keep a quick pick of the options so far.
+	pickOrders(_options);
+
+	_stage = (Stage) ((uint8_t) _stage + 1);
+	return false;
+}
+
+void AIHungryHippo::planCombat()
+{
 	// capture anything!
 	for (Ground& rifleman : _myRiflemen)
 	{
@@ -519,7 +568,7 @@ void AIHungryHippo::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 2) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& myUnit : surrounding)
 		{
 			Order order(Order::Type::FOCUS, myUnit.descriptor,
@@ -564,7 +613,7 @@ void AIHungryHippo::process()
 			surrounding.emplace_back(makeGround(to));
 		}
 		if (surrounding.size() < 1) continue;
-		std::random_shuffle(surrounding.begin(), surrounding.end());
+		Randomness::shuffle(surrounding.begin(), surrounding.end());
 		for (auto& enemyUnit : surrounding)
 		{
 			Order order(Order::Type::SHELL, tank.descriptor,
@@ -573,13 +622,16 @@ void AIHungryHippo::process()
 			break;
 		}
 	}
+}
 
+void AIHungryHippo::planMovement()
+{
 	// move riflemen to targets!
-	TileFloodfill targets(_bible, _board);
-	targets.include(
+	TileFloodfill::Filter targetsfilter;
+	targetsfilter.include(
 		{_towntype, _outposttype, _farmtype, _barrackstype, _industrytype});
-	targets.exclude({_player});
-	targets.execute();
+	targetsfilter.exclude({_player});
+	const TileFloodfill& targets = _floodfills.get(targetsfilter);
 	for (Ground& rifleman : _myRiflemen)
 	{
 		Cell target = _board.cell(rifleman.unfinished.target.position);
@@ -604,11 +656,11 @@ void AIHungryHippo::process()
 	}
 
 	// move tanks next to cities!
-	TileFloodfill cities(_bible, _board);
-	cities.include({_citytype});
-	cities.exclude({_player});
-	cities.excludeOccupied();
-	cities.execute();
+	TileFloodfill::Filter citiesfilter;
+	citiesfilter.include({_citytype});
+	citiesfilter.exclude({_player});
+	citiesfilter.excludeOccupied = true;
+	const TileFloodfill& cities = _floodfills.get(citiesfilter);
 	for (Ground& tank : _myTanks)
 	{
 		if (tank.unfinished.type != Order::Type::NONE) continue;
@@ -653,7 +705,10 @@ void AIHungryHippo::process()
 			Descriptor::cell(destination.pos()), moves);
 		_options.emplace_back(Option{order, 15 - int(moves.size())});
 	}
+}
 
+void AIHungryHippo::planEconomy()
+{
 	// make more barracks!
 	for (Tile& city : _myCities)
 	{
@@ -665,7 +720,7 @@ void AIHungryHippo::process()
 		if (cityNiceness(at) < 3) continue;
 		if (_myBarracks.size() + _queuedBarracks >= 2) continue;
 		std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-		std::random_shuffle(directions.begin(), directions.end());
+		Randomness::shuffle(directions.begin(), directions.end());
 		for (const Move& move : directions)
 		{
 			Cell to = at + move;
@@ -691,7 +746,7 @@ void AIHungryHippo::process()
 		if (cityNiceness(at) < 3) continue;
 		if (_myIndustry.size() + _queuedIndustry >= 2) continue;
 		std::vector<Move> directions = {Move::E, Move::S, Move::W, Move::N};
-		std::random_shuffle(directions.begin(), directions.end());
+		Randomness::shuffle(directions.begin(), directions.end());
 		for (const Move& move : directions)
 		{
 			Cell to = at + move;
@@ -775,10 +830,14 @@ void AIHungryHippo::process()
 		Order order(Order::Type::UPGRADE, industry.descriptor, TileType::NONE);
 		_options.emplace_back(Option{order, 10});
 	}
+}
 
-	// select orders
+void AIHungryHippo::selectOrders()
+{
+	// select orders, replacing the orders picked in earlier stages
 	// shuffle them first to prevent north-south bias
-	std::random_shuffle(_options.begin(), _options.end());
+	_newOrders.clear();
+	Randomness::shuffle(_options.begin(), _options.end());
 	std::sort(_options.begin(), _options.end(),
 		[](const Option& lhs, const Option& rhs) {
 
@@ -795,13 +854,13 @@ void AIHungryHippo::process()
 	if (_difficulty == Difficulty::EASY)
 	{
 		// Throw away all but one order
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 1) _newOrders = {_newOrders[0]};
 	}
 	else if (_difficulty == Difficulty::MEDIUM)
 	{
 		// Throw away all but three orders
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 3)
 		{
 			_newOrders = {_newOrders[0], _newOrders[1], _newOrders[2]};
@@ -43,6 +43,15 @@ public:
 	virtual ~AIHungryHippo() = default;
 
 private:
+	// The options are gathered in stages, each followed by a quick pick.
+	enum class Stage : uint8_t
+	{
+		COMBAT,
+		MOVEMENT,
+		ECONOMY,
+		SELECTION,
+	};
+
 	struct Option
 	{
 		Order order;
@@ -85,6 +94,7 @@ private:
 	uint16_t _barracksUpgradeCost;
 	uint16_t _industryUpgradeCost;
 
+	Stage _stage = Stage::COMBAT;
 	std::vector<Option> _options;
 	std::vector<Tile> _myCities;
 	std::vector<Tile> _myTowns;
@@ -113,10 +123,16 @@ private:
 	int expectedSoil(Cell index);
 	void determineState();
 	void doFarming();
+	void planCombat();
+	void planMovement();
+	void planEconomy();
+	void selectOrders();
 
 protected:
 	virtual std::string ainame() const override;
 	virtual std::string authors() const override;
 
+	virtual void preprocess() override;
 	virtual void process() override;
+	virtual bool postprocess() override;
 };
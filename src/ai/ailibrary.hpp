@@ -41,13 +41,14 @@ public:
 	AILibrary& operator=(AILibrary&&) = delete;
 	virtual ~AILibrary() = default;
 
-	void receiveChanges(const std::vector<Change>& changes,
+	// These go through JSON unless the implementation knows a shortcut.
+	virtual void receiveChanges(const std::vector<Change>& changes,
 		const TypeNamer& namer);
 	virtual void receiveChangesAsString(const std::string& changes) = 0;
 
 	virtual void prepareOrders() = 0;
 
-	std::vector<Order> orders(const TypeNamer& namer);
+	virtual std::vector<Order> orders(const TypeNamer& namer);
 	virtual std::string ordersAsString() = 0;
 
 	Player player() const;
@@ -27,6 +27,9 @@
 #include "difficulty.hpp"
 #include "aim.hpp"
 #include "bible.hpp"
+#include "neuralnewtbrain.hpp"
+#include "locator.hpp"
+#include "randomness.hpp"
 
  // windows.h is being annoying
 #undef near
@@ -61,9 +64,16 @@ AINeuralNewt::AINeuralNewt(const Player& player, const Difficulty& difficulty,
 AINeuralNewt::AINeuralNewt(const Player& player, const Difficulty& difficulty,
 		const std::string& rulesetname, char character) :
 	AINeuralNewt(player, difficulty, rulesetname, character,
-		std::make_shared<DummyNewtBrain>())
+		defaultBrain())
 {}
 
+std::shared_ptr<NewtBrain> AINeuralNewt::defaultBrain()
+{
+	auto brain = NeuralNewtBrain::create(Locator::brainFilename("neuralnewt"));
+	if (brain) return brain;
+	return std::make_shared<DummyNewtBrain>();
+}
+
 void AINeuralNewt::preprocess()
 {
 	_ownBaseFloodfill.reset();
@@ -99,6 +109,59 @@ void AINeuralNewt::process()
 bool AINeuralNewt::postprocess()
 {
 	_evaluation = _brain->evaluate();
+	return decide();
+}
+
+void AINeuralNewt::prepareOrdersTogether(const std::vector<AINeuralNewt*>& ais)
+{
+	std::vector<AINeuralNewt*> busy;
+	for (AINeuralNewt* ai : ais)
+	{
+		if (ai->_finished) continue;
+
+		ai->_newOrders.clear();
+		if (ai->_gameover || ai->_defeated)
+		{
+			ai->_finished = true;
+			continue;
+		}
+
+		ai->preprocess();
+		busy.push_back(ai);
+	}
+
+	// This mirrors AICommander::prepareOrders(), except that the brains of
+	// all bots that are still deciding are evaluated together.
+	std::vector<NewtBrain*> brains;
+	std::vector<NewtBrain::Output> outputs;
+	while (!busy.empty())
+	{
+		brains.clear();
+		for (AINeuralNewt* ai : busy)
+		{
+			ai->process();
+			brains.push_back(ai->_brain.get());
+		}
+
+		NewtBrain::evaluate(brains, outputs);
+
+		size_t kept = 0;
+		for (size_t i = 0; i < busy.size(); i++)
+		{
+			AINeuralNewt* ai = busy[i];
+			ai->_evaluation = outputs[i];
+			if (ai->decide())
+			{
+				ai->_finished = true;
+			}
+			else busy[kept++] = ai;
+		}
+		busy.resize(kept);
+	}
+}
+
+bool AINeuralNewt::decide()
+{
 	LOGV << _player << " evaluation #" << (_newOrders.size() + 1)
 		<< ":\n" << _evaluation.toPrettyString();
 
@@ -579,7 +642,7 @@ void AINeuralNewt::sortSubjects(std::vector<Descriptor>& subjects)
 	// Subjects may have gotten orders earlier this planning phase.
 	filterSubjects(subjects);
 	// Shuffle them to avoid top-left-bias.
-	std::random_shuffle(subjects.begin(), subjects.end());
+	Randomness::shuffle(subjects.begin(), subjects.end());
 	// Non-busy should go first.
 	std::sort(subjects.begin(), subjects.end(),
 		[this](const Descriptor& a, const Descriptor& b) {
@@ -624,7 +687,7 @@ void AINeuralNewt::controlSettler(const Descriptor& unitdesc,
 					score += 1.00f;
 				}
 			}
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = unitdesc.position.row;
 			int subcol = unitdesc.position.col;
 			score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -677,7 +740,7 @@ void AINeuralNewt::controlSettler(const Descriptor& unitdesc,
 			- 1.5f * std::max(0, 4 - threatdis) * economical
 			- 3.0f * (threatdis > 6) * (!economical)
 			- 1.5f * (threatdis <= 1);
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = unitdesc.position.row;
 		int subcol = unitdesc.position.col;
 		score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -712,7 +775,7 @@ void AINeuralNewt::controlCaptor(const Descriptor& unitdesc,
 		TileType tiletype = _board.tile(at).type;
 		float score = 6.0f * _evaluation.tiletypes[(uint8_t) tiletype];
 		score += 4.0f * _bible.tileBinding(tiletype);
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = unitdesc.position.row;
 		int subcol = unitdesc.position.col;
 		score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -743,7 +806,7 @@ void AINeuralNewt::controlCombatant(const Descriptor& unitdesc,
 		{
 			float score = 2.0f * _evaluation.tiletypes[(uint8_t) build.type];
 			score += 3.0f * incombat;
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = unitdesc.position.row;
 			int subcol = unitdesc.position.col;
 			score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -760,7 +823,7 @@ void AINeuralNewt::controlCombatant(const Descriptor& unitdesc,
 	}
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 	for (const Move& move : dirs)
 	{
 		Cell target = at + move;
@@ -773,7 +836,7 @@ void AINeuralNewt::controlCombatant(const Descriptor& unitdesc,
 		{
 			float score = 0.0f;
 			score += 3.5f * victim;
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = unitdesc.position.row;
 			int subcol = unitdesc.position.col;
 			score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -794,7 +857,7 @@ void AINeuralNewt::controlCombatant(const Descriptor& unitdesc,
 			float score = 0.5f;
 			score += 2.5f * victim;
 			score -= 2.0f * incombat;
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = unitdesc.position.row;
 			int subcol = unitdesc.position.col;
 			score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -816,7 +879,7 @@ void AINeuralNewt::controlCombatant(const Descriptor& unitdesc,
 			score += 3.0f * victim;
 			score += 3.0f * (_board.tile(target).owner != Player::NONE
 				&& _board.tile(target).owner != _player);
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = unitdesc.position.row;
 			int subcol = unitdesc.position.col;
 			score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -891,7 +954,7 @@ void AINeuralNewt::controlBombarder(const Descriptor& unitdesc,
 		if (expected <= 0) continue;
 
 		float score = 0.40f * (0.5f + 0.5f * _board.current(target)) * expected;
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = unitdesc.position.row;
 		int subcol = unitdesc.position.col;
 		score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -915,7 +978,7 @@ void AINeuralNewt::moveDefense(const Descriptor& unitdesc,
 	if (isAdjacentToEnemyCombatant(unitdesc)) return;
 
 	// TODO remove once the constant floats it modifies are NN-generated.
-	bool offense = 0.001f * (rand() % 1000)
+	bool offense = 0.001f * (Randomness::next() % 1000)
 		< _evaluation.params[NewtBrain::Output::ATTACK_CHANCE];
 
 	Cell from = _board.cell(unitdesc.position);
@@ -1012,7 +1075,7 @@ void AINeuralNewt::moveDefense(const Descriptor& unitdesc,
 				- 5.0f * (!offense && civiesdis > 3)
 				- 5.0f * (offense && threatdis > currentthreatdis)
 				- 5.0f * (offense && civiesdis == 0);
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = unitdesc.position.row;
 		int subcol = unitdesc.position.col;
 		score *= 2 * _evaluation.groundSubjectPreference[subrow][subcol];
@@ -1150,7 +1213,7 @@ void AINeuralNewt::controlCreator(const Descriptor& citydesc,
 
 			float score = (1.0f + 1.0f * stacks)
 				* 2 * _evaluation.unittypes[(uint8_t) build.type];
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = citydesc.position.row;
 			int subcol = citydesc.position.col;
 			score *= 2 * _evaluation.tileSubjectPreference[subrow][subcol];
@@ -1206,7 +1269,7 @@ void AINeuralNewt::controlExpander(const Descriptor& citydesc,
 			Cell target = _board.cell(targetdesc.position);
 
 			float score = 4.0f * _evaluation.tiletypes[(uint8_t) build.type];
-			score += 0.001f * (rand() % 1000);
+			score += 0.001f * (Randomness::next() % 1000);
 			int subrow = citydesc.position.row;
 			int subcol = citydesc.position.col;
 			score *= 2 * _evaluation.tileSubjectPreference[subrow][subcol];
@@ -1246,7 +1309,7 @@ void AINeuralNewt::controlCultivator(const Descriptor& citydesc,
 	for (const Bible::TileBuild& build : _bible.tileCultivates(fromtype))
 	{
 		float score = 2.0f * _evaluation.tiletypes[(uint8_t) build.type];
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = citydesc.position.row;
 		int subcol = citydesc.position.col;
 		score *= 2 * _evaluation.tileSubjectPreference[subrow][subcol];
@@ -1291,7 +1354,7 @@ void AINeuralNewt::controlUpgrader(const Descriptor& citydesc,
 			? fromtype : build.type;
 
 		float score = 4.0f * _evaluation.tiletypes[(uint8_t) newtype];
-		score += 0.001f * (rand() % 1000);
+		score += 0.001f * (Randomness::next() % 1000);
 		int subrow = citydesc.position.row;
 		int subcol = citydesc.position.col;
 		score *= 2 * _evaluation.tileSubjectPreference[subrow][subcol];
@@ -1372,7 +1435,7 @@ bool AINeuralNewt::isAdjacentToEnemyCombatant(const Descriptor& unitdesc)
 	Cell at = _board.cell(unitdesc.position);
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 	for (const Move& move : dirs)
 	{
 		Cell target = at + move;
@@ -126,6 +126,11 @@ private:
 	int expectedNiceness(Cell index);
 	int expectedOverlap(Cell index);
 
+	// Uses the evaluation to add an order; returns true when done.
+	bool decide();
+
+	static std::shared_ptr<NewtBrain> defaultBrain();
+
 protected:
 	virtual std::string ainame() const override;
 	virtual std::string authors() const override;
@@ -134,6 +139,10 @@ public:
 	virtual void preprocess() override;
 	virtual void process() override;
 	virtual bool postprocess() override;
+
+	// Prepares the orders of several bots, possibly from different games,
+	// evaluating their brains in batches.
+	static void prepareOrdersTogether(const std::vector<AINeuralNewt*>& ais);
 };
 
 class DummyNewtBrain : public NewtBrain
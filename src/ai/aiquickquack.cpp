@@ -26,6 +26,7 @@
 
 #include "pathingfloodfill.hpp"
 #include "difficulty.hpp"
+#include "randomness.hpp"
 
 
 std::string AIQuickQuack::ainame() const
@@ -101,7 +102,7 @@ void AIQuickQuack::process()
 	cities.exclude({_player});
 	cities.excludeOccupied();
 	cities.execute();
-	std::random_shuffle(myMilitaryPositions.begin(), myMilitaryPositions.end());
+	Randomness::shuffle(myMilitaryPositions.begin(), myMilitaryPositions.end());
 	std::sort(myMilitaryPositions.begin(), myMilitaryPositions.end(),
 		[&](Cell lhs, Cell rhs) {
 
@@ -133,7 +134,7 @@ void AIQuickQuack::process()
 		if (_board.tile(index).owner != _player) continue;
 		myCityPositions.emplace_back(index);
 	}
-	std::random_shuffle(myCityPositions.begin(), myCityPositions.end());
+	Randomness::shuffle(myCityPositions.begin(), myCityPositions.end());
 	int militaryCount = 0;
 	for (Cell index : _board)
 	{
@@ -178,13 +179,13 @@ void AIQuickQuack::process()
 	if (_difficulty == Difficulty::EASY)
 	{
 		// Throw away all but one order
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 1) _newOrders = {_newOrders[0]};
 	}
 	else if (_difficulty == Difficulty::MEDIUM)
 	{
 		// Throw away all but three orders
-		std::random_shuffle(_newOrders.begin(), _newOrders.end());
+		Randomness::shuffle(_newOrders.begin(), _newOrders.end());
 		if (_newOrders.size() > 3)
 		{
 			_newOrders = {_newOrders[0], _newOrders[1], _newOrders[2]};
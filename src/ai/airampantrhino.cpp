@@ -28,6 +28,7 @@
 #include "pathingfloodfill.hpp"
 #include "aim.hpp"
 #include "bible.hpp"
+#include "randomness.hpp"
 
  // windows.h is being annoying
 #undef near
@@ -46,7 +47,8 @@ std::string AIRampantRhino::authors() const
 AIRampantRhino::AIRampantRhino(const Player& player,
 		const Difficulty& difficulty,
 		const std::string& rulesetname, char character) :
-	AICommander(player, difficulty, rulesetname, character)
+	AICommander(player, difficulty, rulesetname, character),
+	_stage(Stage::TACTICS)
 {
 	if (_difficulty == Difficulty::NONE)
 	{
@@ -155,69 +157,103 @@ AIRampantRhino::AIRampantRhino(const Player& player,
 	}
 }
 
-void AIRampantRhino::process()
+void AIRampantRhino::preprocess()
 {
 	count();
 
-	if (_captors.size() > 0)
-	{
-		controlCaptors();
-	}
+	_stage = Stage::TACTICS;
+}
 
-	if (_blockers.size() > 0)
+void AIRampantRhino::process()
+{
+	switch (_stage)
 	{
-		controlBlockers();
-	}
+		case Stage::TACTICS:
+		{
+			if (_captors.size() > 0)
+			{
+				controlCaptors();
+			}
 
-	if (_bombarders.size() > 0)
-	{
-		controlBombarders();
-	}
+			if (_blockers.size() > 0)
+			{
+				controlBlockers();
+			}
 
-	if (_offenses.size() > 0)
-	{
-		controlOffenses();
-	}
-	else if ((int) _defenses.size() >= maxDefenseUnits())
-	{
-		declareOffenses();
-	}
+			if (_bombarders.size() > 0)
+			{
+				controlBombarders();
+			}
+		}
+		break;
 
-	if ((int) (_offenses.size() + _defenses.size()) < maxMilitaryUnits())
-	{
-		createDefenses();
-	}
+		case Stage::MILITARY:
+		{
+			if (_offenses.size() > 0)
+			{
+				controlOffenses();
+			}
+			else if ((int) _defenses.size() >= maxDefenseUnits())
+			{
+				declareOffenses();
+			}
 
-	if (_defenses.size() > 0)
-	{
-		controlDefenses();
-	}
+			if ((int) (_offenses.size() + _defenses.size())
+				< maxMilitaryUnits())
+			{
+				createDefenses();
+			}
 
-	if (_cultivators.size() > 0)
-	{
-		controlCultivators();
-	}
+			if (_defenses.size() > 0)
+			{
+				controlDefenses();
+			}
+		}
+		break;
 
-	if (_settlers.size() > 0)
-	{
-		controlSettlers();
-	}
-	else
-	{
-		createSettlers();
-	}
+		case Stage::ECONOMY:
+		{
+			if (_cultivators.size() > 0)
+			{
+				controlCultivators();
+			}
 
-	if (_defenses.size() > 0)
-	{
-		controlIdleDefenses();
-	}
+			if (_settlers.size() > 0)
+			{
+				controlSettlers();
+			}
+			else
+			{
+				createSettlers();
+			}
+		}
+		break;
 
-	if (_stoppers.size() > 0)
-	{
-		controlStoppers();
+		case Stage::IDLE:
+		{
+			if (_defenses.size() > 0)
+			{
+				controlIdleDefenses();
+			}
+
+			if (_stoppers.size() > 0)
+			{
+				controlStoppers();
+			}
+		}
+		break;
 	}
 }
 
+bool AIRampantRhino::postprocess()
+{
+	// Each stage only adds orders, so the orders so far are always valid.
+	if (_stage == Stage::IDLE) return true;
+
+	_stage = (Stage) ((uint8_t) _stage + 1);
+	return false;
+}
+
 void AIRampantRhino::count()
 {
 	_settlers.clear();
@@ -632,11 +668,11 @@ void AIRampantRhino::createSettlers()
 		return;
 	}
 
-	if ((rand() % 10) == 0)
+	if ((Randomness::next() % 10) == 0)
 	{
 		createIndustry();
 	}
-	else if (!_economyupgraders.empty() && (rand() % 3) == 0)
+	else if (!_economyupgraders.empty() && (Randomness::next() % 3) == 0)
 	{
 		upgradeEconomy();
 	}
@@ -646,7 +682,7 @@ void AIRampantRhino::createSettlers()
 
 			return hasNewOrder(desc);
 		}), _settlercreators.end());
-	std::random_shuffle(_settlercreators.begin(), _settlercreators.end());
+	Randomness::shuffle(_settlercreators.begin(), _settlercreators.end());
 	std::sort(_settlercreators.begin(), _settlercreators.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -678,7 +714,7 @@ void AIRampantRhino::createSettlers()
 		else
 		{
 			std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(dirs.begin(), dirs.end());
+			Randomness::shuffle(dirs.begin(), dirs.end());
 			for (const Move& move : dirs)
 			{
 				Cell target = from + move;
@@ -710,7 +746,7 @@ void AIRampantRhino::controlSettlers()
 
 			return hasNewOrder(desc);
 		}), _settlers.end());
-	std::random_shuffle(_settlers.begin(), _settlers.end());
+	Randomness::shuffle(_settlers.begin(), _settlers.end());
 	std::sort(_settlers.begin(), _settlers.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -729,10 +765,10 @@ void AIRampantRhino::controlSettler(const Descriptor& unitdesc)
 	Cell from = _board.cell(unitdesc.position);
 	const UnitToken& unit = _board.ground(from);
 
-	TileFloodfill enemyThreats(_bible, _board);
-	enemyThreats.exclude({_soiltype, _cropstype});
-	enemyThreats.exclude({_player, Player::NONE});
-	enemyThreats.execute();
+	TileFloodfill::Filter enemythreatsfilter;
+	enemythreatsfilter.exclude({_soiltype, _cropstype});
+	enemythreatsfilter.exclude({_player, Player::NONE});
+	const TileFloodfill& enemyThreats = _floodfills.get(enemythreatsfilter);
 
 	const auto& builds = _bible.unitSettles(unit.type);
 	bool cancity = false;
@@ -792,7 +828,7 @@ void AIRampantRhino::controlSettler(const Descriptor& unitdesc)
 			&& _moneyleftover >= citycost
 			&& niceness >= 6
 			&& canBuildCities()
-			&& (rand() % 2) == 0)
+			&& (Randomness::next() % 2) == 0)
 		{
 			_newOrders.emplace_back(Order::Type::SETTLE, unitdesc,
 				_citytype);
@@ -802,7 +838,7 @@ void AIRampantRhino::controlSettler(const Descriptor& unitdesc)
 		else if (canfarm
 			&& _moneyleftover >= farmcost
 			&& buildables >= 6
-			&& (rand() % 2) == 0)
+			&& (Randomness::next() % 2) == 0)
 		{
 			_newOrders.emplace_back(Order::Type::SETTLE, unitdesc,
 				_farmtype);
@@ -883,7 +919,7 @@ void AIRampantRhino::controlSettler(const Descriptor& unitdesc)
 		float score = 1.0f * expected / (turns + 1)
 				- 1.5f * std::max(0, 4 - threatdis) * economical
 				- 1.5f * (threatdis <= 1)
-				+ 0.001f * (rand() % 1000);
+				+ 0.001f * (Randomness::next() % 1000);
 		if (score > bestScore)
 		{
 			bestCell = at;
@@ -965,7 +1001,7 @@ void AIRampantRhino::createIndustry()
 
 			return hasNewOrder(desc);
 		}), _industrycreators.end());
-	std::random_shuffle(_industrycreators.begin(), _industrycreators.end());
+	Randomness::shuffle(_industrycreators.begin(), _industrycreators.end());
 	std::sort(_industrycreators.begin(), _industrycreators.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -994,7 +1030,7 @@ void AIRampantRhino::createIndustry(const Descriptor& citydesc)
 	if (_moneyleftover < cost) return;
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 
 	for (const Move& move : dirs)
 	{
@@ -1025,7 +1061,7 @@ void AIRampantRhino::createBarracks()
 
 			return hasNewOrder(desc);
 		}), _barrackscreators.end());
-	std::random_shuffle(_barrackscreators.begin(), _barrackscreators.end());
+	Randomness::shuffle(_barrackscreators.begin(), _barrackscreators.end());
 	std::sort(_barrackscreators.begin(), _barrackscreators.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1057,7 +1093,7 @@ void AIRampantRhino::createBarracks(const Descriptor& citydesc)
 	if (_moneyleftover - _moneyreserved < cost) return;
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 
 	for (const Move& move : dirs)
 	{
@@ -1088,7 +1124,7 @@ void AIRampantRhino::upgradeDefenseCreator()
 
 			return hasNewOrder(desc);
 		}), _defenseupgraders.end());
-	std::random_shuffle(_defenseupgraders.begin(), _defenseupgraders.end());
+	Randomness::shuffle(_defenseupgraders.begin(), _defenseupgraders.end());
 	std::sort(_defenseupgraders.begin(), _defenseupgraders.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1142,7 +1178,7 @@ void AIRampantRhino::upgradeEconomy()
 
 			return hasNewOrder(desc);
 		}), _economyupgraders.end());
-	std::random_shuffle(_economyupgraders.begin(), _economyupgraders.end());
+	Randomness::shuffle(_economyupgraders.begin(), _economyupgraders.end());
 	std::sort(_economyupgraders.begin(), _economyupgraders.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1190,7 +1226,7 @@ void AIRampantRhino::controlCultivators()
 
 			return hasNewOrder(desc);
 		}), _cultivators.end());
-	std::random_shuffle(_cultivators.begin(), _cultivators.end());
+	Randomness::shuffle(_cultivators.begin(), _cultivators.end());
 	std::sort(_cultivators.begin(), _cultivators.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1227,11 +1263,11 @@ void AIRampantRhino::createDefenses()
 
 	if (canBuildBarracks())
 	{
-		if ((rand() % (_defensecreators.size() + 1)) > 2)
+		if ((Randomness::next() % (_defensecreators.size() + 1)) > 2)
 		{
 			upgradeDefenseCreator();
 		}
-		else if ((rand() % (_defensecreators.size() + 1)) < 3)
+		else if ((Randomness::next() % (_defensecreators.size() + 1)) < 3)
 		{
 			createBarracks();
 		}
@@ -1247,7 +1283,7 @@ void AIRampantRhino::createDefenses()
 
 			return hasNewOrder(desc);
 		}), _defensecreators.end());
-	std::random_shuffle(_defensecreators.begin(), _defensecreators.end());
+	Randomness::shuffle(_defensecreators.begin(), _defensecreators.end());
 	std::sort(_defensecreators.begin(), _defensecreators.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1269,7 +1305,7 @@ void AIRampantRhino::createDefenses()
 				return !_bible.unitCanAttack(build.type);
 		}), prods.end());
 		if (prods.empty()) continue;
-		std::random_shuffle(prods.begin(), prods.end());
+		Randomness::shuffle(prods.begin(), prods.end());
 		while (_moneyleftover - _moneyreserved < prods.back().cost)
 		{
 			prods.pop_back();
@@ -1309,7 +1345,7 @@ void AIRampantRhino::createDefenses()
 		if (!attackofopportunity)
 		{
 			std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-			std::random_shuffle(dirs.begin(), dirs.end());
+			Randomness::shuffle(dirs.begin(), dirs.end());
 			for (const Move& move : dirs)
 			{
 				Cell target = from + move;
@@ -1349,7 +1385,7 @@ void AIRampantRhino::declareOffenses()
 
 			return hasNewOrder(desc);
 		}), _defenses.end());
-	std::random_shuffle(_defenses.begin(), _defenses.end());
+	Randomness::shuffle(_defenses.begin(), _defenses.end());
 	std::sort(_defenses.begin(), _defenses.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1370,7 +1406,7 @@ void AIRampantRhino::controlDefenses()
 
 			return hasNewOrder(desc);
 		}), _defenses.end());
-	std::random_shuffle(_defenses.begin(), _defenses.end());
+	Randomness::shuffle(_defenses.begin(), _defenses.end());
 	std::sort(_defenses.begin(), _defenses.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1391,7 +1427,7 @@ void AIRampantRhino::controlIdleDefenses()
 
 			return hasNewOrder(desc);
 		}), _defenses.end());
-	std::random_shuffle(_defenses.begin(), _defenses.end());
+	Randomness::shuffle(_defenses.begin(), _defenses.end());
 	std::sort(_defenses.begin(), _defenses.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1412,7 +1448,7 @@ void AIRampantRhino::controlOffenses()
 
 			return hasNewOrder(desc);
 		}), _offenses.end());
-	std::random_shuffle(_offenses.begin(), _offenses.end());
+	Randomness::shuffle(_offenses.begin(), _offenses.end());
 	std::sort(_offenses.begin(), _offenses.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1433,7 +1469,7 @@ void AIRampantRhino::controlCaptors()
 
 			return hasNewOrder(desc);
 		}), _captors.end());
-	std::random_shuffle(_captors.begin(), _captors.end());
+	Randomness::shuffle(_captors.begin(), _captors.end());
 	std::sort(_captors.begin(), _captors.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1454,7 +1490,7 @@ void AIRampantRhino::controlBlockers()
 
 			return hasNewOrder(desc);
 		}), _blockers.end());
-	std::random_shuffle(_blockers.begin(), _blockers.end());
+	Randomness::shuffle(_blockers.begin(), _blockers.end());
 	std::sort(_blockers.begin(), _blockers.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1475,7 +1511,7 @@ void AIRampantRhino::controlBombarders()
 
 			return hasNewOrder(desc);
 		}), _bombarders.end());
-	std::random_shuffle(_bombarders.begin(), _bombarders.end());
+	Randomness::shuffle(_bombarders.begin(), _bombarders.end());
 	std::sort(_bombarders.begin(), _bombarders.end(), [this](
 			const Descriptor& a, const Descriptor& b){
 
@@ -1496,7 +1532,7 @@ void AIRampantRhino::controlStoppers()
 
 			return hasNewOrder(desc);
 		}), _stoppers.end());
-	std::random_shuffle(_stoppers.begin(), _stoppers.end());
+	Randomness::shuffle(_stoppers.begin(), _stoppers.end());
 	// All stoppers have old orders.
 	int max = std::max(0, (int) _stoppers.size());
 	for (int i = 0; i < max && (int) _newOrders.size() < maxOrders(); i++)
@@ -1542,7 +1578,7 @@ bool AIRampantRhino::checkLockdown(const Descriptor& unitdesc)
 	}
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 	for (const Move& move : dirs)
 	{
 		Cell target = at + move;
@@ -1608,7 +1644,7 @@ void AIRampantRhino::controlIdleDefense(const Descriptor& unitdesc)
 	}
 
 	std::vector<Move> dirs = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(dirs.begin(), dirs.end());
+	Randomness::shuffle(dirs.begin(), dirs.end());
 	for (const Move& move : dirs)
 	{
 		Cell target = at + move;
@@ -1685,7 +1721,7 @@ void AIRampantRhino::controlBlocker(const Descriptor& unitdesc)
 		int expected = 100.0f * (1 + bonus);
 		int turns = std::max(1, (pathing.steps(at) + speed - 1) / speed);
 		float score = 1.0f * expected / (turns + 1)
-				+ 0.001f * (rand() % 1000);
+				+ 0.001f * (Randomness::next() % 1000);
 		if (score > bestScore)
 		{
 			bestCell = at;
@@ -1765,16 +1801,16 @@ void AIRampantRhino::controlDefense(const Descriptor& unitdesc)
 	pathing.put(from);
 	pathing.execute();
 
-	TileFloodfill enemyThreats(_bible, _board);
-	enemyThreats.exclude({_soiltype, _cropstype});
-	enemyThreats.exclude({_player, Player::NONE});
-	enemyThreats.execute();
+	TileFloodfill::Filter enemythreatsfilter;
+	enemythreatsfilter.exclude({_soiltype, _cropstype});
+	enemythreatsfilter.exclude({_player, Player::NONE});
+	const TileFloodfill& enemyThreats = _floodfills.get(enemythreatsfilter);
 
 	int currentthreatdis = enemyThreats.steps(from);
 
-	TileFloodfill civilians(_bible, _board);
-	civilians.include({_player});
-	civilians.execute();
+	TileFloodfill::Filter civiliansfilter;
+	civiliansfilter.include({_player});
+	const TileFloodfill& civilians = _floodfills.get(civiliansfilter);
 
 	int speed = _bible.unitSpeed(unit.type);
 	if (speed < 1) return;
@@ -1828,7 +1864,7 @@ void AIRampantRhino::controlDefense(const Descriptor& unitdesc)
 		int expected = 100.0f * (4 + bonus) / 5;
 		int turns = std::max(1, (pathing.steps(at) + speed - 1) / speed);
 		float score = 1.0f * expected / (3 * turns + 1)
-				+ 0.001f * (rand() % 1000);
+				+ 0.001f * (Randomness::next() % 1000);
 		if (at == from)
 		{
 			currentScore = score;
@@ -1914,16 +1950,16 @@ void AIRampantRhino::declareOffense(const Descriptor& unitdesc)
 	pathing.put(from);
 	pathing.execute();
 
-	TileFloodfill enemyThreats(_bible, _board);
-	enemyThreats.exclude({_soiltype, _cropstype});
-	enemyThreats.exclude({_player, Player::NONE});
-	enemyThreats.execute();
+	TileFloodfill::Filter enemythreatsfilter;
+	enemythreatsfilter.exclude({_soiltype, _cropstype});
+	enemythreatsfilter.exclude({_player, Player::NONE});
+	const TileFloodfill& enemyThreats = _floodfills.get(enemythreatsfilter);
 
 	int currentthreatdis = enemyThreats.steps(from);
 
-	TileFloodfill civilians(_bible, _board);
-	civilians.include({_player});
-	civilians.execute();
+	TileFloodfill::Filter civiliansfilter;
+	civiliansfilter.include({_player});
+	const TileFloodfill& civilians = _floodfills.get(civiliansfilter);
 
 	UnitType unittype = unit.type;
 	bool canCapture = _bible.unitCanCapture(unittype);
@@ -2003,7 +2039,7 @@ void AIRampantRhino::declareOffense(const Descriptor& unitdesc)
 		int expected = 100.0f * (6 + bonus) / (4 + threatdis);
 		int turns = std::max(1, (pathing.steps(at) + speed - 1) / speed);
 		float score = 1.0f * expected / (2 + turns)
-				+ 0.001f * (rand() % 1000);
+				+ 0.001f * (Randomness::next() % 1000);
 		if (at == from)
 		{
 			currentScore = score;
@@ -2144,7 +2180,7 @@ void AIRampantRhino::controlBombarder(const Descriptor& unitdesc)
 		}
 		if (expected <= 0) continue;
 		float score = (50.0f + 50.0f * _board.current(target)) * expected
-				+ 0.001f * (rand() % 1000);
+				+ 0.001f * (Randomness::next() % 1000);
 		if (score > bestScore)
 		{
 			bestCell = target;
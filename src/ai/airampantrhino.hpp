@@ -41,6 +41,17 @@ public:
 	virtual ~AIRampantRhino() = default;
 
 private:
+	// The orders are prepared in stages, in order of importance.
+	enum class Stage : uint8_t
+	{
+		TACTICS,
+		MILITARY,
+		ECONOMY,
+		IDLE,
+	};
+
+	Stage _stage;
+
 	TileType _citytype;
 	TileType _towntype;
 	TileType _outposttype;
@@ -145,5 +156,7 @@ protected:
 	virtual std::string ainame() const override;
 	virtual std::string authors() const override;
 
+	virtual void preprocess() override;
 	virtual void process() override;
+	virtual bool postprocess() override;
 };
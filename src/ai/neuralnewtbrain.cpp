@@ -0,0 +1,508 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "neuralnewtbrain.hpp"
+#include "source.hpp"
+
+#include <mutex>
+#include <map>
+#include <cstring>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define NEWT_AVX2_ENABLED true
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define NEWT_SSE2_ENABLED true
+#include <emmintrin.h>
+#endif
+
+#include "aicommander.hpp"
+#include "system.hpp"
+#include "cycle.hpp"
+
+
+/*
+The model file has the following layout, with all integers little endian and
+all floats as little endian IEEE 754 single precision:
+
+	4 bytes "NEWT", u8 VERSION, u32 count,
+	count times { u32 inputs, u32 outputs, u8 activation,
+		outputs times inputs floats of weights (row-major),
+		outputs floats of biases }
+
+The first layer must take INPUT_SIZE inputs and the last layer must produce
+Output::SIZE outputs.
+*/
+
+static constexpr uint8_t NEURALNEWTBRAIN_VERSION = 1;
+static constexpr size_t NEURALNEWTBRAIN_MAX_WIDTH = 1 << 20;
+
+static size_t newtStride(size_t width)
+{
+	return (width + 7) & ~((size_t) 7);
+}
+
+static bool takeNewtInteger(const std::string& data, size_t& cursor,
+	uint32_t& value)
+{
+	if (cursor + 4 > data.size()) return false;
+	value = 0;
+	for (size_t i = 0; i < 4; i++)
+	{
+		value |= ((uint32_t) (uint8_t) data[cursor + i]) << (8 * i);
+	}
+	cursor += 4;
+	return true;
+}
+
+static bool takeNewtFloats(const std::string& data, size_t& cursor,
+	float* values, size_t count)
+{
+	if (cursor + 4 * count > data.size()) return false;
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t bits;
+		takeNewtInteger(data, cursor, bits);
+		std::memcpy(&values[i], &bits, sizeof(float));
+	}
+	return true;
+}
+
+#if NEWT_AVX2_ENABLED
+static float newtSum(__m256 sum)
+{
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(sum),
+		_mm256_extractf128_ps(sum, 1));
+	half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+	half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+	return _mm_cvtss_f32(half);
+}
+#elif NEWT_SSE2_ENABLED
+static float newtSum(__m128 sum)
+{
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+	return _mm_cvtss_f32(sum);
+}
+#endif
+
+// The length is a multiple of 8 and the padding of both vectors is zero.
+static float newtDot(const float* a, const float* b, size_t length)
+{
+#if NEWT_AVX2_ENABLED
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+			_mm256_loadu_ps(b + i), sum0);
+		sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8),
+			_mm256_loadu_ps(b + i + 8), sum1);
+	}
+	if (i < length)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+			_mm256_loadu_ps(b + i), sum0);
+	}
+	return newtSum(_mm256_add_ps(sum0, sum1));
+#elif NEWT_SSE2_ENABLED
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+	for (size_t i = 0; i < length; i += 8)
+	{
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i),
+			_mm_loadu_ps(b + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+			_mm_loadu_ps(b + i + 4)));
+	}
+	return newtSum(_mm_add_ps(sum0, sum1));
+#else
+	float sum[4] = {0, 0, 0, 0};
+	for (size_t i = 0; i < length; i += 4)
+	{
+		sum[0] += a[i + 0] * b[i + 0];
+		sum[1] += a[i + 1] * b[i + 1];
+		sum[2] += a[i + 2] * b[i + 2];
+		sum[3] += a[i + 3] * b[i + 3];
+	}
+	return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+#endif
+}
+
+// Like newtDot(), but with four vectors b at once, so that every value of a
+// is loaded only once.
+static void newtDot4(const float* a, const float* const* b, size_t length,
+	float results[4])
+{
+#if NEWT_AVX2_ENABLED
+	__m256 sum[4] = {
+		_mm256_setzero_ps(), _mm256_setzero_ps(),
+		_mm256_setzero_ps(), _mm256_setzero_ps(),
+	};
+	for (size_t i = 0; i < length; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(a + i);
+		for (size_t k = 0; k < 4; k++)
+		{
+			sum[k] = _mm256_fmadd_ps(x, _mm256_loadu_ps(b[k] + i), sum[k]);
+		}
+	}
+	for (size_t k = 0; k < 4; k++)
+	{
+		results[k] = newtSum(sum[k]);
+	}
+#elif NEWT_SSE2_ENABLED
+	__m128 sum[4] = {
+		_mm_setzero_ps(), _mm_setzero_ps(),
+		_mm_setzero_ps(), _mm_setzero_ps(),
+	};
+	for (size_t i = 0; i < length; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(a + i);
+		for (size_t k = 0; k < 4; k++)
+		{
+			sum[k] = _mm_add_ps(sum[k],
+				_mm_mul_ps(x, _mm_loadu_ps(b[k] + i)));
+		}
+	}
+	for (size_t k = 0; k < 4; k++)
+	{
+		results[k] = newtSum(sum[k]);
+	}
+#else
+	float sum[4] = {0, 0, 0, 0};
+	for (size_t i = 0; i < length; i++)
+	{
+		for (size_t k = 0; k < 4; k++)
+		{
+			sum[k] += a[i] * b[k][i];
+		}
+	}
+	for (size_t k = 0; k < 4; k++)
+	{
+		results[k] = sum[k];
+	}
+#endif
+}
+
+static void newtActivate(float* values, size_t count,
+	NeuralNewtBrain::Activation activation)
+{
+	switch (activation)
+	{
+		case NeuralNewtBrain::Activation::LINEAR:
+		break;
+		case NeuralNewtBrain::Activation::RELU:
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				values[i] = std::max(values[i], 0.0f);
+			}
+		}
+		break;
+		case NeuralNewtBrain::Activation::SIGMOID:
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				values[i] = 1.0f / (1.0f + std::exp(-values[i]));
+			}
+		}
+		break;
+		case NeuralNewtBrain::Activation::TANH:
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				values[i] = std::tanh(values[i]);
+			}
+		}
+		break;
+	}
+}
+
+NeuralNewtBrain::NeuralNewtBrain(std::shared_ptr<const Model> model) :
+	_model(std::move(model)),
+	_input(newtStride(INPUT_SIZE), 0.0f)
+{
+	size_t width = 0;
+	for (const Layer& layer : _model->layers)
+	{
+		width = std::max(width, newtStride(layer.outputs));
+	}
+	_front.reserve(width);
+	_back.reserve(width);
+}
+
+void NeuralNewtBrain::prepare(const AICommander& ai)
+{
+	std::fill(_input.begin(), _input.end(), 0.0f);
+
+	const Board& board = ai._board;
+	const Player& player = ai._player;
+	for (Cell index : board)
+	{
+		Position pos = index.pos();
+		if (pos.row >= Position::MAX_ROWS || pos.col >= Position::MAX_COLS)
+		{
+			continue;
+		}
+		float* cell = _input.data() + pos.row * Position::MAX_COLS + pos.col;
+
+		const TileToken& tile = board.tile(index);
+		if (tile)
+		{
+			cell[PLANE_SIZE * TILE_OWN] = (tile.owner == player);
+			cell[PLANE_SIZE * TILE_ENEMY] = (tile.owner != player
+				&& tile.owner != Player::NONE);
+			cell[PLANE_SIZE * TILE_TYPE] = ((float) (size_t) tile.type)
+				/ TILETYPE_SIZE;
+			cell[PLANE_SIZE * TILE_STACKS] = 0.2f * tile.stacks;
+			cell[PLANE_SIZE * TILE_POWER] = 0.2f * tile.power;
+		}
+
+		const UnitToken& ground = board.ground(index);
+		if (ground)
+		{
+			cell[PLANE_SIZE * GROUND_OWN] = (ground.owner == player);
+			cell[PLANE_SIZE * GROUND_ENEMY] = (ground.owner != player);
+			cell[PLANE_SIZE * GROUND_TYPE] = ((float) (size_t) ground.type)
+				/ UNITTYPE_SIZE;
+			cell[PLANE_SIZE * GROUND_STACKS] = 0.2f * ground.stacks;
+		}
+
+		const UnitToken& air = board.air(index);
+		if (air)
+		{
+			cell[PLANE_SIZE * AIR_OWN] = (air.owner == player);
+			cell[PLANE_SIZE * AIR_ENEMY] = (air.owner != player);
+			cell[PLANE_SIZE * AIR_TYPE] = ((float) (size_t) air.type)
+				/ UNITTYPE_SIZE;
+			cell[PLANE_SIZE * AIR_STACKS] = 0.2f * air.stacks;
+		}
+
+		cell[PLANE_SIZE * VISIBLE] = board.vision(index).contains(player);
+		cell[PLANE_SIZE * TEMPERATURE] = 0.01f * board.temperature(index);
+		cell[PLANE_SIZE * HUMIDITY] = 0.01f * board.humidity(index);
+		cell[PLANE_SIZE * CHAOS] = 0.1f * board.chaos(index);
+		cell[PLANE_SIZE * GAS] = 0.2f * board.gas(index);
+		cell[PLANE_SIZE * RADIATION] = 0.2f * board.radiation(index);
+		cell[PLANE_SIZE * SNOW] = board.snow(index);
+		cell[PLANE_SIZE * FROSTBITE] = board.frostbite(index);
+		cell[PLANE_SIZE * FIRESTORM] = board.firestorm(index);
+		cell[PLANE_SIZE * BONEDROUGHT] = board.bonedrought(index);
+		cell[PLANE_SIZE * DEATH] = board.death(index);
+	}
+
+	float* global = _input.data() + CHANNEL_SIZE * PLANE_SIZE;
+	global[MONEY] = 0.01f * ai._money;
+	global[SCORE] = 0.01f * ai._score;
+	global[YEAR] = 0.01f * ai._year;
+	global[SPRING + (size_t) ai._season] = 1.0f;
+	global[LATE + (size_t) ai._daytime] = 1.0f;
+}
+
+NewtBrain::Output NeuralNewtBrain::evaluate()
+{
+	const float* in = _input.data();
+	for (size_t l = 0; l < _model->layers.size(); l++)
+	{
+		const Layer& layer = _model->layers[l];
+		std::vector<float>& out = (l % 2 == 0) ? _front : _back;
+
+		// The padding must be zero because it is part of the next dot product.
+		out.assign(newtStride(layer.outputs), 0.0f);
+		const float* row = layer.weights.data();
+		for (size_t o = 0; o < layer.outputs; o++)
+		{
+			out[o] = layer.biases[o] + newtDot(row, in, layer.stride);
+			row += layer.stride;
+		}
+		newtActivate(out.data(), layer.outputs, layer.activation);
+		in = out.data();
+	}
+
+	Output output;
+	output.assign(in);
+	return output;
+}
+
+void NeuralNewtBrain::evaluateBatch(const std::vector<NewtBrain*>& brains,
+	const std::vector<size_t>& indices, std::vector<Output>& outputs)
+{
+	// All of these brains have the same model as this one.
+	size_t n = indices.size();
+	std::vector<NeuralNewtBrain*> batch(n);
+	std::vector<const float*> ins(n);
+	std::vector<float*> outs(n);
+	for (size_t k = 0; k < n; k++)
+	{
+		batch[k] = static_cast<NeuralNewtBrain*>(brains[indices[k]]);
+		ins[k] = batch[k]->_input.data();
+	}
+
+	for (size_t l = 0; l < _model->layers.size(); l++)
+	{
+		const Layer& layer = _model->layers[l];
+		for (size_t k = 0; k < n; k++)
+		{
+			std::vector<float>& out = (l % 2 == 0)
+				? batch[k]->_front
+				: batch[k]->_back;
+			out.assign(newtStride(layer.outputs), 0.0f);
+			outs[k] = out.data();
+		}
+
+		// Each row of weights is used for every brain before moving on, so
+		// that the weights are read from memory once per batch.
+		const float* row = layer.weights.data();
+		for (size_t o = 0; o < layer.outputs; o++)
+		{
+			size_t k = 0;
+			for (; k + 4 <= n; k += 4)
+			{
+				float results[4];
+				newtDot4(row, ins.data() + k, layer.stride, results);
+				for (size_t j = 0; j < 4; j++)
+				{
+					outs[k + j][o] = layer.biases[o] + results[j];
+				}
+			}
+			for (; k < n; k++)
+			{
+				outs[k][o] = layer.biases[o]
+					+ newtDot(row, ins[k], layer.stride);
+			}
+			row += layer.stride;
+		}
+
+		for (size_t k = 0; k < n; k++)
+		{
+			newtActivate(outs[k], layer.outputs, layer.activation);
+			ins[k] = outs[k];
+		}
+	}
+
+	for (size_t k = 0; k < n; k++)
+	{
+		outputs[indices[k]].assign(ins[k]);
+	}
+}
+
+std::shared_ptr<const NeuralNewtBrain::Model> NeuralNewtBrain::parse(
+	const std::string& data)
+{
+	size_t cursor = 0;
+	uint32_t count;
+	if (data.compare(0, 4, "NEWT") != 0
+		|| data.size() < 5
+		|| (uint8_t) data[4] != NEURALNEWTBRAIN_VERSION)
+	{
+		return nullptr;
+	}
+	cursor = 5;
+	if (!takeNewtInteger(data, cursor, count)) return nullptr;
+
+	// Each layer takes at least two integers and an activation byte, so
+	// check the count before reserving space for it, in case it is corrupt.
+	if (count > (data.size() - cursor) / (4 + 4 + 1)) return nullptr;
+
+	std::shared_ptr<Model> model = std::make_shared<Model>();
+	model->layers.reserve(count);
+	size_t expected = INPUT_SIZE;
+	for (size_t l = 0; l < count; l++)
+	{
+		Layer layer;
+		uint32_t inputs;
+		uint32_t outputs;
+		if (!takeNewtInteger(data, cursor, inputs)
+			|| !takeNewtInteger(data, cursor, outputs)
+			|| cursor + 1 > data.size()
+			|| inputs != expected
+			|| outputs == 0 || outputs > NEURALNEWTBRAIN_MAX_WIDTH
+			|| (uint8_t) data[cursor] > (uint8_t) Activation::TANH)
+		{
+			return nullptr;
+		}
+		layer.inputs = inputs;
+		layer.outputs = outputs;
+		layer.stride = newtStride(inputs);
+		layer.activation = (Activation) (uint8_t) data[cursor];
+		cursor += 1;
+
+		// Check the size before allocating, in case the file is corrupt.
+		if (cursor + 4 * ((size_t) inputs + 1) * outputs > data.size())
+		{
+			return nullptr;
+		}
+		layer.weights.resize(layer.stride * outputs, 0.0f);
+		for (size_t o = 0; o < outputs; o++)
+		{
+			takeNewtFloats(data, cursor,
+				layer.weights.data() + o * layer.stride, inputs);
+		}
+		layer.biases.resize(outputs);
+		takeNewtFloats(data, cursor, layer.biases.data(), outputs);
+
+		model->layers.push_back(std::move(layer));
+		expected = outputs;
+	}
+
+	if (expected != Output::SIZE || cursor != data.size()) return nullptr;
+
+	return model;
+}
+
+std::shared_ptr<const NeuralNewtBrain::Model> NeuralNewtBrain::load(
+	const std::string& filename)
+{
+	static std::mutex mutex;
+	static std::map<std::string, std::weak_ptr<const Model>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::shared_ptr<const Model> model = cache[filename].lock();
+	if (model) return model;
+
+	std::ifstream file = System::ifstream(filename,
+		std::ifstream::in | std::ifstream::binary);
+	if (!file) return nullptr;
+
+	std::string data((std::istreambuf_iterator<char>(file)),
+		std::istreambuf_iterator<char>());
+	model = parse(data);
+	if (!model)
+	{
+		LOGE << "Failed to parse '" << filename << "'";
+		return nullptr;
+	}
+
+	cache[filename] = model;
+	return model;
+}
+
+std::shared_ptr<NewtBrain> NeuralNewtBrain::create(
+	const std::string& filename)
+{
+	std::shared_ptr<const Model> model = load(filename);
+	if (!model) return nullptr;
+	return std::make_shared<NeuralNewtBrain>(std::move(model));
+}
@@ -0,0 +1,139 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "newtbrain.hpp"
+
+
+// A NewtBrain that evaluates a multilayer perceptron on the CPU, using the
+// widest SIMD instructions that the compiler was allowed to emit.
+class NeuralNewtBrain : public NewtBrain
+{
+public:
+	// The input consists of one plane of MAX_ROWS x MAX_COLS values per
+	// channel, in row-major order, followed by the global values.
+	enum Channel : uint8_t
+	{
+		TILE_OWN,
+		TILE_ENEMY,
+		TILE_TYPE,
+		TILE_STACKS,
+		TILE_POWER,
+		GROUND_OWN,
+		GROUND_ENEMY,
+		GROUND_TYPE,
+		GROUND_STACKS,
+		AIR_OWN,
+		AIR_ENEMY,
+		AIR_TYPE,
+		AIR_STACKS,
+		VISIBLE,
+		TEMPERATURE,
+		HUMIDITY,
+		CHAOS,
+		GAS,
+		RADIATION,
+		SNOW,
+		FROSTBITE,
+		FIRESTORM,
+		BONEDROUGHT,
+		DEATH,
+	};
+
+	static constexpr size_t CHANNEL_SIZE = DEATH + 1;
+
+	enum Global : uint8_t
+	{
+		MONEY,
+		SCORE,
+		YEAR,
+		SPRING,
+		SUMMER,
+		AUTUMN,
+		WINTER,
+		LATE,
+		EARLY,
+	};
+
+	static constexpr size_t GLOBAL_SIZE = EARLY + 1;
+
+	static constexpr size_t PLANE_SIZE = Position::MAX_ROWS
+		* Position::MAX_COLS;
+	static constexpr size_t INPUT_SIZE = CHANNEL_SIZE * PLANE_SIZE
+		+ GLOBAL_SIZE;
+
+	enum class Activation : uint8_t
+	{
+		LINEAR,
+		RELU,
+		SIGMOID,
+		TANH,
+	};
+
+	struct Layer
+	{
+		size_t inputs;
+		size_t outputs;
+		size_t stride; // (inputs rounded up to a multiple of 8)
+		Activation activation;
+		std::vector<float> weights; // (outputs rows of stride values)
+		std::vector<float> biases;
+	};
+
+	struct Model
+	{
+		std::vector<Layer> layers;
+	};
+
+	NeuralNewtBrain(std::shared_ptr<const Model> model);
+	NeuralNewtBrain(const NeuralNewtBrain&) = delete;
+	NeuralNewtBrain(NeuralNewtBrain&&) = delete;
+	NeuralNewtBrain& operator=(const NeuralNewtBrain&) = delete;
+	NeuralNewtBrain& operator=(NeuralNewtBrain&&) = delete;
+	virtual ~NeuralNewtBrain() = default;
+
+private:
+	std::shared_ptr<const Model> _model;
+	std::vector<float> _input;
+	std::vector<float> _front;
+	std::vector<float> _back;
+
+protected:
+	virtual const void* batchKey() const override { return _model.get(); }
+	virtual void evaluateBatch(const std::vector<NewtBrain*>& brains,
+		const std::vector<size_t>& indices,
+		std::vector<Output>& outputs) override;
+
+public:
+	virtual void prepare(const AICommander& input) override;
+	virtual Output evaluate() override;
+
+	// Models are shared between all brains that load the same file.
+	static std::shared_ptr<const Model> load(const std::string& filename);
+	static std::shared_ptr<const Model> parse(const std::string& data);
+
+	// Returns null if the model could not be loaded.
+	static std::shared_ptr<NewtBrain> create(const std::string& filename);
+};
@@ -29,52 +29,91 @@ void NewtBrain::Output::assign(const std::vector<float>& data)
 {
 	DEBUG_ASSERT(data.size() == Output::SIZE);
 
+	assign(data.data());
+}
+
+void NewtBrain::Output::assign(const float* data)
+{
 	size_t i = 0;
 
-	DEBUG_ASSERT(data.begin() + i + Output::PARAMETER_SIZE <= data.end());
 	DEBUG_ASSERT(params.size() == Output::PARAMETER_SIZE);
-	std::copy(data.begin() + i, data.begin() + i + Output::PARAMETER_SIZE,
-		params.begin());
+	std::copy(data + i, data + i + Output::PARAMETER_SIZE, params.begin());
 	i += Output::PARAMETER_SIZE;
 
-	DEBUG_ASSERT(data.begin() + i + TILETYPE_SIZE <= data.end());
 	DEBUG_ASSERT(tiletypes.size() == TILETYPE_SIZE);
-	std::copy(data.begin() + i, data.begin() + i + TILETYPE_SIZE,
-		tiletypes.begin());
+	std::copy(data + i, data + i + TILETYPE_SIZE, tiletypes.begin());
 	i += TILETYPE_SIZE;
 
-	DEBUG_ASSERT(data.begin() + i + UNITTYPE_SIZE <= data.end());
 	DEBUG_ASSERT(unittypes.size() == UNITTYPE_SIZE);
-	std::copy(data.begin() + i, data.begin() + i + UNITTYPE_SIZE,
-		unittypes.begin());
+	std::copy(data + i, data + i + UNITTYPE_SIZE, unittypes.begin());
 	i += UNITTYPE_SIZE;
 
 	for (auto& row : groundSubjectPreference)
 	{
-		DEBUG_ASSERT(data.begin() + i + Position::MAX_COLS <= data.end());
 		DEBUG_ASSERT(row.size() == Position::MAX_COLS);
-		std::copy(data.begin() + i, data.begin() + i + Position::MAX_COLS,
-			row.begin());
+		std::copy(data + i, data + i + Position::MAX_COLS, row.begin());
 		i += Position::MAX_COLS;
 	}
 
 	for (auto& row : tileSubjectPreference)
 	{
-		DEBUG_ASSERT(data.begin() + i + Position::MAX_COLS <= data.end());
 		DEBUG_ASSERT(row.size() == Position::MAX_COLS);
-		std::copy(data.begin() + i, data.begin() + i + Position::MAX_COLS,
-			row.begin());
+		std::copy(data + i, data + i + Position::MAX_COLS, row.begin());
 		i += Position::MAX_COLS;
 	}
 
 	for (auto& row : placementPreference)
 	{
-		DEBUG_ASSERT(data.begin() + i + Position::MAX_COLS <= data.end());
 		DEBUG_ASSERT(row.size() == Position::MAX_COLS);
-		std::copy(data.begin() + i, data.begin() + i + Position::MAX_COLS,
-			row.begin());
+		std::copy(data + i, data + i + Position::MAX_COLS, row.begin());
 		i += Position::MAX_COLS;
 	}
+
+	DEBUG_ASSERT(i == Output::SIZE);
+}
+
+void NewtBrain::evaluateBatch(const std::vector<NewtBrain*>& brains,
+	const std::vector<size_t>& indices, std::vector<Output>& outputs)
+{
+	for (size_t i : indices)
+	{
+		outputs[i] = brains[i]->evaluate();
+	}
+}
+
+void NewtBrain::evaluate(const std::vector<NewtBrain*>& brains,
+	std::vector<Output>& outputs)
+{
+	outputs.resize(brains.size());
+
+	std::vector<std::pair<const void*, std::vector<size_t>>> batches;
+	for (size_t i = 0; i < brains.size(); i++)
+	{
+		const void* key = brains[i]->batchKey();
+		if (key == nullptr)
+		{
+			outputs[i] = brains[i]->evaluate();
+			continue;
+		}
+
+		auto iter = std::find_if(batches.begin(), batches.end(),
+			[key](const std::pair<const void*, std::vector<size_t>>& batch) {
+
+			return batch.first == key;
+		});
+		if (iter == batches.end())
+		{
+			batches.emplace_back(key, std::vector<size_t>());
+			iter = batches.end() - 1;
+		}
+		iter->second.push_back(i);
+	}
+
+	for (const auto& batch : batches)
+	{
+		brains[batch.second.front()]->evaluateBatch(brains, batch.second,
+			outputs);
+	}
 }
 
 std::string NewtBrain::Output::toPrettyString() const
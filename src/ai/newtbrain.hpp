@@ -79,6 +79,7 @@ public:
 			+ Position::MAX_COLS * Position::MAX_ROWS;
 
 		void assign(const std::vector<float>& output);
+		void assign(const float* output);
 
 		std::string toPrettyString() const;
 	};
@@ -90,6 +91,19 @@ public:
 	NewtBrain& operator=(NewtBrain&&) = delete;
 	virtual ~NewtBrain() = default;
 
+protected:
+	// Brains with the same non-null batch key can be evaluated together by
+	// any one of them.
+	virtual const void* batchKey() const { return nullptr; }
+	virtual void evaluateBatch(const std::vector<NewtBrain*>& brains,
+		const std::vector<size_t>& indices, std::vector<Output>& outputs);
+
+public:
 	virtual void prepare(const AICommander& input) = 0;
 	virtual Output evaluate() = 0;
+
+	// Evaluates several prepared brains, which is cheaper per brain than
+	// evaluating them one by one if they can be batched.
+	static void evaluate(const std::vector<NewtBrain*>& brains,
+		std::vector<Output>& outputs);
 };
@@ -0,0 +1,212 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "source.hpp"
+
+#include <bitset>
+#include <chrono>
+
+#include "loginstaller.hpp"
+#include "bible.hpp"
+#include "library.hpp"
+#include "tiletype.hpp"
+#include "unittype.hpp"
+
+
+// The per-property layout that the accessors used to read from: one vector
+// or bitset per property, so that a handful of lookups for a single type
+// touches a handful of unrelated cache lines.
+struct PerPropertyBible
+{
+	std::vector<int8_t> tileStacksMax;
+	std::vector<int8_t> tilePowerMax;
+	std::vector<int8_t> tileVision;
+	std::vector<int8_t> tileHitpoints;
+	std::vector<int8_t> tileIncome;
+	std::vector<int8_t> tileEmission;
+	std::vector<int16_t> tileScoreBase;
+	std::bitset<TILETYPE_SIZE> tileAccessible;
+	std::bitset<TILETYPE_SIZE> tileBuildable;
+	std::bitset<TILETYPE_SIZE> tileOwnable;
+	std::bitset<TILETYPE_SIZE> tileNatural;
+
+	std::vector<int8_t> unitSpeed;
+	std::vector<int8_t> unitVision;
+	std::vector<int8_t> unitHitpoints;
+	std::vector<int8_t> unitAttackShots;
+	std::vector<int8_t> unitAttackDamage;
+	std::bitset<UNITTYPE_SIZE> unitAir;
+	std::bitset<UNITTYPE_SIZE> unitCanMove;
+	std::bitset<UNITTYPE_SIZE> unitCanAttack;
+
+	explicit PerPropertyBible(const Bible& bible) :
+		tileStacksMax(TILETYPE_SIZE, 0),
+		tilePowerMax(TILETYPE_SIZE, 0),
+		tileVision(TILETYPE_SIZE, 0),
+		tileHitpoints(TILETYPE_SIZE, 0),
+		tileIncome(TILETYPE_SIZE, 0),
+		tileEmission(TILETYPE_SIZE, 0),
+		tileScoreBase(TILETYPE_SIZE, 0),
+		unitSpeed(UNITTYPE_SIZE, 0),
+		unitVision(UNITTYPE_SIZE, 0),
+		unitHitpoints(UNITTYPE_SIZE, 0),
+		unitAttackShots(UNITTYPE_SIZE, 0),
+		unitAttackDamage(UNITTYPE_SIZE, 0)
+	{
+		for (size_t i = 0; i < TILETYPE_SIZE; i++)
+		{
+			TileType x = (TileType) i;
+			tileStacksMax[i] = bible.tileStacksMax(x);
+			tilePowerMax[i] = bible.tilePowerMax(x);
+			tileVision[i] = bible.tileVision(x);
+			tileHitpoints[i] = bible.tileHitpoints(x);
+			tileIncome[i] = bible.tileIncome(x);
+			tileEmission[i] = bible.tileEmission(x);
+			tileScoreBase[i] = bible.tileScoreBase(x);
+			tileAccessible[i] = bible.tileAccessible(x);
+			tileBuildable[i] = bible.tileBuildable(x);
+			tileOwnable[i] = bible.tileOwnable(x);
+			tileNatural[i] = bible.tileNatural(x);
+		}
+		for (size_t i = 0; i < UNITTYPE_SIZE; i++)
+		{
+			UnitType x = (UnitType) i;
+			unitSpeed[i] = bible.unitSpeed(x);
+			unitVision[i] = bible.unitVision(x);
+			unitHitpoints[i] = bible.unitHitpoints(x);
+			unitAttackShots[i] = bible.unitAttackShots(x);
+			unitAttackDamage[i] = bible.unitAttackDamage(x);
+			unitAir[i] = bible.unitAir(x);
+			unitCanMove[i] = bible.unitCanMove(x);
+			unitCanAttack[i] = bible.unitCanAttack(x);
+		}
+	}
+};
+
+static int biblebenchmark_tile(const PerPropertyBible& bible, size_t i)
+{
+	int result = bible.tileStacksMax[i] + bible.tilePowerMax[i]
+		+ bible.tileVision[i] + bible.tileHitpoints[i]
+		+ bible.tileIncome[i] + bible.tileEmission[i]
+		+ bible.tileScoreBase[i];
+	result += bible.tileAccessible[i];
+	result += 2 * bible.tileBuildable[i];
+	result += 4 * bible.tileOwnable[i];
+	result += 8 * bible.tileNatural[i];
+	return result;
+}
+
+static int biblebenchmark_tile(const Bible& bible, size_t i)
+{
+	TileType x = (TileType) i;
+	int result = bible.tileStacksMax(x) + bible.tilePowerMax(x)
+		+ bible.tileVision(x) + bible.tileHitpoints(x)
+		+ bible.tileIncome(x) + bible.tileEmission(x)
+		+ bible.tileScoreBase(x);
+	result += bible.tileAccessible(x);
+	result += 2 * bible.tileBuildable(x);
+	result += 4 * bible.tileOwnable(x);
+	result += 8 * bible.tileNatural(x);
+	return result;
+}
+
+static int biblebenchmark_unit(const PerPropertyBible& bible, size_t i)
+{
+	int result = bible.unitSpeed[i] + bible.unitVision[i]
+		+ bible.unitHitpoints[i] + bible.unitAttackShots[i]
+		+ bible.unitAttackDamage[i];
+	result += bible.unitAir[i];
+	result += 2 * bible.unitCanMove[i];
+	result += 4 * bible.unitCanAttack[i];
+	return result;
+}
+
+static int biblebenchmark_unit(const Bible& bible, size_t i)
+{
+	UnitType x = (UnitType) i;
+	int result = bible.unitSpeed(x) + bible.unitVision(x)
+		+ bible.unitHitpoints(x) + bible.unitAttackShots(x)
+		+ bible.unitAttackDamage(x);
+	result += bible.unitAir(x);
+	result += 2 * bible.unitCanMove(x);
+	result += 4 * bible.unitCanAttack(x);
+	return result;
+}
+
+template <class B>
+static int64_t biblebenchmark_run(const B& bible,
+	const std::vector<uint8_t>& tiles, const std::vector<uint8_t>& units,
+	size_t repetitions, const char* name)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	int64_t checksum = 0;
+	for (size_t r = 0; r < repetitions; r++)
+	{
+		for (size_t i = 0; i < tiles.size(); i++)
+		{
+			checksum += biblebenchmark_tile(bible, tiles[i]);
+			checksum += biblebenchmark_unit(bible, units[i]);
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		end - start).count();
+	double lookups = 2.0 * repetitions * tiles.size();
+	std::cout << name << ": " << (ns / lookups) << " ns per type"
+		<< " (" << (1000.0 * lookups / ns) << " million types per second)"
+		<< std::endl;
+	return checksum;
+}
+
+int main(int /**/, char* /**/[])
+{
+	LogInstaller("biblebenchmark", 5).install();
+
+	Library library;
+	library.load();
+	Bible bible = library.get(library.currentRuleset());
+	PerPropertyBible perproperty(bible);
+
+	// Random type indices, like those read off of a board during a sweep.
+	std::vector<uint8_t> tiles(1 << 16);
+	std::vector<uint8_t> units(1 << 16);
+	uint32_t seed = 2463534242;
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		tiles[i] = seed % TILETYPE_SIZE;
+		units[i] = (seed >> 8) % UNITTYPE_SIZE;
+	}
+
+	const size_t repetitions = 200;
+	int64_t before = biblebenchmark_run(perproperty, tiles, units,
+		repetitions, "per-property");
+	int64_t after = biblebenchmark_run(bible, tiles, units,
+		repetitions, "compiled    ");
+	std::cout << "checksum: " << before << " " << after << std::endl;
+	return (before == after) ? 0 : 1;
+}
@@ -26,6 +26,12 @@
 #include <csignal>
 #include <chrono>
 #include <unordered_map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
 
 #include "libs/SDL2/SDL_net.h"
 
@@ -41,6 +47,7 @@
 #include "writer.hpp"
 #include "parseerror.hpp"
 #include "curl.hpp"
+#include "framereader.hpp"
 #include "library.hpp"
 
 #include "player.hpp"
@@ -114,6 +121,86 @@ struct Key
 	};
 };
 
+// The changes received for one AI in one lobby, in the order they arrived.
+// They are decoded by the worker, which knows the ruleset of the AI.
+struct Job
+{
+	ParsedMessage message;
+};
+
+// A single AI together with the jobs that are waiting for it. At most one
+// worker handles a seat at any time, so its jobs are processed in order.
+struct Seat
+{
+	std::unique_ptr<AICLASS> ai;
+
+	std::mutex mutex;
+	std::deque<Job> jobs;
+	bool scheduled = false;
+};
+
+// Workers push the messages they want to send onto an intrusive stack with
+// a single atomic head; the main thread takes the whole stack at once and
+// reverses it to send the messages in the order they were completed.
+class Outbox
+{
+private:
+	struct Node
+	{
+		StreamedMessage message;
+		Node* next;
+	};
+
+	std::atomic<Node*> _head;
+
+public:
+	Outbox() :
+		_head(nullptr)
+	{}
+
+	~Outbox()
+	{
+		Node* node = _head.exchange(nullptr);
+		while (node)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	Outbox(const Outbox&) = delete;
+	Outbox(Outbox&&) = delete;
+	Outbox& operator=(const Outbox&) = delete;
+	Outbox& operator=(Outbox&&) = delete;
+
+	void push(StreamedMessage&& message)
+	{
+		Node* node = new Node{std::move(message), nullptr};
+		node->next = _head.load(std::memory_order_relaxed);
+		while (!_head.compare_exchange_weak(node->next, node,
+				std::memory_order_release, std::memory_order_relaxed))
+		{
+			// Another worker pushed in between; node->next has been updated.
+		}
+	}
+
+	std::vector<StreamedMessage> take()
+	{
+		Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+		std::vector<StreamedMessage> messages;
+		while (node)
+		{
+			Node* next = node->next;
+			messages.emplace_back(std::move(node->message));
+			delete node;
+			node = next;
+		}
+		std::reverse(messages.begin(), messages.end());
+		return messages;
+	}
+};
+
 class ConnectedBotSDL
 {
 public:
@@ -140,7 +227,7 @@ private:
 	std::shared_ptr<Curl> _curl;
 
 	TCPsocket _socket = nullptr;
-	SDLNet_SocketSet _socketset = nullptr;
+	FrameReader _reader;
 
 	uint64_t _msNow; // Apps Hungarian notation.
 
@@ -149,17 +236,28 @@ private:
 	bool _listed = false;
 	int _numActiveGames = 0;
 
-	std::unordered_map<Key, std::unique_ptr<AICLASS>,
+	std::unordered_map<Key, std::shared_ptr<Seat>,
 		Key::Hash, Key::Equals> _ais;
 
+	std::mutex _readymutex;
+	std::condition_variable _readynotifier;
+	std::deque<std::shared_ptr<Seat>> _ready;
+	bool _stopping = false;
+	Outbox _outbox;
+	std::vector<std::thread> _workers;
+
 	std::vector<std::string> _rulesetsRequested;
 	std::vector<std::pair<std::string, std::string>> _lobbiesWaiting;
 
 	bool checkForActivity();
-	int safelyReceive(TCPsocket socket, char* buffer, uint32_t length);
 
 	void sendMessage(const StreamedMessage& message);
 	void sendMessage(const char* data, uint32_t length);
+	void sendCompletedMessages();
+
+	void dispatch(const std::shared_ptr<Seat>& seat, Job&& job);
+	void work();
+	void plan(Seat& seat, const Job& job);
 
 	bool accessPortal(const std::string& url);
 	bool connect();
@@ -280,17 +378,37 @@ ConnectedBot::ConnectedBot(Settings& settings) :
 
 	_library.load();
 	_library.install();
+
+	size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+	if (_settings.jobs.defined() && _settings.jobs.value() > 0)
+	{
+		jobs = _settings.jobs.value();
+	}
+	LOGI << "Planning with " << jobs << " workers";
+	for (size_t j = 0; j < jobs; j++)
+	{
+		_workers.emplace_back([this]() {
+
+			work();
+		});
+	}
 }
 
 ConnectedBot::~ConnectedBot()
 {
-	if (_socketset)
 	{
-		SDLNet_FreeSocketSet(_socketset);
+		std::lock_guard<std::mutex> lock(_readymutex);
+		_stopping = true;
+	}
+	_readynotifier.notify_all();
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
 	}
 
 	if (_socket)
 	{
+		_reader.detach();
 		SDLNet_TCP_Close(_socket);
 	}
 }
@@ -298,7 +416,7 @@ ConnectedBot::~ConnectedBot()
 bool ConnectedBot::checkForActivity()
 {
 	SDL_ClearError();
-	int active = SDLNet_CheckSockets(_socketset, 1);
+	int active = _reader.check(1);
 	if (active < 0)
 	{
 		throw std::runtime_error("Error while checking for socket activity: "
@@ -307,24 +425,6 @@ bool ConnectedBot::checkForActivity()
 	else return (active > 0);
 }
 
-int ConnectedBot::safelyReceive(TCPsocket socket, char* buffer, uint32_t length)
-{
-	uint32_t receivedTotal = 0;
-	while (receivedTotal < length)
-	{
-		int received = SDLNet_TCP_Recv(socket, buffer + receivedTotal,
-			length - receivedTotal);
-		if (received <= 0)
-		{
-			LOGW << "Received too few bytes,"
-				" expected " << length << ", received " << receivedTotal;
-			return received;
-		}
-		receivedTotal += received;
-	}
-	return receivedTotal;
-}
-
 inline Json::Value createAiMetadata()
 {
 	Json::Value metadata = Json::objectValue;
@@ -378,6 +478,8 @@ void ConnectedBot::run()
 			sendMessage("", 0);
 			_msLastPulse = _msNow;
 		}
+
+		sendCompletedMessages();
 	}
 
 	if (_socket)
@@ -505,6 +607,103 @@ void ConnectedBot::sendMessage(const char* data, uint32_t length)
 	LOGI << "Sent message: \'" << data << "\'";
 }
 
+void ConnectedBot::sendCompletedMessages()
+{
+	for (const StreamedMessage& message : _outbox.take())
+	{
+		sendMessage(message);
+	}
+}
+
+void ConnectedBot::dispatch(const std::shared_ptr<Seat>& seat, Job&& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(seat->mutex);
+		seat->jobs.emplace_back(std::move(job));
+
+		// If a worker is already handling this seat, it will get to this job.
+		if (seat->scheduled) return;
+		seat->scheduled = true;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_readymutex);
+		_ready.emplace_back(seat);
+	}
+	_readynotifier.notify_one();
+}
+
+void ConnectedBot::work()
+{
+	// Writer::write() needs a Writer installed in this thread.
+	Writer writer;
+	writer.install();
+
+	while (true)
+	{
+		std::shared_ptr<Seat> seat;
+		{
+			std::unique_lock<std::mutex> lock(_readymutex);
+			_readynotifier.wait(lock, [this]() {
+
+				return _stopping || !_ready.empty();
+			});
+			if (_stopping) return;
+			seat = std::move(_ready.front());
+			_ready.pop_front();
+		}
+
+		while (true)
+		{
+			Job job;
+			{
+				std::lock_guard<std::mutex> lock(seat->mutex);
+				if (seat->jobs.empty())
+				{
+					seat->scheduled = false;
+					break;
+				}
+				job = std::move(seat->jobs.front());
+				seat->jobs.pop_front();
+			}
+
+			plan(*seat, job);
+		}
+	}
+}
+
+void ConnectedBot::plan(Seat& seat, const Job& job)
+{
+	if (!seat.ai)
+	{
+		LOGE << "CHANGE message for discarded AI";
+		return;
+	}
+
+	try
+	{
+		seat.ai->receiveChanges(job.message.changes(seat.ai->bible()));
+
+		if (seat.ai->wantsToPrepareOrders())
+		{
+			// The server does not wait for us, so send the best orders we
+			// have once the deadline has passed.
+			seat.ai->prepareOrdersFor(std::max(0,
+				_settings.botDeadline.value(3000)));
+			_outbox.push(Message::order_new(seat.ai->bible(),
+				seat.ai->orders(),
+				job.message.metadata()));
+		}
+	}
+	catch (const std::exception& error)
+	{
+		// Only this lobby is affected, the other lobbies can keep going.
+		LOGE << "Discarding AI after error while planning: " << error.what()
+			<< " in " << Writer::write(job.message.metadata());
+		seat.ai.reset();
+	}
+}
+
 inline Key extractKeyFromMetadata(const Json::Value& metadata)
 {
 	Key key = Key::undefined();
@@ -526,33 +725,16 @@ inline Key extractKeyFromMetadata(const Json::Value& metadata)
 
 void ConnectedBot::checkForResponse()
 {
-	int active;
-	while ((active = SDLNet_CheckSockets(_socketset, 0)) > 0
-		&& SDLNet_SocketReady((TCPsocket) _socket))
+	FrameReader::Frame frame;
+	FrameReader::Status status = FrameReader::Status::PENDING;
+	while (_socket
+		&& (status = _reader.next(frame)) == FrameReader::Status::FRAME)
 	{
-		// Get the network order (big-endian) byte representation of the length.
-		uint8_t length_be_bytes[4] = {0, 0, 0, 0};
-		if (safelyReceive(_socket, (char*) length_be_bytes, 4) <= 0)
-		{
-			LOGW << "Too few bytes in message length";
-			disconnect();
-			return;
-		}
-
-		uint32_t length = (uint32_t(length_be_bytes[0]) << 24)
-			| (uint32_t(length_be_bytes[1]) << 16)
-			| (uint32_t(length_be_bytes[2]) << 8)
-			| (uint32_t(length_be_bytes[3]));
-		if (length >= MESSAGE_SIZE_LIMIT)
-		{
-			LOGW << "Receiving very large message of length " << length;
-			LOGW << "Refusing to receive message of length " << length;
-			disconnect();
-			return;
-		}
-		else if (length >= MESSAGE_SIZE_WARNING_LIMIT)
+		const char* data = frame.data;
+		uint32_t length = frame.length;
+		if (length >= MESSAGE_SIZE_WARNING_LIMIT)
 		{
-			LOGW << "Receiving very large message of length " << length;
+			LOGW << "Received very large message of length " << length;
 		}
 		else if (length == 0)
 		{
@@ -562,29 +744,20 @@ void ConnectedBot::checkForResponse()
 			continue /*onto the next message*/;
 		}
 
-		LOGD << "Receiving message of length " << length;
+		LOGD << "Received message of length " << length;
 
-		std::vector<char> buffer;
-		buffer.resize(length);
-		if (safelyReceive(_socket, buffer.data(), length) <= 0)
-		{
-			LOGW << "Too few bytes in message";
-			disconnect();
-			return;
-		}
-
-		if (length > 0 && buffer[0] == '=')
+		if (length > 0 && data[0] == '=')
 		{
 			LOGW << "Received compressed message in pulse server";
 			disconnect();
 			return;
 		}
 
-		LOGD << "Received message: " << std::string(buffer.data(), length);
+		LOGD << "Received message: " << std::string(data, length);
 
 		try
 		{
-			ParsedMessage message = Message::parse(buffer.data(), length);
+			ParsedMessage message = Message::parse(data, length);
 			switch (message.type())
 			{
 				case Message::Type::QUIT:
@@ -757,10 +930,12 @@ void ConnectedBot::checkForResponse()
 						LOGW << "GAME messaeg without difficulty";
 					}
 
-					_ais[key].reset(new AICLASS(message.player(),
+					std::shared_ptr<Seat> seat = std::make_shared<Seat>();
+					seat->ai.reset(new AICLASS(message.player(),
 						difficulty,
 						message.content(),
 						key.slot));
+					_ais[key] = seat;
 				}
 				break;
 
@@ -778,15 +953,7 @@ void ConnectedBot::checkForResponse()
 						break;
 					}
 
-					_ais[key]->receiveChangesAsJson(message.changes());
-
-					if (_ais[key]->wantsToPrepareOrders())
-					{
-						_ais[key]->prepareOrders();
-						sendMessage(Message::order_new(_ais[key]->bible(),
-							_ais[key]->orders(),
-							message.metadata()));
-					}
+					dispatch(_ais[key], Job{std::move(message)});
 				}
 				break;
 
@@ -848,19 +1015,29 @@ void ConnectedBot::checkForResponse()
 		catch (ParseError& error)
 		{
 			LOGE << "Error while parsing message: "
-				<< "\'" << std::string(buffer.data(), length) << "\', error "
+				<< "\'" << std::string(data, length) << "\', error "
 				<< error.what();
 			throw;
 		}
 		catch (Json::Exception& error)
 		{
 			LOGE << "Error while parsing message: "
-				<< "\'" << std::string(buffer.data(), length) << "\', error "
+				<< "\'" << std::string(data, length) << "\', error "
 				<< error.what();
 			throw;
 		}
 	}
-	if (active < 0)
+	// We might have disconnected while handling a message.
+	if (!_socket) return;
+
+	if (status == FrameReader::Status::OVERSIZED)
+	{
+		LOGW << "Receiving very large message of length " << frame.length;
+		LOGW << "Refusing to receive message of length " << frame.length;
+		disconnect();
+		return;
+	}
+	else if (status != FrameReader::Status::PENDING)
 	{
 		LOGW << "Server disconnected";
 		disconnect();
@@ -897,14 +1074,12 @@ bool ConnectedBot::connect()
 	LOGI << "Connected.";
 
 	SDL_ClearError();
-	_socketset = SDLNet_AllocSocketSet(1);
-	if (!_socketset)
+	if (!_reader.attach(_socket))
 	{
 		LOGF << "Failed to allocate socket set: " << SDLNet_GetError();
 		std::cout << "Failed to allocate socket set." << std::endl;
 		return false;
 	}
-	SDLNet_TCP_AddSocket(_socketset, _socket);
 	return true;
 }
 
@@ -914,6 +1089,7 @@ void ConnectedBot::disconnect()
 	LOGI << "Disconnecting...";
 	sendMessage(Message::quit());
 	waitForClosure();
+	_reader.detach();
 	SDLNet_TCP_Close(_socket);
 	_socket = nullptr;
 	LOGI << "Disconnected.";
@@ -32,17 +32,488 @@
 #include "aichallenge.hpp"
 #include "aicommander.hpp"
 #include "ailibrary.hpp"
+#include "aineuralnewt.hpp"
 #include "difficulty.hpp"
 #include "library.hpp"
 #include "recording.hpp"
+#include "binarychangeset.hpp"
+#include "move.hpp"
 #include "loginstaller.hpp"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
 
 struct Buffer
 {
 	std::string str;
 };
 
+// Fixed-size records that can be exchanged instead of JSON strings, for
+// callers that cannot afford the (de)serialization. They consist only of
+// bytes, so they have no padding; two-byte fields are little endian.
+// Types are raw indices, which only mean something for the ruleset that the
+// Automaton or AI was created with.
+struct OrderRecord
+{
+	uint8_t type;
+	uint8_t tiletype_or_unittype;
+	uint8_t subject[3]; // (descriptor type, row, col)
+	uint8_t target[3]; // (descriptor type, row, col)
+	uint8_t moves_count;
+	uint8_t moves[55];
+};
+
+struct ChangeRecord
+{
+	uint8_t type;
+	uint8_t subject[3]; // (descriptor type, row, col)
+	uint8_t bytes[10]; // (player/snow, stacks/frostbite, ..., chaos)
+	uint8_t value[4]; // (target, tile, unit, attacker, ..., or score)
+	uint8_t vision[2]; // (who sees this change)
+	uint8_t cellvision[2]; // (the vision that a VISION change announces)
+	uint8_t sequence[2]; // (which changeset within a single call)
+	OrderRecord order;
+};
+
+static_assert(sizeof(OrderRecord) == 64, "OrderRecord must be packed.");
+static_assert(sizeof(ChangeRecord) == 88, "ChangeRecord must be packed.");
+
+static void writeDescriptor(const Descriptor& desc, uint8_t bytes[3])
+{
+	bytes[0] = (uint8_t) desc.type;
+	bytes[1] = (uint8_t) desc.position.row;
+	bytes[2] = (uint8_t) desc.position.col;
+}
+
+static bool readDescriptor(const uint8_t bytes[3], Descriptor& desc)
+{
+	if (bytes[0] >= Descriptor::TYPE_SIZE) return false;
+	desc = Descriptor((Descriptor::Type) bytes[0],
+		Position((int8_t) bytes[1], (int8_t) bytes[2]));
+	return true;
+}
+
+static void writeVision(const Vision& vision, uint8_t bytes[2])
+{
+	uint16_t mask = 0;
+	for (const Player& player : vision)
+	{
+		mask |= (1 << ((size_t) player));
+	}
+	bytes[0] = (uint8_t) (mask & 0xFF);
+	bytes[1] = (uint8_t) (mask >> 8);
+}
+
+static Vision readVision(const uint8_t bytes[2])
+{
+	uint16_t mask = bytes[0] | (bytes[1] << 8);
+	Vision vision;
+	for (size_t i = 0; i < PLAYER_SIZE; i++)
+	{
+		if (mask & (1 << i)) vision.add((Player) i);
+	}
+	return vision;
+}
+
+static bool writeOrderRecord(const Order& order, OrderRecord& record)
+{
+	record = OrderRecord();
+	record.type = (uint8_t) order.type;
+	record.tiletype_or_unittype = order.__byte;
+	writeDescriptor(order.subject, record.subject);
+	writeDescriptor(order.target, record.target);
+	if (order.moves.size() > sizeof(record.moves))
+	{
+		LOGW << "Order has too many moves to fit in a record";
+		return false;
+	}
+	record.moves_count = order.moves.size();
+	for (size_t i = 0; i < order.moves.size(); i++)
+	{
+		record.moves[i] = (uint8_t) order.moves[i];
+	}
+	return true;
+}
+
+static bool readOrderRecord(const TypeNamer& namer,
+	const OrderRecord& record, Order& order)
+{
+	if (record.type >= Order::TYPE_SIZE
+		|| record.moves_count > sizeof(record.moves))
+	{
+		return false;
+	}
+	switch ((Order::Type) record.type)
+	{
+		case Order::Type::SHAPE:
+		case Order::Type::SETTLE:
+		case Order::Type::EXPAND:
+		case Order::Type::UPGRADE:
+		case Order::Type::CULTIVATE:
+		{
+			if (record.tiletype_or_unittype > namer.tiletype_max())
+			{
+				return false;
+			}
+		}
+		break;
+		case Order::Type::PRODUCE:
+		{
+			if (record.tiletype_or_unittype > namer.unittype_max())
+			{
+				return false;
+			}
+		}
+		break;
+		default:
+		break;
+	}
+	order = Order((Order::Type) record.type);
+	order.__byte = record.tiletype_or_unittype;
+	if (!readDescriptor(record.subject, order.subject)
+		|| !readDescriptor(record.target, order.target))
+	{
+		return false;
+	}
+	order.moves.resize(record.moves_count);
+	for (size_t i = 0; i < record.moves_count; i++)
+	{
+		if (record.moves[i] >= MOVE_SIZE) return false;
+		order.moves[i] = (Move) record.moves[i];
+	}
+	return true;
+}
+
+static void appendChangeRecord(std::string& out, const Change& change,
+	const Vision& vision, uint16_t sequence)
+{
+	ChangeRecord record = ChangeRecord();
+	record.type = (uint8_t) change.type;
+	writeDescriptor(change.subject, record.subject);
+	const int8_t bytes[10] = {
+		change.__byteA, change.__byteB, change.__byteC, change.__byteD,
+		change.__byteE, change.__byteF, change.__byteG, change.__byteH,
+		change.__byteI, change.__byteJ,
+	};
+	for (size_t i = 0; i < 10; i++)
+	{
+		record.bytes[i] = (uint8_t) bytes[i];
+	}
+	BinaryChangeSet::packUnion(change, record.value);
+	writeVision(vision, record.vision);
+	writeVision(change.vision, record.cellvision);
+	record.sequence[0] = (uint8_t) (sequence & 0xFF);
+	record.sequence[1] = (uint8_t) (sequence >> 8);
+	writeOrderRecord(change.order, record.order);
+	out.append((const char*) &record, sizeof(ChangeRecord));
+}
+
+static bool readChangeRecord(const TypeNamer& namer,
+	const ChangeRecord& record, Change& change)
+{
+	if (record.type >= Change::TYPE_SIZE) return false;
+	change = Change((Change::Type) record.type);
+	if (!readDescriptor(record.subject, change.subject)) return false;
+	int8_t* bytes[10] = {
+		&change.__byteA, &change.__byteB, &change.__byteC, &change.__byteD,
+		&change.__byteE, &change.__byteF, &change.__byteG, &change.__byteH,
+		&change.__byteI, &change.__byteJ,
+	};
+	for (size_t i = 0; i < 10; i++)
+	{
+		*bytes[i] = (int8_t) record.bytes[i];
+	}
+	if (!BinaryChangeSet::unpackUnion(record.value, change)) return false;
+	change.vision = readVision(record.cellvision);
+	return readOrderRecord(namer, record.order, change.order);
+}
+
+// A fixed set of threads that work through numbered tasks together with the
+// calling thread. Used by GameBatch to step its games in parallel.
+class BatchPool
+{
+public:
+	BatchPool(size_t threadcount)
+	{
+		for (size_t i = 1; i < threadcount; i++)
+		{
+			_threads.emplace_back([this]() {
+
+				loop();
+			});
+		}
+	}
+	BatchPool(const BatchPool&) = delete;
+	BatchPool(BatchPool&&) = delete;
+	BatchPool& operator=(const BatchPool&) = delete;
+	BatchPool& operator=(BatchPool&&) = delete;
+	~BatchPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_wakeup.notify_all();
+		for (std::thread& thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+private:
+	std::vector<std::thread> _threads;
+	std::mutex _mutex;
+	std::condition_variable _wakeup;
+	std::condition_variable _done;
+	const std::function<void(size_t)>* _task = nullptr;
+	size_t _count = 0;
+	std::atomic<size_t> _next{0};
+	size_t _busy = 0;
+	uint64_t _generation = 0;
+	bool _stopping = false;
+
+	void work()
+	{
+		for (size_t i = _next++; i < _count; i = _next++)
+		{
+			(*_task)(i);
+		}
+	}
+
+	void loop()
+	{
+		uint64_t seen = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wakeup.wait(lock, [this, seen]() {
+
+					return _stopping || _generation != seen;
+				});
+				if (_stopping) return;
+				seen = _generation;
+			}
+
+			work();
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_busy--;
+			}
+			_done.notify_all();
+		}
+	}
+
+public:
+	size_t size() const { return _threads.size() + 1; }
+
+	// Calls task(i) for every i below count and returns when all are done.
+	void run(size_t count, const std::function<void(size_t)>& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_task = &task;
+			_count = count;
+			_next = 0;
+			_busy = _threads.size();
+			_generation++;
+		}
+		_wakeup.notify_all();
+
+		work();
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_done.wait(lock, [this]() {
+
+			return _busy == 0;
+		});
+	}
+};
+
+// A number of independent games that are stepped together, so that a caller
+// that drives many games at once (such as a training environment) needs only
+// a single call per turn. The games may have built-in AIs, which are handled
+// entirely within the batch, and agents, whose orders come from the caller
+// and whose observations are returned to the caller as ChangeRecords.
+struct GameBatch
+{
+	struct Agent
+	{
+		Player player;
+		const OrderRecord* orders = nullptr;
+		size_t ordercount = 0;
+		std::string observations;
+		size_t changecount = 0;
+		uint16_t sequence = 0;
+
+		Agent(const Player& p) : player(p) {}
+	};
+
+	struct Game
+	{
+		std::unique_ptr<Automaton> automaton;
+		std::vector<std::unique_ptr<AILibrary>> ais;
+		std::vector<AINeuralNewt*> neuralnewts; // (subset of ais)
+		std::vector<Agent> agents;
+		bool started = false;
+		bool planning = false;
+	};
+
+	std::string ruleset;
+	std::vector<Game> games;
+	std::vector<std::pair<size_t, size_t>> slots; // (game, agent)
+	BatchPool pool;
+
+	GameBatch(size_t gamecount, size_t threadcount) :
+		games(gamecount),
+		pool(threadcount)
+	{}
+
+	void deliver(Game& game, const ChangeSet& cset)
+	{
+		const Bible& bible = game.automaton->bible();
+		for (const auto& ai : game.ais)
+		{
+			ai->receiveChanges(cset.get(ai->player()), bible);
+		}
+		for (Agent& agent : game.agents)
+		{
+			for (const auto& datum : cset)
+			{
+				if (!datum.second.contains(agent.player)) continue;
+				appendChangeRecord(agent.observations,
+					datum.first, datum.second, agent.sequence);
+				agent.changecount++;
+			}
+			agent.sequence++;
+		}
+	}
+
+	// Runs a game from one planning phase until it is time for the AIs to
+	// prepare their orders for the next one, or from the start of the game if
+	// it has not started yet.
+	void advance(Game& game)
+	{
+		Automaton& automaton = *game.automaton;
+		for (Agent& agent : game.agents)
+		{
+			agent.observations.clear();
+			agent.changecount = 0;
+			agent.sequence = 0;
+		}
+
+		game.planning = false;
+		if (automaton.gameover()) return;
+
+		if (game.started)
+		{
+			for (Agent& agent : game.agents)
+			{
+				std::vector<Order> orders(agent.ordercount);
+				for (size_t i = 0; i < agent.ordercount; i++)
+				{
+					if (!readOrderRecord(automaton.bible(),
+							agent.orders[i], orders[i]))
+					{
+						LOGE << "Invalid order record " << i;
+						orders.clear();
+						break;
+					}
+				}
+				automaton.receive(agent.player, orders);
+			}
+			for (const auto& ai : game.ais)
+			{
+				automaton.receive(ai->player(),
+					ai->orders(automaton.bible()));
+			}
+			deliver(game, automaton.prepare());
+		}
+		game.started = true;
+
+		while (automaton.active())
+		{
+			deliver(game, automaton.act());
+		}
+
+		if (automaton.gameover()) return;
+
+		deliver(game, automaton.hibernate());
+		game.planning = true;
+	}
+
+	// Lets the AIs prepare their orders and starts the planning phase. The
+	// neural bots of all games may already have prepared their orders.
+	void resume(Game& game)
+	{
+		if (!game.planning) return;
+
+		for (const auto& ai : game.ais)
+		{
+			ai->prepareOrders();
+		}
+		deliver(game, game.automaton->awake());
+	}
+
+	void step()
+	{
+		pool.run(games.size(), [this](size_t i) {
+
+			try
+			{
+				advance(games[i]);
+			}
+			catch (const std::exception& e)
+			{
+				LOGE << "Exception in game " << i << ": " << e.what();
+				games[i].planning = false;
+			}
+		});
+
+		// Evaluate the brains of neural bots across games in batches, with
+		// one batch per thread.
+		std::vector<AINeuralNewt*> neuralnewts;
+		for (const Game& game : games)
+		{
+			if (!game.planning) continue;
+			neuralnewts.insert(neuralnewts.end(),
+				game.neuralnewts.begin(), game.neuralnewts.end());
+		}
+		size_t chunks = std::min(pool.size(), neuralnewts.size());
+		pool.run(chunks, [&neuralnewts, chunks](size_t k) {
+
+			size_t from = k * neuralnewts.size() / chunks;
+			size_t to = (k + 1) * neuralnewts.size() / chunks;
+			try
+			{
+				AINeuralNewt::prepareOrdersTogether(std::vector<AINeuralNewt*>(
+					neuralnewts.begin() + from, neuralnewts.begin() + to));
+			}
+			catch (const std::exception& e)
+			{
+				LOGE << "Exception: " << e.what();
+			}
+		});
+
+		pool.run(games.size(), [this](size_t i) {
+
+			try
+			{
+				resume(games[i]);
+			}
+			catch (const std::exception& e)
+			{
+				LOGE << "Exception in game " << i << ": " << e.what();
+			}
+		});
+	}
+};
+
 extern "C"
 {
 	Automaton* epicinium_automaton_allocate(size_t playercount,
@@ -82,6 +553,15 @@ extern "C"
 	const char* epicinium_automaton_rejoin(Automaton* automaton,
 		uint8_t player, Buffer* buffer);
 
+	size_t epicinium_change_record_size();
+	size_t epicinium_order_record_size();
+	const uint8_t* epicinium_automaton_act_records(Automaton* automaton,
+		Buffer* buffer, size_t* count);
+	const uint8_t* epicinium_automaton_act_phase_records(Automaton* automaton,
+		AILibrary** ais, size_t ai_count, Buffer* buffer, size_t* count);
+	void epicinium_automaton_receive_records(Automaton* automaton,
+		uint8_t player, const uint8_t* orders, size_t count);
+
 	size_t epicinium_map_pool_size();
 	const char* epicinium_map_pool_get(size_t i);
 	size_t epicinium_map_custom_pool_size();
@@ -110,6 +590,10 @@ extern "C"
 		Buffer* buffer);
 	const char* epicinium_ai_descriptive_metadata(AILibrary* ai,
 		Buffer* buffer);
+	void epicinium_ai_receive_records(AILibrary* ai, Automaton* automaton,
+		const uint8_t* changes, size_t count);
+	const uint8_t* epicinium_ai_retrieve_orders_records(AILibrary* ai,
+		Automaton* automaton, Buffer* buffer, size_t* count);
 
 	uint16_t epicinium_custom_challenge_id();
 	size_t epicinium_challenge_pool_size();
@@ -129,6 +613,22 @@ extern "C"
 	const char* epicinium_challenge_briefing_value(uint16_t id, size_t i,
 		Buffer* buffer);
 
+	GameBatch* epicinium_batch_allocate(size_t game_count,
+		size_t playercount, const char* ruleset, size_t thread_count);
+	void epicinium_batch_deallocate(GameBatch* batch);
+	size_t epicinium_batch_game_count(GameBatch* batch);
+	size_t epicinium_batch_agent_count(GameBatch* batch);
+	Automaton* epicinium_batch_automaton(GameBatch* batch, size_t game);
+	bool epicinium_batch_add_ai(GameBatch* batch, size_t game,
+		const char* name, uint8_t player, uint8_t difficulty,
+		char character);
+	size_t epicinium_batch_add_agent(GameBatch* batch, size_t game,
+		uint8_t player);
+	const uint8_t* epicinium_batch_step(GameBatch* batch,
+		const uint8_t* orders, const size_t* order_counts,
+		Buffer* buffer, size_t* change_counts,
+		int32_t* scores, uint8_t* gameovers);
+
 	Buffer* epicinium_buffer_allocate();
 	void epicinium_buffer_deallocate(Buffer* buffer);
 
@@ -341,6 +841,82 @@ extern "C"
 		return buffer->str.c_str();
 	}
 
+	size_t epicinium_change_record_size()
+	{
+		return sizeof(ChangeRecord);
+	}
+	size_t epicinium_order_record_size()
+	{
+		return sizeof(OrderRecord);
+	}
+	const uint8_t* epicinium_automaton_act_records(Automaton* automaton,
+		Buffer* buffer, size_t* count)
+	{
+		ChangeSet cset = automaton->act();
+		buffer->str.clear();
+		buffer->str.reserve(cset.size() * sizeof(ChangeRecord));
+		for (const auto& datum : cset)
+		{
+			appendChangeRecord(buffer->str, datum.first, datum.second, 0);
+		}
+		*count = cset.size();
+		return (const uint8_t*) buffer->str.data();
+	}
+	const uint8_t* epicinium_automaton_act_phase_records(Automaton* automaton,
+		AILibrary** ais, size_t ai_count, Buffer* buffer, size_t* count)
+	{
+		std::vector<Player> players;
+		players.reserve(ai_count);
+		for (size_t i = 0; i < ai_count; i++)
+		{
+			players.push_back(ais[i]->player());
+		}
+
+		buffer->str.clear();
+		*count = 0;
+		uint16_t sequence = 0;
+		while (automaton->active())
+		{
+			ChangeSet cset = automaton->act();
+			for (size_t i = 0; i < ai_count; i++)
+			{
+				try
+				{
+					ais[i]->receiveChanges(cset.get(players[i]),
+						automaton->bible());
+				}
+				catch (const std::exception& e)
+				{
+					LOGE << "Exception: " << e.what();
+				}
+			}
+			for (const auto& datum : cset)
+			{
+				appendChangeRecord(buffer->str, datum.first, datum.second,
+					sequence);
+			}
+			*count += cset.size();
+			sequence++;
+		}
+		return (const uint8_t*) buffer->str.data();
+	}
+	void epicinium_automaton_receive_records(Automaton* automaton,
+		uint8_t player_as_u8, const uint8_t* orders_as_bytes, size_t count)
+	{
+		Player player = (Player) player_as_u8;
+		const OrderRecord* records = (const OrderRecord*) orders_as_bytes;
+		std::vector<Order> orders(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!readOrderRecord(automaton->bible(), records[i], orders[i]))
+			{
+				LOGE << "Invalid order record " << i;
+				return;
+			}
+		}
+		automaton->receive(player, orders);
+	}
+
 	size_t epicinium_map_pool_size()
 	{
 		return Map::pool().size();
@@ -504,6 +1080,43 @@ extern "C"
 		return buffer->str.c_str();
 	}
 
+	void epicinium_ai_receive_records(AILibrary* ai, Automaton* automaton,
+		const uint8_t* changes_as_bytes, size_t count)
+	{
+		const ChangeRecord* records = (const ChangeRecord*) changes_as_bytes;
+		std::vector<Change> changes(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!readChangeRecord(automaton->bible(), records[i], changes[i]))
+			{
+				LOGE << "Invalid change record " << i;
+				return;
+			}
+		}
+		try
+		{
+			ai->receiveChanges(changes, automaton->bible());
+		}
+		catch (const std::exception& e)
+		{
+			LOGE << "Exception: " << e.what();
+		}
+	}
+	const uint8_t* epicinium_ai_retrieve_orders_records(AILibrary* ai,
+		Automaton* automaton, Buffer* buffer, size_t* count)
+	{
+		buffer->str.clear();
+		*count = 0;
+		for (const Order& order : ai->orders(automaton->bible()))
+		{
+			OrderRecord record;
+			if (!writeOrderRecord(order, record)) continue;
+			buffer->str.append((const char*) &record, sizeof(OrderRecord));
+			*count += 1;
+		}
+		return (const uint8_t*) buffer->str.data();
+	}
+
 	uint16_t epicinium_custom_challenge_id()
 	{
 		return (uint16_t) Challenge::Id::CUSTOM;
@@ -588,6 +1201,107 @@ extern "C"
 		return buffer->str.c_str();
 	}
 
+	GameBatch* epicinium_batch_allocate(size_t game_count,
+		size_t playercount, const char* ruleset, size_t thread_count)
+	{
+		if (thread_count == 0)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		try
+		{
+			std::unique_ptr<GameBatch> batch(
+				new GameBatch(game_count, thread_count));
+			batch->ruleset = ruleset;
+			for (GameBatch::Game& game : batch->games)
+			{
+				game.automaton.reset(new Automaton(playercount, ruleset));
+			}
+			return batch.release();
+		}
+		catch (const std::exception& e)
+		{
+			// If GameBatch creation throws, we return null, in which case
+			// the GameBatch need not and must not be deallocated.
+			LOGE << "Exception: " << e.what();
+			return nullptr;
+		}
+	}
+	void epicinium_batch_deallocate(GameBatch* batch)
+	{
+		delete batch;
+	}
+	size_t epicinium_batch_game_count(GameBatch* batch)
+	{
+		return batch->games.size();
+	}
+	size_t epicinium_batch_agent_count(GameBatch* batch)
+	{
+		return batch->slots.size();
+	}
+	Automaton* epicinium_batch_automaton(GameBatch* batch, size_t game)
+	{
+		// The Automaton is owned by the batch and must not be deallocated.
+		return batch->games[game].automaton.get();
+	}
+	bool epicinium_batch_add_ai(GameBatch* batch, size_t game,
+		const char* name, uint8_t player_as_u8, uint8_t difficulty_as_u8,
+		char character)
+	{
+		AILibrary* ai = epicinium_ai_allocate(name, player_as_u8,
+			difficulty_as_u8, batch->ruleset.c_str(), character);
+		if (!ai) return false;
+		batch->games[game].ais.emplace_back(ai);
+		auto newt = dynamic_cast<AINeuralNewt*>(ai);
+		if (newt) batch->games[game].neuralnewts.push_back(newt);
+		return true;
+	}
+	size_t epicinium_batch_add_agent(GameBatch* batch, size_t game,
+		uint8_t player_as_u8)
+	{
+		Player player = (Player) player_as_u8;
+		std::vector<GameBatch::Agent>& agents = batch->games[game].agents;
+		batch->slots.emplace_back(game, agents.size());
+		agents.emplace_back(player);
+		return batch->slots.size() - 1;
+	}
+	const uint8_t* epicinium_batch_step(GameBatch* batch,
+		const uint8_t* orders_as_bytes, const size_t* order_counts,
+		Buffer* buffer, size_t* change_counts,
+		int32_t* scores, uint8_t* gameovers)
+	{
+		// The orders of all agents are concatenated in slot order.
+		const OrderRecord* orders = (const OrderRecord*) orders_as_bytes;
+		for (const auto& slot : batch->slots)
+		{
+			GameBatch::Agent& agent =
+				batch->games[slot.first].agents[slot.second];
+			agent.orders = orders;
+			agent.ordercount = *order_counts;
+			orders += *order_counts;
+			order_counts++;
+		}
+
+		batch->step();
+
+		buffer->str.clear();
+		for (size_t s = 0; s < batch->slots.size(); s++)
+		{
+			GameBatch::Game& game = batch->games[batch->slots[s].first];
+			GameBatch::Agent& agent = game.agents[batch->slots[s].second];
+			buffer->str += agent.observations;
+			change_counts[s] = agent.changecount;
+			scores[s] = game.automaton->score(agent.player);
+			agent.orders = nullptr;
+			agent.ordercount = 0;
+		}
+		for (size_t i = 0; i < batch->games.size(); i++)
+		{
+			gameovers[i] = batch->games[i].automaton->gameover();
+		}
+		return (const uint8_t*) buffer->str.data();
+	}
+
 	Buffer* epicinium_buffer_allocate()
 	{
 		return new Buffer();
@@ -32,6 +32,7 @@
 #include "bible.hpp"
 #include "library.hpp"
 #include "board.hpp"
+#include "maptemplate.hpp"
 
 
 int main(int /**/, char* /**/[])
@@ -88,6 +89,9 @@ int main(int /**/, char* /**/[])
 			}
 			assert(score % 50 == 0);
 		}
+
+		LOGI << "Precompiling " << mapname;
+		MapTemplate::precompile(latestbible, mapname);
 	}
 
 	for (const std::string& mapname : Map::customPool())
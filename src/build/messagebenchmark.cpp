@@ -0,0 +1,224 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "source.hpp"
+
+#include <chrono>
+
+#include "loginstaller.hpp"
+#include "library.hpp"
+#include "bible.hpp"
+#include "message.hpp"
+#include "change.hpp"
+#include "order.hpp"
+#include "parseerror.hpp"
+#include "system.hpp"
+
+
+// The path that every message used to take: one Json::Value tree for the
+// whole message, from which the changes or orders are then decoded.
+static ParsedMessage messagebenchmark_dom(const std::string& str)
+{
+	Json::Reader reader;
+	Json::Value json;
+	if (!reader.parse(str, json))
+	{
+		throw ParseError("Invalid json");
+	}
+	return ParsedMessage(std::move(json));
+}
+
+static ParsedMessage messagebenchmark_streamed(const std::string& str)
+{
+	return Message::parse(str.data(), str.size());
+}
+
+// Decodes the changes or orders of a message and returns them in their
+// serialized form, so that both paths can be checked against each other.
+static std::string messagebenchmark_decode(const Bible& bible,
+	const ParsedMessage& message)
+{
+	switch (message.type())
+	{
+		case Message::Type::CHANGE:
+		case Message::Type::HOST_REJOIN_CHANGES:
+		{
+			return Message::change(bible, message.changes(bible)).str();
+		}
+		break;
+		case Message::Type::ORDER_OLD:
+		case Message::Type::ORDER_NEW:
+		{
+			return Message::order_new(bible, message.orders(bible)).str();
+		}
+		break;
+		default:
+		{
+			return std::to_string(message.time());
+		}
+		break;
+	}
+}
+
+static size_t messagebenchmark_count(const Bible& bible,
+	const ParsedMessage& message)
+{
+	switch (message.type())
+	{
+		case Message::Type::CHANGE:
+		case Message::Type::HOST_REJOIN_CHANGES:
+		{
+			return message.changes(bible).size();
+		}
+		break;
+		case Message::Type::ORDER_OLD:
+		case Message::Type::ORDER_NEW:
+		{
+			return message.orders(bible).size();
+		}
+		break;
+		default:
+		{
+			return message.time();
+		}
+		break;
+	}
+}
+
+template <class F>
+static size_t messagebenchmark_run(const Bible& bible,
+	const std::vector<std::string>& corpus, size_t bytes,
+	size_t repetitions, const char* name, F parse)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	size_t checksum = 0;
+	for (size_t r = 0; r < repetitions; r++)
+	{
+		for (const std::string& str : corpus)
+		{
+			checksum += messagebenchmark_count(bible, parse(str));
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		end - start).count();
+	double messages = 1.0 * repetitions * corpus.size();
+	std::cout << name << ": " << (0.001 * ns / messages) << " us per message"
+		<< " (" << (1000.0 * repetitions * bytes / ns) << " MB per second)"
+		<< std::endl;
+	return checksum;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " CORPUS..." << std::endl;
+		std::cout << "Each line of a corpus is one message as received,"
+			<< " or a line of a bot log containing 'Received message: '."
+			<< std::endl;
+		return 1;
+	}
+
+	LogInstaller("messagebenchmark", 5).install();
+
+	Library library;
+	library.load();
+	Bible bible = library.get(library.currentRuleset());
+
+	// Only the messages that are decoded while a game is in progress.
+	static const std::string prefix = "Received message: ";
+	std::vector<std::string> corpus;
+	size_t bytes = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		std::ifstream file = System::ifstream(argv[i]);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open '" << argv[i] << "'" << std::endl;
+			return 1;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			size_t pos = line.find(prefix);
+			if (pos != std::string::npos)
+			{
+				line.erase(0, pos + prefix.size());
+			}
+			if (line.empty() || line[0] != '{') continue;
+
+			try
+			{
+				switch (messagebenchmark_dom(line).type())
+				{
+					case Message::Type::CHANGE:
+					case Message::Type::ORDER_OLD:
+					case Message::Type::ORDER_NEW:
+					case Message::Type::SYNC:
+					case Message::Type::HOST_SYNC:
+					case Message::Type::HOST_REJOIN_CHANGES:
+					break;
+					default:
+					continue;
+				}
+			}
+			catch (const std::exception& ignored)
+			{
+				continue;
+			}
+
+			bytes += line.size();
+			corpus.emplace_back(std::move(line));
+		}
+	}
+
+	if (corpus.empty())
+	{
+		std::cerr << "No changes, orders or syncs found" << std::endl;
+		return 1;
+	}
+	std::cout << corpus.size() << " messages, " << bytes << " bytes"
+		<< std::endl;
+
+	for (const std::string& str : corpus)
+	{
+		if (messagebenchmark_decode(bible, messagebenchmark_dom(str))
+			!= messagebenchmark_decode(bible, messagebenchmark_streamed(str)))
+		{
+			std::cerr << "Mismatch for: " << str << std::endl;
+			return 1;
+		}
+	}
+
+	const size_t repetitions = std::max((size_t) 1, (1 << 26) / bytes);
+	size_t before = messagebenchmark_run(bible, corpus, bytes,
+		repetitions, "tree    ", messagebenchmark_dom);
+	size_t after = messagebenchmark_run(bible, corpus, bytes,
+		repetitions, "streamed", messagebenchmark_streamed);
+	std::cout << "checksum: " << before << " " << after << std::endl;
+	return (before == after) ? 0 : 1;
+}
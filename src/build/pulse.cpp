@@ -40,6 +40,7 @@
 #include "writer.hpp"
 #include "parseerror.hpp"
 #include "curl.hpp"
+#include "framereader.hpp"
 #include "slackapi.hpp"
 
 
@@ -69,11 +70,11 @@ private:
 	SlackAPI _slack;
 
 	TCPsocket _socket;
+	FrameReader _reader;
 
 	uint64_t _mstime; // Apps Hungarian notation.
 
 	bool checkForActivity();
-	int safelyReceive(TCPsocket socket, char* buffer, uint32_t length);
 
 	void sendMessage(const StreamedMessage& message,
 		std::string& warning, uint64_t& warningTTL);
@@ -211,6 +212,7 @@ Pulse::~Pulse()
 {
 	if (_socket)
 	{
+		_reader.detach();
 		SDLNet_TCP_Close(_socket);
 	}
 
@@ -219,19 +221,8 @@ Pulse::~Pulse()
 
 bool Pulse::checkForActivity()
 {
-	// TODO maybe it is better to reuse the same socket set?
 	SDL_ClearError();
-	SDLNet_SocketSet set = SDLNet_AllocSocketSet(1);
-	if (!set)
-	{
-		throw std::runtime_error("Failed to allocate socket set: "
-			+ std::string(SDLNet_GetError()));
-	}
-	SDLNet_TCP_AddSocket(set, _socket);
-
-	SDL_ClearError();
-	int active = SDLNet_CheckSockets(set, 1);
-	SDLNet_FreeSocketSet(set);
+	int active = _reader.check(1);
 	if (active < 0)
 	{
 		throw std::runtime_error("Error while checking for socket activity: "
@@ -240,24 +231,6 @@ bool Pulse::checkForActivity()
 	else return (active > 0);
 }
 
-int Pulse::safelyReceive(TCPsocket socket, char* buffer, uint32_t length)
-{
-	uint32_t receivedTotal = 0;
-	while (receivedTotal < length)
-	{
-		int received = SDLNet_TCP_Recv(socket, buffer + receivedTotal,
-			length - receivedTotal);
-		if (received <= 0)
-		{
-			LOGW << "Received too few bytes,"
-				" expected " << length << ", received " << receivedTotal;
-			return received;
-		}
-		receivedTotal += received;
-	}
-	return receivedTotal;
-}
-
 void Pulse::run()
 {
 	if (!_settings.server.defined() && !_settings.port.defined())
@@ -434,48 +407,16 @@ void Pulse::sendMessage(const char* data, uint32_t length,
 
 void Pulse::checkForResponse(std::string& warning, uint64_t& warningTTL)
 {
-	SDLNet_SocketSet set = SDLNet_AllocSocketSet(1);
-	if (!set)
+	FrameReader::Frame frame;
+	FrameReader::Status status = FrameReader::Status::PENDING;
+	while (_socket
+		&& (status = _reader.next(frame)) == FrameReader::Status::FRAME)
 	{
-		warning = "Pulse Server broken!";
-		warningTTL = 0;
-		LOGE << "Pulse Server broken";
-		disconnect();
-		return;
-	}
-	SDLNet_TCP_AddSocket(set, _socket);
-
-	int active;
-	while ((active = SDLNet_CheckSockets(set, 0)) > 0
-		&& SDLNet_SocketReady((TCPsocket) _socket))
-	{
-		// Get the network order (big-endian) byte representation of the length.
-		uint8_t length_be_bytes[4] = {0, 0, 0, 0};
-		if (safelyReceive(_socket, (char*) length_be_bytes, 4) <= 0)
-		{
-			warning = "Too few bytes in message length!";
-			warningTTL = 0;
-			LOGW << "Too few bytes in message length";
-			disconnect();
-			return;
-		}
-
-		uint32_t length = (uint32_t(length_be_bytes[0]) << 24)
-			| (uint32_t(length_be_bytes[1]) << 16)
-			| (uint32_t(length_be_bytes[2]) << 8)
-			| (uint32_t(length_be_bytes[3]));
-		if (length >= MESSAGE_SIZE_LIMIT)
+		const char* data = frame.data;
+		uint32_t length = frame.length;
+		if (length >= MESSAGE_SIZE_WARNING_LIMIT)
 		{
-			LOGW << "Receiving very large message of length " << length;
-			warning = "Refusing to receive message";
-			warningTTL = 0;
-			LOGW << "Refusing to receive message of length " << length;
-			disconnect();
-			return;
-		}
-		else if (length >= MESSAGE_SIZE_WARNING_LIMIT)
-		{
-			LOGW << "Receiving very large message of length " << length;
+			LOGW << "Received very large message of length " << length;
 		}
 		else if (length == 0)
 		{
@@ -491,31 +432,20 @@ void Pulse::checkForResponse(std::string& warning, uint64_t& warningTTL)
 			continue /*onto the next message*/;
 		}
 
-		LOGD << "Receiving message of length " << length;
+		LOGD << "Received message of length " << length;
 
-		std::vector<char> buffer;
-		buffer.resize(length);
-		if (safelyReceive(_socket, buffer.data(), length) <= 0)
-		{
-			warning = "Too few bytes in message!";
-			warningTTL = 0;
-			LOGW << "Too few bytes in message";
-			disconnect();
-			return;
-		}
-
-		if (length > 0 && buffer[0] == '=')
+		if (length > 0 && data[0] == '=')
 		{
 			LOGW << "Received compressed message in pulse server";
 			disconnect();
 			return;
 		}
 
-		LOGD << "Received message: " << std::string(buffer.data(), length);
+		LOGD << "Received message: " << std::string(data, length);
 
 		try
 		{
-			ParsedMessage message = Message::parse(buffer.data(), length);
+			ParsedMessage message = Message::parse(data, length);
 			switch (message.type())
 			{
 				case Message::Type::QUIT:
@@ -674,7 +604,7 @@ void Pulse::checkForResponse(std::string& warning, uint64_t& warningTTL)
 		catch (ParseError& error)
 		{
 			LOGE << "Error while parsing message: "
-				<< "\'" << std::string(buffer.data(), length) << "\', error "
+				<< "\'" << std::string(data, length) << "\', error "
 				<< error.what();
 			warning = "Broken message!";
 			warningTTL = 0;
@@ -683,21 +613,46 @@ void Pulse::checkForResponse(std::string& warning, uint64_t& warningTTL)
 		catch (Json::Exception& error)
 		{
 			LOGE << "Error while parsing message: "
-				<< "\'" << std::string(buffer.data(), length) << "\', error "
+				<< "\'" << std::string(data, length) << "\', error "
 				<< error.what();
 			warning = "Broken message!";
 			warningTTL = 0;
 			return;
 		}
 	}
-	SDLNet_FreeSocketSet(set);
-	if (active < 0)
+	// We might have disconnected while handling a message.
+	if (!_socket) return;
+
+	switch (status)
 	{
-		warning = "Disconnected!";
-		warningTTL = 0;
-		LOGW << "Disconnected";
-		disconnect();
-		return;
+		case FrameReader::Status::FRAME:
+		case FrameReader::Status::PENDING:
+		break;
+		case FrameReader::Status::OVERSIZED:
+		{
+			LOGW << "Receiving very large message of length " << frame.length;
+			warning = "Refusing to receive message";
+			warningTTL = 0;
+			LOGW << "Refusing to receive message of length " << frame.length;
+			disconnect();
+		}
+		break;
+		case FrameReader::Status::CLOSED:
+		{
+			warning = "Too few bytes in message!";
+			warningTTL = 0;
+			LOGW << "Too few bytes in message";
+			disconnect();
+		}
+		break;
+		case FrameReader::Status::FAILED:
+		{
+			warning = "Disconnected!";
+			warningTTL = 0;
+			LOGW << "Disconnected";
+			disconnect();
+		}
+		break;
 	}
 }
 
@@ -726,6 +681,14 @@ void Pulse::connect(std::string& warning, uint64_t& /**/)
 		// do not set warningTTL
 		return;
 	}
+	if (!_reader.attach(_socket))
+	{
+		LOGE << "Pulse Server broken";
+		warning = "Pulse Server broken!";
+		SDLNet_TCP_Close(_socket);
+		_socket = nullptr;
+		return;
+	}
 	LOGI << "Pulse connected";
 	_slack.post("Pulse connected.");
 }
@@ -736,6 +699,7 @@ void Pulse::disconnect()
 	std::string dummyS = "";
 	uint64_t dummyMs = 0;
 	sendMessage(Message::quit(), dummyS, dummyMs);
+	_reader.detach();
 	SDLNet_TCP_Close(_socket);
 	_socket = nullptr;
 	LOGI << "Pulse disconnected";
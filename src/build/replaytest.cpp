@@ -33,6 +33,8 @@
 #include "writer.hpp"
 #include "recording.hpp"
 #include "automaton.hpp"
+#include "binarychangeset.hpp"
+#include "changeset.hpp"
 #include "cycle.hpp"
 
 
@@ -120,6 +122,83 @@ static inline void replay(Recording& recording, bool reenactFromOrders)
 	automaton_total_divisor++;
 }
 
+static inline void seek(Recording& recording, int interval)
+{
+	// Play the recording forward from the start, remembering the state of
+	// the game at the start of every round.
+	std::vector<std::pair<int, std::string>> snapshots;
+	{
+		Automaton automaton(recording.getPlayers(), recording.getRuleset());
+		automaton.replay(recording);
+
+		while (!automaton.gameover())
+		{
+			if (automaton.active())
+			{
+				automaton.act();
+			}
+			else if (automaton.replaying())
+			{
+				snapshots.emplace_back(automaton.round(),
+					BinaryChangeSet::encode(automaton.snapshot()));
+				automaton.act();
+			}
+			else break;
+		}
+	}
+
+	Automaton automaton(recording.getPlayers(), recording.getRuleset());
+	automaton.replay(recording);
+	automaton.indexReplay(interval);
+
+	// Seek backwards so that every seek has to restore from the index.
+	for (auto it = snapshots.rbegin(); it != snapshots.rend(); ++it)
+	{
+		if (!automaton.seek(it->first))
+		{
+			LOGF << "Failed to seek to round " << it->first
+				<< " in " << recording.filename();
+			throw std::runtime_error("failed to seek");
+		}
+
+		if (BinaryChangeSet::encode(automaton.snapshot()) != it->second)
+		{
+			LOGF << "State after seeking to round " << it->first
+				<< " in " << recording.filename()
+				<< " differs from replaying up to it";
+			throw std::runtime_error("seek mismatch");
+		}
+	}
+}
+
+static inline void roundtripLongOrder()
+{
+	// Orders longer than a byte can count must survive the binary format.
+	Order order(Order::Type::MOVE);
+	order.subject = Descriptor::ground(Position(1, 1));
+	order.target = Descriptor::cell(Position(1, 2));
+	for (size_t i = 0; i < 300; i++)
+	{
+		order.moves.push_back((i % 2) ? Move::E : Move::W);
+	}
+
+	ChangeSet changeset;
+	changeset.push(Change(Change::Type::ORDERED, order.subject,
+			Player::RED, order),
+		Vision::only(Player::RED));
+	std::string buffer = BinaryChangeSet::encode(changeset);
+
+	ChangeSet decoded;
+	BinaryChangeSet::Reader reader(buffer.data(), buffer.size());
+	if (!reader.collect(decoded)
+		|| BinaryChangeSet::encode(decoded) != buffer)
+	{
+		LOGF << "Binary changeset with an order of "
+			<< order.moves.size() << " moves does not round-trip";
+		throw std::runtime_error("binary changeset mismatch");
+	}
+}
+
 int main(int argc, char* argv[])
 {
 	CoreDump::enable();
@@ -163,6 +242,7 @@ int main(int argc, char* argv[])
 	std::string indexfilename;
 	std::vector<std::string> recnames;
 	bool reenactFromOrders = false;
+	int seekInterval = 0;
 
 	for (int i = 1; i < argc; i++)
 	{
@@ -189,6 +269,13 @@ int main(int argc, char* argv[])
 		{
 			reenactFromOrders = true;
 		}
+		else if (arglen >= 4
+			&& strncmp(arg + arglen - 4, "seek", 4) == 0)
+		{
+			// Seek through each replay using an index with a snapshot
+			// every few rounds instead of measuring how long it takes.
+			seekInterval = 3;
+		}
 		else
 		{
 			throw std::runtime_error("unknown argument "
@@ -196,6 +283,12 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	if (seekInterval > 0 && reenactFromOrders)
+	{
+		LOGE << "Cannot seek while reenacting from orders";
+		throw std::runtime_error("cannot seek while reenacting from orders");
+	}
+
 	if (!indexfilename.empty() && !recnames.empty())
 	{
 		LOGE << "Cannot specify both index and filenames";
@@ -228,12 +321,15 @@ int main(int argc, char* argv[])
 		srand(settings.seed.value());
 	}
 
+	roundtripLongOrder();
+
 	if (!recnames.empty())
 	{
 		for (const std::string& recname : recnames)
 		{
 			Recording recording(recname);
-			replay(recording, reenactFromOrders);
+			if (seekInterval > 0) seek(recording, seekInterval);
+			else replay(recording, reenactFromOrders);
 		}
 	}
 	else if (settings.dataRoot.defined())
@@ -252,7 +348,8 @@ int main(int argc, char* argv[])
 		{
 			Recording recording(".replaytest");
 			System::copyFile(data.filename(), recording.filename());
-			replay(recording, reenactFromOrders);
+			if (seekInterval > 0) seek(recording, seekInterval);
+			else replay(recording, reenactFromOrders);
 		}
 	}
 	else
@@ -265,7 +362,8 @@ int main(int argc, char* argv[])
 
 		for (Recording& recording : recordings)
 		{
-			replay(recording, reenactFromOrders);
+			if (seekInterval > 0) seek(recording, seekInterval);
+			else replay(recording, reenactFromOrders);
 		}
 	}
 
@@ -0,0 +1,157 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "source.hpp"
+
+#include "spritebatch.hpp"
+
+
+static void check(bool condition, const std::string& what)
+{
+	if (!condition)
+	{
+		std::cout << "FAILED: " << what << std::endl;
+		throw std::runtime_error("check failed: " + what);
+	}
+}
+
+static void checkRun(const SpriteBatch& batch, size_t index,
+	const SpriteBatch::State& state, size_t first, size_t count)
+{
+	std::string name = "run " + std::to_string(index);
+	check(index < batch.runs().size(), name + " exists");
+	const SpriteBatch::Run& run = batch.runs()[index];
+	check(run.state == state, name + " state");
+	check(run.first == first, name + " first");
+	check(run.count == count, name + " count");
+}
+
+static void checkVertex(const SpriteBatch& batch, size_t index,
+	float x, float y, float s, float t, float flags)
+{
+	std::string name = "vertex " + std::to_string(index);
+	check(index < batch.vertices().size(), name + " exists");
+	const SpriteVertex& vertex = batch.vertices()[index];
+	check(vertex.x == x && vertex.y == y, name + " position");
+	check(vertex.s == s && vertex.t == t, name + " texcoords");
+	check(vertex.flags == flags, name + " flags");
+}
+
+int main(int /**/, char* /**/[])
+{
+	std::cout << "[ Epicinium Test ]" << std::endl << std::endl;
+
+	// The batch only ever compares palettes by address, so these stand-ins
+	// are never dereferenced and no OpenGL context is needed.
+	char palettes[2];
+	Sprite::Palette* red = reinterpret_cast<Sprite::Palette*>(&palettes[0]);
+	Sprite::Palette* blue = reinterpret_cast<Sprite::Palette*>(&palettes[1]);
+
+	SpriteBatch::State grass;
+	grass.texture = 1;
+	grass.palette = red;
+	SpriteBatch::State trees = grass;
+	trees.texture = 2;
+	SpriteBatch::State masked = grass;
+	masked.mask = 3;
+	SpriteBatch::State bluegrass = grass;
+	bluegrass.palette = blue;
+	SpriteBatch::State tiled = grass;
+	tiled.repeat = true;
+
+	SpriteBatch batch;
+	check(batch.empty(), "new batch is empty");
+
+	// Consecutive sprites with the same state share a run, even when their
+	// attributes differ.
+	batch.setState(grass);
+	batch.quad(0, 0, 16, 16, 0, 0, 0.5f, 0.5f);
+	batch.setMasked(true);
+	batch.quad(16, 0, 32, 16, 0.5f, 0, 1, 0.5f);
+	batch.setMasked(false);
+
+	// A sprite with a different texture starts a new run.
+	batch.setState(trees);
+	SpriteBatch::Corner a = {0, 0, 0, 0, 0, 0};
+	SpriteBatch::Corner b = {8, 0, 1, 0, 0, 0};
+	SpriteBatch::Corner c = {8, 8, 1, 1, 0, 0};
+	batch.triangle(a, b, c);
+
+	// Going back to an earlier state does not reopen its run.
+	batch.setState(grass);
+	batch.quad(0, 16, 16, 32, 0, 0.5f, 0.5f, 1);
+
+	// A different mask, palette or wrapping mode also starts a new run.
+	batch.setState(masked);
+	batch.quad(0, 0, 1, 1, 0, 0, 1, 1);
+	batch.setState(bluegrass);
+	batch.quad(0, 0, 1, 1, 0, 0, 1, 1);
+	SpriteBatch::Attributes border;
+	border.border = true;
+	border.masked = true;
+	batch.setAttributes(border);
+	batch.setState(tiled);
+	batch.quad(0, 0, 1, 1, 0, 0, 1, 1);
+	batch.quad(1, 0, 2, 1, 0, 0, 1, 1);
+
+	check(!batch.empty(), "batch is not empty");
+	check(batch.runs().size() == 6, "number of runs");
+	check(batch.vertices().size() == 6 + 6 + 3 + 6 + 6 + 6 + 12,
+		"number of vertices");
+	checkRun(batch, 0, grass, 0, 12);
+	checkRun(batch, 1, trees, 12, 3);
+	checkRun(batch, 2, grass, 15, 6);
+	checkRun(batch, 3, masked, 21, 6);
+	checkRun(batch, 4, bluegrass, 27, 6);
+	checkRun(batch, 5, tiled, 33, 12);
+
+	// A quad is two triangles: top left, top right, bottom right and then
+	// top left, bottom right, bottom left.
+	checkVertex(batch, 0, 0, 0, 0, 0, 0);
+	checkVertex(batch, 1, 16, 0, 0.5f, 0, 0);
+	checkVertex(batch, 2, 16, 16, 0.5f, 0.5f, 0);
+	checkVertex(batch, 3, 0, 0, 0, 0, 0);
+	checkVertex(batch, 4, 16, 16, 0.5f, 0.5f, 0);
+	checkVertex(batch, 5, 0, 16, 0, 0.5f, 0);
+	checkVertex(batch, 6, 16, 0, 0.5f, 0, 1);
+	checkVertex(batch, 11, 16, 16, 0.5f, 0.5f, 1);
+	checkVertex(batch, 12, 0, 0, 0, 0, 0);
+	checkVertex(batch, 13, 8, 0, 1, 0, 0);
+	checkVertex(batch, 14, 8, 8, 1, 1, 0);
+	checkVertex(batch, 15, 0, 16, 0, 0.5f, 0);
+	checkVertex(batch, 33, 0, 0, 0, 0, 3);
+	checkVertex(batch, 44, 1, 1, 0, 1, 3);
+
+	batch.clear();
+	check(batch.empty(), "cleared batch is empty");
+	check(batch.runs().empty(), "cleared batch has no runs");
+
+	// Clearing also resets the state and the attributes.
+	batch.quad(0, 0, 1, 1, 0, 0, 1, 1);
+	checkRun(batch, 0, SpriteBatch::State(), 0, 6);
+	checkVertex(batch, 0, 0, 0, 0, 0, 0);
+
+	std::cout << "OK" << std::endl;
+	std::cout << std::endl << "[ Done ]" << std::endl;
+	return 0;
+}
@@ -1,3 +1,4 @@
+#include "asynclogwriter.cpp"
 #include "clock.cpp"
 #include "constructordebugger.cpp"
 #include "coredump.cpp"
@@ -5,6 +6,8 @@
 #include "locator.cpp"
 #include "loginstaller.cpp"
 #include "point.cpp"
+#include "profiler.cpp"
+#include "randomness.cpp"
 #include "setting.cpp"
 #include "settings.cpp"
 #include "stringref.cpp"
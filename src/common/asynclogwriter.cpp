@@ -0,0 +1,387 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "asynclogwriter.hpp"
+#include "source.hpp"
+
+#include "libs/plog/Appenders/IAppender.h"
+#include "libs/plog/Formatters/TxtFormatter.h"
+#include "libs/plog/Converters/NativeEOLConverter.h"
+
+
+class AsyncLogWriter::Appender : public plog::IAppender
+{
+public:
+	Appender(AsyncLogWriter& writer, uint8_t fileindex) :
+		_writer(writer),
+		_fileindex(fileindex)
+	{}
+
+	virtual void write(const plog::Record& record) override
+	{
+		_writer.push(_fileindex, record);
+	}
+
+private:
+	AsyncLogWriter& _writer;
+	const uint8_t _fileindex;
+};
+
+struct AsyncLogWriter::Entry
+{
+	std::atomic<size_t> sequence;
+	plog::Severity severity;
+	uint8_t fileindex;
+	unsigned int tid;
+	size_t line;
+	plog::util::Time time;
+	std::string func;
+	plog::util::nstring message;
+};
+
+struct AsyncLogWriter::File
+{
+	plog::util::nstring nameWithoutExtension;
+	plog::util::nstring extension;
+	plog::util::File handle;
+	off_t size = 0;
+	off_t maxSize;
+	int maxFiles;
+	bool opened = false;
+	std::string batch;
+	std::unique_ptr<Appender> appender;
+};
+
+using AsyncLogConverter = plog::NativeEOLConverter<plog::UTF8Converter>;
+
+// Numbered the same way as the files of plog::RollingFileAppender.
+static plog::util::nstring asyncLogFileName(
+	const plog::util::nstring& nameWithoutExtension,
+	const plog::util::nstring& extension, int number)
+{
+	plog::util::nostringstream strm;
+	strm << nameWithoutExtension;
+	if (number > 0)
+	{
+		strm << '.' << number;
+	}
+	if (!extension.empty())
+	{
+		strm << '.' << extension;
+	}
+	return strm.str();
+}
+
+// A view of a queued entry that the plog formatters can work with.
+class AsyncLogRecord : public plog::Record
+{
+public:
+	AsyncLogRecord() :
+		plog::Record(plog::none, "", 0, "", nullptr, 0)
+	{}
+
+	plog::Severity severity = plog::none;
+	plog::util::Time time = {};
+	unsigned int tid = 0;
+	size_t line = 0;
+	const std::string* func = nullptr;
+	const plog::util::nstring* message = nullptr;
+
+	virtual const plog::util::Time& getTime() const override
+	{
+		return time;
+	}
+
+	virtual plog::Severity getSeverity() const override
+	{
+		return severity;
+	}
+
+	virtual unsigned int getTid() const override
+	{
+		return tid;
+	}
+
+	virtual size_t getLine() const override
+	{
+		return line;
+	}
+
+	virtual const plog::util::nchar* getMessage() const override
+	{
+		return message->c_str();
+	}
+
+	virtual const char* getFunc() const override
+	{
+		return func->c_str();
+	}
+};
+
+AsyncLogWriter::AsyncLogWriter(Overload overload) :
+	_overload(overload),
+	_entries(new Entry[CAPACITY]),
+	_enqueuePos(0),
+	_written(0),
+	_dropped(0),
+	_droppedTotal(0),
+	_urgent(false)
+{
+	for (size_t i = 0; i < CAPACITY; i++)
+	{
+		_entries[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	_thread = std::thread(&AsyncLogWriter::run, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wakeup.notify_one();
+	_thread.join();
+}
+
+plog::IAppender* AsyncLogWriter::addFile(const std::string& filename,
+	size_t maxFileSize, int maxFiles)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_files.size() > UINT8_MAX)
+	{
+		throw std::runtime_error("too many asynchronous log files");
+	}
+
+	std::unique_ptr<File> file(new File());
+#ifdef _WIN32
+	plog::util::splitFileName(plog::util::toWide(filename.c_str()).c_str(),
+		file->nameWithoutExtension, file->extension);
+#else
+	plog::util::splitFileName(filename.c_str(),
+		file->nameWithoutExtension, file->extension);
+#endif
+	file->maxSize = std::max((off_t) maxFileSize, (off_t) 1000);
+	file->maxFiles = maxFiles;
+	file->appender.reset(new Appender(*this, (uint8_t) _files.size()));
+	plog::IAppender* appender = file->appender.get();
+	_files.emplace_back(std::move(file));
+	return appender;
+}
+
+void AsyncLogWriter::push(uint8_t fileindex, const plog::Record& record)
+{
+	// Claim a slot in the ring buffer. A slot is free for position pos if
+	// its sequence number equals pos, and it has not been written yet if
+	// its sequence number is behind.
+	size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+	Entry* entry;
+	while (true)
+	{
+		entry = &_entries[pos % CAPACITY];
+		size_t sequence = entry->sequence.load(std::memory_order_acquire);
+		if (sequence == pos)
+		{
+			if (_enqueuePos.compare_exchange_weak(pos, pos + 1,
+					std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (sequence < pos)
+		{
+			if (_overload == Overload::DROP)
+			{
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (_stopping) return;
+			_urgent.store(true);
+			_wakeup.notify_one();
+			_drained.wait_for(lock, std::chrono::milliseconds(10));
+			pos = _enqueuePos.load(std::memory_order_relaxed);
+		}
+		else pos = _enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	// Assigning reuses the capacity that the slot already has.
+	entry->severity = record.getSeverity();
+	entry->fileindex = fileindex;
+	entry->tid = record.getTid();
+	entry->line = record.getLine();
+	entry->time = record.getTime();
+	entry->func = record.getFunc();
+	entry->message = record.getMessage();
+	entry->sequence.store(pos + 1, std::memory_order_release);
+
+	if (entry->severity <= plog::error)
+	{
+		wakeAndWait(pos);
+	}
+	else if ((pos + 1) % (CAPACITY / 4) == 0)
+	{
+		// Do not wait for the timeout if we are logging a lot.
+		_urgent.store(true);
+		_wakeup.notify_one();
+	}
+}
+
+void AsyncLogWriter::wakeAndWait(size_t pos)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_urgent.store(true);
+	_wakeup.notify_one();
+	_drained.wait(lock, [this, pos]() {
+
+		return _stopping || _written.load(std::memory_order_acquire) > pos;
+	});
+}
+
+void AsyncLogWriter::run()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_wakeup.wait_for(lock, std::chrono::milliseconds(50), [this]() {
+
+			return _urgent.load() || _stopping;
+		});
+		_urgent.store(false);
+
+		drain();
+		_drained.notify_all();
+
+		if (_stopping) break;
+	}
+}
+
+void AsyncLogWriter::drain()
+{
+	AsyncLogRecord record;
+
+	size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+	if (dropped > 0)
+	{
+		std::string func = "AsyncLogWriter::drain";
+		plog::util::nostringstream strm;
+		strm << "Dropped " << dropped << " log records";
+		plog::util::nstring message = strm.str();
+		record.severity = plog::warning;
+		plog::util::ftime(&record.time);
+		record.func = &func;
+		record.message = &message;
+		for (auto& file : _files)
+		{
+			file->batch += AsyncLogConverter::convert(
+				plog::TxtFormatter::format(record));
+		}
+	}
+
+	while (true)
+	{
+		Entry& entry = _entries[_dequeuePos % CAPACITY];
+		size_t sequence = entry.sequence.load(std::memory_order_acquire);
+		if (sequence != _dequeuePos + 1) break;
+
+		if (entry.fileindex < _files.size())
+		{
+			record.severity = entry.severity;
+			record.time = entry.time;
+			record.tid = entry.tid;
+			record.line = entry.line;
+			record.func = &entry.func;
+			record.message = &entry.message;
+			_files[entry.fileindex]->batch += AsyncLogConverter::convert(
+				plog::TxtFormatter::format(record));
+		}
+
+		// Keep the memory bounded after an unusually long message.
+		if (entry.message.capacity() > 4096)
+		{
+			plog::util::nstring().swap(entry.message);
+		}
+
+		entry.sequence.store(_dequeuePos + CAPACITY,
+			std::memory_order_release);
+		_dequeuePos++;
+	}
+
+	for (auto& file : _files)
+	{
+		if (!file->batch.empty()) write(*file);
+	}
+
+	_written.store(_dequeuePos, std::memory_order_release);
+}
+
+void AsyncLogWriter::write(File& file)
+{
+	if (!file.opened)
+	{
+		open(file);
+	}
+	else if (file.maxFiles > 0 && file.size > file.maxSize)
+	{
+		file.handle.close();
+
+		plog::util::File::unlink(asyncLogFileName(file.nameWithoutExtension,
+				file.extension, file.maxFiles - 1).c_str());
+		for (int number = file.maxFiles - 2; number >= 0; number--)
+		{
+			plog::util::File::rename(
+				asyncLogFileName(file.nameWithoutExtension,
+					file.extension, number).c_str(),
+				asyncLogFileName(file.nameWithoutExtension,
+					file.extension, number + 1).c_str());
+		}
+
+		open(file);
+	}
+
+	int written = file.handle.write(file.batch);
+	if (written > 0) file.size += written;
+
+	file.batch.clear();
+	if (file.batch.capacity() > 65536)
+	{
+		std::string().swap(file.batch);
+	}
+}
+
+void AsyncLogWriter::open(File& file)
+{
+	file.size = file.handle.open(asyncLogFileName(file.nameWithoutExtension,
+			file.extension, 0).c_str());
+	file.opened = true;
+
+	if (file.size == 0)
+	{
+		int written = file.handle.write(AsyncLogConverter::header(
+			plog::TxtFormatter::header()));
+		if (written > 0) file.size += written;
+	}
+}
@@ -0,0 +1,107 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace plog
+{
+	class IAppender;
+	class Record;
+}
+
+
+/*
+Writes log records to rolling log files on a background thread. Logging
+threads only copy the message into a bounded ring buffer; formatting and
+writing to disk happen in batches on the background thread. Errors and
+fatal records are written before the logging thread continues, so they
+are not lost if the program crashes right after.
+*/
+class AsyncLogWriter
+{
+public:
+	enum class Overload : uint8_t
+	{
+		// Discard new records while the ring buffer is full.
+		DROP,
+		// Wait until the background thread has made room.
+		BLOCK,
+	};
+
+	explicit AsyncLogWriter(Overload overload);
+	~AsyncLogWriter();
+
+	AsyncLogWriter(const AsyncLogWriter&) = delete;
+	AsyncLogWriter(AsyncLogWriter&&) = delete;
+	AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+	AsyncLogWriter& operator=(AsyncLogWriter&&) = delete;
+
+private:
+	class Appender;
+	struct Entry;
+	struct File;
+
+	static constexpr size_t CAPACITY = 4096;
+
+	const Overload _overload;
+	std::unique_ptr<Entry[]> _entries;
+	std::atomic<size_t> _enqueuePos;
+	std::atomic<size_t> _written;
+	std::atomic<size_t> _dropped;
+	std::atomic<size_t> _droppedTotal;
+	size_t _dequeuePos = 0;
+
+	std::vector<std::unique_ptr<File>> _files;
+
+	std::mutex _mutex;
+	std::condition_variable _wakeup;
+	std::condition_variable _drained;
+	std::atomic<bool> _urgent;
+	bool _stopping = false;
+	std::thread _thread;
+
+public:
+	// The appender remains owned by the writer.
+	plog::IAppender* addFile(const std::string& filename, size_t maxFileSize,
+		int maxFiles);
+
+	size_t dropped() const
+	{
+		return _droppedTotal.load(std::memory_order_relaxed);
+	}
+
+private:
+	void push(uint8_t fileindex, const plog::Record& record);
+	void wakeAndWait(size_t pos);
+
+	void run();
+	void drain();
+	void write(File& file);
+	void open(File& file);
+};
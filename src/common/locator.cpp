@@ -226,6 +226,11 @@ std::string Locator::fzmodelName(const std::string& fullfilename)
 	return "";
 }
 
+std::string Locator::brainFilename(const std::string& brainname)
+{
+	return _resourceroot + "brains/" + brainname + ".nnb";
+}
+
 void Locator::useExternalFolder(ExternalFolder&& newFolder)
 {
 	LOGD << "Using '" << newFolder.uniqueTag << "'"
@@ -44,6 +44,7 @@ public:
 	static std::string rulesetName(const std::string& filename);
 	static std::string fzmodelFilename(const std::string& fzmodelname);
 	static std::string fzmodelName(const std::string& filename);
+	static std::string brainFilename(const std::string& brainname);
 
 	static std::string getRelativeFilename(const std::string& filename);
 
@@ -36,6 +36,8 @@
 #include "settings.hpp"
 #include "version.hpp"
 #include "system.hpp"
+#include "profiler.hpp"
+#include "asynclogwriter.hpp"
 
 
 #if LOG_REPLACE_WITH_CALLBACK_ENABLED
@@ -61,6 +63,31 @@ static CallbackAppender _installed_callback_appender;
 
 std::string LogInstaller::_logsfolder = "logs/";
 
+#if !LOG_REPLACE_WITH_CALLBACK_ENABLED
+static AsyncLogWriter* asyncLogWriter(AsyncLogWriter::Overload overload)
+{
+	// Like the plog appenders, the writer lives until the program exits.
+	static AsyncLogWriter writer(overload);
+	return &writer;
+}
+
+template<int instanceId>
+static void initLogFile(AsyncLogWriter* writer, plog::Severity severity,
+	const std::string& filename, size_t maxFileSize, int maxFiles)
+{
+	if (writer)
+	{
+		plog::init<instanceId>(severity,
+			writer->addFile(filename, maxFileSize, maxFiles));
+	}
+	else
+	{
+		plog::init<instanceId>(severity, filename.c_str(),
+			maxFileSize, maxFiles);
+	}
+}
+#endif
+
 void LogInstaller::setRoot(const std::string& root)
 {
 	if (root.empty())
@@ -81,6 +108,7 @@ LogInstaller::LogInstaller(const Settings& settings) :
 	_name(settings.logname.value()),
 	_level(settings.loglevel.value("")),
 	_perf(settings.perflog.value("")),
+	_async(settings.logasync.value("")),
 	_rollback(std::max(1, settings.logrollback.value(20)))
 {}
 
@@ -89,6 +117,7 @@ LogInstaller::LogInstaller(const std::string& name, int rollback,
 	_name(name),
 	_level(level),
 	_perf(perf),
+	_async(""),
 	_rollback(std::max(1, rollback))
 {}
 
@@ -96,6 +125,7 @@ LogInstaller::LogInstaller(log_callback_fn callback, uint8_t severity) :
 	_name(""),
 	_level(plog::severityToString((plog::Severity) severity)),
 	_perf(""),
+	_async(""),
 	_rollback(1)
 {
 	assert(callback != nullptr);
@@ -147,28 +177,44 @@ void LogInstaller::install()
 	// Each file is up to 1MB.
 	constexpr int SIZE = 1024000;
 
+	// Optionally write the logs on a background thread, either dropping or
+	// blocking on new records when it cannot keep up.
+	AsyncLogWriter* writer = nullptr;
+	if (_async == "drop")
+	{
+		writer = asyncLogWriter(AsyncLogWriter::Overload::DROP);
+	}
+	else if (_async == "block")
+	{
+		writer = asyncLogWriter(AsyncLogWriter::Overload::BLOCK);
+	}
+	else if (!_async.empty())
+	{
+		std::cerr << "Unknown logasync '" << _async << "'" << std::endl;
+	}
+
 	// If we want a separate verbose log, keep three separate logs.
 	if (_verboserollback > 0)
 	{
-		plog::init<0>(std::max(verbosity, plog::verbose),
-			verbosefilename.c_str(), SIZE, _verboserollback);
-		plog::init<1>(std::min(verbosity, plog::debug),
-			infofilename.c_str(), SIZE, _rollback);
-		plog::init<2>(plog::warning, errorfilename.c_str(), SIZE, _rollback);
+		initLogFile<0>(writer, std::max(verbosity, plog::verbose),
+			verbosefilename, SIZE, _verboserollback);
+		initLogFile<1>(writer, std::min(verbosity, plog::debug),
+			infofilename, SIZE, _rollback);
+		initLogFile<2>(writer, plog::warning, errorfilename, SIZE, _rollback);
 		plog::get<0>()->addAppender(plog::get<1>());
 		plog::get<0>()->addAppender(plog::get<2>());
 	}
 	// If we are relatively verbose, keep a separate error log.
 	else if (verbosity > plog::warning)
 	{
-		plog::init<0>(verbosity, infofilename.c_str(), SIZE, _rollback);
-		plog::init<1>(plog::warning, errorfilename.c_str(), SIZE, _rollback);
+		initLogFile<0>(writer, verbosity, infofilename, SIZE, _rollback);
+		initLogFile<1>(writer, plog::warning, errorfilename, SIZE, _rollback);
 		plog::get<0>()->addAppender(plog::get<1>());
 	}
 	// Otherwise, only keep an error log.
 	else if (verbosity != plog::none)
 	{
-		plog::init<0>(verbosity, errorfilename.c_str(), SIZE, _rollback);
+		initLogFile<0>(writer, verbosity, errorfilename, SIZE, _rollback);
 	}
 
 	// If we have a PERFLOG_INSTANCE, install it.
@@ -178,6 +224,7 @@ void LogInstaller::install()
 		plog::Severity perfosity = std::max(plog::info, verbosity);
 		std::string fname = perflogfilename();
 		plog::init<PERFLOG_INSTANCE>(perfosity, fname.c_str(), SIZE, 1);
+		Profiler::start(tracefilename());
 	}
 #endif
 #endif
@@ -200,6 +247,13 @@ std::string LogInstaller::perflogfilename() const
 	return fname;
 }
 
+std::string LogInstaller::tracefilename() const
+{
+	std::string fname = perflogfilename();
+	fname.replace(fname.size() - 4, 4, ".trace.json");
+	return fname;
+}
+
 
 
 
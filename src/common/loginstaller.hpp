@@ -41,6 +41,7 @@ private:
 	const std::string _name;
 	const std::string _level;
 	const std::string _perf;
+	const std::string _async;
 	const int _rollback;
 
 	int _verboserollback = 0;
@@ -55,6 +56,7 @@ public:
 	}
 
 	std::string perflogfilename() const;
+	std::string tracefilename() const;
 
 private:
 	static std::string _logsfolder;
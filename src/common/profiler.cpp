@@ -0,0 +1,235 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "profiler.hpp"
+#include "source.hpp"
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+std::atomic<bool> Profiler::_recording(false);
+
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+struct ProfileRing
+{
+	// The owning thread is the only one that writes events and moves the
+	// head, and the flushing thread is the only one that reads events and
+	// moves the tail, so neither needs to lock.
+	static constexpr size_t CAPACITY = 1 << 15;
+
+	std::vector<ProfileEvent> events;
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+	std::atomic<size_t> dropped;
+	const int tid;
+
+	explicit ProfileRing(int t) :
+		events(CAPACITY),
+		head(0),
+		tail(0),
+		dropped(0),
+		tid(t)
+	{}
+};
+
+struct ProfilerState
+{
+	std::mutex mutex;
+	std::condition_variable notifier;
+	std::vector<std::shared_ptr<ProfileRing>> rings;
+	// Drained rings of threads that have exited; a new thread that reuses one
+	// also takes over its tid, so the trace gets no more tracks than needed.
+	std::vector<std::shared_ptr<ProfileRing>> spares;
+	int tids = 0;
+	std::ofstream file;
+	bool empty = true;
+	bool stopping = false;
+	bool exiting = false;
+	uint64_t origin = 0;
+	std::thread flusher;
+
+	~ProfilerState()
+	{
+		// The loggers might already have been destroyed at this point.
+		exiting = true;
+		Profiler::stop();
+	}
+};
+
+static ProfilerState& profilerState()
+{
+	static ProfilerState state;
+	return state;
+}
+
+// A thread keeps its ring alive, even if the profiler is stopped.
+static thread_local std::shared_ptr<ProfileRing> _profileRing;
+
+static void profilerDrain(ProfilerState& state)
+{
+	for (auto iter = state.rings.begin(); iter != state.rings.end();)
+	{
+		ProfileRing& ring = **iter;
+
+		// Once the owning thread has exited, we hold the only reference.
+		bool orphaned = (iter->use_count() == 1);
+		if (orphaned) std::atomic_thread_fence(std::memory_order_acquire);
+
+		size_t tail = ring.tail.load(std::memory_order_relaxed);
+		size_t head = ring.head.load(std::memory_order_acquire);
+		for (; tail != head; tail++)
+		{
+			size_t i = tail % ProfileRing::CAPACITY;
+			const ProfileEvent& event = ring.events[i];
+
+			// Zones that were still open during a previous stop() are stale.
+			if (event.begin < state.origin) continue;
+
+			// Zone names are string literals, so they need no escaping.
+			state.file << (state.empty ? "" : ",\n")
+				<< "{\"name\":\"" << event.name << "\""
+				<< ",\"ph\":\"X\",\"pid\":1"
+				<< ",\"tid\":" << ring.tid
+				<< ",\"ts\":" << 0.001 * (event.begin - state.origin)
+				<< ",\"dur\":" << 0.001 * (event.end - event.begin)
+				<< "}";
+			state.empty = false;
+		}
+		ring.tail.store(tail, std::memory_order_release);
+
+		size_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0 && !state.exiting)
+		{
+			LOGW << "Profiler dropped " << dropped << " zones"
+				" on thread " << ring.tid;
+		}
+
+		// Short-lived threads (such as those started for each bot turn) would
+		// otherwise each leave behind a ring that is never written to again.
+		if (orphaned)
+		{
+			state.spares.push_back(std::move(*iter));
+			iter = state.rings.erase(iter);
+		}
+		else iter++;
+	}
+	state.file.flush();
+}
+
+static void profilerFlushPeriodically(ProfilerState& state)
+{
+	std::unique_lock<std::mutex> lock(state.mutex);
+	while (!state.stopping)
+	{
+		state.notifier.wait_for(lock, std::chrono::milliseconds(50));
+		profilerDrain(state);
+	}
+}
+
+uint64_t Profiler::nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, uint64_t begin, uint64_t end)
+{
+	if (!_profileRing)
+	{
+		ProfilerState& state = profilerState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (!state.spares.empty())
+		{
+			_profileRing = std::move(state.spares.back());
+			state.spares.pop_back();
+		}
+		else _profileRing = std::make_shared<ProfileRing>(++state.tids);
+		state.rings.push_back(_profileRing);
+	}
+
+	ProfileRing& ring = *_profileRing;
+	size_t head = ring.head.load(std::memory_order_relaxed);
+	size_t tail = ring.tail.load(std::memory_order_acquire);
+	if (head - tail >= ProfileRing::CAPACITY)
+	{
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ring.events[head % ProfileRing::CAPACITY] = {name, begin, end};
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::start(const std::string& filename)
+{
+	ProfilerState& state = profilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if (state.flusher.joinable())
+	{
+		LOGW << "Profiler already started";
+		return;
+	}
+
+	state.file.open(filename, std::ios::out | std::ios::trunc);
+	if (!state.file)
+	{
+		LOGE << "Failed to open " << filename;
+		return;
+	}
+	state.file << std::fixed << std::setprecision(3);
+	state.file << "[\n";
+	state.empty = true;
+	state.stopping = false;
+	state.origin = nanoseconds();
+	state.flusher = std::thread(profilerFlushPeriodically, std::ref(state));
+
+	LOGI << "Recording profile to " << filename;
+	_recording.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop()
+{
+	_recording.store(false, std::memory_order_relaxed);
+
+	ProfilerState& state = profilerState();
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (!state.flusher.joinable()) return;
+		state.stopping = true;
+	}
+	state.notifier.notify_all();
+	state.flusher.join();
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	profilerDrain(state);
+	state.file << "\n]\n";
+	state.file.close();
+}
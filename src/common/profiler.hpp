@@ -0,0 +1,90 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <atomic>
+
+
+/*
+Scoped zones that are written to a trace file that can be opened with
+chrome://tracing or ui.perfetto.dev. Each thread records its zones into its
+own ring buffer without taking locks, and a background thread periodically
+moves them to the file. Zones only exist in development builds.
+*/
+#ifdef DEVELOPMENT
+#define PROFILE_ZONE_CONCAT2(X, Y) X##Y
+#define PROFILE_ZONE_CONCAT(X, Y) PROFILE_ZONE_CONCAT2(X, Y)
+#define PROFILE_ZONE(NAME) \
+	ProfileZone PROFILE_ZONE_CONCAT(_profilezone_, __LINE__)(NAME)
+#else
+#define PROFILE_ZONE(NAME)
+#endif
+
+
+class Profiler
+{
+public:
+	Profiler() = delete;
+
+private:
+	static std::atomic<bool> _recording;
+
+public:
+	static bool recording()
+	{
+		return _recording.load(std::memory_order_relaxed);
+	}
+
+	// The name must be a string literal or otherwise outlive the profiler.
+	static void record(const char* name, uint64_t begin, uint64_t end);
+
+	static uint64_t nanoseconds();
+
+	static void start(const std::string& filename);
+	static void stop();
+};
+
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) :
+		_name(name),
+		_begin(Profiler::recording() ? Profiler::nanoseconds() : 0)
+	{}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone(ProfileZone&&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+	ProfileZone& operator=(ProfileZone&&) = delete;
+
+	~ProfileZone()
+	{
+		if (_begin) Profiler::record(_name, _begin, Profiler::nanoseconds());
+	}
+
+private:
+	const char* const _name;
+	const uint64_t _begin;
+};
@@ -24,6 +24,8 @@
 #pragma once
 #include "header.hpp"
 
+#include "randomness.hpp"
+
 
 template <class T>
 class Randomizer
@@ -66,7 +68,7 @@ public:
 	{
 		if (shuffle)
 		{
-			std::random_shuffle(options.begin(), options.end());
+			Randomness::shuffle(options.begin(), options.end());
 			shuffle = false;
 		}
 		T t = options.back();
@@ -0,0 +1,52 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <random>
+
+
+// The game logic and the AIs draw from this instead of rand(), so that each
+// thread has a generator of its own and games played side by side can each be
+// reproduced from a seed. A thread that is never seeded seeds itself from
+// rand() on first use, so programs that call srand() once behave as before.
+class Randomness
+{
+public:
+	static void seed(uint32_t seed);
+
+	static std::mt19937& engine();
+
+	// A non-negative integer, to be used like rand().
+	static int next()
+	{
+		return (int) (engine()() >> 1);
+	}
+
+	template <class Iterator>
+	static void shuffle(Iterator first, Iterator last)
+	{
+		std::shuffle(first, last, engine());
+	}
+};
@@ -57,12 +57,16 @@ Settings::Settings(std::unique_ptr<Settings> fallback) :
 	logname(this, "logname"),
 	loglevel(this, "loglevel"),
 	logrollback(this, "logrollback"),
+	logasync(this, "logasync"),
 	perflog(this, "perflog"),
 	configRoot(this, "config-root"),
 	dataRoot(this, "data-root", "data-folder"),
 	cacheRoot(this, "cache-root"),
 	resourceRoot(this, "resource-root"),
 	seed(this, "seed"),
+	jobs(this, "jobs"),
+	botDeadline(this, "bot-deadline"),
+	changesetFormat(this, "changeset-format"),
 	display(this, "display"),
 	screenmode(this, "screenmode"),
 	windowX(this, "window-x"),
@@ -132,6 +136,7 @@ Settings::Settings() :
 	screenmode = ScreenMode::DESKTOP;
 	scale = 2;
 	framerate = 60;
+	botDeadline = 3000;
 	discord = true;
 	allowDiscordLogin = false;
 	patchmode = detectPatchMode();
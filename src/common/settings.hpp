@@ -106,12 +106,16 @@ public:
 	Setting<std::string> logname;
 	Setting<std::string> loglevel;
 	Setting<int> logrollback;
+	Setting<std::string> logasync;
 	Setting<std::string> perflog;
 	Setting<std::string> configRoot;
 	Setting<std::string> dataRoot;
 	Setting<std::string> cacheRoot;
 	Setting<std::string> resourceRoot;
 	Setting<int> seed;
+	Setting<int> jobs;
+	Setting<int> botDeadline;
+	Setting<std::string> changesetFormat;
 	Setting<int> display;
 	Setting<ScreenMode> screenmode;
 	Setting<int> windowX;
@@ -260,6 +260,18 @@ std::string System::getHttpModificationTimeString(const std::string& filename)
 	return stringbuffer;
 }
 
+int64_t System::getModificationTime(const std::string& filename)
+{
+	struct stat buffer;
+	if (::stat(filename.c_str(), &buffer) != 0)
+	{
+		LOGE << "Failed to stat '" << filename << "'";
+		return 0;
+	}
+
+	return buffer.st_mtime;
+}
+
 void System::purgeFile(const std::string& filename)
 {
 	if (!isFile(filename))
@@ -608,6 +620,18 @@ std::string System::getHttpModificationTimeString(const std::string& filename)
 	return stringbuffer;
 }
 
+int64_t System::getModificationTime(const std::string& filename)
+{
+	struct stat buffer;
+	if (::stat(filename.c_str(), &buffer) != 0)
+	{
+		LOGE << "Failed to stat '" << filename << "'";
+		return 0;
+	}
+
+	return buffer.st_mtime;
+}
+
 void System::purgeFile(const std::string& filename)
 {
 	if (!isFile(filename))
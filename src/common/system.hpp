@@ -51,6 +51,7 @@ namespace System
 	void makeFileExecutable(const std::string& filename);
 
 	std::string getHttpModificationTimeString(const std::string& filename);
+	int64_t getModificationTime(const std::string& filename);
 
 	void touchFile(const std::string& filename);
 	void touchDirectory(const std::string& dirname);
@@ -42,6 +42,9 @@ std::string Writer::write(const Json::Value& json)
 	Writer* writer;
 	try
 	{
+		// We need a lock around the lookup because other threads might be
+		// installing their own writers at the same time.
+		std::lock_guard<std::mutex> lock(_writerMutex);
 		writer = _installed.at(std::this_thread::get_id());
 	}
 	catch (const std::out_of_range&)
@@ -34,6 +34,7 @@
 #include "palette.hpp"
 #include "editortheme.hpp"
 #include "screenshot.hpp"
+#include "profiler.hpp"
 
 
 EngineSDL::EngineSDL()
@@ -143,11 +144,14 @@ void Engine::doFirst()
 
 void Engine::doFrame()
 {
+	PROFILE_ZONE("Engine::doFrame");
+
 	if (_preloadThread.joinable()) _preloadThread.detach();
 
 	/* FLIP THE FRAME */
 	if (_draw && _display)
 	{
+		PROFILE_ZONE("Engine::flip");
 		_graphics.flip();
 		_graphics.finish();
 		_loop.flip();
@@ -156,11 +160,14 @@ void Engine::doFrame()
 	/* RESET THE FRAME */
 	_input.reset();
 
-	SDL_Event event;
-	while (SDL_PollEvent(&event))
 	{
-		handle(event);
-		_loop.event();
+		PROFILE_ZONE("Engine::events");
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			handle(event);
+			_loop.event();
+		}
 	}
 
 	_input.moveMouse();
@@ -182,6 +189,7 @@ void Engine::doFrame()
 	auto game = _game.lock();
 	if (game)
 	{
+		PROFILE_ZONE("Engine::update");
 		_camera.update();
 		game->update();
 	}
@@ -194,6 +202,7 @@ void Engine::doFrame()
 
 	if (_draw && _display)
 	{
+		PROFILE_ZONE("Engine::render");
 		_graphics.prepare();
 		_renderer.render();
 		if (_screenshot)
@@ -231,6 +231,10 @@ void LocalGame::load()
 	_automaton.load(_mapname, /*shufflePlayers=*/false);
 	if (_enableRecording)
 	{
+		if (_settings.changesetFormat.defined())
+		{
+			metadata["changeset-format"] = _settings.changesetFormat.value();
+		}
 		_automaton.startRecording(metadata);
 	}
 	for (const auto& commander : _commanders)
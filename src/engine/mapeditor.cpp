@@ -32,6 +32,7 @@
 #include "changeset.hpp"
 #include "automaton.hpp"
 #include "map.hpp"
+#include "maptemplate.hpp"
 #include "locator.hpp"
 #include "typenamer.hpp"
 #include "parseerror.hpp"
@@ -1912,6 +1913,9 @@ void MapEditor::saveToFile(const std::string& mapname)
 		file << "}" << std::endl;
 	}
 
+	// The file may be saved more than once within the same second.
+	MapTemplate::forget(mapname);
+
 	saved();
 }
 
@@ -60,6 +60,7 @@
 #include "notice.hpp"
 #include "clip.hpp"
 #include "skin.hpp"
+#include "profiler.hpp"
 
 
 Observer::Observer(Settings& settings, Game& game,
@@ -73,7 +74,8 @@ Observer::Observer(Settings& settings, Game& game,
 	_settings(settings),
 	_game(game),
 	_arranger(110, 4),
-	_bible(Library::getBible(rulesetname)),
+	_sharedbible(Library::shareBible(rulesetname)),
+	_bible(*_sharedbible),
 	_skinner(_bible),
 	_player(player),
 	_board(_bible),
@@ -966,6 +968,8 @@ void Observer::prepareAnimationGroup()
 
 void Observer::processChanges()
 {
+	PROFILE_ZONE("Observer::processChanges");
+
 	LOGV << "Processing set of changes";
 
 	// Create an animation group. Remember it so we can wait for it to finish
@@ -82,7 +82,8 @@ protected:
 	Settings& _settings;
 	Game& _game;
 	Arranger _arranger;
-	Bible _bible;
+	const std::shared_ptr<const Bible> _sharedbible;
+	const Bible& _bible;
 	Skinner _skinner;
 	Player _player;
 
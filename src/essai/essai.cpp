@@ -24,6 +24,11 @@
 #include "essai.hpp"
 #include "source.hpp"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
 #include "libs/termcolor/termcolor.hpp"
 
 #include "coredump.hpp"
@@ -35,11 +40,13 @@
 #include "player.hpp"
 #include "aicommander.hpp"
 #include "ailibrary.hpp"
+#include "aineuralnewt.hpp"
 #include "automaton.hpp"
 #include "map.hpp"
 #include "library.hpp"
 #include "recording.hpp"
 #include "clock.hpp"
+#include "randomness.hpp"
 #include "system.hpp"
 
 
@@ -60,6 +67,12 @@ public:
 	std::array<std::array<size_t, NUM_BUCKETS>,
 		ABSOLUTE_MAX_TURNS + 1> globalWarmingPerTurn = {0};
 
+	uint64_t ms_action_phase_total = 0;
+	uint64_t ms_resting_phase_total = 0;
+	uint64_t ms_planning_phase_total = 0;
+	uint64_t ms_staging_phase_total = 0;
+	size_t total_divisor = 0;
+
 	void trackGlobalScorePerTurn(int score, int turn)
 	{
 		int bucket = std::max(0, std::min(
@@ -75,6 +88,24 @@ public:
 			NUM_BUCKETS - 1));
 		globalWarmingPerTurn[turn][bucket] += 1;
 	}
+
+	void merge(const Tracker& other)
+	{
+		for (size_t t = 0; t < globalScorePerTurn.size(); t++)
+		{
+			for (size_t b = 0; b < NUM_BUCKETS; b++)
+			{
+				globalScorePerTurn[t][b] += other.globalScorePerTurn[t][b];
+				globalWarmingPerTurn[t][b] += other.globalWarmingPerTurn[t][b];
+			}
+		}
+
+		ms_action_phase_total += other.ms_action_phase_total;
+		ms_resting_phase_total += other.ms_resting_phase_total;
+		ms_planning_phase_total += other.ms_planning_phase_total;
+		ms_staging_phase_total += other.ms_staging_phase_total;
+		total_divisor += other.total_divisor;
+	}
 };
 
 EssAI::EssAI(Settings& settings,
@@ -88,7 +119,8 @@ EssAI::EssAI(Settings& settings,
 	_ainames(ainames),
 	_aidifficulties(aidifficulties),
 	_mapname(mapname),
-	_enableRecordings(enableRecordings)
+	_enableRecordings(enableRecordings),
+	_jobs(1)
 {
 	_writer.install();
 	_library.load();
@@ -143,6 +175,11 @@ EssAI::EssAI(Settings& settings,
 		auto timestampMs = SteadyClock::milliseconds();
 		srand(timestampMs);
 	}
+
+	if (_settings.jobs.defined() && _settings.jobs.value() > 1)
+	{
+		_jobs = _settings.jobs.value();
+	}
 }
 
 EssAI::~EssAI()
@@ -163,7 +200,7 @@ EssAI::~EssAI()
 	}
 }
 
-EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
+EssAI::Matchup EssAI::nextMatchup(size_t offset)
 {
 	if (_players.size() <= 2)
 	{
@@ -189,6 +226,22 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 		}
 	}
 
+	Matchup matchup;
+	matchup.placements = _placements;
+	matchup.players = _players;
+	matchup.seed = rand();
+	return matchup;
+}
+
+EssAI::Result EssAI::playGame(const Matchup& matchup, Tracker& tracker)
+{
+	const std::vector<uint8_t>& placements = matchup.placements;
+	const std::vector<Player>& players = matchup.players;
+
+	// Each game draws from its own generator, so that it plays out the same
+	// regardless of which other games are played alongside it.
+	Randomness::seed(matchup.seed);
+
 	Json::Value metadata = Json::objectValue;
 	metadata["map"] = _mapname;
 	metadata["online"] = false;
@@ -200,12 +253,12 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 	std::vector<std::shared_ptr<AILibrary>> ailibraries; // (unique ownership)
 	for (size_t i = 0; i < _ainames.size(); i++)
 	{
-		aiplayers.emplace_back(_players[_placements[i]]);
+		aiplayers.emplace_back(players[placements[i]]);
 
 		if (AILibrary::isLibraryReminder(_ainames[i]))
 		{
 			std::shared_ptr<AILibrary> ptr = AILibrary::create(_ainames[i],
-				_players[_placements[i]], _aidifficulties[i],
+				players[placements[i]], _aidifficulties[i],
 				_ruleset, 'A' + i);
 
 			if (AILibrary::hasFastDirective(_ainames[i]))
@@ -233,7 +286,7 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 		else
 		{
 			aicommanders.emplace_back(AI::create(_ainames[i],
-				_players[_placements[i]], _aidifficulties[i],
+				players[placements[i]], _aidifficulties[i],
 				_ruleset, 'A' + i));
 
 			const AICommander& ai = *aicommanders.back();
@@ -248,19 +301,31 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 		}
 	}
 
-	Automaton automaton(_players, _ruleset);
+	// Neural bots prepare their orders together so their brains can batch.
+	std::vector<AINeuralNewt*> neuralnewts;
+	for (const auto& aicommander : aicommanders)
+	{
+		auto newt = dynamic_cast<AINeuralNewt*>(aicommander.get());
+		if (newt) neuralnewts.push_back(newt);
+	}
+
+	Automaton automaton(players, _ruleset);
 	Phase phase = Phase::GROWTH;
 
 	automaton.load(_mapname, false);
 	if (_enableRecordings)
 	{
+		if (_settings.changesetFormat.defined())
+		{
+			metadata["changeset-format"] = _settings.changesetFormat.value();
+		}
 		automaton.startRecording(metadata);
 	}
 	size_t turns = 0;
 	bool draw = false;
 
 	uint64_t ms = SteadyClock::milliseconds();
-	ms_phase_start = ms;
+	uint64_t ms_phase_start = ms;
 
 	while (phase != Phase::DECAY)
 	{
@@ -291,7 +356,7 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 			case Phase::RESTING:
 			{
 				ms = SteadyClock::milliseconds();
-				ms_action_phase_total += ms - ms_phase_start;
+				tracker.ms_action_phase_total += ms - ms_phase_start;
 				ms_phase_start = ms;
 
 				if (automaton.gameover())
@@ -336,9 +401,10 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 			case Phase::PLANNING:
 			{
 				ms = SteadyClock::milliseconds();
-				ms_resting_phase_total += ms - ms_phase_start;
+				tracker.ms_resting_phase_total += ms - ms_phase_start;
 				ms_phase_start = ms;
 
+				AINeuralNewt::prepareOrdersTogether(neuralnewts);
 				for (const auto& aicommander : aicommanders)
 				{
 					aicommander->prepareOrders();
@@ -367,7 +433,7 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 			case Phase::STAGING:
 			{
 				ms = SteadyClock::milliseconds();
-				ms_planning_phase_total += ms - ms_phase_start;
+				tracker.ms_planning_phase_total += ms - ms_phase_start;
 				ms_phase_start = ms;
 
 				for (const auto& aicommander : aicommanders)
@@ -395,7 +461,7 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 				}
 
 				ms = SteadyClock::milliseconds();
-				ms_staging_phase_total += ms - ms_phase_start;
+				tracker.ms_staging_phase_total += ms - ms_phase_start;
 				ms_phase_start = ms;
 
 				phase = Phase::ACTION;
@@ -408,15 +474,15 @@ EssAI::Result EssAI::playGame(size_t offset, Tracker& tracker)
 		}
 	}
 
-	total_divisor += turns;
+	tracker.total_divisor += turns;
 
 	Result result;
 	{
 		for (const Player& player : aiplayers)
 		{
-			for (size_t i = 0; i < _players.size(); i++)
+			for (size_t i = 0; i < players.size(); i++)
 			{
-				if (_players[i] == player)
+				if (players[i] == player)
 				{
 					result.initiatives.emplace_back(i + 1);
 					break;
@@ -791,6 +857,122 @@ static const char* ordinal(uint8_t x)
 	}
 }
 
+void EssAI::printResult(size_t offset, const Result& result)
+{
+	std::cout << "Result of game " << offset
+		<< " (" << result.recordingName << ")"
+		<< ": "
+		<< "Challenger"
+		<< " started " << ordinal(result.initiatives[0])
+		<< " from the " << ::stringify(result.positions[0]) << " position"
+		<< " and";
+	if (result.mutualDestruction)
+	{
+		std::cout << " "
+			<< termcolor::yellow
+			<< "achieved mutual destruction"
+			<< termcolor::reset;
+	}
+	else if (result.draw)
+	{
+		std::cout << " "
+			<< termcolor::yellow
+			<< "drew"
+			<< termcolor::reset;
+	}
+	else if (result.defeated[0])
+	{
+		std::cout << " "
+			<< termcolor::bold << termcolor::red
+			<< "lost"
+			<< termcolor::reset;
+	}
+	// TODO is it possible to broker peace when the totalscore is 0?
+	else if (result.scores[0] == result.totalScore)
+	{
+		std::cout << " "
+			<< termcolor::bold << termcolor::green
+			<< "won"
+			<< termcolor::reset;
+	}
+	else
+	{
+		std::cout << " "
+			<< termcolor::bold << termcolor::cyan
+			<< "achieved peace"
+			<< termcolor::reset;
+	}
+	std::cout << " in " << result.turns << " turns";
+	std::cout << " with " << result.scores[0] << " against "
+		<< (result.totalScore - result.scores[0]) << " points."
+		<< std::endl;
+}
+
+void EssAI::playGames(const std::vector<Matchup>& matchups,
+	std::vector<Result>& results, Tracker& tracker)
+{
+	size_t games = matchups.size();
+	size_t jobs = std::min(_jobs, games);
+	results.resize(games);
+
+	std::atomic<size_t> next(0);
+	std::mutex mutex;
+	std::condition_variable notifier;
+	std::vector<char> finished(games, false);
+
+	// Each worker has its own tracker, which are merged in afterwards.
+	std::vector<std::unique_ptr<Tracker>> trackers;
+	std::vector<std::thread> workers;
+	for (size_t j = 0; j < jobs; j++)
+	{
+		trackers.emplace_back(new Tracker());
+		Tracker& own = *trackers.back();
+		workers.emplace_back([this, &matchups, &results, &finished,
+				&next, &mutex, &notifier, &own, games]() {
+
+			// Writer::write() needs a Writer installed in this thread.
+			Writer writer;
+			writer.install();
+
+			for (size_t i = next++; i < games; i = next++)
+			{
+				Result result = playGame(matchups[i], own);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					results[i] = std::move(result);
+					finished[i] = true;
+				}
+
+				notifier.notify_all();
+			}
+		});
+	}
+
+	// Report the results in order, regardless of which game finished first.
+	for (size_t i = 0; i < games; i++)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			notifier.wait(lock, [&finished, i]() {
+				return finished[i];
+			});
+		}
+
+		printResult(i, results[i]);
+	}
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	for (const auto& own : trackers)
+	{
+		tracker.merge(*own);
+	}
+}
+
 void EssAI::run(size_t games)
 {
 	time_t starttime;
@@ -817,60 +999,34 @@ void EssAI::run(size_t games)
 
 	Tracker tracker;
 
-	std::vector<Result> results;
+	// The matchups are determined up front so that the outcome does not
+	// depend on the order in which the games are played.
+	std::vector<Matchup> matchups;
 	for (size_t i = 0; i < games; i++)
 	{
-		results.emplace_back(playGame(i, tracker));
-		Result& result = results.back();
-		std::cout << "Result of game " << i
-			<< " (" << result.recordingName << ")"
-			<< ": "
-			<< "Challenger"
-			<< " started " << ordinal(result.initiatives[0])
-			<< " from the " << ::stringify(result.positions[0]) << " position"
-			<< " and";
-		if (result.mutualDestruction)
-		{
-			std::cout << " "
-				<< termcolor::yellow
-				<< "achieved mutual destruction"
-				<< termcolor::reset;
-		}
-		else if (result.draw)
-		{
-			std::cout << " "
-				<< termcolor::yellow
-				<< "drew"
-				<< termcolor::reset;
-		}
-		else if (result.defeated[0])
-		{
-			std::cout << " "
-				<< termcolor::bold << termcolor::red
-				<< "lost"
-				<< termcolor::reset;
-		}
-		// TODO is it possible to broker peace when the totalscore is 0?
-		else if (result.scores[0] == result.totalScore)
-		{
-			std::cout << " "
-				<< termcolor::bold << termcolor::green
-				<< "won"
-				<< termcolor::reset;
-		}
-		else
+		matchups.emplace_back(nextMatchup(i));
+	}
+
+	std::vector<Result> results;
+	if (_jobs > 1 && games > 1)
+	{
+		playGames(matchups, results, tracker);
+	}
+	else
+	{
+		for (size_t i = 0; i < games; i++)
 		{
-			std::cout << " "
-				<< termcolor::bold << termcolor::cyan
-				<< "achieved peace"
-				<< termcolor::reset;
+			results.emplace_back(playGame(matchups[i], tracker));
+			printResult(i, results.back());
 		}
-		std::cout << " in " << result.turns << " turns";
-		std::cout << " with " << result.scores[0] << " against "
-			<< (result.totalScore - result.scores[0]) << " points."
-			<< std::endl;
 	}
 
+	ms_action_phase_total += tracker.ms_action_phase_total;
+	ms_resting_phase_total += tracker.ms_resting_phase_total;
+	ms_planning_phase_total += tracker.ms_planning_phase_total;
+	ms_staging_phase_total += tracker.ms_staging_phase_total;
+	total_divisor += tracker.total_divisor;
+
 	Json::Value json = resultsToJson(results, starttime, humantime);
 	log << Writer::write(json);
 	log.close();
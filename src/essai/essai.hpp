@@ -67,6 +67,13 @@ private:
 		std::string recordingName;
 	};
 
+	struct Matchup
+	{
+		std::vector<uint8_t> placements;
+		std::vector<Player> players;
+		uint32_t seed;
+	};
+
 	Settings& _settings;
 	Writer _writer;
 	Library _library;
@@ -78,8 +85,8 @@ private:
 	std::string _mapname;
 	std::string _fullsuitelogname;
 	bool _enableRecordings;
+	size_t _jobs;
 
-	uint64_t ms_phase_start;
 	uint64_t ms_action_phase_total = 0;
 	uint64_t ms_resting_phase_total = 0;
 	uint64_t ms_planning_phase_total = 0;
@@ -90,7 +97,11 @@ private:
 		time_t starttime, const char* humantime);
 	void writeMatchLengthTsv(const std::vector<Result>& results,
 		const std::string& filename);
-	Result playGame(size_t offset, Tracker& tracker);
+	Matchup nextMatchup(size_t offset);
+	Result playGame(const Matchup& matchup, Tracker& tracker);
+	void playGames(const std::vector<Matchup>& matchups,
+		std::vector<Result>& results, Tracker& tracker);
+	void printResult(size_t offset, const Result& result);
 
 public:
 	void run(size_t games);
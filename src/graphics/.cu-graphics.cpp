@@ -6,6 +6,8 @@
 #include "colorname.cpp"
 #include "collector.cpp"
 #include "displaysettings.cpp"
+#include "glyphatlas.cpp"
+#include "glyphlayout.cpp"
 #include "graphics.cpp"
 #include "input.cpp"
 #include "loop.cpp"
@@ -16,6 +18,7 @@
 #include "primitive.cpp"
 #include "shader.cpp"
 #include "sprite.cpp"
+#include "spritebatch.cpp"
 #include "spritepattern.cpp"
 #include "text.cpp"
 #include "texture.cpp"
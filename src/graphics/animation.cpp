@@ -41,25 +41,32 @@ void Animation::update()
 	if (_progress >= 1) return;
 
 	float dt = Loop::delta() * Loop::tempo();
+	if (!advance(_progress, _delay, _duration, dt)) return;
 
-	if (_delay > 0)
+	_callback(_progress);
+}
+
+bool Animation::advance(float& progress, float& delay, float duration,
+	float dt)
+{
+	if (delay > 0)
 	{
-		_delay -= dt;
-		if (_delay >= 0) return;
-		else dt = -_delay;
+		delay -= dt;
+		if (delay >= 0) return false;
+		else dt = -delay;
 	}
 
-	if (_duration <= 0 || std::isnan(_duration) || std::isinf(_duration))
+	if (duration <= 0 || std::isnan(duration) || std::isinf(duration))
 	{
-		_progress = 1;
+		progress = 1;
 	}
 	else
 	{
-		_progress += dt / _duration;
-		if (_progress > 1) _progress = 1;
+		progress += dt / duration;
+		if (progress > 1) progress = 1;
 	}
 
-	_callback(_progress);
+	return true;
 }
 
 bool Animation::finished()
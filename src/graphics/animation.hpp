@@ -44,4 +44,11 @@ public:
 		float delay);
 	void update();
 	bool finished();
+
+	// Advance the progress by dt once the delay has run out. Returns false
+	// if the delay has not run out yet.
+	static bool advance(float& progress, float& delay, float duration,
+		float dt);
+
+	friend class Animator;
 };
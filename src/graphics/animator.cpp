@@ -25,16 +25,56 @@
 #include "source.hpp"
 
 #include "animationgroup.hpp"
+#include "loop.hpp"
 
 
 void Animator::update()
 {
-	for (auto animation = _animations.begin(); animation != _animations.end(); /**/)
+	float dt = Loop::delta() * Loop::tempo();
+
+	// Update the tweens in order, because later tweens should overrule
+	// earlier ones, and move the unfinished ones forward as we go.
+	// Callbacks might add new tweens, so we cannot hold on to references.
+	size_t count = _tweens.size();
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++)
 	{
-		animation->update();
-		if (animation->finished()) animation = _animations.erase(animation);
-		else ++animation;
+		Tween& tween = _tweens[i];
+		if (Animation::advance(tween.progress, tween.delay, tween.duration,
+				dt))
+		{
+			switch (tween.type)
+			{
+				case Tween::Type::PAUSE:
+				break;
+				case Tween::Type::CALLBACK:
+				{
+					_callbacks[tween.index](tween.progress);
+
+					// The callback might have reset this animator.
+					if (_tweens.size() < count) return;
+				}
+				break;
+				case Tween::Type::TRANSITION:
+				{
+					applyTransition(tween);
+				}
+				break;
+			}
+		}
+
+		if (_tweens[i].progress < 1)
+		{
+			if (kept != i) _tweens[kept] = std::move(_tweens[i]);
+			kept++;
+		}
+		else if (_tweens[i].type == Tween::Type::CALLBACK)
+		{
+			_callbacks[_tweens[i].index] = nullptr;
+			_freecallbacks.push_back(_tweens[i].index);
+		}
 	}
+	_tweens.erase(_tweens.begin() + kept, _tweens.begin() + count);
 
 	if (_personalDelayGroup.lock() == nullptr)
 	{
@@ -44,7 +84,45 @@ void Animator::update()
 
 void Animator::addAnimation(Animation&& animation)
 {
-	_animations.emplace_back(animation);
+	size_t slot;
+	if (_freecallbacks.empty())
+	{
+		slot = _callbacks.size();
+		_callbacks.emplace_back(std::move(animation._callback));
+	}
+	else
+	{
+		slot = _freecallbacks.back();
+		_freecallbacks.pop_back();
+		_callbacks[slot] = std::move(animation._callback);
+	}
+
+	addTween(std::move(animation._group), Tween::Type::CALLBACK, slot,
+		animation._duration, animation._delay);
+}
+
+void Animator::addTransition(std::shared_ptr<AnimationGroup> group,
+	size_t index, float target, float duration, float delay)
+{
+	addTween(std::move(group), Tween::Type::TRANSITION, index,
+		duration, delay);
+	_tweens.back().target = target;
+}
+
+void Animator::addTween(std::shared_ptr<AnimationGroup>&& group,
+	Tween::Type type, size_t index, float duration, float delay)
+{
+	_tweens.emplace_back();
+	Tween& tween = _tweens.back();
+	tween.group = std::move(group);
+	tween.duration = duration;
+	tween.delay = delay;
+	tween.progress = 0;
+	tween.type = type;
+	tween.started = false;
+	tween.index = index;
+	tween.origin = 0;
+	tween.target = 0;
 }
 
 void Animator::personalDelay(std::shared_ptr<AnimationGroup> group)
@@ -80,10 +158,12 @@ void Animator::personalDelay(std::shared_ptr<AnimationGroup> group, float delay)
 
 void Animator::pause(std::shared_ptr<AnimationGroup> group, float delay)
 {
-	addAnimation(Animation(group, [](float /**/) {}, 0, delay));
+	addTween(std::move(group), Tween::Type::PAUSE, 0, 0, delay);
 }
 
 void Animator::reset()
 {
-	_animations.clear();
+	_tweens.clear();
+	_callbacks.clear();
+	_freecallbacks.clear();
 }
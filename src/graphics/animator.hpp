@@ -24,6 +24,8 @@
 #pragma once
 #include "header.hpp"
 
+#include <deque>
+
 #include "animation.hpp"
 
 struct AnimationGroup;
@@ -36,8 +38,36 @@ protected:
 public:
 	virtual ~Animator() = default;
 
+protected:
+	// A running animation. Transitions and pauses are plain data, whereas
+	// the callbacks of other animations are kept in a separate pool, so that
+	// tweens are cheap to move when finished tweens are removed.
+	struct Tween
+	{
+		enum class Type : uint8_t
+		{
+			PAUSE,
+			CALLBACK,
+			TRANSITION,
+		};
+
+		std::shared_ptr<AnimationGroup> group;
+		float duration;
+		float delay;
+		float progress;
+		Type type;
+		bool started;
+		// The callback slot or the transition index, depending on the type.
+		size_t index;
+		float origin;
+		float target;
+	};
+
 private:
-	std::vector<Animation> _animations;
+	std::vector<Tween> _tweens;
+	// A deque, so a callback remains in place if it adds more animations.
+	std::deque<std::function<void(float)>> _callbacks;
+	std::vector<size_t> _freecallbacks;
 
 	float _personalDelay = 0;
 	std::weak_ptr<AnimationGroup> _personalDelayGroup;
@@ -49,4 +79,14 @@ public:
 	void personalDelay(std::shared_ptr<AnimationGroup> group, float delay);
 	void pause(std::shared_ptr<AnimationGroup> group, float delay);
 	void reset();
+
+protected:
+	void addTransition(std::shared_ptr<AnimationGroup> group, size_t index,
+		float target, float duration, float delay);
+
+	virtual void applyTransition(Tween& /**/) {}
+
+private:
+	void addTween(std::shared_ptr<AnimationGroup>&& group, Tween::Type type,
+		size_t index, float duration, float delay);
 };
@@ -30,6 +30,7 @@
 #include "text.hpp"
 #include "primitive.hpp"
 #include "graphics.hpp"
+#include "spritebatch.hpp"
 
 
 Collector* Collector::_installed = nullptr;
@@ -43,6 +44,11 @@ Collector::Collector(const Graphics& graphics) :
 	_graphics(graphics)
 {}
 
+Collector::~Collector()
+{
+	if (_vertexbuffer) glDeleteBuffers(1, &_vertexbuffer);
+}
+
 void Collector::addAlways(std::vector<CoSprite>& drawlist,
 		const std::shared_ptr<Sprite> sprite, const Point& point)
 {
@@ -231,69 +237,45 @@ void Collector::renderSprites()
 
 	/* Draw the surfaces. */
 
-	for (const CoSprite& item : _backgroundSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::UNMASKED);
-	}
-	_backgroundSurfaces.clear();
+	// Within these draw steps the order does not matter, so we group sprites
+	// that share textures and palettes in order to draw them together.
+	sortByState(_unmaskedBorderSurfaces);
+	sortByState(_unmaskedSurfaces);
+	sortByState(_maskedSurfaces);
+	sortByState(_maskedBorderSurfaces);
 
-	for (const CoSprite& item : _unmaskedBorderSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::UNMASKED);
-	}
-	_unmaskedBorderSurfaces.clear();
-
-	for (const CoSprite& item : _unmaskedSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::UNMASKED);
-	}
-	_unmaskedSurfaces.clear();
-
-	for (const CoSprite& item : _maskedSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::MASKED);
-	}
-	_maskedSurfaces.clear();
-
-	for (const CoSprite& item : _maskedBorderSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::MASKED);
-	}
-	_maskedBorderSurfaces.clear();
+	batchAndClear(_backgroundSurfaces, SurfaceDrawFlag::UNMASKED);
+	batchAndClear(_unmaskedBorderSurfaces, SurfaceDrawFlag::UNMASKED);
+	batchAndClear(_unmaskedSurfaces, SurfaceDrawFlag::UNMASKED);
+	batchAndClear(_maskedSurfaces, SurfaceDrawFlag::MASKED);
+	batchAndClear(_maskedBorderSurfaces, SurfaceDrawFlag::MASKED);
 
 	std::sort(_sortedSurfaces.begin(), _sortedSurfaces.end(), lessYahooOrXenon);
-	for (const CoSprite& item : _sortedSurfaces)
-	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo,
-				SurfaceDrawFlag::UNMASKED | SurfaceDrawFlag::MASKED);
-	}
-	_sortedSurfaces.clear();
+	batchAndClear(_sortedSurfaces,
+		SurfaceDrawFlag::UNMASKED | SurfaceDrawFlag::MASKED);
 
 	/* Draw the shadows and guides on top of the surfaces. */
 
 	std::sort(_shadows.begin(), _shadows.end(), lessYahooOrXenon);
-	renderAndClear(spriteshader, _shadows);
+	batchAndClear(_shadows);
 
 	std::sort(_footprints.begin(), _footprints.end(), lessYahooOrXenon);
-	renderAndClear(spriteshader, _footprints);
+	batchAndClear(_footprints);
 
-	renderAndClear(spriteshader, _guides);
-	renderAndClear(spriteshader, _hovers);
+	batchAndClear(_guides);
+	batchAndClear(_hovers);
 
 	/* Draw the figures and particles in y,x-order. */
 
 	std::sort(_figures.begin(), _figures.end(), lessYahooOrXenon);
-	renderAndClear(spriteshader, _figures);
+	batchAndClear(_figures);
 
 	/* Draw the guidestamps and busycursor. */
 
-	renderAndClear(spriteshader, _guidestamps);
-	renderAndClear(spriteshader, _busycursors);
+	batchAndClear(_guidestamps);
+	batchAndClear(_busycursors);
+
+	drawBatch(spriteshader);
 }
 
 void Collector::renderLayers()
@@ -330,8 +312,9 @@ void Collector::renderLayerFrames(const CoLayer& layer)
 
 	for (const CoSprite& item : layer.frames)
 	{
-		item.sprite->render(shader, item.pixel.xenon, item.pixel.yahoo);
+		item.sprite->draw(_batch, item.pixel.xenon, item.pixel.yahoo);
 	}
+	drawBatch(shader);
 }
 
 void Collector::renderLayerPrimitives(const CoLayer& layer)
@@ -352,8 +335,9 @@ void Collector::renderLayerImages(const CoLayer& layer)
 
 	for (const CoSprite& item : layer.images)
 	{
-		item.sprite->render(shader, item.pixel.xenon, item.pixel.yahoo);
+		item.sprite->draw(_batch, item.pixel.xenon, item.pixel.yahoo);
 	}
+	drawBatch(shader);
 }
 
 void Collector::renderLayerTexts(const CoLayer& layer)
@@ -367,16 +351,111 @@ void Collector::renderLayerTexts(const CoLayer& layer)
 	}
 }
 
-void Collector::renderAndClear(GLuint spriteshader,
-	std::vector<CoSprite>& drawlist)
+void Collector::batchAndClear(std::vector<CoSprite>& drawlist, int flags)
 {
 	for (const CoSprite& item : drawlist)
 	{
-		item.sprite->render(spriteshader, item.pixel.xenon, item.pixel.yahoo);
+		item.sprite->draw(_batch, item.pixel.xenon, item.pixel.yahoo, flags);
 	}
 	drawlist.clear();
 }
 
+void Collector::sortByState(std::vector<CoSprite>& drawlist)
+{
+	std::stable_sort(drawlist.begin(), drawlist.end(),
+		[](const CoSprite& a, const CoSprite& b) {
+
+		return (a.sprite->texture() < b.sprite->texture())
+			|| (a.sprite->texture() == b.sprite->texture()
+				&& std::less<const Sprite::Palette*>()(
+					a.sprite->palette(), b.sprite->palette()));
+	});
+}
+
+void Collector::drawBatch(GLuint shader)
+{
+	if (_batch.empty()) return;
+
+	GLuint glTexture = glGetUniformLocation(shader, "texture");
+	glUniform1i(glTexture, 0);
+
+	GLuint glPalette = glGetUniformLocation(shader, "palette");
+	glUniform1i(glPalette, 1);
+
+	GLuint glMask = glGetUniformLocation(shader, "mask");
+	glUniform1i(glMask, 2);
+
+	const std::vector<SpriteVertex>& vertices = _batch.vertices();
+	size_t size = vertices.size() * sizeof(SpriteVertex);
+	if (!_vertexbuffer) glGenBuffers(1, &_vertexbuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, _vertexbuffer);
+
+	// Orphan the storage of the previous batch, so that filling the buffer
+	// does not have to wait until the GPU has finished drawing from it.
+	_vertexcapacity = std::max(_vertexcapacity, size);
+	glBufferData(GL_ARRAY_BUFFER, _vertexcapacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+
+	const GLsizei stride = sizeof(SpriteVertex);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, stride,
+		(const GLvoid*) offsetof(SpriteVertex, x));
+	glClientActiveTexture(GL_TEXTURE0);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, stride,
+		(const GLvoid*) offsetof(SpriteVertex, s));
+	glClientActiveTexture(GL_TEXTURE2);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, stride,
+		(const GLvoid*) offsetof(SpriteVertex, ms));
+	glClientActiveTexture(GL_TEXTURE3);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(4, GL_FLOAT, stride,
+		(const GLvoid*) offsetof(SpriteVertex, obscured));
+	glClientActiveTexture(GL_TEXTURE4);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(4, GL_FLOAT, stride,
+		(const GLvoid*) offsetof(SpriteVertex, shinecolor));
+
+	const Sprite::Palette* palette = nullptr;
+	for (const SpriteBatch::Run& run : _batch.runs())
+	{
+		if (run.state.palette != palette)
+		{
+			glActiveTexture(GL_TEXTURE1);
+			run.state.palette->bind(shader);
+			palette = run.state.palette;
+		}
+
+		if (run.state.mask)
+		{
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_2D, run.state.mask);
+		}
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, run.state.texture);
+		if (run.state.repeat)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		}
+
+		glDrawArrays(GL_TRIANGLES, run.first, run.count);
+	}
+
+	// Pictures and primitives are still drawn in immediate mode.
+	for (GLenum unit : {GL_TEXTURE4, GL_TEXTURE3, GL_TEXTURE2, GL_TEXTURE0})
+	{
+		glClientActiveTexture(unit);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	_batch.clear();
+}
+
 void Collector::empty()
 {
 	_backgroundSurfaces.clear();
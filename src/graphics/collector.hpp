@@ -27,6 +27,7 @@
 #include "libs/GLEW/glew.h"
 
 #include "pixel.hpp"
+#include "spritebatch.hpp"
 
 class Sprite;
 class Picture;
@@ -126,10 +127,20 @@ private:
 	// A vector of interface layers for all of the interface elements.
 	std::vector<CoLayer> _layers;
 
+	// Sprites are collected into a batch before being sent to the GPU.
+	SpriteBatch _batch;
+	GLuint _vertexbuffer = 0;
+	size_t _vertexcapacity = 0;
+
 public:
 	static Collector* get() { return _installed; }
 
 	Collector(const Graphics& graphics);
+	Collector(const Collector&) = delete;
+	Collector(Collector&&) = delete;
+	Collector& operator=(const Collector&) = delete;
+	Collector& operator=(Collector&&) = delete;
+	~Collector();
 
 	void install();
 
@@ -182,7 +193,9 @@ public:
 
 private:
 	void renderSprites();
-	void renderAndClear(GLuint spriteshader, std::vector<CoSprite>& drawlist);
+	void batchAndClear(std::vector<CoSprite>& drawlist, int flags = 0);
+	void sortByState(std::vector<CoSprite>& drawlist);
+	void drawBatch(GLuint shader);
 
 	void renderLayers();
 	void renderLayerPictures(const CoLayer& layer);
@@ -0,0 +1,239 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "glyphatlas.hpp"
+#include "source.hpp"
+
+#include "libs/SDL2/SDL.h"
+#include "libs/SDL2/SDL_ttf.h"
+
+
+// Glyphs are packed onto shelves that span the full width of the atlas,
+// and the atlas grows downwards when it runs out of shelves.
+constexpr int GLYPHATLAS_WIDTH = 512;
+constexpr int GLYPHATLAS_INITIAL_HEIGHT = 128;
+constexpr int GLYPHATLAS_MAX_HEIGHT = 4096;
+
+static uint8_t glyphatlasCoverage(const SDL_Surface* surface, int x, int y)
+{
+	if (x < 0 || x >= surface->w || y < 0 || y >= surface->h) return 0;
+
+	const uint8_t* row = (const uint8_t*) surface->pixels + y * surface->pitch;
+	uint32_t pixel = ((const uint32_t*) row)[x];
+	uint8_t r, g, b, a;
+	SDL_GetRGBA(pixel, surface->format, &r, &g, &b, &a);
+	return a;
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font* font, TTF_Font* outlinefont, int outline) :
+	_font(font),
+	_outlinefont(outlinefont),
+	_outline(outlinefont ? outline : 0),
+	_surface(SDL_CreateRGBSurfaceWithFormat(0,
+		GLYPHATLAS_WIDTH, GLYPHATLAS_INITIAL_HEIGHT,
+		32, SDL_PIXELFORMAT_RGBA8888))
+{
+	if (!_surface)
+	{
+		LOGW << "SDL generated invalid surface while constructing GlyphAtlas";
+		DEBUG_ASSERT(false);
+		_full = true;
+		return;
+	}
+	SDL_SetSurfaceBlendMode(_surface, SDL_BLENDMODE_NONE);
+	SDL_FillRect(_surface, nullptr, 0);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	if (_textureID) glDeleteTextures(1, &_textureID);
+	if (_surface) SDL_FreeSurface(_surface);
+}
+
+int GlyphAtlas::width() const
+{
+	return (_surface) ? _surface->w : 1;
+}
+
+int GlyphAtlas::height() const
+{
+	return (_surface) ? _surface->h : 1;
+}
+
+bool GlyphAtlas::prepare(const std::vector<uint16_t>& codepoints)
+{
+	for (uint16_t codepoint : codepoints)
+	{
+		if (_table.find(codepoint)) continue;
+		if (!rasterize(codepoint)) return false;
+	}
+
+	for (size_t i = 1; i < codepoints.size(); i++)
+	{
+		uint16_t prev = codepoints[i - 1];
+		uint16_t next = codepoints[i];
+		if (_table.hasKerning(prev, next)) continue;
+		_table.addKerning(prev, next,
+			TTF_GetFontKerningSizeGlyphs(_font, prev, next));
+	}
+
+	return true;
+}
+
+bool GlyphAtlas::rasterize(uint16_t codepoint)
+{
+	if (!_surface) return false;
+
+	// Missing glyphs are left to the TTF fallback, which knows how to
+	// render them as boxes.
+	if (!TTF_GlyphIsProvided(_font, codepoint)) return false;
+
+	int minx, maxx, miny, maxy, advance;
+	if (TTF_GlyphMetrics(_font, codepoint, &minx, &maxx, &miny, &maxy,
+		&advance))
+	{
+		return false;
+	}
+
+	// Render the glyph as a string of its own, so that it is placed on the
+	// baseline in exactly the same way as in a longer string.
+	std::string str = GlyphTable::encode(codepoint);
+	SDL_Color white = {255, 255, 255, 255};
+	SDL_Surface* fg = TTF_RenderUTF8_Blended(_font, str.c_str(), white);
+	if (!fg) return false;
+	SDL_Surface* ol = nullptr;
+	if (_outline > 0)
+	{
+		ol = TTF_RenderUTF8_Blended(_outlinefont, str.c_str(), white);
+		if (!ol)
+		{
+			SDL_FreeSurface(fg);
+			return false;
+		}
+	}
+
+	// The glyph lies on top of its outline, offset by the outline width.
+	int w = (ol) ? ol->w : fg->w;
+	int h = (ol) ? ol->h : fg->h;
+	int u, v;
+	if (!allocate(w, h, u, v))
+	{
+		SDL_FreeSurface(fg);
+		if (ol) SDL_FreeSurface(ol);
+		return false;
+	}
+
+	for (int y = 0; y < h; y++)
+	{
+		uint8_t* row = (uint8_t*) _surface->pixels + (v + y) * _surface->pitch;
+		for (int x = 0; x < w; x++)
+		{
+			uint8_t glyph = glyphatlasCoverage(fg, x - _outline, y - _outline);
+			uint8_t outline = (ol) ? glyphatlasCoverage(ol, x, y) : 0;
+			((uint32_t*) row)[u + x] = SDL_MapRGBA(_surface->format,
+				glyph, outline, 0, 0);
+		}
+	}
+	SDL_FreeSurface(fg);
+	if (ol) SDL_FreeSurface(ol);
+
+	_table.add(codepoint, GlyphCell{
+		(uint16_t) u, (uint16_t) v, (uint16_t) w, (uint16_t) h,
+		(int16_t) std::min(0, minx), (int16_t) advance});
+	_dirty = true;
+	return true;
+}
+
+bool GlyphAtlas::allocate(int w, int h, int& u, int& v)
+{
+	// Leave a pixel of space between cells.
+	if (w + 1 > _surface->w) return false;
+
+	if (_shelfX + w + 1 > _surface->w)
+	{
+		_shelfY += _shelfH;
+		_shelfX = 0;
+		_shelfH = 0;
+	}
+
+	while (_shelfY + h + 1 > _surface->h)
+	{
+		if (!grow()) return false;
+	}
+
+	u = _shelfX;
+	v = _shelfY;
+	_shelfX += w + 1;
+	_shelfH = std::max(_shelfH, h + 1);
+	return true;
+}
+
+bool GlyphAtlas::grow()
+{
+	if (_full) return false;
+
+	if (2 * _surface->h > GLYPHATLAS_MAX_HEIGHT)
+	{
+		LOGW << "Glyph atlas is full, falling back to TTF textures";
+		_full = true;
+		return false;
+	}
+
+	SDL_Surface* grown = SDL_CreateRGBSurfaceWithFormat(0,
+		_surface->w, 2 * _surface->h,
+		32, SDL_PIXELFORMAT_RGBA8888);
+	if (!grown)
+	{
+		LOGW << "SDL generated invalid surface while growing GlyphAtlas";
+		DEBUG_ASSERT(false);
+		_full = true;
+		return false;
+	}
+	SDL_SetSurfaceBlendMode(grown, SDL_BLENDMODE_NONE);
+	SDL_FillRect(grown, nullptr, 0);
+	SDL_BlitSurface(_surface, nullptr, grown, nullptr);
+	SDL_FreeSurface(_surface);
+	_surface = grown;
+	_dirty = true;
+	return true;
+}
+
+void GlyphAtlas::bind()
+{
+	if (!_textureID)
+	{
+		glGenTextures(1, &_textureID);
+		glBindTexture(GL_TEXTURE_2D, _textureID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	else glBindTexture(GL_TEXTURE_2D, _textureID);
+
+	// New glyphs are uploaded together the next time the atlas is used.
+	if (_dirty && _surface)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _surface->w, _surface->h,
+			0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, _surface->pixels);
+		_dirty = false;
+	}
+}
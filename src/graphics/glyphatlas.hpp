@@ -0,0 +1,80 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "libs/GLEW/glew.h"
+
+#include "glyphlayout.hpp"
+
+struct SDL_Surface;
+typedef struct _TTF_Font TTF_Font;
+
+
+/*
+A texture that holds every glyph of a single font and style that has been
+drawn so far. The coverage of the glyph itself is stored in the red channel
+and that of its outline in the green channel, so that the same glyphs can be
+drawn in any color.
+*/
+class GlyphAtlas
+{
+public:
+	GlyphAtlas(TTF_Font* font, TTF_Font* outlinefont, int outline);
+	GlyphAtlas(const GlyphAtlas&) = delete;
+	GlyphAtlas(GlyphAtlas&&) = delete;
+	GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+	GlyphAtlas& operator=(GlyphAtlas&&) = delete;
+	~GlyphAtlas();
+
+private:
+	TTF_Font* const _font;
+	TTF_Font* const _outlinefont;
+	const int _outline;
+
+	GlyphTable _table;
+	SDL_Surface* _surface;
+	int _shelfX = 0;
+	int _shelfY = 0;
+	int _shelfH = 0;
+	bool _full = false;
+
+	GLuint _textureID = 0;
+	bool _dirty = true;
+
+	bool rasterize(uint16_t codepoint);
+	bool allocate(int w, int h, int& u, int& v);
+	bool grow();
+
+public:
+	const GlyphTable& table() const { return _table; }
+	bool hasOutline() const { return _outline > 0; }
+	int width() const;
+	int height() const;
+
+	// Returns false if some glyphs cannot be drawn from this atlas.
+	bool prepare(const std::vector<uint16_t>& codepoints);
+
+	void bind();
+};
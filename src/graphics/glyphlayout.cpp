@@ -0,0 +1,169 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "glyphlayout.hpp"
+#include "source.hpp"
+
+
+void GlyphTable::add(uint16_t codepoint, const GlyphCell& cell)
+{
+	_cells[codepoint] = cell;
+}
+
+void GlyphTable::addKerning(uint16_t prev, uint16_t next, int kerning)
+{
+	kerning = std::max(-128, std::min(kerning, 127));
+	_kerning[pair(prev, next)] = (int8_t) kerning;
+}
+
+const GlyphCell* GlyphTable::find(uint16_t codepoint) const
+{
+	auto found = _cells.find(codepoint);
+	if (found == _cells.end()) return nullptr;
+	return &(found->second);
+}
+
+bool GlyphTable::hasKerning(uint16_t prev, uint16_t next) const
+{
+	return (_kerning.find(pair(prev, next)) != _kerning.end());
+}
+
+int GlyphTable::kerning(uint16_t prev, uint16_t next) const
+{
+	auto found = _kerning.find(pair(prev, next));
+	if (found == _kerning.end()) return 0;
+	return found->second;
+}
+
+int GlyphTable::layout(const std::vector<uint16_t>& codepoints,
+	std::vector<GlyphQuad>* quads) const
+{
+	size_t offset = (quads) ? quads->size() : 0;
+	int pen = 0;
+	int left = 0;
+	int right = 0;
+	for (size_t i = 0; i < codepoints.size(); i++)
+	{
+		const GlyphCell* cell = find(codepoints[i]);
+		if (!cell) return -1;
+
+		if (i > 0) pen += kerning(codepoints[i - 1], codepoints[i]);
+
+		// Cells may stick out on either side of the pen, for instance
+		// because of an outline or because of an italic style.
+		int x = pen + cell->bearing;
+		left = std::min(left, x);
+		right = std::max(right, x + cell->w);
+		if (quads)
+		{
+			quads->emplace_back(GlyphQuad{x, 0, cell->w, cell->h,
+				cell->u, cell->v});
+		}
+
+		pen += cell->advance;
+	}
+	right = std::max(right, pen);
+
+	// Nothing is drawn left of the text's origin.
+	if (quads && left < 0)
+	{
+		for (size_t i = offset; i < quads->size(); i++)
+		{
+			(*quads)[i].x -= left;
+		}
+	}
+
+	return right - left;
+}
+
+int GlyphTable::measure(const std::vector<uint16_t>& codepoints) const
+{
+	return layout(codepoints, nullptr);
+}
+
+bool GlyphTable::decode(const std::string& text,
+	std::vector<uint16_t>& codepoints)
+{
+	codepoints.clear();
+	codepoints.reserve(text.size());
+	for (size_t i = 0; i < text.size(); )
+	{
+		uint8_t lead = text[i];
+		uint32_t codepoint;
+		size_t length;
+		if (lead < 0x80)
+		{
+			codepoint = lead;
+			length = 1;
+		}
+		else if ((lead & 0xE0) == 0xC0)
+		{
+			codepoint = lead & 0x1F;
+			length = 2;
+		}
+		else if ((lead & 0xF0) == 0xE0)
+		{
+			codepoint = lead & 0x0F;
+			length = 3;
+		}
+		else return false;
+
+		if (i + length > text.size()) return false;
+		for (size_t k = 1; k < length; k++)
+		{
+			uint8_t x = text[i + k];
+			if ((x & 0xC0) != 0x80) return false;
+			codepoint = (codepoint << 6) | (x & 0x3F);
+		}
+
+		// Reject overlong encodings and UTF16 surrogates.
+		if (length == 2 && codepoint < 0x80) return false;
+		if (length == 3 && codepoint < 0x800) return false;
+		if (codepoint >= 0xD800 && codepoint <= 0xDFFF) return false;
+
+		codepoints.push_back((uint16_t) codepoint);
+		i += length;
+	}
+	return true;
+}
+
+std::string GlyphTable::encode(uint16_t codepoint)
+{
+	std::string str;
+	if (codepoint < 0x80)
+	{
+		str += (char) codepoint;
+	}
+	else if (codepoint < 0x800)
+	{
+		str += (char) (0xC0 | (codepoint >> 6));
+		str += (char) (0x80 | (codepoint & 0x3F));
+	}
+	else
+	{
+		str += (char) (0xE0 | (codepoint >> 12));
+		str += (char) (0x80 | ((codepoint >> 6) & 0x3F));
+		str += (char) (0x80 | (codepoint & 0x3F));
+	}
+	return str;
+}
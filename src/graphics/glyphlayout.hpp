@@ -0,0 +1,100 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <unordered_map>
+
+
+/*
+The CPU side of the glyph atlas: metrics of glyphs that have been rasterized
+into the atlas, and how a string of those glyphs is laid out. Nothing in here
+touches SDL_ttf or OpenGL, so it can be exercised without a window.
+*/
+
+struct GlyphCell
+{
+	// The rectangle in the atlas that holds the rasterized glyph.
+	uint16_t u;
+	uint16_t v;
+	uint16_t w;
+	uint16_t h;
+
+	// The cell is drawn at the pen position plus the bearing,
+	// after which the pen moves forward by the advance.
+	int16_t bearing;
+	int16_t advance;
+};
+
+struct GlyphQuad
+{
+	// The destination rectangle relative to the top left of the text.
+	int x;
+	int y;
+	int w;
+	int h;
+
+	// The source rectangle in the atlas.
+	uint16_t u;
+	uint16_t v;
+};
+
+class GlyphTable
+{
+public:
+	GlyphTable() = default;
+	GlyphTable(const GlyphTable&) = delete;
+	GlyphTable(GlyphTable&&) = delete;
+	GlyphTable& operator=(const GlyphTable&) = delete;
+	GlyphTable& operator=(GlyphTable&&) = delete;
+	~GlyphTable() = default;
+
+private:
+	std::unordered_map<uint16_t, GlyphCell> _cells;
+	std::unordered_map<uint32_t, int8_t> _kerning;
+
+	static uint32_t pair(uint16_t prev, uint16_t next)
+	{
+		return (((uint32_t) prev) << 16) | next;
+	}
+
+public:
+	void add(uint16_t codepoint, const GlyphCell& cell);
+	void addKerning(uint16_t prev, uint16_t next, int kerning);
+
+	const GlyphCell* find(uint16_t codepoint) const;
+	bool hasKerning(uint16_t prev, uint16_t next) const;
+	int kerning(uint16_t prev, uint16_t next) const;
+
+	// Returns the width of the laid out text, or -1 if a glyph is missing.
+	int layout(const std::vector<uint16_t>& codepoints,
+		std::vector<GlyphQuad>* quads) const;
+	int measure(const std::vector<uint16_t>& codepoints) const;
+
+	// SDL_ttf can only render codepoints in the Basic Multilingual Plane,
+	// so this fails on those outside it as well as on invalid UTF8.
+	static bool decode(const std::string& text,
+		std::vector<uint16_t>& codepoints);
+	static std::string encode(uint16_t codepoint);
+};
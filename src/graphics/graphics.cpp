@@ -31,6 +31,7 @@
 #include "settings.hpp"
 #include "shader.hpp"
 #include "font.hpp"
+#include "glyphatlas.hpp"
 #include "input.hpp"
 
 
@@ -49,6 +50,8 @@ Graphics::~Graphics()
 	{
 		glDeleteProgram(program);
 	}
+	// The atlases hold textures and fonts, so they must go first.
+	_glyphAtlases.clear();
 	if (_context) SDL_GL_DeleteContext(_context);
 	if (_window) SDL_DestroyWindow(_window);
 	for (auto font : _fontTextures)
@@ -125,9 +128,37 @@ TTF_Font* Graphics::getFont(const Font& font, const FontStyle& style)
 	_fonts.emplace_back(font);
 	_fontStyles.emplace_back(style);
 	_fontTextures.emplace_back(texture);
+	_glyphAtlases.emplace_back(nullptr);
 	return texture;
 }
 
+GlyphAtlas& Graphics::getGlyphAtlas(const Font& font, const FontStyle& style)
+{
+	// The glyphs are measured and drawn with the font without an outline,
+	// and the outline is drawn with the outlined font.
+	FontStyle glyphstyle = style;
+	glyphstyle.outline = 0;
+	TTF_Font* glyphfont = getFont(font, glyphstyle);
+	TTF_Font* outlinefont = getFont(font, style);
+
+	for (size_t i = 0; i < _fonts.size(); i++)
+	{
+		if (_fonts[i] == font && _fontStyles[i] == style)
+		{
+			if (!_glyphAtlases[i])
+			{
+				_glyphAtlases[i].reset(new GlyphAtlas(glyphfont,
+					(style.outline > 0) ? outlinefont : nullptr,
+					style.outline));
+			}
+			return *_glyphAtlases[i];
+		}
+	}
+
+	LOGF << "Failed to find font after loading it";
+	throw std::runtime_error("Failed to find font after loading it");
+}
+
 void Graphics::install()
 {
 	_installed = this;
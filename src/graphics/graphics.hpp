@@ -32,6 +32,7 @@ typedef struct _TTF_Font TTF_Font;
 
 class Settings;
 struct FontStyle;
+class GlyphAtlas;
 
 enum class Font : uint8_t;
 enum class Shader : uint8_t;
@@ -64,6 +65,7 @@ private:
 	std::vector<Font> _fonts;             // married
 	std::vector<FontStyle> _fontStyles;   // married
 	std::vector<TTF_Font*> _fontTextures; // married
+	std::vector<std::unique_ptr<GlyphAtlas>> _glyphAtlases; // married
 	Settings& _settings;
 
 	unsigned int _rendertimeoffset = 0;
@@ -100,6 +102,7 @@ public:
 	Font findFontFromFilename(const std::string& filename);
 	TTF_Font* getFont(const FontStyle& style);
 	TTF_Font* getFont(const Font& font, const FontStyle& style);
+	GlyphAtlas& getGlyphAtlas(const Font& font, const FontStyle& style);
 	int width();
 	int height();
 	std::vector<std::string> resolutions();
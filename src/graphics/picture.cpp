@@ -71,29 +71,14 @@ void Picture::render(GLuint shader, int x, int y)
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, _texture->_textureID);
 
-	GLuint glObscured = glGetUniformLocation(shader, "obscured");
-	glUniform1f(glObscured, 0);
-
-	GLuint glGrayed = glGetUniformLocation(shader, "grayed");
-	glUniform1f(glGrayed, _grayed);
-
-	GLuint glShine = glGetUniformLocation(shader, "shine");
-	glUniform1f(glShine, _shine);
-
-	if (_shine > 0)
-	{
-		GLuint glShinecolor = glGetUniformLocation(shader, "shinecolor");
-		glUniform3fv(glShinecolor, 1, _shinecolor);
-	}
-
-	GLuint glTheta = glGetUniformLocation(shader, "theta");
-	glUniform1f(glTheta, fmod(Loop::theta() + _thetaOffset, 360.0f));
-
-	GLuint glMasked = glGetUniformLocation(shader, "masked");
-	glUniform1i(glMasked, _isSetAsBackground);
-
-	GLuint glBorder = glGetUniformLocation(shader, "border");
-	glUniform1i(glBorder, false);
+	// The sprite shaders take these as texture coordinates instead of
+	// uniforms, because sprites are drawn in batches. The flags are 1 for
+	// masked plus 2 for border.
+	glMultiTexCoord4f(GL_TEXTURE3, 0, _shine,
+		fmod(Loop::theta() + _thetaOffset, 360.0f),
+		_isSetAsBackground ? 1.0f : 0.0f);
+	glMultiTexCoord4f(GL_TEXTURE4,
+		_shinecolor[0], _shinecolor[1], _shinecolor[2], _grayed);
 
 	if (_isSetAsBackground) drawBackgroundQuads(shader, x, y);
 	else drawStandardQuads(shader, x, y);
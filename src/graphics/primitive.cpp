@@ -127,29 +127,12 @@ void Primitive::render(GLuint shader, int x, int y)
 		_lastShader_static = shader;
 	}
 
-	GLuint glObscured = glGetUniformLocation(shader, "obscured");
-	glUniform1f(glObscured, _obscured);
-
-	GLuint glGrayed = glGetUniformLocation(shader, "grayed");
-	glUniform1f(glGrayed, 0);
-
-	GLuint glShine = glGetUniformLocation(shader, "shine");
-	glUniform1f(glShine, _shine);
-
-	if (_shine > 0)
-	{
-		GLuint glShinecolor = glGetUniformLocation(shader, "shinecolor");
-		glUniform3fv(glShinecolor, 1, _shinecolor);
-	}
-
-	GLuint glTheta = glGetUniformLocation(shader, "theta");
-	glUniform1f(glTheta, fmod(Loop::theta() + _thetaOffset, 360.0f));
-
-	GLuint glMasked = glGetUniformLocation(shader, "masked");
-	glUniform1i(glMasked, false);
-
-	GLuint glBorder = glGetUniformLocation(shader, "border");
-	glUniform1i(glBorder, false);
+	// Like pictures, primitives are drawn with the picture shader, which
+	// takes these as texture coordinates.
+	glMultiTexCoord4f(GL_TEXTURE3, _obscured, _shine,
+		fmod(Loop::theta() + _thetaOffset, 360.0f), 0);
+	glMultiTexCoord4f(GL_TEXTURE4,
+		_shinecolor[0], _shinecolor[1], _shinecolor[2], 0);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, _textureID);
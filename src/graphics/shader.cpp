@@ -61,6 +61,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -76,6 +77,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_picture.glsl"
 			#include "shader_body.glsl"
@@ -99,6 +101,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -115,6 +118,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -131,6 +135,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -147,6 +152,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -163,6 +169,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -179,6 +186,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -195,6 +203,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -211,6 +220,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -227,6 +237,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -243,6 +254,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -259,6 +271,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
@@ -275,6 +288,7 @@ const char* getShaderSource(Shader shader)
 			#include "shader_head.glsl"
 			"void main()"
 			"{"
+			#include "shader_attributes.glsl"
 			#include "shader_mask.glsl"
 			#include "shader_color_sprite.glsl"
 			#include "shader_body.glsl"
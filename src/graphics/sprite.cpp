@@ -28,10 +28,9 @@
 #include "spritepattern.hpp"
 #include "camera.hpp"
 #include "loop.hpp"
+#include "spritebatch.hpp"
 
 
-GLuint Sprite::_lastShader_static = 0;
-
 Sprite::Sprite(SpritePattern* ptn, std::shared_ptr<Palette> palette) :
 	_name(ptn->name()),
 	_pattern(ptn),
@@ -127,74 +126,34 @@ void Sprite::Palette::bind(GLuint shader)
 	glUniform1f(glPaletteScale, 256 / size);
 }
 
-void Sprite::render(GLuint shader, int x, int y, int flags)
+void Sprite::draw(SpriteBatch& batch, int x, int y, int flags)
 {
-	/*
-	Once per shader, we declare that the shader variable named 'texture'
-	corresponds to GL_TEXTURE0, variable 'palette' to GL_TEXTURE1 and
-	'mask' to GL_TEXTURE2.
-	Something similar also happens in the other ::render() functions,
-	and it is important that we do not have to reassign 'texture' or 'palette'
-	here after it was used by something else.
-	*/
-	if (shader != _lastShader_static)
-	{
-		GLuint glTexture = glGetUniformLocation(shader, "texture");
-		glUniform1i(glTexture, 0);
-
-		GLuint glPalette = glGetUniformLocation(shader, "palette");
-		glUniform1i(glPalette, 1);
-
-		GLuint glMask = glGetUniformLocation(shader, "mask");
-		glUniform1i(glMask, 2);
-
-		_lastShader_static = shader;
-	}
-
-	glActiveTexture(GL_TEXTURE1);
-	_palette->bind(shader);
-
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, _pattern->texture(_drawframe));
-
-	GLuint glObscured = glGetUniformLocation(shader, "obscured");
-	glUniform1f(glObscured, _obscured);
+	SpriteBatch::State state;
+	state.texture = _pattern->texture(_drawframe);
+	state.palette = _palette.get();
+	state.repeat = _isSetAsBackground;
+	batch.setState(state);
 
-	GLuint glGrayed = glGetUniformLocation(shader, "grayed");
-	glUniform1f(glGrayed, 0.0f);
+	SpriteBatch::Attributes attributes;
+	attributes.obscured = _obscured;
+	attributes.shine = _shine;
+	std::copy(_shinecolor, _shinecolor + 3, attributes.shinecolor);
+	attributes.theta = fmod(Loop::theta() + _thetaOffset, 360.0f);
+	attributes.masked = _blended && !(flags & SurfaceDrawFlag::UNMASKED);
+	attributes.border = _border;
+	batch.setAttributes(attributes);
 
-	GLuint glShine = glGetUniformLocation(shader, "shine");
-	glUniform1f(glShine, _shine);
-
-	if (_shine > 0)
-	{
-		GLuint glShinecolor = glGetUniformLocation(shader, "shinecolor");
-		glUniform3fv(glShinecolor, 1, _shinecolor);
-	}
-
-	GLuint glTheta = glGetUniformLocation(shader, "theta");
-	glUniform1f(glTheta, fmod(Loop::theta() + _thetaOffset, 360.0f));
-
-	GLuint glMasked = glGetUniformLocation(shader, "masked");
-	glUniform1i(glMasked, _blended && !(flags & SurfaceDrawFlag::UNMASKED));
-
-	GLuint glBorder = glGetUniformLocation(shader, "border");
-	glUniform1i(glBorder, _border);
-
-	if (_isSetAsBackground) drawBackgroundQuads(shader, x, y);
-	else if (_blended) drawBlendedQuads(shader, x, y, flags);
-	else if (_ninepatch) drawNinePatchQuads(shader, x, y);
-	else drawStandardQuads(shader, x, y);
+	if (_isSetAsBackground) drawBackgroundQuads(batch, x, y);
+	else if (_blended) drawBlendedQuads(batch, x, y, flags);
+	else if (_ninepatch) drawNinePatchQuads(batch, x, y);
+	else drawStandardQuads(batch, x, y);
 }
 
-void Sprite::drawBackgroundQuads(GLuint /**/, int x, int y)
+void Sprite::drawBackgroundQuads(SpriteBatch& batch, int x, int y)
 {
 	// The unit might be invisible.
 	if (_drawframe >= _pattern->slices()) return;
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
 	// The x and y are the on-screen coordinates where the origin should be
 	// placed. By default, the origin is the upper left corner of the pattern,
 	// but it can be moved around by setting the offset.
@@ -217,21 +176,10 @@ void Sprite::drawBackgroundQuads(GLuint /**/, int x, int y)
 	float s2 = 1.0f * (wr - l) / (r - l);
 	float t2 = 1.0f * (wb - t) / (b - t);
 
-	glBegin(GL_QUADS);
-	{
-		glTexCoord2f(s1, t1);
-		glVertex2i(wl, wt);
-		glTexCoord2f(s2, t1);
-		glVertex2i(wr, wt);
-		glTexCoord2f(s2, t2);
-		glVertex2i(wr, wb);
-		glTexCoord2f(s1, t2);
-		glVertex2i(wl, wb);
-	}
-	glEnd();
+	batch.quad(wl, wt, wr, wb, s1, t1, s2, t2);
 }
 
-void Sprite::drawBlendedQuads(GLuint shader, int x, int y, int flags)
+void Sprite::drawBlendedQuads(SpriteBatch& batch, int x, int y, int flags)
 {
 	// The unit might be invisible.
 	if (_drawframe >= _pattern->slices()) return;
@@ -259,46 +207,29 @@ void Sprite::drawBlendedQuads(GLuint shader, int x, int y, int flags)
 	if (flags & SurfaceDrawFlag::UNMASKED)
 	{
 		// Sander: purple-outlined triangles.
-		glBegin(GL_TRIANGLES);
-		{
-			// Sander: green-and-orange-filled triangle.
-			glTexCoord2f(slice.right, slice.top);
-			glVertex2i(r, t);
-			glTexCoord2f(slice.right, slice.bottom);
-			glVertex2i(r, b);
-			glTexCoord2f(slice.left, slice.bottom);
-			glVertex2i(l, b);
-
-			// Sander: red-filled triangle.
-			glTexCoord2f(slice.left, slice.top);
-			glVertex2i(r, t);
-			glTexCoord2f(slice.center, slice.middle);
-			glVertex2i(fr, m);
-			glTexCoord2f(slice.left, slice.bottom);
-			glVertex2i(r, b);
-
-			// Sander: blue-filled triangle.
-			glTexCoord2f(slice.right, slice.top);
-			glVertex2i(r, b);
-			glTexCoord2f(slice.center, slice.middle);
-			glVertex2i(c, fb);
-			glTexCoord2f(slice.left, slice.top);
-			glVertex2i(l, b);
-		}
-		glEnd();
-	}
 
-	if (   (flags & SurfaceDrawFlag::MASKED)
-		&& (flags & SurfaceDrawFlag::UNMASKED))
-	{
-		GLuint glMasked = glGetUniformLocation(shader, "masked");
-		glUniform1i(glMasked, true);
+		// Sander: green-and-orange-filled triangle.
+		batch.triangle(
+			{(float) r, (float) t, slice.right, slice.top, 0, 0},
+			{(float) r, (float) b, slice.right, slice.bottom, 0, 0},
+			{(float) l, (float) b, slice.left, slice.bottom, 0, 0});
+
+		// Sander: red-filled triangle.
+		batch.triangle(
+			{(float) r, (float) t, slice.left, slice.top, 0, 0},
+			{(float) fr, (float) m, slice.center, slice.middle, 0, 0},
+			{(float) r, (float) b, slice.left, slice.bottom, 0, 0});
+
+		// Sander: blue-filled triangle.
+		batch.triangle(
+			{(float) r, (float) b, slice.right, slice.top, 0, 0},
+			{(float) c, (float) fb, slice.center, slice.middle, 0, 0},
+			{(float) l, (float) b, slice.left, slice.top, 0, 0});
 	}
 
 	if (flags & SurfaceDrawFlag::MASKED)
 	{
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, _blendTop->texture());
+		batch.setMasked(true);
 
 		// Calculate the corresponding coordinates on the mask.
 		// TODO animated masks require non-trivial coordinates
@@ -309,62 +240,42 @@ void Sprite::drawBlendedQuads(GLuint shader, int x, int y, int flags)
 		float mc = (ml + mr) / 2;
 		float mm = (mt + mb) / 2;
 
+		SpriteBatch::State state;
+		state.texture = _pattern->texture(_drawframe);
+		state.palette = _palette.get();
+		state.mask = _blendTop->texture();
+		batch.setState(state);
+
 		// Sander: blue- and orange-outlined triangles.
-		glBegin(GL_TRIANGLES);
-		{
-			// Sander: blue-filled triangle.
-			glMultiTexCoord2f(GL_TEXTURE0, slice.left, slice.top);
-			glMultiTexCoord2f(GL_TEXTURE2, ml, mt);
-			glVertex2i(l, t);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.right, slice.top);
-			glMultiTexCoord2f(GL_TEXTURE2, mr, mt);
-			glVertex2i(r, t);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.center, slice.middle);
-			glMultiTexCoord2f(GL_TEXTURE2, mc, mm);
-			glVertex2i(c, m);
-
-			// Sander: orange-filled triangle.
-			glMultiTexCoord2f(GL_TEXTURE0, slice.center, slice.middle);
-			glMultiTexCoord2f(GL_TEXTURE2, mc, mm);
-			glVertex2i(c, ft);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.right, slice.bottom);
-			glMultiTexCoord2f(GL_TEXTURE2, mr, mb);
-			glVertex2i(r, t);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.left, slice.bottom);
-			glMultiTexCoord2f(GL_TEXTURE2, ml, mb);
-			glVertex2i(l, t);
-		}
-		glEnd();
 
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, _blendLeft->texture());
+		// Sander: blue-filled triangle.
+		batch.triangle(
+			{(float) l, (float) t, slice.left, slice.top, ml, mt},
+			{(float) r, (float) t, slice.right, slice.top, mr, mt},
+			{(float) c, (float) m, slice.center, slice.middle, mc, mm});
+
+		// Sander: orange-filled triangle.
+		batch.triangle(
+			{(float) c, (float) ft, slice.center, slice.middle, mc, mm},
+			{(float) r, (float) t, slice.right, slice.bottom, mr, mb},
+			{(float) l, (float) t, slice.left, slice.bottom, ml, mb});
+
+		state.mask = _blendLeft->texture();
+		batch.setState(state);
 
 		// Sander: red- and green-outlined triangles.
-		glBegin(GL_TRIANGLES);
-		{
-			// Sander: red-filled triangle.
-			glMultiTexCoord2f(GL_TEXTURE0, slice.left, slice.top);
-			glMultiTexCoord2f(GL_TEXTURE2, ml, mt);
-			glVertex2i(l, t);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.center, slice.middle);
-			glMultiTexCoord2f(GL_TEXTURE2, mc, mm);
-			glVertex2i(c, m);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.left, slice.bottom);
-			glMultiTexCoord2f(GL_TEXTURE2, ml, mb);
-			glVertex2i(l, b);
-
-			// Sander: green-filled triangle.
-			glMultiTexCoord2f(GL_TEXTURE0, slice.right, slice.top);
-			glMultiTexCoord2f(GL_TEXTURE2, mr, mt);
-			glVertex2i(l, t);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.right, slice.bottom);
-			glMultiTexCoord2f(GL_TEXTURE2, mr, mb);
-			glVertex2i(l, b);
-			glMultiTexCoord2f(GL_TEXTURE0, slice.center, slice.middle);
-			glMultiTexCoord2f(GL_TEXTURE2, mc, mm);
-			glVertex2i(fl, m);
-		}
-		glEnd();
+
+		// Sander: red-filled triangle.
+		batch.triangle(
+			{(float) l, (float) t, slice.left, slice.top, ml, mt},
+			{(float) c, (float) m, slice.center, slice.middle, mc, mm},
+			{(float) l, (float) b, slice.left, slice.bottom, ml, mb});
+
+		// Sander: green-filled triangle.
+		batch.triangle(
+			{(float) l, (float) t, slice.right, slice.top, mr, mt},
+			{(float) l, (float) b, slice.right, slice.bottom, mr, mb},
+			{(float) fl, (float) m, slice.center, slice.middle, mc, mm});
 	}
 
 	if (   !(flags & SurfaceDrawFlag::MASKED)
@@ -375,7 +286,7 @@ void Sprite::drawBlendedQuads(GLuint shader, int x, int y, int flags)
 	}
 }
 
-void Sprite::drawStandardQuads(GLuint /**/, int x, int y)
+void Sprite::drawStandardQuads(SpriteBatch& batch, int x, int y)
 {
 	// The unit might be invisible.
 	if (_drawframe >= _pattern->slices()) return;
@@ -392,21 +303,10 @@ void Sprite::drawStandardQuads(GLuint /**/, int x, int y)
 		- _pattern->topMarginHeight() * scale;
 	int b = t + slice.h * scale;
 
-	glBegin(GL_QUADS);
-	{
-		glTexCoord2f(slice.left, slice.top);
-		glVertex2i(l, t);
-		glTexCoord2f(slice.right, slice.top);
-		glVertex2i(r, t);
-		glTexCoord2f(slice.right, slice.bottom);
-		glVertex2i(r, b);
-		glTexCoord2f(slice.left, slice.bottom);
-		glVertex2i(l, b);
-	}
-	glEnd();
+	batch.quad(l, t, r, b, slice.left, slice.top, slice.right, slice.bottom);
 }
 
-void Sprite::drawNinePatchQuads(GLuint /**/, int x, int y)
+void Sprite::drawNinePatchQuads(SpriteBatch& batch, int x, int y)
 {
 	int scale = drawscale();
 
@@ -441,22 +341,17 @@ void Sprite::drawNinePatchQuads(GLuint /**/, int x, int y)
 		(ty += 1.0f * _pattern->bottomPatchHeight() / _pattern->height()),
 	};
 
-	glBegin(GL_QUADS);
 	for (int r = 0; r < 3; r++)
 	{
 		for (int c = 0; c < 3; c++)
 		{
-			glTexCoord2f(coords_x[c + 0], coords_y[r + 0]);
-			glVertex2i(  vertices_x[c + 0], vertices_y[r + 0]);
-			glTexCoord2f(coords_x[c + 1], coords_y[r + 0]);
-			glVertex2i(  vertices_x[c + 1], vertices_y[r + 0]);
-			glTexCoord2f(coords_x[c + 1], coords_y[r + 1]);
-			glVertex2i(  vertices_x[c + 1], vertices_y[r + 1]);
-			glTexCoord2f(coords_x[c + 0], coords_y[r + 1]);
-			glVertex2i(  vertices_x[c + 0], vertices_y[r + 1]);
+			batch.quad(
+				vertices_x[c + 0], vertices_y[r + 0],
+				vertices_x[c + 1], vertices_y[r + 1],
+				coords_x[c + 0], coords_y[r + 0],
+				coords_x[c + 1], coords_y[r + 1]);
 		}
 	}
-	glEnd();
 }
 
 void Sprite::randomizeAnimationStart()
@@ -718,6 +613,11 @@ void Sprite::update()
 	}
 }
 
+GLuint Sprite::texture() const
+{
+	return _pattern->texture(_drawframe);
+}
+
 int Sprite::drawscale() const
 {
 	return _upscale * Camera::get()->scale();
@@ -30,6 +30,7 @@
 
 struct Pixel;
 class SpritePattern;
+class SpriteBatch;
 
 
 class Sprite
@@ -87,7 +88,6 @@ private:
 	float _progress = 0;
 	float _totalduration = 0;
 	std::shared_ptr<Palette> _palette;
-	static GLuint _lastShader_static;
 	float _shinecolor[3] = {1, 1, 1};
 
 	size_t _start = 0;
@@ -113,14 +113,14 @@ private:
 	const SpritePattern* _blendTop = nullptr;
 	const SpritePattern* _blendLeft = nullptr;
 
-	void drawStandardQuads(GLuint shader, int x, int y);
-	void drawNinePatchQuads(GLuint shader, int x, int y);
-	void drawBlendedQuads(GLuint shader, int x, int y, int flags);
-	void drawBackgroundQuads(GLuint shader, int x, int y);
+	void drawStandardQuads(SpriteBatch& batch, int x, int y);
+	void drawNinePatchQuads(SpriteBatch& batch, int x, int y);
+	void drawBlendedQuads(SpriteBatch& batch, int x, int y, int flags);
+	void drawBackgroundQuads(SpriteBatch& batch, int x, int y);
 
 public:
 	const char* name() const { return _name; }
-	void render(GLuint shader, int x, int y, int flags = 0);
+	void draw(SpriteBatch& batch, int x, int y, int flags = 0);
 	void randomizeAnimationStart();
 	void setOriginAtBase();
 	void setOriginAtCenter();
@@ -151,6 +151,8 @@ public:
 	bool isBorder() const { return _border; }
 	bool isSetAsBackground() const { return _isSetAsBackground; }
 	const SpritePattern* backgroundPattern() const { return _pattern; }
+	const Palette* palette() const { return _palette.get(); }
+	GLuint texture() const;
 	const std::string& getTag() const;
 	void update();
 	int paletteSize() const;
@@ -0,0 +1,77 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "spritebatch.hpp"
+#include "source.hpp"
+
+
+void SpriteBatch::vertex(const Corner& corner)
+{
+	// Consecutive sprites with the same state are merged into one run.
+	if (_runs.empty() || _runs.back().state != _state)
+	{
+		_runs.emplace_back(Run{_state, _vertices.size(), 0});
+	}
+	_runs.back().count++;
+
+	// The flags are stored as 1 for masked plus 2 for border.
+	_vertices.emplace_back(SpriteVertex{
+		corner.x, corner.y,
+		corner.s, corner.t,
+		corner.ms, corner.mt,
+		_attributes.obscured, _attributes.shine, _attributes.theta,
+		(_attributes.masked ? 1.0f : 0.0f) + (_attributes.border ? 2.0f : 0.0f),
+		{
+			_attributes.shinecolor[0],
+			_attributes.shinecolor[1],
+			_attributes.shinecolor[2],
+		},
+		_attributes.grayed,
+	});
+}
+
+void SpriteBatch::triangle(const Corner& a, const Corner& b, const Corner& c)
+{
+	vertex(a);
+	vertex(b);
+	vertex(c);
+}
+
+void SpriteBatch::quad(float l, float t, float r, float b,
+	float s1, float t1, float s2, float t2)
+{
+	Corner lt = {l, t, s1, t1, 0, 0};
+	Corner rt = {r, t, s2, t1, 0, 0};
+	Corner rb = {r, b, s2, t2, 0, 0};
+	Corner lb = {l, b, s1, t2, 0, 0};
+	triangle(lt, rt, rb);
+	triangle(lt, rb, lb);
+}
+
+void SpriteBatch::clear()
+{
+	_vertices.clear();
+	_runs.clear();
+	_state = State();
+	_attributes = Attributes();
+}
@@ -0,0 +1,148 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "libs/GLEW/glew.h"
+
+#include "sprite.hpp"
+
+
+/*
+Vertices for many sprites at once, grouped into runs that share the same
+textures and palette. Everything that used to be a per-sprite uniform is
+stored in every vertex instead, so that one run can be drawn with a single
+draw call. The batch itself makes no OpenGL calls; the Collector streams
+the vertices to the GPU.
+*/
+
+struct SpriteVertex
+{
+	GLfloat x;
+	GLfloat y;
+
+	// Texture coordinates on GL_TEXTURE0.
+	GLfloat s;
+	GLfloat t;
+
+	// Mask coordinates on GL_TEXTURE2.
+	GLfloat ms;
+	GLfloat mt;
+
+	// Passed to the shader as texture coordinates on GL_TEXTURE3.
+	GLfloat obscured;
+	GLfloat shine;
+	GLfloat theta;
+	GLfloat flags;
+
+	// Passed to the shader as texture coordinates on GL_TEXTURE4.
+	GLfloat shinecolor[3];
+	GLfloat grayed;
+};
+
+class SpriteBatch
+{
+public:
+	SpriteBatch() = default;
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch(SpriteBatch&&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(SpriteBatch&&) = delete;
+	~SpriteBatch() = default;
+
+	struct State
+	{
+		GLuint texture = 0;
+		GLuint mask = 0;
+		Sprite::Palette* palette = nullptr;
+		bool repeat = false;
+
+		bool operator==(const State& other) const
+		{
+			return (texture == other.texture
+				&& mask == other.mask
+				&& palette == other.palette
+				&& repeat == other.repeat);
+		}
+
+		bool operator!=(const State& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	struct Attributes
+	{
+		float obscured = 0;
+		float shine = 0;
+		float theta = 0;
+		bool masked = false;
+		bool border = false;
+		float shinecolor[3] = {1, 1, 1};
+		float grayed = 0;
+	};
+
+	struct Corner
+	{
+		float x;
+		float y;
+		float s;
+		float t;
+		float ms;
+		float mt;
+	};
+
+	struct Run
+	{
+		State state;
+		size_t first;
+		size_t count;
+	};
+
+private:
+	std::vector<SpriteVertex> _vertices;
+	std::vector<Run> _runs;
+	State _state;
+	Attributes _attributes;
+
+	void vertex(const Corner& corner);
+
+public:
+	void setState(const State& state) { _state = state; }
+	void setAttributes(const Attributes& attributes)
+	{
+		_attributes = attributes;
+	}
+	void setMasked(bool masked) { _attributes.masked = masked; }
+
+	void triangle(const Corner& a, const Corner& b, const Corner& c);
+	void quad(float l, float t, float r, float b,
+		float s1, float t1, float s2, float t2);
+
+	bool empty() const { return _vertices.empty(); }
+	const std::vector<SpriteVertex>& vertices() const { return _vertices; }
+	const std::vector<Run>& runs() const { return _runs; }
+
+	void clear();
+};
@@ -31,17 +31,42 @@
 #include "textstyle.hpp"
 #include "paint.hpp"
 #include "graphics.hpp"
+#include "glyphatlas.hpp"
 
 
 GLuint Text::_lastShader_static = 0;
 
 static std::string hexify(const std::string& text);
 
-Text::Text(const std::string& text, const TextStyle& preferredstyle) :
-	_text(text)
+Text::Text(const std::string& text, const TextStyle& style) :
+	_text(text),
+	_textcolor(style.textcolor),
+	_outlinecolor(style.outlinecolor)
 {
 	if (text.empty()) return;
 
+	std::vector<uint16_t> codepoints;
+	if (GlyphTable::decode(text, codepoints))
+	{
+		GlyphAtlas& atlas = Graphics::get()->getGlyphAtlas(style.font, style);
+		if (atlas.prepare(codepoints))
+		{
+			_atlas = &atlas;
+			_width = atlas.table().layout(codepoints, &_quads);
+			for (const GlyphQuad& quad : _quads)
+			{
+				_height = std::max(_height, quad.h);
+			}
+			return;
+		}
+	}
+
+	createTexture(style);
+}
+
+void Text::createTexture(const TextStyle& preferredstyle)
+{
+	const std::string& text = _text;
 	TextStyle style = preferredstyle;
 
 	Color color = (style.outline > 0) ? style.outlinecolor : style.textcolor;
@@ -144,7 +169,7 @@ Text::Text(const std::string& text, const TextStyle& preferredstyle) :
 
 Text::~Text()
 {
-	if (_text.empty()) return;
+	if (!_textureID) return;
 
 	glDeleteTextures(1, &_textureID);
 }
@@ -172,6 +197,16 @@ void Text::render(GLuint shader, int x, int y)
 	glUniform1f(glGrayed, _alpha);
 
 	glActiveTexture(GL_TEXTURE0);
+
+	if (_atlas)
+	{
+		renderGlyphs(shader, x, y);
+		return;
+	}
+
+	GLuint glChannel = glGetUniformLocation(shader, "glyphchannel");
+	glUniform4f(glChannel, 0, 0, 0, 0);
+
 	glBindTexture(GL_TEXTURE_2D, _textureID);
 
 	glBegin(GL_QUADS);
@@ -188,6 +223,56 @@ void Text::render(GLuint shader, int x, int y)
 	glEnd();
 }
 
+void Text::renderGlyphs(GLuint shader, int x, int y)
+{
+	_atlas->bind();
+
+	GLuint glChannel = glGetUniformLocation(shader, "glyphchannel");
+	GLuint glColor = glGetUniformLocation(shader, "glyphcolor");
+
+	// All outlines go underneath all glyphs, as when TTF renders a string.
+	if (_atlas->hasOutline())
+	{
+		glUniform4f(glChannel, 0, 1, 0, 0);
+		glUniform4f(glColor, _outlinecolor.r / 255.0f,
+			_outlinecolor.g / 255.0f, _outlinecolor.b / 255.0f,
+			_outlinecolor.a / 255.0f);
+		renderQuads(x, y);
+	}
+
+	glUniform4f(glChannel, 1, 0, 0, 0);
+	glUniform4f(glColor, _textcolor.r / 255.0f,
+		_textcolor.g / 255.0f, _textcolor.b / 255.0f,
+		_textcolor.a / 255.0f);
+	renderQuads(x, y);
+}
+
+void Text::renderQuads(int x, int y)
+{
+	float ds = 1.0f / _atlas->width();
+	float dt = 1.0f / _atlas->height();
+
+	glBegin(GL_QUADS);
+	for (const GlyphQuad& quad : _quads)
+	{
+		float s0 = quad.u * ds;
+		float t0 = quad.v * dt;
+		float s1 = (quad.u + quad.w) * ds;
+		float t1 = (quad.v + quad.h) * dt;
+		int x0 = x + quad.x;
+		int y0 = y + quad.y;
+		glTexCoord2f(s0, t0);
+		glVertex2i(x0, y0);
+		glTexCoord2f(s1, t0);
+		glVertex2i(x0 + quad.w, y0);
+		glTexCoord2f(s1, t1);
+		glVertex2i(x0 + quad.w, y0 + quad.h);
+		glTexCoord2f(s0, t1);
+		glVertex2i(x0, y0 + quad.h);
+	}
+	glEnd();
+}
+
 int Text::fontH(int fontsize)
 {
 	int h = TTF_FontHeight(Graphics::get()->getFont(FontStyle(fontsize)));
@@ -206,6 +291,17 @@ int Text::fontH(const TextStyle& style)
 
 int Text::calculateWidth(const TextStyle& style, const std::string& text)
 {
+	// Use the advances of glyphs in the atlas, if they are all there.
+	std::vector<uint16_t> codepoints;
+	if (GlyphTable::decode(text, codepoints))
+	{
+		GlyphAtlas& atlas = Graphics::get()->getGlyphAtlas(style.font, style);
+		if (atlas.prepare(codepoints))
+		{
+			return atlas.table().measure(codepoints);
+		}
+	}
+
 	int w = 0;
 	int error = TTF_SizeUTF8(Graphics::get()->getFont(style.font, style),
 		text.c_str(), &w, nullptr);
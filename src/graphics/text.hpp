@@ -26,7 +26,11 @@
 
 #include "libs/GLEW/glew.h"
 
+#include "color.hpp"
+#include "glyphlayout.hpp"
+
 struct TextStyle;
+class GlyphAtlas;
 
 
 class Text
@@ -45,12 +49,24 @@ private:
 
 	int _width = 0;
 	int _height = 0;
+
+	// Texts are drawn from a shared glyph atlas where possible.
+	GlyphAtlas* _atlas = nullptr;
+	std::vector<GlyphQuad> _quads;
+	Color _textcolor;
+	Color _outlinecolor;
+
+	// Otherwise the whole text is rendered into a texture of its own.
 	float _s = 0;
 	float _t = 0;
 	GLuint _textureID = 0;
 
 	static GLuint _lastShader_static;
 
+	void createTexture(const TextStyle& style);
+	void renderGlyphs(GLuint shader, int x, int y);
+	void renderQuads(int x, int y);
+
 public:
 	void render(GLuint shader, int x, int y);
 	const std::string& text() const { return _text; }
@@ -46,21 +46,7 @@ void Transitionator::set(size_t index, float target)
 void Transitionator::transition(std::shared_ptr<AnimationGroup> group, size_t index,
 	float target, float duration, float delay)
 {
-	bool once = false;
-	float origin = 0;
-
-	addAnimation(Animation(group, [=](float progress) mutable {
-
-		if (!once)
-		{
-			origin = _transitions[index];
-			once = true;
-		}
-
-		if (_transitionlocked[index]) return;
-
-		_transitions[index] = origin + progress * (target - origin);
-	}, duration, delay));
+	addTransition(group, index, target, duration, delay);
 }
 
 void Transitionator::transition(std::shared_ptr<AnimationGroup> group, size_t index,
@@ -80,3 +66,18 @@ void Transitionator::transition(size_t index,
 {
 	transition(nullptr, index, target, duration, 0);
 }
+
+void Transitionator::applyTransition(Tween& tween)
+{
+	// The origin is only known once the transition starts.
+	if (!tween.started)
+	{
+		tween.origin = _transitions[tween.index];
+		tween.started = true;
+	}
+
+	if (_transitionlocked[tween.index]) return;
+
+	_transitions[tween.index] = tween.origin
+		+ tween.progress * (tween.target - tween.origin);
+}
@@ -75,4 +75,7 @@ public:
 		float target, float duration);
 	void transition(size_t index, float target, float duration, float delay);
 	void transition(size_t index, float target, float duration);
+
+protected:
+	virtual void applyTransition(Tween& tween) override;
 };
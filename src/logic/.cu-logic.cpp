@@ -1,20 +1,25 @@
 #include "aim.cpp"
 #include "attacker.cpp"
+#include "binarychangeset.cpp"
+#include "bitboards.cpp"
 #include "board.cpp"
 #include "cell.cpp"
 #include "challenge.cpp"
 #include "change.cpp"
 #include "changeset.cpp"
 #include "chaostransition.cpp"
+#include "climate.cpp"
 #include "cycle.cpp"
 #include "damage.cpp"
 #include "descriptor.cpp"
 #include "difficulty.cpp"
 #include "elevationtransition.cpp"
+#include "floodfillcache.cpp"
 #include "freshwatertransition.cpp"
 #include "gastransition.cpp"
 #include "library.cpp"
 #include "map.cpp"
+#include "maptemplate.cpp"
 #include "markertransition.cpp"
 #include "move.cpp"
 #include "notice.cpp"
@@ -27,6 +32,7 @@
 #include "powertransition.cpp"
 #include "radiationtransition.cpp"
 #include "recording.cpp"
+#include "recordingindex.cpp"
 #include "recordingiterator.cpp"
 #include "role.cpp"
 #include "tiletoken.cpp"
@@ -37,6 +43,7 @@
 #include "unittoken.cpp"
 #include "unittype.cpp"
 #include "vision.cpp"
+#include "visionproviders.cpp"
 #include "visiontransition.cpp"
 #include "watertransition.cpp"
 #include "weathertransition.cpp"
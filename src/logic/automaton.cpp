@@ -43,15 +43,20 @@
 #include "map.hpp"
 #include "recording.hpp"
 #include "recordingiterator.hpp"
+#include "recordingindex.hpp"
+#include "binarychangeset.hpp"
 #include "challenge.hpp"
 #include "typenamer.hpp"
 #include "system.hpp"
+#include "profiler.hpp"
+#include "randomness.hpp"
 
 
 Automaton::Automaton(size_t playercount, const std::string& rulesetname) :
 	PlayerInfo(playercount),
 	RoundInfo(),
-	_bible(Library::getBible(rulesetname)),
+	_sharedbible(Library::shareBible(rulesetname)),
+	_bible(*_sharedbible),
 	_board(_bible),
 	_sequencer(playercount)
 {
@@ -91,8 +96,26 @@ void Automaton::startRecording(Json::Value metadata,
 		recording.start();
 	}
 	_identifier = recording.name();
-	_recording = System::ofstream(recording.filename(),
-		std::ofstream::out | std::ofstream::app);
+	// The metadata determines whether changesets are recorded as JSON lines
+	// or as length-prefixed binary frames; see BinaryChangeSet.
+	_binaryRecording = (metadata["changeset-format"].isString()
+		&& metadata["changeset-format"].asString() == "binary");
+	if (!_binaryRecording && !metadata["changeset-format"].isNull()
+		&& metadata["changeset-format"] != "json")
+	{
+		LOGW << "Unknown changeset format, recording as json instead";
+		metadata.removeMember("changeset-format");
+	}
+	if (_binaryRecording)
+	{
+		_recording = System::ofstream(recording.filename(),
+			std::ofstream::out | std::ofstream::app | std::ofstream::binary);
+	}
+	else
+	{
+		_recording = System::ofstream(recording.filename(),
+			std::ofstream::out | std::ofstream::app);
+	}
 	if (!_recording)
 	{
 		LOGW << "Failed to open " << recording.filename() << " for writing";
@@ -149,7 +172,7 @@ void Automaton::load(const std::string& mapname, bool shufflePlayers)
 	{
 		// Shuffle the player list so that the player at the top of the lobby
 		// is not necessarily the player to move first, which is _player[0].
-		std::random_shuffle(_players.begin(), _players.end());
+		Randomness::shuffle(_players.begin(), _players.end());
 
 		// Assign the players to random starting positions on the board,
 		// independent of player order. The board shuffles again internally.
@@ -224,6 +247,13 @@ void Automaton::replay(Recording& recording, bool fromOrders)
 	_oldstyleUnfinished = false;
 	_reenactFromOrders = fromOrders;
 
+	// Use the index of the recording if someone has made one.
+	_replayindex.reset(new RecordingIndex());
+	if (!_replayindex->load(recording))
+	{
+		_replayindex.reset();
+	}
+
 	// Read version information.
 	Version myversion = Version::current();
 	Version automatonversion;
@@ -316,6 +346,9 @@ void Automaton::enactOnPlayerInfo(const Change& change)
 				for (auto& kv : _activeorders) kv.second.clear();
 				for (auto& kv : _activeidentifiers) kv.second.clear();
 				for (auto& kv : _neworders) kv.second.clear();
+
+				// When reenacting from orders, prepareForAction() does this.
+				if (!_reenactFromOrders) _round++;
 			}
 			_phase = change.phase;
 		}
@@ -525,6 +558,34 @@ void Automaton::reenactFromOrders(const ChangeSet& changeset)
 }
 
 ChangeSet Automaton::rejoin(const Player& perspective)
+{
+	// Simulate the board from the perspective of the player/observer.
+	Board simulation(_bible);
+
+	// Open the recording and reenact the changes that that player saw.
+	for (RecordingIterator iter{_bible, Recording{_identifier}}; iter; ++iter)
+	{
+		if (_replay && *_replay
+			&& iter.linenumber() == _replay->linenumber())
+		{
+			break;
+		}
+
+		for (const Change& change : (*iter).get(perspective))
+		{
+			simulation.enact(change);
+		}
+	}
+
+	return describe(simulation, false);
+}
+
+ChangeSet Automaton::snapshot()
+{
+	return describe(_board, true);
+}
+
+ChangeSet Automaton::describe(Board& board, bool omniscient)
 {
 	ChangeSet cset;
 
@@ -534,37 +595,50 @@ ChangeSet Automaton::rejoin(const Player& perspective)
 	cset.push(Change(Change::Type::DAYTIME, _daytime), Vision::all(_players));
 	cset.push(Change(Change::Type::PHASE,   _phase),   Vision::all(_players));
 
-	{
-		// Simulate the board from the perspective of the player/observer.
-		Board simulation(_bible);
+	// Declare the bottom right corner of the map.
+	cset.push(Change(Change::Type::CORNER, Descriptor::cell(
+			Position(board.rows() - 1, board.cols() - 1))),
+		Vision::all(_players));
 
-		// Open the recording and reenact the changes that that player saw.
-		for (RecordingIterator iter{_bible, Recording{_identifier}}; iter; ++iter)
+	if (omniscient)
+	{
+		// Reveal the contents of every cell to everyone, including the
+		// parts that are fogged for some or all of the players.
+		for (Cell index : board)
 		{
-			if (_replay && *_replay
-				&& iter.linenumber() == _replay->linenumber())
+			Descriptor desc = Descriptor::cell(index.pos());
+			cset.push(Change(Change::Type::REVEAL, desc,
+				board.tile(index), board.snow(index),
+				board.frostbite(index), board.firestorm(index),
+				board.bonedrought(index), board.death(index),
+				board.gas(index), board.radiation(index),
+				board.temperature(index), board.humidity(index),
+				board.chaos(index)),
+				Vision::all(_players));
+			for (Descriptor::Type slot : {Descriptor::Type::GROUND,
+					Descriptor::Type::AIR, Descriptor::Type::BYPASS})
 			{
-				break;
-			}
+				const UnitToken& unit = board.unit(index, slot);
+				if (!unit) continue;
 
-			for (const Change& change : (*iter).get(perspective))
-			{
-				simulation.enact(change);
+				Descriptor unitdesc(slot, index.pos());
+				cset.push(Change(Change::Type::ENTERED, unitdesc, unit),
+					Vision::all(_players));
 			}
+			// Restore who has vision of the cell, which REVEAL does not.
+			cset.push(Change(Change::Type::VISION, desc, board.vision(index)),
+				Vision::all(_players));
 		}
-
-		// Declare the bottom right corner of the map.
-		cset.push(Change(Change::Type::CORNER, Descriptor::cell(
-				Position(simulation.rows() - 1, simulation.cols() - 1))),
-			Vision::all(_players));
-
+	}
+	else
+	{
 		// Reveal the entire map to the rejoining player.
-		RejoinVisionTransition(_bible, simulation, *this, cset).execute();
-
-		// Declare that the entire map has been announced.
-		cset.push(Change(Change::Type::BORDER), Vision::all(_players));
+		RejoinVisionTransition(_bible, board, *this, cset).execute();
 	}
 
+	// Declare that the entire map has been announced.
+	cset.push(Change(Change::Type::BORDER), Vision::all(_players));
+
 	// Reveal the last chaos report.
 	if (_bible.quantitativeChaos() && _board.mass() > 0
 		&& _bible.chaosThreshold() > 0)
@@ -920,6 +994,8 @@ bool Automaton::replaying() const
 
 ChangeSet Automaton::act()
 {
+	PROFILE_ZONE("Automaton::act");
+
 	if (_replay)
 	{
 		return actAsReplay();
@@ -934,7 +1010,7 @@ ChangeSet Automaton::actAsGame()
 {
 	if (!_changesets.empty())
 	{
-		ChangeSet changeset(_changesets.front());
+		ChangeSet changeset(std::move(_changesets.front()));
 		_changesets.pop();
 		record(changeset);
 		return changeset;
@@ -988,6 +1064,113 @@ ChangeSet Automaton::actAsGame()
 	}
 }
 
+void Automaton::indexReplay(int interval)
+{
+	if (!_replay || _reenactFromOrders || interval <= 0)
+	{
+		LOGE << "Cannot index " << _identifier;
+		DEBUG_ASSERT(false);
+		return;
+	}
+
+	RecordingIndex index(interval);
+	while (*_replay)
+	{
+		actAsReplay();
+
+		// Take a snapshot whenever we are resting between rounds, so that the
+		// changeset after it is the start of the next planning phase.
+		if (_phase == Phase::RESTING && !_gameover
+			&& _round % interval == 0 && *_replay)
+		{
+			const RecordingIndex::Entry* last = index.find(_round);
+			if (last && last->round == _round) continue;
+
+			RecordingIndex::Entry entry;
+			entry.round = _round;
+			entry.linenumber = _replay->linenumber();
+			entry.offset = _replay->offset();
+			entry.snapshot = BinaryChangeSet::encode(snapshot());
+			index.add(std::move(entry));
+		}
+	}
+
+	Recording recording(_identifier);
+	index.save(recording);
+	_replayindex.reset(new RecordingIndex(std::move(index)));
+
+	seek(0);
+}
+
+bool Automaton::seek(int round)
+{
+	if (!_replay || _reenactFromOrders || round < 0)
+	{
+		LOGW << "Cannot seek in " << _identifier;
+		return false;
+	}
+
+	const RecordingIndex::Entry* entry = nullptr;
+	if (_replayindex)
+	{
+		entry = _replayindex->find(round);
+	}
+
+	if (round < (int) _round || (entry && entry->round > _round))
+	{
+		if (entry)
+		{
+			BinaryChangeSet::Reader reader(entry->snapshot.data(),
+				entry->snapshot.size());
+			ChangeSet snapshot;
+			if (!reader.collect(snapshot)
+				|| !_replay->seek(entry->offset, entry->linenumber))
+			{
+				LOGE << "Corrupt index for " << _identifier;
+				_replayindex.reset();
+				return false;
+			}
+			restore(snapshot, entry->round);
+		}
+		else
+		{
+			// Start over from the beginning of the recording.
+			_replay.reset(new RecordingIterator{_bible, Recording{_identifier}});
+			restore(ChangeSet(), 0);
+		}
+	}
+
+	while (*_replay && ((int) _round < round || _phase != Phase::RESTING))
+	{
+		actAsReplay();
+	}
+
+	return ((int) _round == round && _phase == Phase::RESTING);
+}
+
+void Automaton::restore(const ChangeSet& snapshot, uint32_t round)
+{
+	_board.clear(0, 0);
+
+	_money.clear();
+	_initiative.clear();
+	_orderlists.clear();
+	_citybound.clear();
+	_defeated.clear();
+	_score.clear();
+	_award.clear();
+
+	_gameover = false;
+	_year = 1;
+	_season = Season::SPRING;
+	_daytime = Daytime::LATE;
+	_phase = Phase::GROWTH;
+
+	reenactFromChanges(snapshot);
+
+	_round = round;
+}
+
 ChangeSet Automaton::actAsReplay()
 {
 	if (*_replay)
@@ -2942,7 +3125,7 @@ void Automaton::processCultivate(const Player& player, Order& order)
 	}
 
 	// Cultivate each target tile in random order.
-	std::random_shuffle(targets.begin(), targets.end());
+	Randomness::shuffle(targets.begin(), targets.end());
 	for (Cell target : targets)
 	{
 		// Get the old type.
@@ -3036,7 +3219,7 @@ void Automaton::checkAutoCultivate(Cell from, ChangeSet& cset)
 	}
 
 	// Cultivate each target tile in random order.
-	std::random_shuffle(targets.begin(), targets.end());
+	Randomness::shuffle(targets.begin(), targets.end());
 	for (Cell target : targets)
 	{
 		doAutoCultivate(cultivator.owner, from, target, newtype, cset);
@@ -5531,7 +5714,22 @@ void Automaton::doDefeat(const std::vector<Player>& defeats,
 
 void Automaton::record(const ChangeSet& changes)
 {
-	if (_recording.is_open())
+	if (!_recording.is_open()) return;
+
+	if (_binaryRecording)
+	{
+		// Each frame is a u32 length (little endian) followed by the changeset.
+		_recordingbuffer.assign(4, '\0');
+		BinaryChangeSet::encode(_recordingbuffer, changes);
+		uint32_t length = _recordingbuffer.size() - 4;
+		for (size_t i = 0; i < 4; i++)
+		{
+			_recordingbuffer[i] = (char) ((length >> (8 * i)) & 0xFF);
+		}
+		_recording.write(_recordingbuffer.data(), _recordingbuffer.size());
+		_recording.flush();
+	}
+	else
 	{
 		_recording << changes << std::endl;
 	}
@@ -43,6 +43,7 @@ struct Descriptor;
 class Damage;
 class Recording;
 class RecordingIterator;
+class RecordingIndex;
 class Challenge;
 
 
@@ -60,7 +61,9 @@ public:
 	Automaton& operator=(Automaton&&) = delete;
 
 private:
-	Bible _bible;
+	// Bibles are shared between all games and bots with the same ruleset.
+	const std::shared_ptr<const Bible> _sharedbible;
+	const Bible& _bible;
 	Board _board;
 	InitiativeSequencer _sequencer;
 
@@ -79,7 +82,10 @@ private:
 
 	std::string _identifier;
 	std::ofstream _recording;
+	std::string _recordingbuffer; // (only used for binary recordings)
+	bool _binaryRecording = false;
 	std::unique_ptr<RecordingIterator> _replay;
+	std::unique_ptr<RecordingIndex> _replayindex;
 	bool _oldstyleUnfinished = false;
 	bool _reenactFromOrders = false;
 
@@ -204,6 +210,9 @@ private:
 	void enactOnPlayerInfo(const Change& change);
 	void enactUnfinishedOrder(const Change& change, const Player& player);
 
+	ChangeSet describe(Board& board, bool omniscient);
+	void restore(const ChangeSet& snapshot, uint32_t round);
+
 	ChangeSet actAsGame();
 	ChangeSet actAsReplay();
 
@@ -218,6 +227,19 @@ public:
 		const char* recnameOrNull = nullptr);
 	ChangeSet rejoin(const Player& player);
 
+	// Describe the entire board and the state of each player, regardless of
+	// who can see what, such that restoring it recreates the current state.
+	ChangeSet snapshot();
+
+	// Replay the rest of the recording while saving a snapshot every so many
+	// rounds to an index file next to it, then go back to the start.
+	void indexReplay(int interval);
+
+	// Go to the start of the given round of the replay, at which point the
+	// next act() starts its planning phase. With an index this only needs to
+	// reenact at most one interval's worth of changesets.
+	bool seek(int round);
+
 	void setChallenge(std::shared_ptr<Challenge> challenge);
 
 	void resign(const Player& player);
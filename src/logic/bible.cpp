@@ -24,6 +24,8 @@
 #include "bible.hpp"
 #include "source.hpp"
 
+#include <new>
+
 #include "tiletype.hpp"
 #include "unittype.hpp"
 #include "cycle.hpp"
@@ -298,13 +300,23 @@ Bible::Bible(const std::string& name, const Version& version) :
 	_startingMoney(0),
 	_maxMoney(0),
 	_minMoney(0),
-	_newOrderLimit(0)
+	_newOrderLimit(0),
+	_tileRules(nullptr),
+	_unitRules(nullptr)
 {
 	/* TYPES */
 	_tiletype_max = 0;
 	_unittype_max = 0;
 	_tiletypes[0] = forceTypeWord("none");
 	_unittypes[0] = forceTypeWord("none");
+
+	/* RULES */
+	// Every type has blank rules until finalize() compiles the actual ones.
+	static const std::shared_ptr<const void> blank = allocateRules();
+	_compiled = blank;
+	_tileRules = static_cast<const TileRules*>(blank.get());
+	_unitRules = reinterpret_cast<const UnitRules*>(
+		_tileRules + TILETYPE_SIZE);
 }
 
 #define VARIABLE(X) _##X
@@ -1084,6 +1096,150 @@ void Bible::finalize()
 		FILLBUILDLIST(_unitShapes[i], _tileCost)
 		FILLBUILDLIST(_unitSettles[i], _tileCost)
 	}
+
+	/* COMPILING */
+	compile();
+}
+
+std::shared_ptr<void> Bible::allocateRules()
+{
+	static_assert(sizeof(TileRules) == 64, "TileRules must fit a cache line");
+	static_assert(sizeof(UnitRules) == 64, "UnitRules must fit a cache line");
+
+	size_t space = TILETYPE_SIZE * sizeof(TileRules)
+		+ UNITTYPE_SIZE * sizeof(UnitRules);
+	size_t size = space + 64 - 1;
+	std::shared_ptr<uint8_t> buffer(new uint8_t[size],
+		std::default_delete<uint8_t[]>());
+	void* start = buffer.get();
+	std::align(64, space, start, size);
+	TileRules* tiles = static_cast<TileRules*>(start);
+	UnitRules* units = reinterpret_cast<UnitRules*>(tiles + TILETYPE_SIZE);
+
+	for (size_t i = 0; i < TILETYPE_SIZE; i++)
+	{
+		new (tiles + i) TileRules();
+	}
+	for (size_t i = 0; i < UNITTYPE_SIZE; i++)
+	{
+		new (units + i) UnitRules();
+	}
+
+	// Own the entire buffer, but point to its aligned start.
+	return std::shared_ptr<void>(buffer, start);
+}
+
+void Bible::compile()
+{
+	std::shared_ptr<void> buffer = allocateRules();
+	TileRules* tiles = static_cast<TileRules*>(buffer.get());
+	UnitRules* units = reinterpret_cast<UnitRules*>(tiles + TILETYPE_SIZE);
+
+	for (size_t i = 0; i < TILETYPE_SIZE; i++)
+	{
+		TileRules& rules = tiles[i];
+		rules.scoreBase = _tileScoreBase[i];
+		rules.scoreStack = _tileScoreStack[i];
+		rules.stacksBuilt = _tileStacksBuilt[i];
+		rules.stacksMax = _tileStacksMax[i];
+		rules.powerBuilt = _tilePowerBuilt[i];
+		rules.powerMax = _tilePowerMax[i];
+		rules.growthMax = _tileGrowthMax[i];
+		rules.vision = _tileVision[i];
+		rules.hitpoints = _tileHitpoints[i];
+		rules.income = _tileIncome[i];
+		rules.leakGas = _tileLeakGas[i];
+		rules.leakRads = _tileLeakRads[i];
+		rules.emission = _tileEmission[i];
+		rules.pollutionAmount = _tilePollutionAmount[i];
+		rules.pollutionRadius = _tilePollutionRadius[i];
+		rules.slowAmount = _tileSlowAmount[i];
+		rules.slowMaximum = _tileSlowMaximum[i];
+		rules.regrowthProbabilityDivisor = _tileRegrowthProbabilityDivisor[i];
+		rules.regrowthAmount = _tileRegrowthAmount[i];
+		rules.firestormResistance = _tileFirestormResistance[i];
+		rules.moraleGainWhenBuilt = _tileMoraleGainWhenBuilt[i];
+		rules.moraleGainWhenLost = _tileMoraleGainWhenLost[i];
+		rules.moraleGainWhenDestroyed = _tileMoraleGainWhenDestroyed[i];
+		rules.moraleGainWhenCaptured = _tileMoraleGainWhenCaptured[i];
+		rules.moraleGainWhenRazed = _tileMoraleGainWhenRazed[i];
+		rules.moraleGainWhenGathered = _tileMoraleGainWhenGathered[i];
+		rules.destroyed = _tileDestroyed[i];
+		rules.degraded = _tileDegraded[i];
+		rules.desertified = _tileDesertified[i];
+		rules.consumed = _tileConsumed[i];
+		rules.regrown = _tileRegrown[i];
+		rules.accessible = _tileAccessible[i];
+		rules.walkable = _tileWalkable[i];
+		rules.buildable = _tileBuildable[i];
+		rules.destructible = _tileDestructible[i];
+		rules.grassy = _tileGrassy[i];
+		rules.natural = _tileNatural[i];
+		rules.laboring = _tileLaboring[i];
+		rules.energizing = _tileEnergizing[i];
+		rules.powered = _tilePowered[i];
+		rules.needsNiceness = _tileNeedsNiceness[i];
+		rules.needsLabor = _tileNeedsLabor[i];
+		rules.needsEnergy = _tileNeedsEnergy[i];
+		rules.needsTime = _tileNeedsTime[i];
+		rules.ownable = _tileOwnable[i];
+		rules.controllable = _tileControllable[i];
+		rules.binding = _tileBinding[i];
+		rules.autoCultivates = _tileAutoCultivates[i];
+		rules.plane = _tilePlane[i];
+		rules.flammable = _tileFlammable[i];
+		rules.water = _tileWater[i];
+		rules.mountain = _tileMountain[i];
+		rules.desert = _tileDesert[i];
+		rules.stone = _tileStone[i];
+		rules.trenches = _tileTrenches[i];
+		rules.forceOccupy = _tileForceOccupy[i];
+		rules.chaosProtection = _tileChaosProtection[i];
+		rules.regrowOnlyInSpring = _tileRegrowOnlyInSpring[i];
+		rules.gathersMorale = _tileGathersMorale[i];
+	}
+
+	for (size_t i = 0; i < UNITTYPE_SIZE; i++)
+	{
+		UnitRules& rules = units[i];
+		rules.stacksMax = _unitStacksMax[i];
+		rules.speed = _unitSpeed[i];
+		rules.vision = _unitVision[i];
+		rules.hitpoints = _unitHitpoints[i];
+		rules.attackShots = _unitAttackShots[i];
+		rules.attackDamage = _unitAttackDamage[i];
+		rules.trampleShots = _unitTrampleShots[i];
+		rules.trampleDamage = _unitTrampleDamage[i];
+		rules.abilityVolleys = _unitAbilityVolleys[i];
+		rules.abilityShots = _unitAbilityShots[i];
+		rules.abilityDamage = _unitAbilityDamage[i];
+		rules.abilityGas = _unitAbilityGas[i];
+		rules.abilityRads = _unitAbilityRads[i];
+		rules.abilityRadius = _unitAbilityRadius[i];
+		rules.rangeMin = _unitRangeMin[i];
+		rules.rangeMax = _unitRangeMax[i];
+		rules.leakGas = _unitLeakGas[i];
+		rules.leakRads = _unitLeakRads[i];
+		rules.moraleGainWhenLost = _unitMoraleGainWhenLost[i];
+		rules.moraleGainWhenKilled = _unitMoraleGainWhenKilled[i];
+		rules.air = _unitAir[i];
+		rules.infantry = _unitInfantry[i];
+		rules.mechanical = _unitMechanical[i];
+		rules.canMove = _unitCanMove[i];
+		rules.canAttack = _unitCanAttack[i];
+		rules.canGuard = _unitCanGuard[i];
+		rules.canFocus = _unitCanFocus[i];
+		rules.canLockdown = _unitCanLockdown[i];
+		rules.canShell = _unitCanShell[i];
+		rules.canBombard = _unitCanBombard[i];
+		rules.canBomb = _unitCanBomb[i];
+		rules.canCapture = _unitCanCapture[i];
+		rules.canOccupy = _unitCanOccupy[i];
+	}
+
+	_compiled = std::move(buffer);
+	_tileRules = tiles;
+	_unitRules = units;
 }
 
 static void Bible_log_sizelimit_reached(const char* NAME, size_t SIZE)
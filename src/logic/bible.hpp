@@ -370,65 +370,182 @@ private:
 	int16_t _minMoney;
 	uint8_t _newOrderLimit;
 
+	/* COMPILED */
+	// The scalar properties and flags of a single tile type.
+	struct alignas(64) TileRules
+	{
+		int16_t scoreBase;
+		int16_t scoreStack;
+
+		int8_t stacksBuilt;
+		int8_t stacksMax;
+		int8_t powerBuilt;
+		int8_t powerMax;
+		int8_t growthMax;
+		int8_t vision;
+		int8_t hitpoints;
+		int8_t income;
+		int8_t leakGas;
+		int8_t leakRads;
+		int8_t emission;
+		int8_t pollutionAmount;
+		int8_t pollutionRadius;
+		int8_t slowAmount;
+		int8_t slowMaximum;
+		int8_t regrowthProbabilityDivisor;
+		int8_t regrowthAmount;
+		int8_t firestormResistance;
+		int8_t moraleGainWhenBuilt;
+		int8_t moraleGainWhenLost;
+		int8_t moraleGainWhenDestroyed;
+		int8_t moraleGainWhenCaptured;
+		int8_t moraleGainWhenRazed;
+		int8_t moraleGainWhenGathered;
+
+		TileType destroyed;
+		TileType degraded;
+		TileType desertified;
+		TileType consumed;
+		TileType regrown;
+
+		bool accessible;
+		bool walkable;
+		bool buildable;
+		bool destructible;
+		bool grassy;
+		bool natural;
+		bool laboring;
+		bool energizing;
+		bool powered;
+		bool needsNiceness;
+		bool needsLabor;
+		bool needsEnergy;
+		bool needsTime;
+		bool ownable;
+		bool controllable;
+		bool binding;
+		bool autoCultivates;
+		bool plane;
+		bool flammable;
+		bool water;
+		bool mountain;
+		bool desert;
+		bool stone;
+		bool trenches;
+		bool forceOccupy;
+		bool chaosProtection;
+		bool regrowOnlyInSpring;
+		bool gathersMorale;
+	};
+
+	// The scalar properties and flags of a single unit type.
+	struct alignas(64) UnitRules
+	{
+		int8_t stacksMax;
+		int8_t speed;
+		int8_t vision;
+		int8_t hitpoints;
+		int8_t attackShots;
+		int8_t attackDamage;
+		int8_t trampleShots;
+		int8_t trampleDamage;
+		int8_t abilityVolleys;
+		int8_t abilityShots;
+		int8_t abilityDamage;
+		int8_t abilityGas;
+		int8_t abilityRads;
+		int8_t abilityRadius;
+		int8_t rangeMin;
+		int8_t rangeMax;
+		int8_t leakGas;
+		int8_t leakRads;
+		int8_t moraleGainWhenLost;
+		int8_t moraleGainWhenKilled;
+
+		bool air;
+		bool infantry;
+		bool mechanical;
+		bool canMove;
+		bool canAttack;
+		bool canGuard;
+		bool canFocus;
+		bool canLockdown;
+		bool canShell;
+		bool canBombard;
+		bool canBomb;
+		bool canCapture;
+		bool canOccupy;
+	};
+
+	// Compiled by finalize() into a single shared, cache-line-aligned buffer
+	// with one TileRules per TileType and one UnitRules per UnitType, so that
+	// looking up a property of a type touches only that type's cache line.
+	std::shared_ptr<const void> _compiled;
+	const TileRules* _tileRules;
+	const UnitRules* _unitRules;
+
+	static std::shared_ptr<void> allocateRules();
+	void compile();
+
 public:
 	/* NAME & VERSION */
 	const std::string& name() const { return _name; }
 	const Version& version() const { return _version; }
 
 	/* TILES */
-	bool tileAccessible(  const TileType& x) const { return _tileAccessible[(size_t) x];   }
-	bool tileWalkable(    const TileType& x) const { return _tileWalkable[(size_t) x];     }
-	bool tileBuildable(   const TileType& x) const { return _tileBuildable[(size_t) x];    }
-	bool tileDestructible(const TileType& x) const { return _tileDestructible[(size_t) x]; }
-	bool tileGrassy(      const TileType& x) const { return _tileGrassy[(size_t) x];       }
-	bool tileNatural(     const TileType& x) const { return _tileNatural[(size_t) x];      }
-	bool tileLaboring(    const TileType& x) const { return _tileLaboring[(size_t) x];     }
-	bool tileEnergizing(  const TileType& x) const { return _tileEnergizing[(size_t) x];   }
-	bool tilePowered(     const TileType& x) const { return _tilePowered[(size_t) x];      }
-	bool tileNeedsNiceness(const TileType& x) const { return _tileNeedsNiceness[(size_t) x]; }
-	bool tileNeedsLabor(const TileType& x) const { return _tileNeedsLabor[(size_t) x]; }
-	bool tileNeedsEnergy(const TileType& x) const { return _tileNeedsEnergy[(size_t) x]; }
-	bool tileNeedsTime(const TileType& x) const { return _tileNeedsTime[(size_t) x]; }
-	bool tileOwnable(     const TileType& x) const { return _tileOwnable[(size_t) x];      }
-	bool tileControllable(const TileType& x) const { return _tileControllable[(size_t) x]; }
-	bool tileBinding(const TileType& x) const { return _tileBinding[(size_t) x]; }
-	bool tileAutoCultivates(const TileType& x) const { return _tileAutoCultivates[(size_t) x]; }
-	bool tilePlane(const TileType& x) const { return _tilePlane[(size_t) x]; }
-	bool tileFlammable(const TileType& x) const { return _tileFlammable[(size_t) x]; }
-	bool tileWater(const TileType& x) const { return _tileWater[(size_t) x]; }
-	bool tileMountain(const TileType& x) const { return _tileMountain[(size_t) x]; }
-	bool tileDesert(const TileType& x) const { return _tileDesert[(size_t) x]; }
-	bool tileStone(const TileType& x) const { return _tileStone[(size_t) x]; }
-	bool tileTrenches(const TileType& x) const { return _tileTrenches[(size_t) x]; }
-	bool tileForceOccupy(const TileType& x) const { return _tileForceOccupy[(size_t) x]; }
-	bool tileChaosProtection(const TileType& x) const { return _tileChaosProtection[(size_t) x]; }
-	bool tileRegrowOnlyInSpring(const TileType& x) const { return _tileRegrowOnlyInSpring[(size_t) x]; }
-	bool tileGathersMorale(const TileType& x) const { return _tileGathersMorale[(size_t) x]; }
-
-	int8_t tileStacksBuilt(  const TileType& x) const { return _tileStacksBuilt[(size_t) x];   }
-	int8_t tileStacksMax(    const TileType& x) const { return _tileStacksMax[(size_t) x];     }
-	int8_t tilePowerBuilt(   const TileType& x) const { return _tilePowerBuilt[(size_t) x];    }
-	int8_t tilePowerMax(     const TileType& x) const { return _tilePowerMax[(size_t) x];      }
-	int8_t tileGrowthMax(    const TileType& x) const { return _tileGrowthMax[(size_t) x];     }
-	int8_t tileVision(       const TileType& x) const { return _tileVision[(size_t) x];        }
-	int8_t tileHitpoints(    const TileType& x) const { return _tileHitpoints[(size_t) x];     }
-	int8_t tileIncome(       const TileType& x) const { return _tileIncome[(size_t) x];        }
-	int8_t tileLeakGas(      const TileType& x) const { return _tileLeakGas[(size_t) x];       }
-	int8_t tileLeakRads(     const TileType& x) const { return _tileLeakRads[(size_t) x];      }
-	int8_t tileEmission(     const TileType& x) const { return _tileEmission[(size_t) x];      }
-	int8_t tilePollutionAmount(const TileType& x) const { return _tilePollutionAmount[(size_t) x]; }
-	int8_t tilePollutionRadius(const TileType& x) const { return _tilePollutionRadius[(size_t) x]; }
-	int8_t tileSlowAmount(   const TileType& x) const { return _tileSlowAmount[(size_t) x];    }
-	int8_t tileSlowMaximum(  const TileType& x) const { return _tileSlowMaximum[(size_t) x];   }
-	int8_t tileRegrowthProbabilityDivisor(const TileType& x) const { return _tileRegrowthProbabilityDivisor[(size_t) x]; }
-	int8_t tileRegrowthAmount(const TileType& x) const { return _tileRegrowthAmount[(size_t) x]; }
-	int8_t tileFirestormResistance(const TileType& x) const { return _tileFirestormResistance[(size_t) x]; }
-	int8_t tileMoraleGainWhenBuilt(const TileType& x) const { return _tileMoraleGainWhenBuilt[(size_t) x]; }
-	int8_t tileMoraleGainWhenLost(const TileType& x) const { return _tileMoraleGainWhenLost[(size_t) x]; }
-	int8_t tileMoraleGainWhenDestroyed(const TileType& x) const { return _tileMoraleGainWhenDestroyed[(size_t) x]; }
-	int8_t tileMoraleGainWhenCaptured(const TileType& x) const { return _tileMoraleGainWhenCaptured[(size_t) x]; }
-	int8_t tileMoraleGainWhenRazed(const TileType& x) const { return _tileMoraleGainWhenRazed[(size_t) x]; }
-	int8_t tileMoraleGainWhenGathered(const TileType& x) const { return _tileMoraleGainWhenGathered[(size_t) x]; }
+	bool tileAccessible(  const TileType& x) const { return _tileRules[(size_t) x].accessible;   }
+	bool tileWalkable(    const TileType& x) const { return _tileRules[(size_t) x].walkable;     }
+	bool tileBuildable(   const TileType& x) const { return _tileRules[(size_t) x].buildable;    }
+	bool tileDestructible(const TileType& x) const { return _tileRules[(size_t) x].destructible; }
+	bool tileGrassy(      const TileType& x) const { return _tileRules[(size_t) x].grassy;       }
+	bool tileNatural(     const TileType& x) const { return _tileRules[(size_t) x].natural;      }
+	bool tileLaboring(    const TileType& x) const { return _tileRules[(size_t) x].laboring;     }
+	bool tileEnergizing(  const TileType& x) const { return _tileRules[(size_t) x].energizing;   }
+	bool tilePowered(     const TileType& x) const { return _tileRules[(size_t) x].powered;      }
+	bool tileNeedsNiceness(const TileType& x) const { return _tileRules[(size_t) x].needsNiceness; }
+	bool tileNeedsLabor(const TileType& x) const { return _tileRules[(size_t) x].needsLabor; }
+	bool tileNeedsEnergy(const TileType& x) const { return _tileRules[(size_t) x].needsEnergy; }
+	bool tileNeedsTime(const TileType& x) const { return _tileRules[(size_t) x].needsTime; }
+	bool tileOwnable(     const TileType& x) const { return _tileRules[(size_t) x].ownable;      }
+	bool tileControllable(const TileType& x) const { return _tileRules[(size_t) x].controllable; }
+	bool tileBinding(const TileType& x) const { return _tileRules[(size_t) x].binding; }
+	bool tileAutoCultivates(const TileType& x) const { return _tileRules[(size_t) x].autoCultivates; }
+	bool tilePlane(const TileType& x) const { return _tileRules[(size_t) x].plane; }
+	bool tileFlammable(const TileType& x) const { return _tileRules[(size_t) x].flammable; }
+	bool tileWater(const TileType& x) const { return _tileRules[(size_t) x].water; }
+	bool tileMountain(const TileType& x) const { return _tileRules[(size_t) x].mountain; }
+	bool tileDesert(const TileType& x) const { return _tileRules[(size_t) x].desert; }
+	bool tileStone(const TileType& x) const { return _tileRules[(size_t) x].stone; }
+	bool tileTrenches(const TileType& x) const { return _tileRules[(size_t) x].trenches; }
+	bool tileForceOccupy(const TileType& x) const { return _tileRules[(size_t) x].forceOccupy; }
+	bool tileChaosProtection(const TileType& x) const { return _tileRules[(size_t) x].chaosProtection; }
+	bool tileRegrowOnlyInSpring(const TileType& x) const { return _tileRules[(size_t) x].regrowOnlyInSpring; }
+	bool tileGathersMorale(const TileType& x) const { return _tileRules[(size_t) x].gathersMorale; }
+
+	int8_t tileStacksBuilt(  const TileType& x) const { return _tileRules[(size_t) x].stacksBuilt; }
+	int8_t tileStacksMax(    const TileType& x) const { return _tileRules[(size_t) x].stacksMax;   }
+	int8_t tilePowerBuilt(   const TileType& x) const { return _tileRules[(size_t) x].powerBuilt;  }
+	int8_t tilePowerMax(     const TileType& x) const { return _tileRules[(size_t) x].powerMax;    }
+	int8_t tileGrowthMax(    const TileType& x) const { return _tileRules[(size_t) x].growthMax;   }
+	int8_t tileVision(       const TileType& x) const { return _tileRules[(size_t) x].vision;      }
+	int8_t tileHitpoints(    const TileType& x) const { return _tileRules[(size_t) x].hitpoints;   }
+	int8_t tileIncome(       const TileType& x) const { return _tileRules[(size_t) x].income;      }
+	int8_t tileLeakGas(      const TileType& x) const { return _tileRules[(size_t) x].leakGas;     }
+	int8_t tileLeakRads(     const TileType& x) const { return _tileRules[(size_t) x].leakRads;    }
+	int8_t tileEmission(     const TileType& x) const { return _tileRules[(size_t) x].emission;    }
+	int8_t tilePollutionAmount(const TileType& x) const { return _tileRules[(size_t) x].pollutionAmount; }
+	int8_t tilePollutionRadius(const TileType& x) const { return _tileRules[(size_t) x].pollutionRadius; }
+	int8_t tileSlowAmount(   const TileType& x) const { return _tileRules[(size_t) x].slowAmount;  }
+	int8_t tileSlowMaximum(  const TileType& x) const { return _tileRules[(size_t) x].slowMaximum; }
+	int8_t tileRegrowthProbabilityDivisor(const TileType& x) const { return _tileRules[(size_t) x].regrowthProbabilityDivisor; }
+	int8_t tileRegrowthAmount(const TileType& x) const { return _tileRules[(size_t) x].regrowthAmount; }
+	int8_t tileFirestormResistance(const TileType& x) const { return _tileRules[(size_t) x].firestormResistance; }
+	int8_t tileMoraleGainWhenBuilt(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenBuilt; }
+	int8_t tileMoraleGainWhenLost(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenLost; }
+	int8_t tileMoraleGainWhenDestroyed(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenDestroyed; }
+	int8_t tileMoraleGainWhenCaptured(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenCaptured; }
+	int8_t tileMoraleGainWhenRazed(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenRazed; }
+	int8_t tileMoraleGainWhenGathered(const TileType& x) const { return _tileRules[(size_t) x].moraleGainWhenGathered; }
 
 	const std::vector<UnitBuild>& tileProduces(const TileType& x) const
 	{
@@ -451,14 +568,14 @@ public:
 	int16_t tileCost(      const TileType& x) const { return _tileCost[(size_t) x];       }
 */
 
-	int16_t tileScoreBase( const TileType& x) const { return _tileScoreBase[(size_t) x];  }
-	int16_t tileScoreStack(const TileType& x) const { return _tileScoreStack[(size_t) x]; }
+	int16_t tileScoreBase( const TileType& x) const { return _tileRules[(size_t) x].scoreBase;  }
+	int16_t tileScoreStack(const TileType& x) const { return _tileRules[(size_t) x].scoreStack; }
 
-	TileType tileDestroyed(const TileType& x) const { return _tileDestroyed[(size_t) x]; }
-	TileType tileDegraded(const TileType& x) const { return _tileDegraded[(size_t) x]; }
-	TileType tileDesertified(const TileType& x) const { return _tileDesertified[(size_t) x]; }
-	TileType tileConsumed(const TileType& x) const { return _tileConsumed[(size_t) x]; }
-	TileType tileRegrown(const TileType& x) const { return _tileRegrown[(size_t) x]; }
+	TileType tileDestroyed(const TileType& x) const { return _tileRules[(size_t) x].destroyed; }
+	TileType tileDegraded(const TileType& x) const { return _tileRules[(size_t) x].degraded; }
+	TileType tileDesertified(const TileType& x) const { return _tileRules[(size_t) x].desertified; }
+	TileType tileConsumed(const TileType& x) const { return _tileRules[(size_t) x].consumed; }
+	TileType tileRegrown(const TileType& x) const { return _tileRules[(size_t) x].regrown; }
 
 	int8_t tileExpandRangeMin() const { return _tileExpandRangeMin; }
 	int8_t tileExpandRangeMax() const { return _tileExpandRangeMax; }
@@ -466,40 +583,40 @@ public:
 	int8_t tileProduceRangeMax() const { return _tileProduceRangeMax; }
 
 	/* UNITS */
-	bool unitAir(       const UnitType& x) const { return _unitAir[(size_t) x];        }
-	bool unitInfantry(  const UnitType& x) const { return _unitInfantry[(size_t) x];   }
-	bool unitMechanical(const UnitType& x) const { return _unitMechanical[(size_t) x]; }
-	bool unitCanMove(   const UnitType& x) const { return _unitCanMove[(size_t) x];    }
-	bool unitCanAttack( const UnitType& x) const { return _unitCanAttack[(size_t) x];  }
-	bool unitCanGuard(  const UnitType& x) const { return _unitCanGuard[(size_t) x];   }
-	bool unitCanFocus(  const UnitType& x) const { return _unitCanFocus[(size_t) x];   }
-	bool unitCanLockdown(const UnitType& x) const { return _unitCanLockdown[(size_t) x]; }
-	bool unitCanShell(  const UnitType& x) const { return _unitCanShell[(size_t) x];   }
-	bool unitCanBombard(const UnitType& x) const { return _unitCanBombard[(size_t) x]; }
-	bool unitCanBomb(   const UnitType& x) const { return _unitCanBomb[(size_t) x];    }
-	bool unitCanCapture(const UnitType& x) const { return _unitCanCapture[(size_t) x]; }
-	bool unitCanOccupy( const UnitType& x) const { return _unitCanOccupy[(size_t) x];  }
-
-	int8_t unitStacksMax(    const UnitType& x) const { return _unitStacksMax[(size_t) x];     }
-	int8_t unitSpeed(        const UnitType& x) const { return _unitSpeed[(size_t) x];         }
-	int8_t unitVision(       const UnitType& x) const { return _unitVision[(size_t) x];        }
-	int8_t unitHitpoints(    const UnitType& x) const { return _unitHitpoints[(size_t) x];     }
-	int8_t unitAttackShots(  const UnitType& x) const { return _unitAttackShots[(size_t) x];   }
-	int8_t unitAttackDamage( const UnitType& x) const { return _unitAttackDamage[(size_t) x];  }
-	int8_t unitTrampleShots( const UnitType& x) const { return _unitTrampleShots[(size_t) x];  }
-	int8_t unitTrampleDamage(const UnitType& x) const { return _unitTrampleDamage[(size_t) x]; }
-	int8_t unitAbilityShots( const UnitType& x) const { return _unitAbilityShots[(size_t) x];  }
-	int8_t unitAbilityVolleys(const UnitType& x) const {return _unitAbilityVolleys[(size_t) x];}
-	int8_t unitAbilityDamage(const UnitType& x) const { return _unitAbilityDamage[(size_t) x]; }
-	int8_t unitAbilityGas(   const UnitType& x) const { return _unitAbilityGas[(size_t) x];    }
-	int8_t unitAbilityRads(  const UnitType& x) const { return _unitAbilityRads[(size_t) x];   }
-	int8_t unitAbilityRadius(const UnitType& x) const { return _unitAbilityRadius[(size_t) x]; }
-	int8_t unitRangeMin(     const UnitType& x) const { return _unitRangeMin[(size_t) x];      }
-	int8_t unitRangeMax(     const UnitType& x) const { return _unitRangeMax[(size_t) x];      }
-	int8_t unitLeakGas(      const UnitType& x) const { return _unitLeakGas[(size_t) x];       }
-	int8_t unitLeakRads(     const UnitType& x) const { return _unitLeakRads[(size_t) x];      }
-	int8_t unitMoraleGainWhenLost(const UnitType& x) const { return _unitMoraleGainWhenLost[(size_t) x]; }
-	int8_t unitMoraleGainWhenKilled(const UnitType& x) const { return _unitMoraleGainWhenKilled[(size_t) x]; }
+	bool unitAir(       const UnitType& x) const { return _unitRules[(size_t) x].air;        }
+	bool unitInfantry(  const UnitType& x) const { return _unitRules[(size_t) x].infantry;   }
+	bool unitMechanical(const UnitType& x) const { return _unitRules[(size_t) x].mechanical; }
+	bool unitCanMove(   const UnitType& x) const { return _unitRules[(size_t) x].canMove;    }
+	bool unitCanAttack( const UnitType& x) const { return _unitRules[(size_t) x].canAttack;  }
+	bool unitCanGuard(  const UnitType& x) const { return _unitRules[(size_t) x].canGuard;   }
+	bool unitCanFocus(  const UnitType& x) const { return _unitRules[(size_t) x].canFocus;   }
+	bool unitCanLockdown(const UnitType& x) const { return _unitRules[(size_t) x].canLockdown; }
+	bool unitCanShell(  const UnitType& x) const { return _unitRules[(size_t) x].canShell;   }
+	bool unitCanBombard(const UnitType& x) const { return _unitRules[(size_t) x].canBombard; }
+	bool unitCanBomb(   const UnitType& x) const { return _unitRules[(size_t) x].canBomb;    }
+	bool unitCanCapture(const UnitType& x) const { return _unitRules[(size_t) x].canCapture; }
+	bool unitCanOccupy( const UnitType& x) const { return _unitRules[(size_t) x].canOccupy;  }
+
+	int8_t unitStacksMax(    const UnitType& x) const { return _unitRules[(size_t) x].stacksMax;     }
+	int8_t unitSpeed(        const UnitType& x) const { return _unitRules[(size_t) x].speed;         }
+	int8_t unitVision(       const UnitType& x) const { return _unitRules[(size_t) x].vision;        }
+	int8_t unitHitpoints(    const UnitType& x) const { return _unitRules[(size_t) x].hitpoints;     }
+	int8_t unitAttackShots(  const UnitType& x) const { return _unitRules[(size_t) x].attackShots;   }
+	int8_t unitAttackDamage( const UnitType& x) const { return _unitRules[(size_t) x].attackDamage;  }
+	int8_t unitTrampleShots( const UnitType& x) const { return _unitRules[(size_t) x].trampleShots;  }
+	int8_t unitTrampleDamage(const UnitType& x) const { return _unitRules[(size_t) x].trampleDamage; }
+	int8_t unitAbilityShots( const UnitType& x) const { return _unitRules[(size_t) x].abilityShots;  }
+	int8_t unitAbilityVolleys(const UnitType& x) const {return _unitRules[(size_t) x].abilityVolleys;}
+	int8_t unitAbilityDamage(const UnitType& x) const { return _unitRules[(size_t) x].abilityDamage; }
+	int8_t unitAbilityGas(   const UnitType& x) const { return _unitRules[(size_t) x].abilityGas;    }
+	int8_t unitAbilityRads(  const UnitType& x) const { return _unitRules[(size_t) x].abilityRads;   }
+	int8_t unitAbilityRadius(const UnitType& x) const { return _unitRules[(size_t) x].abilityRadius; }
+	int8_t unitRangeMin(     const UnitType& x) const { return _unitRules[(size_t) x].rangeMin;      }
+	int8_t unitRangeMax(     const UnitType& x) const { return _unitRules[(size_t) x].rangeMax;      }
+	int8_t unitLeakGas(      const UnitType& x) const { return _unitRules[(size_t) x].leakGas;       }
+	int8_t unitLeakRads(     const UnitType& x) const { return _unitRules[(size_t) x].leakRads;      }
+	int8_t unitMoraleGainWhenLost(const UnitType& x) const { return _unitRules[(size_t) x].moraleGainWhenLost; }
+	int8_t unitMoraleGainWhenKilled(const UnitType& x) const { return _unitRules[(size_t) x].moraleGainWhenKilled; }
 
 	const std::vector<TileBuild>& unitShapes(const UnitType& x) const
 	{
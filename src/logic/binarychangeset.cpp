@@ -0,0 +1,634 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "binarychangeset.hpp"
+#include "source.hpp"
+
+#include "change.hpp"
+#include "changeset.hpp"
+#include "vision.hpp"
+#include "move.hpp"
+
+
+/*
+A binary changeset has the following layout, with all integers little endian:
+
+	u8 VERSION, u32 count, count times { change, vision }
+
+A change starts with its type and a flags byte, followed by the parts that
+are indicated by the flags, followed by the part of the large union that is
+in use for that type of change (see packUnion() below):
+
+	u8 type, u8 flags,
+	[SUBJECT] descriptor,
+	[BYTES] u16 mask, one i8 for each bit set in the mask (A through J),
+	union,
+	[ORDER] u8 type, u8 tiletype/unittype, descriptor subject,
+		descriptor target, u16 count, count times u8 move,
+	[VISION] vision
+
+A descriptor is three bytes (u8 type, i8 row, i8 col) and a vision is a u16
+with one bit per player.
+*/
+
+namespace BinaryFlag
+{
+	enum
+	{
+		SUBJECT = 0x01,
+		BYTES = 0x02,
+		ORDER = 0x04,
+		VISION = 0x08,
+	};
+}
+
+enum class BinaryUnion : uint8_t
+{
+	NONE = 0,
+	TARGET,
+	TILE,
+	UNIT,
+	ATTACKER,
+	BOMBARDER,
+	BYTE,
+	SHORT,
+};
+
+// Which member of the large union of Change is in use. We cannot simply copy
+// the four raw bytes, because some constructors leave part of them
+// uninitialized; this must agree with operator<<(std::ostream&, Change).
+static BinaryUnion binaryUnionOf(const Change::Type& type)
+{
+	switch (type)
+	{
+		case Change::Type::NONE:
+		case Change::Type::STARTS:
+		case Change::Type::MOVES:
+		case Change::Type::EXPANDS:
+		case Change::Type::AIMS:
+		case Change::Type::ATTACKS:
+		case Change::Type::SHELLS:
+		return BinaryUnion::TARGET;
+
+		case Change::Type::REVEAL:
+		case Change::Type::TRANSFORMED:
+		case Change::Type::CONSUMED:
+		case Change::Type::SHAPED:
+		case Change::Type::SETTLED:
+		case Change::Type::EXPANDED:
+		case Change::Type::UPGRADED:
+		case Change::Type::CULTIVATED:
+		case Change::Type::DESTROYED:
+		return BinaryUnion::TILE;
+
+		case Change::Type::PRODUCED:
+		case Change::Type::ENTERED:
+		return BinaryUnion::UNIT;
+
+		case Change::Type::ATTACKED:
+		case Change::Type::SHELLED:
+		return BinaryUnion::ATTACKER;
+
+		case Change::Type::TRAMPLED:
+		case Change::Type::BOMBARDED:
+		case Change::Type::BOMBED:
+		return BinaryUnion::BOMBARDER;
+
+		case Change::Type::CHAOSREPORT:
+		case Change::Type::SEASON:
+		case Change::Type::DAYTIME:
+		case Change::Type::PHASE:
+		case Change::Type::INITIATIVE:
+		case Change::Type::AWARD:
+		return BinaryUnion::BYTE;
+
+		case Change::Type::YEAR:
+		case Change::Type::FUNDS:
+		case Change::Type::INCOME:
+		case Change::Type::EXPENDITURE:
+		case Change::Type::SCORED:
+		case Change::Type::DEFEAT:
+		case Change::Type::VICTORY:
+		case Change::Type::GAMEOVER:
+		return BinaryUnion::SHORT;
+
+		default:
+		return BinaryUnion::NONE;
+	}
+}
+
+size_t BinaryChangeSet::unionSize(const Change& change)
+{
+	switch (binaryUnionOf(change.type))
+	{
+		case BinaryUnion::NONE: return 0;
+		case BinaryUnion::TARGET: return 3;
+		case BinaryUnion::TILE: return 4;
+		case BinaryUnion::UNIT: return 3;
+		case BinaryUnion::ATTACKER: return 3;
+		case BinaryUnion::BOMBARDER: return 1;
+		case BinaryUnion::BYTE: return 1;
+		case BinaryUnion::SHORT: return 2;
+	}
+	return 0;
+}
+
+void BinaryChangeSet::packUnion(const Change& change, uint8_t bytes[4])
+{
+	bytes[0] = bytes[1] = bytes[2] = bytes[3] = 0;
+
+	switch (binaryUnionOf(change.type))
+	{
+		case BinaryUnion::NONE: break;
+		case BinaryUnion::TARGET:
+		{
+			bytes[0] = (uint8_t) change.target.type;
+			bytes[1] = (uint8_t) change.target.position.row;
+			bytes[2] = (uint8_t) change.target.position.col;
+		}
+		break;
+		case BinaryUnion::TILE:
+		{
+			bytes[0] = (uint8_t) change.tile.type;
+			bytes[1] = (uint8_t) change.tile.owner;
+			bytes[2] = (uint8_t) change.tile.stacks;
+			bytes[3] = (uint8_t) change.tile.power;
+		}
+		break;
+		case BinaryUnion::UNIT:
+		{
+			bytes[0] = (uint8_t) change.unit.type;
+			bytes[1] = (uint8_t) change.unit.owner;
+			bytes[2] = (uint8_t) change.unit.stacks;
+		}
+		break;
+		case BinaryUnion::ATTACKER:
+		{
+			bytes[0] = (uint8_t) change.attacker.unittype;
+			bytes[1] = (uint8_t) change.attacker.position.row;
+			bytes[2] = (uint8_t) change.attacker.position.col;
+		}
+		break;
+		case BinaryUnion::BOMBARDER:
+		{
+			bytes[0] = (uint8_t) change.bombarder.unittype;
+		}
+		break;
+		case BinaryUnion::BYTE:
+		{
+			// Season, daytime, phase, initiative and level share this byte.
+			bytes[0] = (uint8_t) change.level;
+		}
+		break;
+		case BinaryUnion::SHORT:
+		{
+			// Year, money and score share these two bytes.
+			uint16_t value = (uint16_t) change.score;
+			bytes[0] = (uint8_t) (value & 0xFF);
+			bytes[1] = (uint8_t) (value >> 8);
+		}
+		break;
+	}
+}
+
+bool BinaryChangeSet::unpackUnion(const uint8_t bytes[4], Change& change)
+{
+	switch (binaryUnionOf(change.type))
+	{
+		case BinaryUnion::NONE: break;
+		case BinaryUnion::TARGET:
+		{
+			if (bytes[0] >= Descriptor::TYPE_SIZE) return false;
+			change.target = Descriptor((Descriptor::Type) bytes[0],
+				Position((int8_t) bytes[1], (int8_t) bytes[2]));
+		}
+		break;
+		case BinaryUnion::TILE:
+		{
+			if (bytes[0] >= TILETYPE_SIZE || bytes[1] >= PLAYER_SIZE)
+			{
+				return false;
+			}
+			change.tile = TileToken();
+			change.tile.type = (TileType) bytes[0];
+			change.tile.owner = (Player) bytes[1];
+			change.tile.stacks = (int8_t) bytes[2];
+			change.tile.power = (int8_t) bytes[3];
+		}
+		break;
+		case BinaryUnion::UNIT:
+		{
+			if (bytes[0] >= UNITTYPE_SIZE || bytes[1] >= PLAYER_SIZE)
+			{
+				return false;
+			}
+			change.unit = UnitToken();
+			change.unit.type = (UnitType) bytes[0];
+			change.unit.owner = (Player) bytes[1];
+			change.unit.stacks = (int8_t) bytes[2];
+		}
+		break;
+		case BinaryUnion::ATTACKER:
+		{
+			if (bytes[0] >= UNITTYPE_SIZE) return false;
+			change.attacker = Attacker((UnitType) bytes[0],
+				Position((int8_t) bytes[1], (int8_t) bytes[2]));
+		}
+		break;
+		case BinaryUnion::BOMBARDER:
+		{
+			if (bytes[0] >= UNITTYPE_SIZE) return false;
+			change.bombarder = Bombarder((UnitType) bytes[0]);
+		}
+		break;
+		case BinaryUnion::BYTE:
+		{
+			change.__byteZ = 0;
+			change.level = (int8_t) bytes[0];
+		}
+		break;
+		case BinaryUnion::SHORT:
+		{
+			change.__byteZ = 0;
+			change.score = (int16_t) (bytes[0] | (bytes[1] << 8));
+		}
+		break;
+	}
+	return true;
+}
+
+static void binaryPut(std::string& buffer, uint8_t value)
+{
+	buffer.push_back((char) value);
+}
+
+static void binaryPut(std::string& buffer, int8_t value)
+{
+	buffer.push_back((char) value);
+}
+
+static void binaryPut(std::string& buffer, uint16_t value)
+{
+	buffer.push_back((char) (value & 0xFF));
+	buffer.push_back((char) (value >> 8));
+}
+
+static void binaryPut(std::string& buffer, uint32_t value)
+{
+	buffer.push_back((char) (value & 0xFF));
+	buffer.push_back((char) ((value >> 8) & 0xFF));
+	buffer.push_back((char) ((value >> 16) & 0xFF));
+	buffer.push_back((char) (value >> 24));
+}
+
+static void binaryPut(std::string& buffer, const Descriptor& desc)
+{
+	binaryPut(buffer, (uint8_t) desc.type);
+	binaryPut(buffer, desc.position.row);
+	binaryPut(buffer, desc.position.col);
+}
+
+static int8_t* binaryBytesOf(Change& change, size_t i)
+{
+	switch (i)
+	{
+		case 0: return &change.__byteA;
+		case 1: return &change.__byteB;
+		case 2: return &change.__byteC;
+		case 3: return &change.__byteD;
+		case 4: return &change.__byteE;
+		case 5: return &change.__byteF;
+		case 6: return &change.__byteG;
+		case 7: return &change.__byteH;
+		case 8: return &change.__byteI;
+		case 9: return &change.__byteJ;
+	}
+	return nullptr;
+}
+
+static const int8_t* binaryBytesOf(const Change& change, size_t i)
+{
+	return binaryBytesOf(const_cast<Change&>(change), i);
+}
+
+static constexpr size_t BINARY_BYTES_SIZE = 10;
+
+void BinaryChangeSet::encode(std::string& buffer, const Vision& vision)
+{
+	static_assert(PLAYER_SIZE <= 16, "Vision must fit in a u16.");
+
+	uint16_t mask = 0;
+	for (const Player& player : vision)
+	{
+		mask |= (1 << ((size_t) player));
+	}
+	binaryPut(buffer, mask);
+}
+
+void BinaryChangeSet::encode(std::string& buffer, const Change& change)
+{
+	uint16_t mask = 0;
+	for (size_t i = 0; i < BINARY_BYTES_SIZE; i++)
+	{
+		if (*binaryBytesOf(change, i)) mask |= (1 << i);
+	}
+
+	const Order& order = change.order;
+	bool hasOrder = (order.type != Order::Type::NONE
+		|| order.subject || order.target || !order.moves.empty());
+
+	uint8_t flags = 0;
+	if (change.subject) flags |= BinaryFlag::SUBJECT;
+	if (mask) flags |= BinaryFlag::BYTES;
+	if (hasOrder) flags |= BinaryFlag::ORDER;
+	if (!change.vision.empty()) flags |= BinaryFlag::VISION;
+
+	binaryPut(buffer, (uint8_t) change.type);
+	binaryPut(buffer, flags);
+
+	if (flags & BinaryFlag::SUBJECT)
+	{
+		binaryPut(buffer, change.subject);
+	}
+
+	if (flags & BinaryFlag::BYTES)
+	{
+		binaryPut(buffer, mask);
+		for (size_t i = 0; i < BINARY_BYTES_SIZE; i++)
+		{
+			if (mask & (1 << i)) binaryPut(buffer, *binaryBytesOf(change, i));
+		}
+	}
+
+	{
+		uint8_t bytes[4];
+		packUnion(change, bytes);
+		for (size_t i = 0; i < unionSize(change); i++)
+		{
+			binaryPut(buffer, bytes[i]);
+		}
+	}
+
+	if (flags & BinaryFlag::ORDER)
+	{
+		binaryPut(buffer, (uint8_t) order.type);
+		binaryPut(buffer, order.__byte);
+		binaryPut(buffer, order.subject);
+		binaryPut(buffer, order.target);
+		static_assert(MoveList::MAX_SIZE <= 0xFFFF, "Count must fit in a u16.");
+		binaryPut(buffer, (uint16_t) order.moves.size());
+		for (const Move& move : order.moves)
+		{
+			binaryPut(buffer, (uint8_t) move);
+		}
+	}
+
+	if (flags & BinaryFlag::VISION)
+	{
+		encode(buffer, change.vision);
+	}
+}
+
+void BinaryChangeSet::encode(std::string& buffer, const ChangeSet& changeset)
+{
+	binaryPut(buffer, VERSION);
+	binaryPut(buffer, (uint32_t) changeset.size());
+	for (const auto& datum : changeset)
+	{
+		encode(buffer, datum.first);
+		encode(buffer, datum.second);
+	}
+}
+
+std::string BinaryChangeSet::encode(const ChangeSet& changeset)
+{
+	std::string buffer;
+	encode(buffer, changeset);
+	return buffer;
+}
+
+BinaryChangeSet::Reader::Reader(const char* data, size_t size) :
+	_cursor((const uint8_t*) data),
+	_end((const uint8_t*) data + size),
+	_remaining(0),
+	_failed(false)
+{
+	uint8_t version;
+	uint32_t count;
+	if (!take(version) || !take(count))
+	{
+		LOGW << "Truncated binary changeset";
+		return;
+	}
+	else if (version != VERSION)
+	{
+		LOGW << "Unknown binary changeset version " << ((int) version);
+		_failed = true;
+		return;
+	}
+	_remaining = count;
+}
+
+bool BinaryChangeSet::Reader::take(uint8_t& value)
+{
+	if (_failed || _cursor + 1 > _end)
+	{
+		_failed = true;
+		return false;
+	}
+	value = _cursor[0];
+	_cursor += 1;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(int8_t& value)
+{
+	uint8_t raw;
+	if (!take(raw)) return false;
+	value = (int8_t) raw;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(uint16_t& value)
+{
+	if (_failed || _cursor + 2 > _end)
+	{
+		_failed = true;
+		return false;
+	}
+	value = (uint16_t) (_cursor[0] | (_cursor[1] << 8));
+	_cursor += 2;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(int16_t& value)
+{
+	uint16_t raw;
+	if (!take(raw)) return false;
+	value = (int16_t) raw;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(uint32_t& value)
+{
+	if (_failed || _cursor + 4 > _end)
+	{
+		_failed = true;
+		return false;
+	}
+	value = ((uint32_t) _cursor[0])
+		| (((uint32_t) _cursor[1]) << 8)
+		| (((uint32_t) _cursor[2]) << 16)
+		| (((uint32_t) _cursor[3]) << 24);
+	_cursor += 4;
+	return true;
+}
+
+template <typename T>
+bool BinaryChangeSet::Reader::takeEnum(T& value, size_t size)
+{
+	uint8_t raw;
+	if (!take(raw)) return false;
+	if (raw >= size)
+	{
+		_failed = true;
+		return false;
+	}
+	value = (T) raw;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(Vision& vision)
+{
+	uint16_t mask;
+	if (!take(mask)) return false;
+	vision = Vision();
+	for (size_t i = 0; i < PLAYER_SIZE; i++)
+	{
+		if (mask & (1 << i)) vision.add((Player) i);
+	}
+	return true;
+}
+
+bool BinaryChangeSet::Reader::take(Change& change)
+{
+	uint8_t flags;
+	change = Change();
+	if (!takeEnum(change.type, Change::TYPE_SIZE) || !take(flags))
+	{
+		return false;
+	}
+
+	if (flags & BinaryFlag::SUBJECT)
+	{
+		if (!takeEnum(change.subject.type, Descriptor::TYPE_SIZE)
+			|| !take(change.subject.position.row)
+			|| !take(change.subject.position.col))
+		{
+			return false;
+		}
+	}
+
+	if (flags & BinaryFlag::BYTES)
+	{
+		uint16_t mask;
+		if (!take(mask)) return false;
+		for (size_t i = 0; i < BINARY_BYTES_SIZE; i++)
+		{
+			if (!(mask & (1 << i))) continue;
+			if (!take(*binaryBytesOf(change, i))) return false;
+		}
+	}
+
+	{
+		uint8_t bytes[4] = {0, 0, 0, 0};
+		for (size_t i = 0; i < unionSize(change); i++)
+		{
+			if (!take(bytes[i])) return false;
+		}
+		if (!unpackUnion(bytes, change))
+		{
+			_failed = true;
+			return false;
+		}
+	}
+
+	if (flags & BinaryFlag::ORDER)
+	{
+		Order& order = change.order;
+		uint16_t count;
+		if (!takeEnum(order.type, Order::TYPE_SIZE)
+			|| !take(order.__byte)
+			|| !takeEnum(order.subject.type, Descriptor::TYPE_SIZE)
+			|| !take(order.subject.position.row)
+			|| !take(order.subject.position.col)
+			|| !takeEnum(order.target.type, Descriptor::TYPE_SIZE)
+			|| !take(order.target.position.row)
+			|| !take(order.target.position.col)
+			|| !take(count))
+		{
+			return false;
+		}
+		order.moves.resize(count);
+		for (Move& move : order.moves)
+		{
+			if (!takeEnum(move, MOVE_SIZE)) return false;
+		}
+	}
+
+	if (flags & BinaryFlag::VISION)
+	{
+		if (!take(change.vision)) return false;
+	}
+
+	return true;
+}
+
+bool BinaryChangeSet::Reader::next(Change& change, Vision& vision)
+{
+	if (_failed || _remaining == 0) return false;
+
+	if (!take(change) || !take(vision))
+	{
+		LOGW << "Malformed binary changeset";
+		_failed = true;
+		return false;
+	}
+
+	_remaining--;
+	return true;
+}
+
+bool BinaryChangeSet::Reader::collect(ChangeSet& changeset)
+{
+	changeset = ChangeSet();
+	changeset.reserve(_remaining);
+
+	Change change;
+	Vision vision;
+	while (next(change, vision))
+	{
+		changeset.push(change, vision);
+	}
+	return !_failed;
+}
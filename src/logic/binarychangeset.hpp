@@ -0,0 +1,96 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+struct Change;
+class Vision;
+class ChangeSet;
+
+
+// A compact binary alternative to the JSON representation of changesets,
+// used for recordings and bulk replays. Unlike the JSON representation,
+// types are stored as raw indices, so the reader must use the same ruleset
+// as the writer; recordings already store the name of their ruleset.
+namespace BinaryChangeSet
+{
+	// Bump this whenever the layout changes; readers refuse other versions.
+	constexpr uint8_t VERSION = 2;
+
+	void encode(std::string& buffer, const Change& change);
+	void encode(std::string& buffer, const Vision& vision);
+	void encode(std::string& buffer, const ChangeSet& changeset);
+
+	std::string encode(const ChangeSet& changeset);
+
+	// Only part of the large union in Change is in use for a given type of
+	// change; these convert that part to and from at most four bytes, so that
+	// we never read or write bytes that were left uninitialized.
+	size_t unionSize(const Change& change);
+	void packUnion(const Change& change, uint8_t bytes[4]);
+	bool unpackUnion(const uint8_t bytes[4], Change& change);
+
+	// Iterates over the changes in a buffer produced by encode() without
+	// copying the buffer or building an intermediate Json::Value tree.
+	// The buffer must outlive the Reader.
+	class Reader
+	{
+	public:
+		Reader(const char* data, size_t size);
+
+		Reader(const Reader&) = delete;
+		Reader(Reader&&) = delete;
+		Reader& operator=(const Reader&) = delete;
+		Reader& operator=(Reader&&) = delete;
+		~Reader() = default;
+
+	private:
+		const uint8_t* _cursor;
+		const uint8_t* _end;
+		size_t _remaining;
+		bool _failed;
+
+		bool take(uint8_t& value);
+		bool take(int8_t& value);
+		bool take(uint16_t& value);
+		bool take(int16_t& value);
+		bool take(uint32_t& value);
+
+		template <typename T>
+		bool takeEnum(T& value, size_t size);
+
+		bool take(Change& change);
+		bool take(Vision& vision);
+
+	public:
+		// False if the buffer was malformed, truncated or of another version.
+		explicit operator bool() const { return !_failed; }
+
+		size_t remaining() const { return _remaining; }
+
+		bool next(Change& change, Vision& vision);
+
+		bool collect(ChangeSet& changeset);
+	};
+}
@@ -0,0 +1,128 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "position.hpp"
+
+
+// A Bitboard holds one bit for each cell of a board, with one 32-bit word per
+// row and bit c of that word set for the cell in column c. Because boards are
+// at most MAX_ROWS by MAX_COLS, any per-cell predicate fits in one Bitboard.
+struct Bitboard
+{
+	static_assert(Position::MAX_COLS <= 32, "a row must fit in a word");
+
+	std::array<uint32_t, Position::MAX_ROWS> rows;
+
+	Bitboard() : rows() {}
+
+	bool get(int r, int c) const
+	{
+		return (rows[r] >> c) & 1;
+	}
+
+	void set(int r, int c)
+	{
+		rows[r] |= (uint32_t(1) << c);
+	}
+
+	void reset(int r, int c)
+	{
+		rows[r] &= ~(uint32_t(1) << c);
+	}
+
+	bool any() const
+	{
+		for (uint32_t word : rows)
+		{
+			if (word) return true;
+		}
+		return false;
+	}
+
+	Bitboard& operator|=(const Bitboard& other)
+	{
+		for (size_t r = 0; r < rows.size(); r++) rows[r] |= other.rows[r];
+		return *this;
+	}
+
+	Bitboard& operator&=(const Bitboard& other)
+	{
+		for (size_t r = 0; r < rows.size(); r++) rows[r] &= other.rows[r];
+		return *this;
+	}
+
+	// Removes all cells that are set in other.
+	Bitboard& operator-=(const Bitboard& other)
+	{
+		for (size_t r = 0; r < rows.size(); r++) rows[r] &= ~other.rows[r];
+		return *this;
+	}
+
+	// The cells that are orthogonally adjacent to a cell in this bitboard.
+	// This can include cells just past the last column or row of a board that
+	// is smaller than the maximum size, so the result should be masked.
+	Bitboard neighbours() const
+	{
+		Bitboard result;
+		size_t last = rows.size() - 1;
+		for (size_t r = 0; r <= last; r++)
+		{
+			result.rows[r] = (rows[r] << 1) | (rows[r] >> 1)
+				| ((r > 0) ? rows[r - 1] : 0)
+				| ((r < last) ? rows[r + 1] : 0);
+		}
+		return result;
+	}
+
+	template <typename F>
+	void forEach(F f) const
+	{
+		for (size_t r = 0; r < rows.size(); r++)
+		{
+			uint32_t word = rows[r];
+			while (word)
+			{
+				f(int(r), lowest(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	static int lowest(uint32_t word)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz(word);
+#else
+		int c = 0;
+		while (!(word & 1))
+		{
+			word >>= 1;
+			c++;
+		}
+		return c;
+#endif
+	}
+};
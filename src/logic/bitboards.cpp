@@ -0,0 +1,90 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "bitboards.hpp"
+#include "source.hpp"
+
+#include "bible.hpp"
+#include "board.hpp"
+
+
+void Bitboards::reset()
+{
+	_tiletypes.fill(Bitboard());
+	_tileowners.fill(Bitboard());
+	_groundowners.fill(Bitboard());
+	_airowners.fill(Bitboard());
+	_ground = Bitboard();
+	_air = Bitboard();
+}
+
+void Bitboards::update(const Board& board, Cell index)
+{
+	if (!index.valid()) return;
+
+	Position pos = index.pos();
+	int r = pos.row;
+	int c = pos.col;
+
+	for (Bitboard& bitboard : _tiletypes) bitboard.reset(r, c);
+	for (Bitboard& bitboard : _tileowners) bitboard.reset(r, c);
+	for (Bitboard& bitboard : _groundowners) bitboard.reset(r, c);
+	for (Bitboard& bitboard : _airowners) bitboard.reset(r, c);
+	_ground.reset(r, c);
+	_air.reset(r, c);
+
+	const TileToken& tile = board.tile(index);
+	if (tile)
+	{
+		_tiletypes[(size_t) tile.type].set(r, c);
+		_tileowners[(size_t) tile.owner].set(r, c);
+	}
+
+	const UnitToken& ground = board.ground(index);
+	if (ground)
+	{
+		_groundowners[(size_t) ground.owner].set(r, c);
+		_ground.set(r, c);
+	}
+
+	const UnitToken& air = board.air(index);
+	if (air)
+	{
+		_airowners[(size_t) air.owner].set(r, c);
+		_air.set(r, c);
+	}
+}
+
+Bitboard Bitboards::passable(const Bible& bible, bool air) const
+{
+	Bitboard result;
+	for (size_t i = 0; i < TILETYPE_SIZE; i++)
+	{
+		TileType type = (TileType) i;
+		if (bible.tileAccessible(type) && (air || bible.tileWalkable(type)))
+		{
+			result |= _tiletypes[i];
+		}
+	}
+	return result;
+}
@@ -0,0 +1,88 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "bitboard.hpp"
+#include "cell.hpp"
+#include "player.hpp"
+#include "tiletype.hpp"
+
+class Bible;
+class Board;
+
+
+// Keeps a Bitboard of the cells with each tile type, the tiles and units
+// owned by each player and the cells occupied by ground and air units, so
+// that floodfills can select and grow whole rows of cells at a time.
+class Bitboards
+{
+public:
+	Bitboards() = default;
+	Bitboards(const Bitboards&) = delete;
+	Bitboards(Bitboards&&) = delete;
+	Bitboards& operator=(const Bitboards&) = delete;
+	Bitboards& operator=(Bitboards&&) = delete;
+	~Bitboards() = default;
+
+private:
+	std::array<Bitboard, TILETYPE_SIZE> _tiletypes;
+	std::array<Bitboard, PLAYER_SIZE> _tileowners;
+	std::array<Bitboard, PLAYER_SIZE> _groundowners;
+	std::array<Bitboard, PLAYER_SIZE> _airowners;
+	Bitboard _ground;
+	Bitboard _air;
+
+public:
+	void reset();
+
+	// Brings the bits of this cell up to date with its tile and units.
+	void update(const Board& board, Cell index);
+
+	const Bitboard& tiles(const TileType& type) const
+	{
+		return _tiletypes[(size_t) type];
+	}
+
+	const Bitboard& tilesOwnedBy(const Player& player) const
+	{
+		return _tileowners[(size_t) player];
+	}
+
+	const Bitboard& groundOwnedBy(const Player& player) const
+	{
+		return _groundowners[(size_t) player];
+	}
+
+	const Bitboard& airOwnedBy(const Player& player) const
+	{
+		return _airowners[(size_t) player];
+	}
+
+	const Bitboard& ground() const { return _ground; }
+	const Bitboard& air() const { return _air; }
+
+	// The cells whose tiles are accessible and, unless air is true, walkable.
+	Bitboard passable(const Bible& bible, bool air) const;
+};
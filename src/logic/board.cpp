@@ -26,9 +26,9 @@
 
 #include "change.hpp"
 #include "player.hpp"
-#include "map.hpp"
+#include "maptemplate.hpp"
 #include "typenamer.hpp"
-#include "system.hpp"
+#include "randomness.hpp"
 
 
 Board::Board(const TypeNamer& typenamer) :
@@ -55,6 +55,9 @@ void Board::resize(int cols, int rows)
 	}
 
 	_spaces.clear();
+	_climate.reset();
+	_visionproviders.reset();
+	_bitboards.reset();
 
 	_cols = cols;
 	_rows = rows;
@@ -73,135 +76,76 @@ void Board::resize(int cols, int rows)
 
 void Board::load(const std::string& mapname)
 {
-	Json::Reader reader;
-	Json::Value metadata;
-	std::string line;
+	std::shared_ptr<const MapTemplate> maptemplate =
+		MapTemplate::get(_typenamer, mapname);
 
-	std::string fname = Map::readOnlyFilename(mapname);
-	if (!System::isFile(fname))
-	{
-		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
-			<< "file does not exist";
-		throw std::runtime_error("failed to load map " + mapname + ": \t"
-				+ "file does not exist");
-	}
-
-	std::ifstream file = System::ifstream(fname);
-	if (!file)
-	{
-		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
-			<< "failed to open file";
-		throw std::runtime_error("failed to load map " + mapname + ": \t"
-				+ "failed to open file");
-	}
-	else if (!std::getline(file, line) || line.empty())
-	{
-		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
-			<< "failed to read line";
-		throw std::runtime_error("failed to load map " + mapname + ": \t"
-				+ "failed to read line");
-	}
-	else if (!reader.parse(line, metadata) || !metadata.isObject())
-	{
-		// Try old style.
-		file.close();
-		file.open(fname);
-		if (!reader.parse(file, metadata) || !metadata.isObject())
-		{
-			LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
-				<< reader.getFormattedErrorMessages();
-			throw std::runtime_error("failed to load map " + mapname + ": \t"
-					+ reader.getFormattedErrorMessages());
-		}
-	}
-
-	int cols = metadata["cols"].asInt();
-	int rows = metadata["rows"].asInt();
+	int cols = maptemplate->cols();
+	int rows = maptemplate->rows();
 	if (cols != _cols || _rows != rows)
 	{
 		resize(cols, rows);
 	}
 
-	// Old style: cells are included in the json.
-	if (metadata["cells"].isArray())
+	auto square = maptemplate->squares().begin();
+	for (Cell index : cells())
 	{
-		Json::ValueConstIterator iter = metadata["cells"].begin();
-		for (Cell index : cells())
-		{
-			const Json::Value& celljson = *iter;
-			loadCellFromJson(index, celljson);
-			iter++;
-		}
-	}
-	// New style: each line is its own celljson.
-	else
-	{
-		for (Cell index : cells())
-		{
-			Json::Value celljson;
-			if (!std::getline(file, line) || !reader.parse(line, celljson))
-			{
-				throw std::runtime_error("error while parsing cells");
-			}
-			loadCellFromJson(index, celljson);
-		}
+		loadCellFromTemplate(index, *square);
+		++square;
 	}
 }
 
-void Board::loadCellFromJson(Cell index, const Json::Value& celljson)
+void Board::loadCellFromTemplate(Cell index,
+	const MapTemplate::Square& square)
 {
-	DEBUG_ASSERT(index.valid());
-	{
-		tile(index) = TileToken(_typenamer, celljson["tile"]);
-	}
-	{
-		ground(index) = UnitToken(_typenamer, celljson["ground"]);
-	}
-	{
-		air(index) = UnitToken(_typenamer, celljson["air"]);
-	}
+	tile(index) = square.tile;
+	ground(index) = square.ground;
+	air(index) = square.air;
 
-	if (celljson["temperature"].isInt())
-	{
-		temperature(index) = celljson["temperature"].asInt();
-	}
-	if (celljson["humidity"].isInt())
-	{
-		humidity(index) = celljson["humidity"].asInt();
-	}
-	if (celljson["chaos"].isInt())
-	{
-		chaos(index) = celljson["chaos"].asInt();
-	}
-	if (celljson["gas"].isInt())
-	{
-		gas(index) = celljson["gas"].asInt();
-	}
-	if (celljson["radiation"].isInt())
+	if (square.layers)
 	{
-		radiation(index) = celljson["radiation"].asInt();
+		if (square.layers & MapTemplate::TEMPERATURE)
+		{
+			temperature(index) = square.temperature;
+		}
+		if (square.layers & MapTemplate::HUMIDITY)
+		{
+			humidity(index) = square.humidity;
+		}
+		if (square.layers & MapTemplate::CHAOS)
+		{
+			chaos(index) = square.chaos;
+		}
+		if (square.layers & MapTemplate::GAS)
+		{
+			gas(index) = square.gas;
+		}
+		if (square.layers & MapTemplate::RADIATION)
+		{
+			radiation(index) = square.radiation;
+		}
+		if (square.layers & MapTemplate::SNOW)
+		{
+			snow(index) = square.snow;
+		}
+		if (square.layers & MapTemplate::FROSTBITE)
+		{
+			frostbite(index) = square.frostbite;
+		}
+		if (square.layers & MapTemplate::FIRESTORM)
+		{
+			firestorm(index) = square.firestorm;
+		}
+		if (square.layers & MapTemplate::BONEDROUGHT)
+		{
+			bonedrought(index) = square.bonedrought;
+		}
+		if (square.layers & MapTemplate::DEATH)
+		{
+			death(index) = square.death;
+		}
 	}
 
-	if (celljson["snow"].isBool())
-	{
-		snow(index) = celljson["snow"].asBool();
-	}
-	if (celljson["frostbite"].isBool())
-	{
-		frostbite(index) = celljson["frostbite"].asBool();
-	}
-	if (celljson["firestorm"].isBool())
-	{
-		firestorm(index) = celljson["firestorm"].asBool();
-	}
-	if (celljson["bonedrought"].isBool())
-	{
-		bonedrought(index) = celljson["bonedrought"].asBool();
-	}
-	if (celljson["death"].isBool())
-	{
-		death(index) = celljson["death"].asBool();
-	}
+	_bitboards.update(*this, index);
 }
 
 // Note the pass by value, since we will locally shuffle the players in this function.
@@ -232,7 +176,7 @@ void Board::assignPlayers(std::vector<Player> players)
 		players.push_back(Player::NONE);
 	}
 
-	std::random_shuffle(players.begin(), players.end());
+	Randomness::shuffle(players.begin(), players.end());
 
 	{
 		size_t i = 0;
@@ -273,6 +217,8 @@ void Board::assignPlayers(std::vector<Player> players)
 				air(index) = UnitToken();
 			}
 		}
+
+		_bitboards.update(*this, index);
 	}
 }
 
@@ -696,4 +642,11 @@ void Board::enact(const Change& change)
 		case Change::Type::NONE:
 		break;
 	}
+
+	// Only the subject cell and, for moves, the target cell can have changed.
+	_bitboards.update(*this, cell(change.subject.position));
+	if (change.type == Change::Type::MOVES)
+	{
+		_bitboards.update(*this, cell(change.target.position));
+	}
 }
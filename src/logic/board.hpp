@@ -28,6 +28,10 @@
 #include "cell.hpp"
 #include "area.hpp"
 #include "space.hpp"
+#include "climate.hpp"
+#include "visionproviders.hpp"
+#include "bitboards.hpp"
+#include "maptemplate.hpp"
 
 struct Change;
 class TypeNamer;
@@ -51,9 +55,19 @@ private:
 
 	std::vector<Space> _spaces;
 
+	// The climate is kept apart from the Spaces, one plane per layer.
+	Climate _climate;
+
 	std::vector<Player> _players;
 
+	VisionProviders _visionproviders;
+
+	// Kept in sync by load() and enact(); code that assigns to tiles and
+	// units directly, such as the Automaton, cannot rely on them.
+	Bitboards _bitboards;
+
 	void resize(int cols, int rows);
+	void loadCellFromTemplate(Cell index, const MapTemplate::Square& square);
 
 	int checkedindex(int r, int c) const
 	{
@@ -76,6 +90,10 @@ public:
 	int rows() const { return _rows; }
 	int cols() const { return _cols; }
 
+	VisionProviders& visionProviders() { return _visionproviders; }
+
+	const Bitboards& bitboards() const { return _bitboards; }
+
 	Space& at(Cell index)
 	{
 		return _spaces[index.ix()];
@@ -88,7 +106,6 @@ public:
 
 	void clear(int cols, int rows);
 	void load(const std::string& mapname);
-	void loadCellFromJson(Cell index, const Json::Value& celljson);
 
 	int mass() const { return (rows() * cols()) / 125; }
 
@@ -105,29 +122,31 @@ public:
 	const Vision& vision(Cell i) const { return at(i).vision(); }
 	Vision& vision(Cell i) { return at(i).vision(); }
 
-	int8_t temperature(Cell i) const { return at(i).temperature(); }
-	int8_t humidity(Cell i)    const { return at(i).humidity();    }
-	int8_t chaos(Cell i)       const { return at(i).chaos();       }
-	int8_t gas(Cell i)         const { return at(i).gas();         }
-	int8_t radiation(Cell i)   const { return at(i).radiation();   }
-
-	int8_t& temperature(Cell i) { return at(i).temperature(); }
-	int8_t& humidity(Cell i)    { return at(i).humidity();    }
-	int8_t& chaos(Cell i)       { return at(i).chaos();       }
-	int8_t& gas(Cell i)         { return at(i).gas();         }
-	int8_t& radiation(Cell i)   { return at(i).radiation();   }
-
-	bool snow(Cell i)        const { return at(i).snow();        }
-	bool frostbite(Cell i)   const { return at(i).frostbite();   }
-	bool firestorm(Cell i)   const { return at(i).firestorm();   }
-	bool bonedrought(Cell i) const { return at(i).bonedrought(); }
-	bool death(Cell i)       const { return at(i).death();       }
-
-	bool& snow(Cell i)        { return at(i).snow();        }
-	bool& frostbite(Cell i)   { return at(i).frostbite();   }
-	bool& firestorm(Cell i)   { return at(i).firestorm();   }
-	bool& bonedrought(Cell i) { return at(i).bonedrought(); }
-	bool& death(Cell i)       { return at(i).death();       }
+	const Climate& climate() const { return _climate; }
+
+	int8_t temperature(Cell i) const { return _climate.temperature[i.ix()]; }
+	int8_t humidity(Cell i)    const { return _climate.humidity[i.ix()];    }
+	int8_t chaos(Cell i)       const { return _climate.chaos[i.ix()];       }
+	int8_t gas(Cell i)         const { return _climate.gas[i.ix()];         }
+	int8_t radiation(Cell i)   const { return _climate.radiation[i.ix()];   }
+
+	int8_t& temperature(Cell i) { return _climate.temperature[i.ix()]; }
+	int8_t& humidity(Cell i)    { return _climate.humidity[i.ix()];    }
+	int8_t& chaos(Cell i)       { return _climate.chaos[i.ix()];       }
+	int8_t& gas(Cell i)         { return _climate.gas[i.ix()];         }
+	int8_t& radiation(Cell i)   { return _climate.radiation[i.ix()];   }
+
+	bool snow(Cell i)        const { return _climate.snow[i.ix()];        }
+	bool frostbite(Cell i)   const { return _climate.frostbite[i.ix()];   }
+	bool firestorm(Cell i)   const { return _climate.firestorm[i.ix()];   }
+	bool bonedrought(Cell i) const { return _climate.bonedrought[i.ix()]; }
+	bool death(Cell i)       const { return _climate.death[i.ix()];       }
+
+	bool& snow(Cell i)        { return _climate.snow[i.ix()];        }
+	bool& frostbite(Cell i)   { return _climate.frostbite[i.ix()];   }
+	bool& firestorm(Cell i)   { return _climate.firestorm[i.ix()];   }
+	bool& bonedrought(Cell i) { return _climate.bonedrought[i.ix()]; }
+	bool& death(Cell i)       { return _climate.death[i.ix()];       }
 
 	const TileTokenWithId& tile(Cell i)   const { return at(i).tile();   }
 	const UnitTokenWithId& ground(Cell i) const { return at(i).ground(); }
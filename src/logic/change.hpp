@@ -125,6 +125,8 @@ public:
 		AWARD,       // <player> was awarded <level> stars for this challenge
 	};
 
+	static constexpr size_t TYPE_SIZE = ((size_t) Type::AWARD) + 1;
+
 	Type type;
 	Descriptor subject;
 	union { int8_t __byteA;    Player player;        bool snow;              };
@@ -49,6 +49,7 @@ public:
 	std::vector<Change> get(const Player& player) const
 	{
 		std::vector<Change> results;
+		results.reserve(_data.size());
 		for (const auto& kv : _data)
 		{
 			if (kv.second.contains(player))
@@ -59,12 +60,102 @@ public:
 		return results;
 	}
 
+	// Gives range-based-for-loop-access to the changes that a player can
+	// see, without copying them. The ChangeSet must outlive the View.
+	class View
+	{
+	public:
+		class Iterator
+		{
+		private:
+			const std::pair<Change, Vision>* _at;
+			const std::pair<Change, Vision>* _end;
+			Player _player;
+
+			void settle()
+			{
+				while (_at != _end && !_at->second.contains(_player))
+				{
+					++_at;
+				}
+			}
+
+		public:
+			Iterator(const std::pair<Change, Vision>* at,
+					const std::pair<Change, Vision>* end,
+					const Player& player) :
+				_at(at),
+				_end(end),
+				_player(player)
+			{
+				settle();
+			}
+
+			const Change& operator*() const
+			{
+				return _at->first;
+			}
+
+			Iterator& operator++()
+			{
+				++_at;
+				settle();
+				return *this;
+			}
+
+			bool operator!=(const Iterator& other) const
+			{
+				return _at != other._at;
+			}
+		};
+
+		View(const ChangeSet& changeset, const Player& player) :
+			_begin(changeset._data.data()),
+			_end(changeset._data.data() + changeset._data.size()),
+			_player(player)
+		{}
+
+	private:
+		const std::pair<Change, Vision>* _begin;
+		const std::pair<Change, Vision>* _end;
+		Player _player;
+
+	public:
+		Iterator begin() const { return Iterator(_begin, _end, _player); }
+		Iterator end() const { return Iterator(_end, _end, _player); }
+	};
+
+	View view(const Player& player) const
+	{
+		return View(*this, player);
+	}
+
 	friend std::ostream& operator<<(std::ostream& os,
 		const ChangeSet& changeset);
 
 	static bool equal(const TypeNamer& namer,
 		const ChangeSet& a, const ChangeSet& b);
 
+	void reserve(size_t size)
+	{
+		_data.reserve(size);
+	}
+
+	size_t size() const
+	{
+		return _data.size();
+	}
+
+	std::vector<std::pair<Change, Vision>>::const_iterator begin() const
+	{
+		return _data.begin();
+	}
+
+	std::vector<std::pair<Change, Vision>>::const_iterator end() const
+	{
+		return _data.end();
+	}
+
 	bool any() const
 	{
 		return (!_data.empty());
@@ -27,6 +27,7 @@
 #include "bible.hpp"
 #include "board.hpp"
 #include "changeset.hpp"
+#include "profiler.hpp"
 
 
 ChaosTransition::ChaosTransition(const Bible& bible, Board& board,
@@ -53,6 +54,8 @@ void ChaosTransition::fillRandomPositions()
 
 void ChaosTransition::execute()
 {
+	PROFILE_ZONE("ChaosTransition::execute");
+
 	int oldtotal = 0;
 	for (Cell index : _board)
 	{
@@ -0,0 +1,214 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "climate.hpp"
+#include "source.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define CLIMATE_SSE2_ENABLED true
+#include <emmintrin.h>
+#endif
+
+
+void Climate::reset()
+{
+	temperature.fill(0);
+	humidity.fill(0);
+	chaos.fill(0);
+	gas.fill(0);
+	radiation.fill(0);
+
+	snow.fill(false);
+	frostbite.fill(false);
+	firestorm.fill(false);
+	bonedrought.fill(false);
+	death.fill(false);
+}
+
+// Rows are copied into a padded grid with a border of zeroes, so that the
+// neighbours of every cell can be read without checking for edges, and with
+// enough room on the right to read 16 columns at a time.
+static constexpr int CLIMATE_STRIDE = 1 + Position::MAX_COLS + 16;
+static constexpr int CLIMATE_PADDED_SIZE =
+	(Position::MAX_ROWS + 2) * CLIMATE_STRIDE;
+
+void Climate::spreadGas(const int8_t* gas, int rows, int cols,
+	uint8_t* results)
+{
+	// The levels that each cell keeps, and the levels that it spreads.
+	uint8_t own[CLIMATE_PADDED_SIZE] = {};
+	uint8_t spread[CLIMATE_PADDED_SIZE] = {};
+	for (int r = 0; r < rows; r++)
+	{
+		for (int c = 0; c < cols; c++)
+		{
+			int8_t level = gas[r * cols + c];
+			DEBUG_ASSERT(level >= 0);
+			int p = (r + 1) * CLIMATE_STRIDE + (c + 1);
+			own[p] = level;
+			spread[p] = (level >= 2) ? level : 0;
+		}
+	}
+
+	const int neighbours[8] = {
+		+1,
+		+1 + CLIMATE_STRIDE,
+		+CLIMATE_STRIDE,
+		-1 + CLIMATE_STRIDE,
+		-1,
+		-1 - CLIMATE_STRIDE,
+		-CLIMATE_STRIDE,
+		+1 - CLIMATE_STRIDE,
+	};
+
+	for (int r = 0; r < rows; r++)
+	{
+		int start = (r + 1) * CLIMATE_STRIDE + 1;
+		uint8_t row[Position::MAX_COLS + 16];
+
+#if CLIMATE_SSE2_ENABLED
+		for (int c = 0; c < cols; c += 16)
+		{
+			int p = start + c;
+			__m128i best = _mm_loadu_si128((const __m128i*) (own + p));
+			for (int offset : neighbours)
+			{
+				__m128i x = _mm_loadu_si128(
+					(const __m128i*) (spread + p + offset));
+				best = _mm_max_epu8(best, x);
+			}
+			_mm_storeu_si128((__m128i*) (row + c), best);
+		}
+#else
+		for (int c = 0; c < cols; c++)
+		{
+			int p = start + c;
+			uint8_t best = own[p];
+			for (int offset : neighbours)
+			{
+				best = std::max(best, spread[p + offset]);
+			}
+			row[c] = best;
+		}
+#endif
+
+		memcpy(results + r * cols, row, cols);
+	}
+}
+
+void Climate::warm(const int8_t* temperature, const int8_t* chaos,
+	size_t count, int base, int8_t factor, int8_t min, int8_t max,
+	int8_t* out)
+{
+	// Because temperature + chaos * factor lies well within 16 bits,
+	// a base beyond these bounds would be clamped to min or max either way.
+	base = std::max(-20000, std::min(base, 20000));
+
+	size_t i = 0;
+
+#if CLIMATE_SSE2_ENABLED
+	const __m128i vbase = _mm_set1_epi16(base);
+	const __m128i vfactor = _mm_set1_epi16(factor);
+	const __m128i vmin = _mm_set1_epi16(min);
+	const __m128i vmax = _mm_set1_epi16(max);
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i t = _mm_loadu_si128((const __m128i*) (temperature + i));
+		__m128i c = _mm_loadu_si128((const __m128i*) (chaos + i));
+		__m128i halves[2];
+		for (int h = 0; h < 2; h++)
+		{
+			// Sign-extend eight bytes to eight words.
+			__m128i tt = (h == 0)
+				? _mm_unpacklo_epi8(t, t)
+				: _mm_unpackhi_epi8(t, t);
+			__m128i cc = (h == 0)
+				? _mm_unpacklo_epi8(c, c)
+				: _mm_unpackhi_epi8(c, c);
+			tt = _mm_srai_epi16(tt, 8);
+			cc = _mm_srai_epi16(cc, 8);
+			__m128i x = _mm_add_epi16(tt, _mm_mullo_epi16(cc, vfactor));
+			x = _mm_adds_epi16(x, vbase);
+			x = _mm_max_epi16(x, vmin);
+			x = _mm_min_epi16(x, vmax);
+			halves[h] = x;
+		}
+		_mm_storeu_si128((__m128i*) (out + i),
+			_mm_packs_epi16(halves[0], halves[1]));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		int x = temperature[i] + base + chaos[i] * factor;
+		out[i] = std::max((int) min, std::min(x, (int) max));
+	}
+}
+
+void Climate::moisten(const int8_t* humidity,
+	const uint8_t* gain, const uint8_t* loss,
+	size_t count, int8_t min, int8_t max,
+	int8_t* out)
+{
+	size_t i = 0;
+
+#if CLIMATE_SSE2_ENABLED
+	const __m128i vmin = _mm_set1_epi16(min);
+	const __m128i vmax = _mm_set1_epi16(max);
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i h = _mm_loadu_si128((const __m128i*) (humidity + i));
+		__m128i d = _mm_sub_epi8(
+			_mm_loadu_si128((const __m128i*) (gain + i)),
+			_mm_loadu_si128((const __m128i*) (loss + i)));
+		__m128i halves[2];
+		for (int k = 0; k < 2; k++)
+		{
+			// Sign-extend eight bytes to eight words.
+			__m128i hh = (k == 0)
+				? _mm_unpacklo_epi8(h, h)
+				: _mm_unpackhi_epi8(h, h);
+			__m128i dd = (k == 0)
+				? _mm_unpacklo_epi8(d, d)
+				: _mm_unpackhi_epi8(d, d);
+			hh = _mm_srai_epi16(hh, 8);
+			dd = _mm_srai_epi16(dd, 8);
+			__m128i x = _mm_add_epi16(hh, dd);
+			x = _mm_max_epi16(x, vmin);
+			x = _mm_min_epi16(x, vmax);
+			halves[k] = x;
+		}
+		_mm_storeu_si128((__m128i*) (out + i),
+			_mm_packs_epi16(halves[0], halves[1]));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		int8_t diff = gain[i] - loss[i];
+		int x = humidity[i] + diff;
+		out[i] = std::max((int) min, std::min(x, (int) max));
+	}
+}
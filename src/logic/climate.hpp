@@ -0,0 +1,72 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "position.hpp"
+
+
+// The climate of a Board, stored as one contiguous plane per layer and
+// indexed by Cell::ix(). The planes have room for the largest board and its
+// edge cell, so they never need to be reallocated. Transitions that sweep the
+// entire board can process a single layer at a time with the kernels below.
+struct Climate
+{
+	static constexpr size_t CAPACITY =
+		Position::MAX_ROWS * Position::MAX_COLS + 1;
+
+	std::array<int8_t, CAPACITY> temperature;
+	std::array<int8_t, CAPACITY> humidity;
+	std::array<int8_t, CAPACITY> chaos;
+	std::array<int8_t, CAPACITY> gas;
+	std::array<int8_t, CAPACITY> radiation;
+
+	std::array<bool, CAPACITY> snow;
+	std::array<bool, CAPACITY> frostbite;
+	std::array<bool, CAPACITY> firestorm;
+	std::array<bool, CAPACITY> bonedrought;
+	std::array<bool, CAPACITY> death;
+
+	void reset();
+
+	// Sets results[i] to one more than the level of gas that cell i will
+	// have after gas spreads, or to 0 if it will have none: each cell keeps
+	// one less than its own level and receives one less than the level of
+	// each neighbour that has at least 2.
+	static void spreadGas(const int8_t* gas, int rows, int cols,
+		uint8_t* results);
+
+	// Sets out[i] to temperature[i] + base + chaos[i] * factor,
+	// clamped between min and max.
+	static void warm(const int8_t* temperature, const int8_t* chaos,
+		size_t count, int base, int8_t factor, int8_t min, int8_t max,
+		int8_t* out);
+
+	// Sets out[i] to humidity[i] + int8_t(gain[i] - loss[i]),
+	// clamped between min and max.
+	static void moisten(const int8_t* humidity,
+		const uint8_t* gain, const uint8_t* loss,
+		size_t count, int8_t min, int8_t max,
+		int8_t* out);
+};
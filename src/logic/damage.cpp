@@ -29,6 +29,7 @@
 #include "bible.hpp"
 #include "board.hpp"
 #include "cell.hpp"
+#include "randomness.hpp"
 
 
 Damage::Shot::Shot(const Descriptor& desc, const UnitToken* token, int8_t fig,
@@ -165,7 +166,7 @@ void Damage::addBackground(const Descriptor& desc, const UnitToken& unit)
 
 	// If the unit is in the background, only one body is added.
 	// This body is killable.
-	int8_t fig = (rand() % unit.stacks);
+	int8_t fig = (Randomness::next() % unit.stacks);
 	_bodies.emplace_back(desc, &unit, fig, hp);
 }
 
@@ -182,7 +183,8 @@ void Damage::addBackground(const Descriptor& desc, const TileToken& tile)
 	bool killable = _bible.collateralDamageKillsTiles();
 	// It is important that this body may belong to a powered stack.
 	bool powered = (tile.power > 0);
-	int8_t fig = powered ? (rand() % tile.power) : (rand() % tile.stacks);
+	int8_t fig = powered ? (Randomness::next() % tile.power)
+		: (Randomness::next() % tile.stacks);
 	_bodies.emplace_back(desc, &tile, fig, hp, killable, powered);
 }
 
@@ -251,7 +253,7 @@ void Damage::resolve()
 				_targets.push_back(i);
 			}
 		}
-		size_t offset = rand() % _targets.size();
+		size_t offset = Randomness::next() % _targets.size();
 
 		// Apply damage.
 		Body& body = _bodies[_targets[offset]];
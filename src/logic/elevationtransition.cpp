@@ -29,6 +29,8 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
+#include "randomness.hpp"
 
 
 ElevationTransition::ElevationTransition(const Bible& bible, Board& board,
@@ -45,6 +47,8 @@ ElevationTransition::ElevationTransition(const Bible& bible, Board& board,
 
 void ElevationTransition::execute()
 {
+	PROFILE_ZONE("ElevationTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -86,7 +90,8 @@ void ElevationTransition::reduce(Cell index)
 	int8_t elev = _elev[index.ix()];
 	int8_t coast = _coast[index.ix()];
 
-	int target = (int) _bible.tempGenDefault() + elev + coast + rand() % 4 - 1;
+	int target = (int) _bible.tempGenDefault() + elev + coast
+		+ Randomness::next() % 4 - 1;
 	int8_t temperature = std::max((int) _bible.temperatureMin(),
 		std::min(target, (int) _bible.temperatureMax()));
 
@@ -54,7 +54,8 @@ protected:
 	const Bible& _bible;
 	Board& _board;
 
-private:
+	// Realizations that fill the marks by other means than flood() may touch
+	// the marks and the queue directly.
 	std::vector<uint16_t> _marks;
 	std::vector<Cell> _queue;
 	size_t _head = 0;
@@ -0,0 +1,72 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "floodfillcache.hpp"
+#include "source.hpp"
+
+#include "bible.hpp"
+#include "board.hpp"
+
+
+FloodfillCache::FloodfillCache(const Bible& bible, Board& board) :
+	_bible(bible),
+	_board(board)
+{}
+
+const TileFloodfill& FloodfillCache::get(const TileFloodfill::Filter& filter)
+{
+	auto found = _tiles.find(filter);
+	if (found != _tiles.end())
+	{
+		return *(found->second);
+	}
+
+	std::unique_ptr<TileFloodfill> floodfill(
+		new TileFloodfill(_bible, _board, filter));
+	floodfill->execute();
+	const TileFloodfill& result = *floodfill;
+	_tiles.emplace(filter, std::move(floodfill));
+	return result;
+}
+
+const UnitFloodfill& FloodfillCache::get(const UnitFloodfill::Filter& filter)
+{
+	auto found = _units.find(filter);
+	if (found != _units.end())
+	{
+		return *(found->second);
+	}
+
+	std::unique_ptr<UnitFloodfill> floodfill(
+		new UnitFloodfill(_bible, _board, filter));
+	floodfill->execute();
+	const UnitFloodfill& result = *floodfill;
+	_units.emplace(filter, std::move(floodfill));
+	return result;
+}
+
+void FloodfillCache::clear()
+{
+	_tiles.clear();
+	_units.clear();
+}
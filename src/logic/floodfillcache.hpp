@@ -0,0 +1,61 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <map>
+
+#include "pathingfloodfill.hpp"
+
+class Bible;
+class Board;
+
+
+// FloodfillCache remembers executed floodfills by their filter, so that
+// multiple units planning on the same board can share them. It must be
+// cleared whenever the board changes.
+class FloodfillCache
+{
+public:
+	FloodfillCache(const Bible& bible, Board& board);
+
+	FloodfillCache(const FloodfillCache&) = delete;
+	FloodfillCache(FloodfillCache&&) = delete;
+	FloodfillCache& operator=(const FloodfillCache&) = delete;
+	FloodfillCache& operator=(FloodfillCache&&) = delete;
+	~FloodfillCache() = default;
+
+private:
+	const Bible& _bible;
+	Board& _board;
+
+	std::map<TileFloodfill::Filter, std::unique_ptr<TileFloodfill>> _tiles;
+	std::map<UnitFloodfill::Filter, std::unique_ptr<UnitFloodfill>> _units;
+
+public:
+	const TileFloodfill& get(const TileFloodfill::Filter& filter);
+	const UnitFloodfill& get(const UnitFloodfill::Filter& filter);
+
+	void clear();
+};
@@ -29,6 +29,8 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
+#include "randomness.hpp"
 
 
 FreshwaterTransition::FreshwaterTransition(const Bible& bible, Board& board,
@@ -45,6 +47,8 @@ FreshwaterTransition::FreshwaterTransition(const Bible& bible, Board& board,
 
 void FreshwaterTransition::execute()
 {
+	PROFILE_ZONE("FreshwaterTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -115,7 +119,8 @@ void FreshwaterTransition::reduce(Cell index)
 	else if (gain >= _bible.humGenLakeGain(0)) freshwater = gain;
 	else freshwater = gain - loss;
 
-	int target = (int) _bible.humGenDefault() + freshwater + rand() % 4 - 1;
+	int target = (int) _bible.humGenDefault() + freshwater
+		+ Randomness::next() % 4 - 1;
 	int8_t humidity = std::max((int) _bible.humidityMin(),
 		std::min(target, (int) _bible.humidityMax()));
 
@@ -27,6 +27,7 @@
 class TypeNamer;
 struct Change;
 struct Order;
+class ParsedMessage;
 
 
 class Game
@@ -53,7 +54,7 @@ public:
 
 	virtual void sendOrders() = 0;
 
-	virtual void receiveChanges(const Json::Value& /**/) {}
+	virtual void receiveChanges(const ParsedMessage& /**/) {}
 	virtual void sync(uint32_t /*time*/) {}
 	virtual void setAnimation(bool /*animate*/) {}
 
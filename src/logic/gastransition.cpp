@@ -29,6 +29,7 @@
 #include "changeset.hpp"
 #include "cell.hpp"
 #include "cycle.hpp"
+#include "profiler.hpp"
 
 
 GasTransition::GasTransition(const Bible& bible, Board& board,
@@ -41,9 +42,21 @@ GasTransition::GasTransition(const Bible& bible, Board& board,
 
 void GasTransition::execute()
 {
-	for (Cell index : _board)
+	PROFILE_ZONE("GasTransition::execute");
+
+	const Climate& climate = _board.climate();
+	int rows = _board.rows();
+	int cols = _board.cols();
+	Climate::spreadGas(climate.gas.data(), rows, cols, _results.data());
+
+	// Moving west from the first column lands on the edge cell, and moving
+	// north from the edge cell lands on the last cell of the first column.
+	// Gas has always spread there from the first column, so it still does.
+	uint8_t& corner = _results[(rows - 1) * cols];
+	for (int r = 0; r < rows; r++)
 	{
-		map(index);
+		int8_t level = climate.gas[r * cols];
+		if (level >= 2) corner = std::max(corner, (uint8_t) level);
 	}
 
 	for (Cell index : _board)
@@ -52,32 +65,6 @@ void GasTransition::execute()
 	}
 }
 
-void GasTransition::map(Cell index)
-{
-	int8_t level = _board.gas(index);
-
-	if (!level) return;
-
-	put(index, level - 1);
-	if (level >= 2)
-	{
-		// We do not use Area here because we want to put() gas on edges.
-		for (Cell neighbor : {
-				index + Move::E,
-				index + Move::E + Move::S,
-				index + Move::S,
-				index + Move::S + Move::W,
-				index + Move::W,
-				index + Move::W + Move::N,
-				index + Move::N,
-				index + Move::N + Move::E,
-			})
-		{
-			put(neighbor, level - 1);
-		}
-	}
-}
-
 void GasTransition::reduce(Cell index)
 {
 	if (!_results[index.ix()]) return;
@@ -130,12 +117,3 @@ void GasTransition::reduce(Cell index)
 		}
 	}
 }
-
-void GasTransition::put(Cell index, int8_t level)
-{
-	DEBUG_ASSERT(level >= 0);
-
-	// Inside _results, levels are increased by 1 so that 0 means undefined.
-	uint8_t result = level + 1;
-	_results[index.ix()] = std::max(_results[index.ix()], result);
-}
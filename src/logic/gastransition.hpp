@@ -42,11 +42,8 @@ private:
 
 	std::vector<uint8_t> _results;
 
-	void map(Cell index);
 	void reduce(Cell index);
 
-	void put(Cell index, int8_t level);
-
 public:
 	void execute();
 };
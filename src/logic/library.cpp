@@ -25,6 +25,7 @@
 #include "source.hpp"
 
 #include <mutex>
+#include <map>
 
 #include "bible.hpp"
 #include "system.hpp"
@@ -40,6 +41,12 @@ static std::string _latestrulesetname = "current";
 
 static std::mutex _mutex;
 
+// Bibles that have been shared before, by ruleset name. A published shelf is
+// never modified, so once a ruleset is on it, it can be shared without
+// locking _mutex; sharing a new ruleset publishes a new shelf.
+typedef std::map<std::string, std::shared_ptr<const Bible>> LibraryShelf;
+static std::shared_ptr<const LibraryShelf> _shelf;
+
 Library* Library::_installed = nullptr;
 
 Library::Library() = default;
@@ -71,8 +78,38 @@ bool Library::existsBible(const std::string& rulesetname)
 
 Bible Library::getBible(const std::string& rulesetname)
 {
+	return *shareBible(rulesetname);
+}
+
+std::shared_ptr<const Bible> Library::shareBible(
+	const std::string& rulesetname)
+{
+	{
+		std::shared_ptr<const LibraryShelf> shelf = std::atomic_load(&_shelf);
+		if (shelf)
+		{
+			auto iter = shelf->find(rulesetname);
+			if (iter != shelf->end()) return iter->second;
+		}
+	}
+
 	std::lock_guard<std::mutex> lock(_mutex);
-	return _installed->get(rulesetname);
+	std::shared_ptr<const Bible> bible = _installed->share(rulesetname);
+
+	// Do not put the default bible on the shelf under the name of a missing
+	// ruleset, because that ruleset might be stored later.
+	if (bible->name() == rulesetname)
+	{
+		std::shared_ptr<const LibraryShelf> shelf = std::atomic_load(&_shelf);
+		std::shared_ptr<LibraryShelf> newshelf = (shelf)
+			? std::make_shared<LibraryShelf>(*shelf)
+			: std::make_shared<LibraryShelf>();
+		(*newshelf)[rulesetname] = bible;
+		std::atomic_store(&_shelf,
+			std::shared_ptr<const LibraryShelf>(std::move(newshelf)));
+	}
+
+	return bible;
 }
 
 bool Library::storeBible(const std::string& rulesetname,
@@ -86,6 +123,7 @@ void Library::install()
 {
 	std::lock_guard<std::mutex> lock(_mutex);
 	_installed = this;
+	std::atomic_store(&_shelf, std::shared_ptr<const LibraryShelf>());
 }
 
 bool Library::loadIndex(const std::string& filename)
@@ -381,13 +419,18 @@ bool Library::exists(const std::string& rulesetname)
 }
 
 Bible Library::get(const std::string& rulesetname)
+{
+	return *share(rulesetname);
+}
+
+std::shared_ptr<const Bible> Library::share(const std::string& rulesetname)
 {
 	// Look for the bible in the cache.
 	for (auto& bible : _cache)
 	{
 		if (bible->name() == rulesetname)
 		{
-			return *bible;
+			return bible;
 		}
 	}
 
@@ -395,12 +438,13 @@ Bible Library::get(const std::string& rulesetname)
 	if (exists(rulesetname))
 	{
 		// Not yet cached, load it now.
-		return loadBible(rulesetname);
+		loadBible(rulesetname);
+		return _cache.back();
 	}
 
 	// Not found, just use the default bible.
 	LOGW << "Missing bible '" << rulesetname << "'";
-	return Bible::createDefault();
+	return std::make_shared<const Bible>(Bible::createDefault());
 }
 
 bool Library::store(const std::string& rulesetname, const Json::Value& json)
@@ -44,7 +44,7 @@ public:
 
 private:
 	std::vector<Version> _available;
-	std::vector<std::unique_ptr<const Bible>> _cache;
+	std::vector<std::shared_ptr<const Bible>> _cache;
 
 	bool loadIndex(const std::string& filename);
 	const Bible& loadBible(const Version& version);
@@ -61,6 +61,7 @@ public:
 
 	bool exists(const std::string& rulesetname);
 	Bible get(const std::string& rulesetname);
+	std::shared_ptr<const Bible> share(const std::string& rulesetname);
 	bool store(const std::string& rulesetname, const Json::Value& biblejson);
 
 	std::string currentRuleset();
@@ -73,6 +74,8 @@ public:
 	static std::string nameCompatibleBible(const std::string& rulesetname);
 	static bool existsBible(const std::string& rulesetname);
 	static Bible getBible(const std::string& rulesetname);
+	static std::shared_ptr<const Bible> shareBible(
+		const std::string& rulesetname);
 	static bool storeBible(const std::string& rulesetname,
 		const Json::Value& biblejson);
 };
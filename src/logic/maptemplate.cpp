@@ -0,0 +1,540 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "maptemplate.hpp"
+#include "source.hpp"
+
+#include <mutex>
+
+#include "map.hpp"
+#include "system.hpp"
+#include "parseerror.hpp"
+
+
+static std::mutex _maptemplatesmutex;
+static std::vector<std::shared_ptr<const MapTemplate>> _maptemplates;
+
+// Enough for every map in the pools, with room for a few custom maps.
+constexpr size_t MAPTEMPLATE_CACHE_SIZE = 32;
+
+// The first bytes of a precompiled binary map, followed by a format version.
+static const char MAPTEMPLATE_MAGIC[4] = {'E', 'P', 'M', 'B'};
+constexpr uint8_t MAPTEMPLATE_FORMAT = 1;
+
+static uint64_t maptemplate_checksum(const std::string& contents)
+{
+	// FNV-1a.
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : contents)
+	{
+		hash ^= (uint8_t) c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+MapTemplate::MapTemplate(const TypeNamer& typenamer,
+		const std::string& filename) :
+	_typenamer(typenamer),
+	_filename(filename)
+{}
+
+std::shared_ptr<const MapTemplate> MapTemplate::get(
+	const TypeNamer& typenamer, const std::string& mapname)
+{
+	std::string fname = Map::readOnlyFilename(mapname);
+	if (!System::isFile(fname))
+	{
+		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
+			<< "file does not exist";
+		throw std::runtime_error("failed to load map " + mapname + ": \t"
+				+ "file does not exist");
+	}
+	int64_t mtime = System::getModificationTime(fname);
+
+	{
+		std::lock_guard<std::mutex> lock(_maptemplatesmutex);
+		for (const auto& maptemplate : _maptemplates)
+		{
+			if (maptemplate->_filename == fname
+				&& maptemplate->_mtime == mtime
+				&& maptemplate->_typenamer.sameTypesAs(typenamer))
+			{
+				return maptemplate;
+			}
+		}
+	}
+
+	// Parse without holding the lock; if two threads happen to parse the
+	// same map at the same time, both results are equally good.
+	std::shared_ptr<MapTemplate> maptemplate(
+		new MapTemplate(typenamer, fname));
+	maptemplate->_mtime = mtime;
+	maptemplate->parse(mapname);
+
+	{
+		std::lock_guard<std::mutex> lock(_maptemplatesmutex);
+		_maptemplates.erase(std::remove_if(
+				_maptemplates.begin(), _maptemplates.end(),
+				[&](const std::shared_ptr<const MapTemplate>& other) {
+
+			return (other->_filename == fname
+				&& other->_typenamer.sameTypesAs(typenamer));
+		}), _maptemplates.end());
+		if (_maptemplates.size() >= MAPTEMPLATE_CACHE_SIZE)
+		{
+			_maptemplates.erase(_maptemplates.begin());
+		}
+		_maptemplates.emplace_back(maptemplate);
+	}
+	return maptemplate;
+}
+
+void MapTemplate::forget(const std::string& mapname)
+{
+	std::string fname = Map::readOnlyFilename(mapname);
+
+	std::lock_guard<std::mutex> lock(_maptemplatesmutex);
+	_maptemplates.erase(std::remove_if(
+			_maptemplates.begin(), _maptemplates.end(),
+			[&](const std::shared_ptr<const MapTemplate>& other) {
+
+		return (other->_filename == fname);
+	}), _maptemplates.end());
+}
+
+std::string MapTemplate::binaryFilename(const std::string& filename)
+{
+	size_t slash = filename.find_last_of('/');
+	size_t dot = filename.find_last_of('.');
+	if (dot != std::string::npos
+		&& (slash == std::string::npos || dot > slash))
+	{
+		return filename.substr(0, dot) + ".bmap";
+	}
+	return filename + ".bmap";
+}
+
+std::string MapTemplate::read(const std::string& mapname) const
+{
+	const std::string& fname = _filename;
+
+	std::ifstream file = System::ifstream(fname, std::ios::binary);
+	if (!file)
+	{
+		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
+			<< "failed to open file";
+		throw std::runtime_error("failed to load map " + mapname + ": \t"
+				+ "failed to open file");
+	}
+	std::stringstream strm;
+	strm << file.rdbuf();
+	return strm.str();
+}
+
+void MapTemplate::parse(const std::string& mapname)
+{
+	std::string contents = read(mapname);
+
+	std::string binaryname = binaryFilename(_filename);
+	if (System::isFile(binaryname)
+		&& loadBinary(binaryname, maptemplate_checksum(contents)))
+	{
+		return;
+	}
+
+	parseText(mapname, contents);
+}
+
+void MapTemplate::parseText(const std::string& mapname,
+	const std::string& contents)
+{
+	const std::string& fname = _filename;
+
+	Json::Reader reader;
+	Json::Value metadata;
+	std::string line;
+
+	std::istringstream file(contents);
+	if (!std::getline(file, line) || line.empty())
+	{
+		LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
+			<< "failed to read line";
+		throw std::runtime_error("failed to load map " + mapname + ": \t"
+				+ "failed to read line");
+	}
+	else if (!reader.parse(line, metadata) || !metadata.isObject())
+	{
+		// Try old style.
+		if (!reader.parse(contents, metadata) || !metadata.isObject())
+		{
+			LOGF << "Failed to load map '" << mapname << "' (" << fname << "): "
+				<< reader.getFormattedErrorMessages();
+			throw std::runtime_error("failed to load map " + mapname + ": \t"
+					+ reader.getFormattedErrorMessages());
+		}
+	}
+
+	_cols = metadata["cols"].asInt();
+	_rows = metadata["rows"].asInt();
+	DEBUG_ASSERT(_cols <= Position::MAX_COLS && _rows <= Position::MAX_ROWS);
+	_cols = std::max(0, std::min(_cols, (int) Position::MAX_COLS));
+	_rows = std::max(0, std::min(_rows, (int) Position::MAX_ROWS));
+	_squares.resize(_rows * _cols);
+
+	// Old style: cells are included in the json.
+	if (metadata["cells"].isArray())
+	{
+		Json::ValueConstIterator iter = metadata["cells"].begin();
+		for (Square& square : _squares)
+		{
+			const Json::Value& celljson = *iter;
+			parseSquare(square, celljson);
+			iter++;
+		}
+	}
+	// New style: each line is its own celljson.
+	else
+	{
+		for (Square& square : _squares)
+		{
+			Json::Value celljson;
+			if (!std::getline(file, line) || !reader.parse(line, celljson))
+			{
+				throw std::runtime_error("error while parsing cells");
+			}
+			parseSquare(square, celljson);
+		}
+	}
+}
+
+void MapTemplate::parseSquare(Square& square, const Json::Value& celljson)
+{
+	square.tile = TileToken(_typenamer, celljson["tile"]);
+	square.ground = UnitToken(_typenamer, celljson["ground"]);
+	square.air = UnitToken(_typenamer, celljson["air"]);
+
+	if (celljson["temperature"].isInt())
+	{
+		square.layers |= TEMPERATURE;
+		square.temperature = celljson["temperature"].asInt();
+	}
+	if (celljson["humidity"].isInt())
+	{
+		square.layers |= HUMIDITY;
+		square.humidity = celljson["humidity"].asInt();
+	}
+	if (celljson["chaos"].isInt())
+	{
+		square.layers |= CHAOS;
+		square.chaos = celljson["chaos"].asInt();
+	}
+	if (celljson["gas"].isInt())
+	{
+		square.layers |= GAS;
+		square.gas = celljson["gas"].asInt();
+	}
+	if (celljson["radiation"].isInt())
+	{
+		square.layers |= RADIATION;
+		square.radiation = celljson["radiation"].asInt();
+	}
+
+	if (celljson["snow"].isBool())
+	{
+		square.layers |= SNOW;
+		square.snow = celljson["snow"].asBool();
+	}
+	if (celljson["frostbite"].isBool())
+	{
+		square.layers |= FROSTBITE;
+		square.frostbite = celljson["frostbite"].asBool();
+	}
+	if (celljson["firestorm"].isBool())
+	{
+		square.layers |= FIRESTORM;
+		square.firestorm = celljson["firestorm"].asBool();
+	}
+	if (celljson["bonedrought"].isBool())
+	{
+		square.layers |= BONEDROUGHT;
+		square.bonedrought = celljson["bonedrought"].asBool();
+	}
+	if (celljson["death"].isBool())
+	{
+		square.layers |= DEATH;
+		square.death = celljson["death"].asBool();
+	}
+}
+
+/*
+A precompiled binary map consists of the magic bytes and the format version,
+followed by the checksum of the map file that it was compiled from, the size
+of the board, and the words of the tile and unit types that the cells refer
+to. Each cell then takes 12 bytes: the type, owner and stacks of the tile,
+ground unit and air unit, the power of the tile and the climate layers that
+are set, followed by one byte for each of those layers.
+*/
+void MapTemplate::saveBinary(uint64_t checksum) const
+{
+	std::string binaryname = binaryFilename(_filename);
+
+	std::vector<char> buffer;
+	buffer.insert(buffer.end(), MAPTEMPLATE_MAGIC, MAPTEMPLATE_MAGIC + 4);
+	buffer.push_back(MAPTEMPLATE_FORMAT);
+	for (size_t i = 0; i < 8; i++)
+	{
+		buffer.push_back((char) (uint8_t) (checksum >> (8 * i)));
+	}
+	buffer.push_back((char) _cols);
+	buffer.push_back((char) _rows);
+
+	// Type 0 is always "none" and is not stored.
+	buffer.push_back((char) _typenamer.tiletype_max());
+	for (size_t i = 1; i <= _typenamer.tiletype_max(); i++)
+	{
+		const TypeWord& word = _typenamer.typeword((TileType) i);
+		buffer.insert(buffer.end(), word.data, word.data + sizeof(word.data));
+	}
+	buffer.push_back((char) _typenamer.unittype_max());
+	for (size_t i = 1; i <= _typenamer.unittype_max(); i++)
+	{
+		const TypeWord& word = _typenamer.typeword((UnitType) i);
+		buffer.insert(buffer.end(), word.data, word.data + sizeof(word.data));
+	}
+
+	for (const Square& square : _squares)
+	{
+		buffer.push_back((char) square.tile.type);
+		buffer.push_back((char) square.tile.owner);
+		buffer.push_back((char) square.tile.stacks);
+		buffer.push_back((char) square.tile.power);
+		buffer.push_back((char) square.ground.type);
+		buffer.push_back((char) square.ground.owner);
+		buffer.push_back((char) square.ground.stacks);
+		buffer.push_back((char) square.air.type);
+		buffer.push_back((char) square.air.owner);
+		buffer.push_back((char) square.air.stacks);
+		buffer.push_back((char) (square.layers & 0xFF));
+		buffer.push_back((char) (square.layers >> 8));
+		if (square.layers & TEMPERATURE) buffer.push_back(square.temperature);
+		if (square.layers & HUMIDITY) buffer.push_back(square.humidity);
+		if (square.layers & CHAOS) buffer.push_back(square.chaos);
+		if (square.layers & GAS) buffer.push_back(square.gas);
+		if (square.layers & RADIATION) buffer.push_back(square.radiation);
+		if (square.layers & SNOW) buffer.push_back(square.snow);
+		if (square.layers & FROSTBITE) buffer.push_back(square.frostbite);
+		if (square.layers & FIRESTORM) buffer.push_back(square.firestorm);
+		if (square.layers & BONEDROUGHT) buffer.push_back(square.bonedrought);
+		if (square.layers & DEATH) buffer.push_back(square.death);
+	}
+
+	std::ofstream file = System::ofstream(binaryname,
+		std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.write(buffer.data(), buffer.size()))
+	{
+		LOGE << "Failed to write '" << binaryname << "'";
+		throw std::runtime_error("failed to write " + binaryname);
+	}
+}
+
+bool MapTemplate::loadBinary(const std::string& binaryname, uint64_t checksum)
+{
+	std::string contents;
+	{
+		std::ifstream file = System::ifstream(binaryname, std::ios::binary);
+		std::stringstream strm;
+		strm << file.rdbuf();
+		contents = strm.str();
+	}
+
+	const uint8_t* cur = (const uint8_t*) contents.data();
+	const uint8_t* end = cur + contents.size();
+	auto have = [&](size_t n) {
+
+		return (size_t) (end - cur) >= n;
+	};
+
+	if (!have(4 + 1 + 8 + 2)
+		|| !std::equal(MAPTEMPLATE_MAGIC, MAPTEMPLATE_MAGIC + 4, cur)
+		|| cur[4] != MAPTEMPLATE_FORMAT)
+	{
+		LOGW << "Ignoring '" << binaryname << "': unknown format";
+		return false;
+	}
+	cur += 5;
+
+	uint64_t compiledchecksum = 0;
+	for (size_t i = 0; i < 8; i++)
+	{
+		compiledchecksum |= ((uint64_t) cur[i]) << (8 * i);
+	}
+	cur += 8;
+	if (compiledchecksum != checksum)
+	{
+		LOGI << "Ignoring '" << binaryname << "': out of date";
+		return false;
+	}
+
+	int cols = cur[0];
+	int rows = cur[1];
+	cur += 2;
+	if (cols > Position::MAX_COLS || rows > Position::MAX_ROWS)
+	{
+		LOGW << "Ignoring '" << binaryname << "': too large";
+		return false;
+	}
+
+	// The types are stored by name and only looked up once they are used,
+	// so that types that are unused or renamed do not get in the way.
+	std::vector<std::string> tilewords(1, "none");
+	std::vector<std::string> unitwords(1, "none");
+	for (std::vector<std::string>* words : {&tilewords, &unitwords})
+	{
+		if (!have(1)) return false;
+		size_t count = *cur++;
+		if (!have(count * sizeof(TypeWord::data))) return false;
+		for (size_t i = 0; i < count; i++)
+		{
+			const char* data = (const char*) cur;
+			words->emplace_back(data,
+				std::find(data, data + sizeof(TypeWord::data), '\0'));
+			cur += sizeof(TypeWord::data);
+		}
+	}
+
+	std::vector<Square> squares(rows * cols);
+	size_t loaded = 0;
+	for (Square& square : squares)
+	{
+		if (!have(12)) break;
+		if ((cur[11] >> 2) != 0
+			|| cur[0] >= tilewords.size()
+			|| cur[4] >= unitwords.size()
+			|| cur[7] >= unitwords.size()
+			|| cur[1] >= PLAYER_SIZE
+			|| cur[5] >= PLAYER_SIZE
+			|| cur[8] >= PLAYER_SIZE)
+		{
+			break;
+		}
+		square.tile.type = parseTileType(_typenamer, tilewords[cur[0]]);
+		square.tile.owner = (Player) cur[1];
+		square.tile.stacks = (int8_t) cur[2];
+		square.tile.power = (int8_t) cur[3];
+		square.ground.type = parseUnitType(_typenamer, unitwords[cur[4]]);
+		square.ground.owner = (Player) cur[5];
+		square.ground.stacks = (int8_t) cur[6];
+		square.air.type = parseUnitType(_typenamer, unitwords[cur[7]]);
+		square.air.owner = (Player) cur[8];
+		square.air.stacks = (int8_t) cur[9];
+		square.layers = cur[10] | (cur[11] << 8);
+		cur += 12;
+
+		size_t count = 0;
+		for (uint16_t bits = square.layers; bits; bits &= bits - 1) count++;
+		if (!have(count)) break;
+		if (square.layers & TEMPERATURE) square.temperature = *cur++;
+		if (square.layers & HUMIDITY) square.humidity = *cur++;
+		if (square.layers & CHAOS) square.chaos = *cur++;
+		if (square.layers & GAS) square.gas = *cur++;
+		if (square.layers & RADIATION) square.radiation = *cur++;
+		if (square.layers & SNOW) square.snow = *cur++;
+		if (square.layers & FROSTBITE) square.frostbite = *cur++;
+		if (square.layers & FIRESTORM) square.firestorm = *cur++;
+		if (square.layers & BONEDROUGHT) square.bonedrought = *cur++;
+		if (square.layers & DEATH) square.death = *cur++;
+		loaded++;
+	}
+
+	if (loaded != squares.size() || cur != end)
+	{
+		LOGW << "Ignoring '" << binaryname << "': corrupted";
+		return false;
+	}
+
+	_cols = cols;
+	_rows = rows;
+	_squares = std::move(squares);
+	return true;
+}
+
+static bool maptemplate_same(const MapTemplate::Square& a,
+	const MapTemplate::Square& b)
+{
+	return (a.tile.type == b.tile.type
+		&& a.tile.owner == b.tile.owner
+		&& a.tile.stacks == b.tile.stacks
+		&& a.tile.power == b.tile.power
+		&& a.ground.type == b.ground.type
+		&& a.ground.owner == b.ground.owner
+		&& a.ground.stacks == b.ground.stacks
+		&& a.air.type == b.air.type
+		&& a.air.owner == b.air.owner
+		&& a.air.stacks == b.air.stacks
+		&& a.layers == b.layers
+		&& a.temperature == b.temperature
+		&& a.humidity == b.humidity
+		&& a.chaos == b.chaos
+		&& a.gas == b.gas
+		&& a.radiation == b.radiation
+		&& a.snow == b.snow
+		&& a.frostbite == b.frostbite
+		&& a.firestorm == b.firestorm
+		&& a.bonedrought == b.bonedrought
+		&& a.death == b.death);
+}
+
+void MapTemplate::precompile(const TypeNamer& typenamer,
+	const std::string& mapname)
+{
+	std::string fname = Map::readOnlyFilename(mapname);
+	std::string binaryname = binaryFilename(fname);
+
+	// Parse the map file itself, even if there already is a binary map.
+	MapTemplate original(typenamer, fname);
+	std::string contents = original.read(mapname);
+	uint64_t checksum = maptemplate_checksum(contents);
+	original.parseText(mapname, contents);
+	original.saveBinary(checksum);
+
+	MapTemplate compiled(typenamer, fname);
+	if (!compiled.loadBinary(binaryname, checksum)
+		|| compiled._cols != original._cols
+		|| compiled._rows != original._rows)
+	{
+		LOGF << "Failed to precompile map '" << mapname << "': "
+			<< "'" << binaryname << "' cannot be loaded";
+		throw std::runtime_error("failed to precompile map " + mapname);
+	}
+
+	for (size_t i = 0; i < original._squares.size(); i++)
+	{
+		if (!maptemplate_same(compiled._squares[i], original._squares[i]))
+		{
+			LOGF << "Failed to precompile map '" << mapname << "': "
+				<< "'" << binaryname << "' differs at cell " << i;
+			throw std::runtime_error("failed to precompile map " + mapname);
+		}
+	}
+}
@@ -0,0 +1,123 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "typenamer.hpp"
+#include "tiletoken.hpp"
+#include "unittoken.hpp"
+
+
+/*
+The contents of a map file after parsing, for one set of tile and unit types.
+Templates are immutable and shared between all Boards that load the same map
+with the same types, so that loading a map only copies its cells. A template
+is parsed from the precompiled binary map next to the map file if there is
+one that matches it, and from the map file itself otherwise.
+*/
+class MapTemplate
+{
+public:
+	enum Layer : uint16_t
+	{
+		TEMPERATURE = 0x0001,
+		HUMIDITY = 0x0002,
+		CHAOS = 0x0004,
+		GAS = 0x0008,
+		RADIATION = 0x0010,
+		SNOW = 0x0020,
+		FROSTBITE = 0x0040,
+		FIRESTORM = 0x0080,
+		BONEDROUGHT = 0x0100,
+		DEATH = 0x0200,
+	};
+
+	struct Square
+	{
+		TileToken tile;
+		UnitToken ground;
+		UnitToken air;
+
+		// The climate layers that the map sets for this cell; the Board
+		// keeps its own values for the other layers.
+		uint16_t layers = 0;
+
+		int8_t temperature = 0;
+		int8_t humidity = 0;
+		int8_t chaos = 0;
+		int8_t gas = 0;
+		int8_t radiation = 0;
+
+		bool snow = false;
+		bool frostbite = false;
+		bool firestorm = false;
+		bool bonedrought = false;
+		bool death = false;
+	};
+
+	MapTemplate(const MapTemplate&) = delete;
+	MapTemplate(MapTemplate&&) = delete;
+	MapTemplate& operator=(const MapTemplate&) = delete;
+	MapTemplate& operator=(MapTemplate&&) = delete;
+	~MapTemplate() = default;
+
+private:
+	MapTemplate(const TypeNamer& typenamer, const std::string& filename);
+
+	TypeNamer _typenamer;
+	std::string _filename;
+	int64_t _mtime = 0;
+	int _cols = 0;
+	int _rows = 0;
+	std::vector<Square> _squares;
+
+	std::string read(const std::string& mapname) const;
+	void parse(const std::string& mapname);
+	void parseText(const std::string& mapname, const std::string& contents);
+	void parseSquare(Square& square, const Json::Value& celljson);
+	void saveBinary(uint64_t checksum) const;
+	bool loadBinary(const std::string& binaryname, uint64_t checksum);
+
+public:
+	// Returns the template of the given map for the given types, parsing it
+	// if it is not cached or if the map file was modified since.
+	static std::shared_ptr<const MapTemplate> get(const TypeNamer& typenamer,
+		const std::string& mapname);
+
+	// Drops every cached template of the given map.
+	static void forget(const std::string& mapname);
+
+	static std::string binaryFilename(const std::string& filename);
+
+	int cols() const { return _cols; }
+	int rows() const { return _rows; }
+
+	const std::vector<Square>& squares() const { return _squares; }
+
+	// Parses the map file, writes the precompiled binary map that get() will
+	// look for and then checks that it loads back into exactly the same
+	// template. Throws if it does not.
+	static void precompile(const TypeNamer& typenamer,
+		const std::string& mapname);
+};
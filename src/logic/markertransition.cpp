@@ -28,6 +28,8 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "randomizer.hpp"
+#include "profiler.hpp"
+#include "randomness.hpp"
 
 
 namespace MarkerFlag
@@ -142,6 +144,8 @@ MarkerTransition::MarkerTransition(const Bible& bible, Board& board,
 
 void MarkerTransition::execute()
 {
+	PROFILE_ZONE("MarkerTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -240,7 +244,7 @@ void MarkerTransition::map(Cell index)
 			int percentage = stage * _bible.firestormBasePercentage()
 				+ drought * _bible.firestormDroughtPercentage()
 				- _bible.tileFirestormResistance(tiletype);
-			int value = (rand() % 100);
+			int value = (Randomness::next() % 100);
 			firestorm = (value < percentage);
 		}
 	}
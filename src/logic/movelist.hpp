@@ -0,0 +1,215 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "move.hpp"
+
+
+// A list of moves with the interface of a std::vector<Move>, but that stores
+// up to INLINE_SIZE moves inline. Almost all move orders are that short, so
+// copying an Order (and thus a Change) does not need to allocate. Longer
+// lists are stored on the heap.
+class MoveList
+{
+public:
+	static constexpr size_t INLINE_SIZE = 24;
+	static constexpr size_t MAX_SIZE = 0xFFFF;
+
+	MoveList() :
+		_size(0),
+		_capacity(INLINE_SIZE)
+	{}
+
+	MoveList(std::initializer_list<Move> moves) :
+		MoveList()
+	{
+		assign(moves.begin(), moves.size());
+	}
+
+	explicit MoveList(const std::vector<Move>& moves) :
+		MoveList()
+	{
+		assign(moves.data(), moves.size());
+	}
+
+	MoveList(const MoveList& other) :
+		MoveList()
+	{
+		assign(other.data(), other.size());
+	}
+
+	MoveList(MoveList&& other) :
+		MoveList()
+	{
+		steal(other);
+	}
+
+	MoveList& operator=(const MoveList& other)
+	{
+		if (this != &other) assign(other.data(), other.size());
+		return *this;
+	}
+
+	MoveList& operator=(MoveList&& other)
+	{
+		if (this != &other)
+		{
+			release();
+			steal(other);
+		}
+		return *this;
+	}
+
+	~MoveList()
+	{
+		release();
+	}
+
+private:
+	union
+	{
+		Move _inline[INLINE_SIZE];
+		Move* _heap;
+	};
+	uint16_t _size;
+	uint16_t _capacity;
+
+	bool spilled() const { return _capacity > INLINE_SIZE; }
+
+	void release()
+	{
+		if (spilled()) delete[] _heap;
+		_capacity = INLINE_SIZE;
+		_size = 0;
+	}
+
+	void steal(MoveList& other)
+	{
+		if (other.spilled())
+		{
+			_heap = other._heap;
+			_capacity = other._capacity;
+			other._capacity = INLINE_SIZE;
+		}
+		else std::memcpy(_inline, other._inline, other._size);
+		_size = other._size;
+		other._size = 0;
+	}
+
+	void assign(const Move* moves, size_t size)
+	{
+		_size = 0;
+		reserve(size);
+		if (size > 0) std::memcpy(data(), moves, size);
+		_size = size;
+	}
+
+public:
+	Move* data() { return spilled() ? _heap : _inline; }
+	const Move* data() const { return spilled() ? _heap : _inline; }
+
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	Move* begin() { return data(); }
+	Move* end() { return data() + _size; }
+	const Move* begin() const { return data(); }
+	const Move* end() const { return data() + _size; }
+
+	Move& operator[](size_t i) { return data()[i]; }
+	const Move& operator[](size_t i) const { return data()[i]; }
+
+	Move& front() { return data()[0]; }
+	Move& back() { return data()[_size - 1]; }
+	const Move& front() const { return data()[0]; }
+	const Move& back() const { return data()[_size - 1]; }
+
+	void reserve(size_t capacity)
+	{
+		if (capacity <= _capacity) return;
+
+		// The counters are 16 bits, so refuse like std::vector would.
+		if (capacity > MAX_SIZE) throw std::length_error("MoveList::reserve");
+		size_t grown = std::max(capacity, 2 * (size_t) _capacity);
+		if (grown > MAX_SIZE) grown = MAX_SIZE;
+		Move* heap = new Move[grown];
+		if (_size > 0) std::memcpy(heap, data(), _size);
+		if (spilled()) delete[] _heap;
+		_heap = heap;
+		_capacity = grown;
+	}
+
+	void resize(size_t size)
+	{
+		reserve(size);
+		if (size > _size) std::memset(data() + _size, 0, size - _size);
+		_size = size;
+	}
+
+	void clear() { _size = 0; }
+
+	void push_back(const Move& move)
+	{
+		reserve(_size + 1);
+		data()[_size++] = move;
+	}
+
+	void emplace_back(const Move& move)
+	{
+		push_back(move);
+	}
+
+	void pop_back()
+	{
+		_size--;
+	}
+
+	Move* erase(Move* first, Move* last)
+	{
+		Move* stop = end();
+		std::memmove(first, last, stop - last);
+		_size -= (last - first);
+		return first;
+	}
+
+	Move* erase(Move* position)
+	{
+		return erase(position, position + 1);
+	}
+
+	bool operator==(const MoveList& other) const
+	{
+		return _size == other._size
+			&& std::equal(begin(), end(), other.begin());
+	}
+
+	bool operator!=(const MoveList& other) const
+	{
+		return !(*this == other);
+	}
+};
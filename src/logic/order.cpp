@@ -85,6 +85,11 @@ Order::Order(const TypeNamer& namer, const Json::Value& json) :
 		{
 			subject = Descriptor(json["subject"]);
 			target = Descriptor(json["target"]);
+			if (json["moves"].size() > MAX_MOVES)
+			{
+				throw ParseError("Too many moves in order: "
+					+ std::to_string(json["moves"].size()));
+			}
 			moves.reserve(json["moves"].size());
 			for (const Json::Value& movejson : json["moves"])
 			{
@@ -25,8 +25,8 @@
 #include "header.hpp"
 
 #include "descriptor.hpp"
+#include "movelist.hpp"
 
-enum class Move : uint8_t;
 enum class TileType : uint8_t;
 enum class UnitType : uint8_t;
 
@@ -60,6 +60,9 @@ public:
 
 	static constexpr size_t TYPE_SIZE = ((size_t) Type::HALT) + 1;
 
+	// No sensible path visits more cells than there are on the largest board.
+	static constexpr size_t MAX_MOVES = Position::MAX_ROWS * Position::MAX_COLS;
+
 	Order() :
 		type(Type::NONE),
 		__byte(0)
@@ -135,7 +138,7 @@ public:
 	};
 	Descriptor subject;
 	Descriptor target;
-	std::vector<Move> moves;
+	MoveList moves;
 
 	static Order::Type parseType(const std::string& str);
 	static const char* stringify(const Order::Type& type);
@@ -26,22 +26,64 @@
 
 #include "bible.hpp"
 #include "board.hpp"
+#include "randomness.hpp"
 
 
 template <class This>
-void PathingFI<This>::flood(Cell from)
+void PathingFI<This>::fill()
 {
-	for (const Move& move : {Move::E, Move::S, Move::W, Move::N})
+	const Bitboard passable = _board.bitboards().passable(_bible, _air);
+	const int rows = _board.rows();
+	const int cols = _board.cols();
+
+	// Everything that is marked has been reached, either by an earlier fill
+	// or because it was put as a source.
+	Bitboard reached;
+	for (int r = 0; r < rows; r++)
 	{
-		Cell to = from + move;
-		TileType tiletype = _board.tile(to).type;
+		for (int c = 0; c < cols; c++)
+		{
+			if (_marks[r * cols + c] != 0) reached.set(r, c);
+		}
+	}
 
-		if (tiletype != TileType::NONE
-			&& _bible.tileAccessible(tiletype)
-			&& (_air || _bible.tileWalkable(tiletype)))
+	// The queue holds the cells that have been put but not yet flooded, in
+	// order of increasing marks. A cell that is marked X is flooded together
+	// with the other cells marked X, and the cells that it reaches are marked
+	// X+1, just as if they had been flooded one at a time.
+	Bitboard frontier;
+	uint16_t mark = (_head < _size) ? _marks[_queue[_head].ix()] : 0;
+	while (true)
+	{
+		while (_head < _size && _marks[_queue[_head].ix()] == mark)
 		{
-			put(from, to);
+			Position pos = _queue[_head].pos();
+			frontier.set(pos.row, pos.col);
+			_head++;
 		}
+
+		if (!frontier.any())
+		{
+			if (_head < _size)
+			{
+				mark = _marks[_queue[_head].ix()];
+				continue;
+			}
+			break;
+		}
+
+		Bitboard grown = frontier.neighbours();
+		grown &= passable;
+		grown -= reached;
+		reached |= grown;
+		mark++;
+
+		grown.forEach([this, cols, mark](int r, int c) {
+
+			_marks[r * cols + c] = mark;
+		});
+
+		frontier = grown;
 	}
 }
 
@@ -53,7 +95,7 @@ Move PathingFI<This>::step(Cell from) const
 
 	// shuffle to prevent congestion (sometimes...)
 	std::vector<Move> moves = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(moves.begin(), moves.end());
+	Randomness::shuffle(moves.begin(), moves.end());
 
 	for (const Move& move : moves)
 	{
@@ -81,124 +123,237 @@ bool PathingFI<This>::reached(Cell at) const
 	return (get(at) != uint16_t(-1));
 }
 
-void TileFloodfill::map(Cell index)
+TileFloodfill::TileFloodfill(const Bible& bible, Board& board,
+		const Filter& filter) :
+	PathingFI(bible, board),
+	_filter(filter)
 {
-	TileType tiletype = _board.tile(index).type;
-
-	// TODO unnecessary?
-	if (tiletype == TileType::NONE) return;
-
-	Player tileowner = _board.tile(index).owner;
-	bool playerfound = (std::find(_players.begin(), _players.end(), tileowner)
-		!= _players.end());
-	if (_excludePlayers && playerfound) return;
-	if (!_excludePlayers && !playerfound) return;
+	_air = filter.air;
+}
 
-	bool typefound = (std::find(_types.begin(), _types.end(), tiletype)
-		!= _types.end());
-	if (_excludeTypes && typefound) return;
-	if (!_excludeTypes && !typefound) return;
+void TileFloodfill::map()
+{
+	const Bitboards& bitboards = _board.bitboards();
 
-	if (_excludeOccupied)
+	Bitboard candidates;
+	if (_filter.excludeTypes)
 	{
-		UnitType unittype = _board.ground(index).type;
-		if (unittype != UnitType::NONE
-			&& _board.ground(index).owner != tileowner
-			&& _bible.unitCanOccupy(unittype)) return;
+		for (size_t i = 0; i < TILETYPE_SIZE; i++)
+		{
+			TileType tiletype = (TileType) i;
+			if (std::find(_filter.types.begin(), _filter.types.end(),
+					tiletype) != _filter.types.end()) continue;
+			candidates |= bitboards.tiles(tiletype);
+		}
+	}
+	else
+	{
+		for (const TileType& tiletype : _filter.types)
+		{
+			candidates |= bitboards.tiles(tiletype);
+		}
 	}
 
-
-	if (_includeOccupied)
+	Bitboard owned;
+	for (const Player& player : _filter.players)
 	{
-		UnitType unittype = _board.ground(index).type;
-		if (unittype == UnitType::NONE
-			|| _board.ground(index).owner == tileowner
-			|| !(_bible.unitCanOccupy(unittype))) return;
+		owned |= bitboards.tilesOwnedBy(player);
 	}
+	if (_filter.excludePlayers) candidates -= owned;
+	else candidates &= owned;
+
+	candidates.forEach([this](int r, int c) {
+
+		Cell index = _board.cell(Position(r, c));
+
+		if (_filter.excludeOccupied)
+		{
+			UnitType unittype = _board.ground(index).type;
+			if (unittype != UnitType::NONE
+				&& _board.ground(index).owner != _board.tile(index).owner
+				&& _bible.unitCanOccupy(unittype)) return;
+		}
+
+		if (_filter.includeOccupied)
+		{
+			UnitType unittype = _board.ground(index).type;
+			if (unittype == UnitType::NONE
+				|| _board.ground(index).owner == _board.tile(index).owner
+				|| !(_bible.unitCanOccupy(unittype))) return;
+		}
 
-	put(index);
+		put(index);
+	});
 }
 
 void TileFloodfill::include(std::vector<Player> players)
 {
-	_players = players;
-	_excludePlayers = false;
+	_filter.include(players);
 }
 
 void TileFloodfill::exclude(std::vector<Player> players)
 {
-	_players = players;
-	_excludePlayers = true;
+	_filter.exclude(players);
 }
 
 void TileFloodfill::include(std::vector<TileType> types)
 {
-	_types = types;
-	_excludeTypes = false;
+	_filter.include(types);
 }
 
 void TileFloodfill::exclude(std::vector<TileType> types)
 {
-	_types = types;
-	_excludeTypes = true;
+	_filter.exclude(types);
 }
 
 void TileFloodfill::excludeOccupied(bool exclude)
 {
-	_excludeOccupied = exclude;
+	_filter.excludeOccupied = exclude;
 }
 
 void TileFloodfill::includeOccupied(bool include)
 {
-	_includeOccupied = include;
+	_filter.includeOccupied = include;
+}
+
+TileFloodfill::Filter TileFloodfill::filter() const
+{
+	Filter result = _filter;
+	result.air = _air;
+	return result;
 }
 
-void UnitFloodfill::map(Cell index)
+void TileFloodfill::Filter::include(std::vector<Player> newplayers)
 {
+	players = newplayers;
+	excludePlayers = false;
+}
+
+void TileFloodfill::Filter::exclude(std::vector<Player> newplayers)
+{
+	players = newplayers;
+	excludePlayers = true;
+}
+
+void TileFloodfill::Filter::include(std::vector<TileType> newtypes)
+{
+	types = newtypes;
+	excludeTypes = false;
+}
+
+void TileFloodfill::Filter::exclude(std::vector<TileType> newtypes)
+{
+	types = newtypes;
+	excludeTypes = true;
+}
+
+bool TileFloodfill::Filter::operator<(const Filter& other) const
+{
+	return std::tie(players, types, excludePlayers, excludeTypes,
+			excludeOccupied, includeOccupied, air)
+		< std::tie(other.players, other.types,
+			other.excludePlayers, other.excludeTypes,
+			other.excludeOccupied, other.includeOccupied, other.air);
+}
+
+UnitFloodfill::UnitFloodfill(const Bible& bible, Board& board,
+		const Filter& filter) :
+	PathingFI(bible, board),
+	_filter(filter)
+{
+	_air = filter.air;
+}
+
+void UnitFloodfill::map()
+{
+	const Bitboards& bitboards = _board.bitboards();
+
+	Bitboard candidates = (_air) ? bitboards.air() : bitboards.ground();
+
+	Bitboard owned;
+	for (const Player& player : _filter.players)
+	{
+		owned |= (_air)
+			? bitboards.airOwnedBy(player)
+			: bitboards.groundOwnedBy(player);
+	}
+	if (_filter.excludePlayers) candidates -= owned;
+	else candidates &= owned;
+
 	Descriptor::Type desctype = (_air)
 		? Descriptor::Type::AIR
 		: Descriptor::Type::GROUND;
-	UnitType unittype = _board.unit(index, desctype).type;
-
-	// TODO unnecessary?
-	if (unittype == UnitType::NONE) return;
+	const std::vector<UnitType>& types = _filter.types;
 
-	Player unitowner = _board.unit(index, desctype).owner;
-	bool playerfound = (std::find(_players.begin(), _players.end(), unitowner)
-		!= _players.end());
-	if (_excludePlayers && playerfound) return;
-	if (!_excludePlayers && !playerfound) return;
+	candidates.forEach([&](int r, int c) {
 
-	bool typefound = (std::find(_types.begin(), _types.end(), unittype)
-		!= _types.end());
-	if (_excludeTypes && typefound) return;
-	if (!_excludeTypes && !typefound) return;
+		Cell index = _board.cell(Position(r, c));
+		UnitType unittype = _board.unit(index, desctype).type;
+		bool typefound = (std::find(types.begin(), types.end(), unittype)
+			!= types.end());
+		if (_filter.excludeTypes && typefound) return;
+		if (!_filter.excludeTypes && !typefound) return;
 
-	put(index);
+		put(index);
+	});
 }
 
 void UnitFloodfill::include(std::vector<Player> players)
 {
-	_players = players;
-	_excludePlayers = false;
+	_filter.include(players);
 }
 
 void UnitFloodfill::exclude(std::vector<Player> players)
 {
-	_players = players;
-	_excludePlayers = true;
+	_filter.exclude(players);
 }
 
 void UnitFloodfill::include(std::vector<UnitType> types)
 {
-	_types = types;
-	_excludeTypes = false;
+	_filter.include(types);
 }
 
 void UnitFloodfill::exclude(std::vector<UnitType> types)
 {
-	_types = types;
-	_excludeTypes = true;
+	_filter.exclude(types);
+}
+
+UnitFloodfill::Filter UnitFloodfill::filter() const
+{
+	Filter result = _filter;
+	result.air = _air;
+	return result;
+}
+
+void UnitFloodfill::Filter::include(std::vector<Player> newplayers)
+{
+	players = newplayers;
+	excludePlayers = false;
+}
+
+void UnitFloodfill::Filter::exclude(std::vector<Player> newplayers)
+{
+	players = newplayers;
+	excludePlayers = true;
+}
+
+void UnitFloodfill::Filter::include(std::vector<UnitType> newtypes)
+{
+	types = newtypes;
+	excludeTypes = false;
+}
+
+void UnitFloodfill::Filter::exclude(std::vector<UnitType> newtypes)
+{
+	types = newtypes;
+	excludeTypes = true;
+}
+
+bool UnitFloodfill::Filter::operator<(const Filter& other) const
+{
+	return std::tie(players, types, excludePlayers, excludeTypes, air)
+		< std::tie(other.players, other.types,
+			other.excludePlayers, other.excludeTypes, other.air);
 }
 
 template class PathingFI<PathingFloodfill>;
@@ -32,6 +32,9 @@ class Board;
 
 
 // PathingFloodfillImplementation has 3 realizations.
+// Instead of flooding one cell at a time, it uses the Board's bitboards to
+// grow the entire frontier by one step at a time, and it maps its sources by
+// selecting them from the bitboards as well.
 template <class This>
 class PathingFI : public Floodfill<PathingFI<This>>
 {
@@ -41,16 +44,19 @@ public:
 protected:
 	bool _air = false;
 
-	void map(Cell index)
+	void map()
 	{
-		static_cast<This*>(this)->map(index);
+		static_cast<This*>(this)->map();
 	}
-	void flood(Cell index);
-	void reduce(Cell /**/) {}
+	void fill();
 
 	friend Floodfill<PathingFI<This>>;
 	using  Floodfill<PathingFI<This>>::_bible;
 	using  Floodfill<PathingFI<This>>::_board;
+	using  Floodfill<PathingFI<This>>::_marks;
+	using  Floodfill<PathingFI<This>>::_queue;
+	using  Floodfill<PathingFI<This>>::_head;
+	using  Floodfill<PathingFI<This>>::_size;
 	using  Floodfill<PathingFI<This>>::put;
 	using  Floodfill<PathingFI<This>>::get;
 
@@ -58,6 +64,12 @@ public:
 	void walk() { _air = false; }
 	void fly() { _air = true; }
 
+	void execute()
+	{
+		map();
+		fill();
+	}
+
 	Move step(Cell from) const;
 	uint16_t steps(Cell index) const;
 	bool reached(Cell index) const;
@@ -71,7 +83,7 @@ public:
 private:
 	friend PathingFI;
 
-	void map(Cell /**/) {}
+	void map() {}
 
 public:
 	void put(Cell at)
@@ -83,19 +95,36 @@ public:
 class TileFloodfill : public PathingFI<TileFloodfill>
 {
 public:
+	// The Filter determines which tiles are sources of the floodfill.
+	// Two floodfills on the same board with equal filters are identical.
+	struct Filter
+	{
+		std::vector<Player> players;
+		std::vector<TileType> types;
+		bool excludePlayers = true;
+		bool excludeTypes = true;
+		bool excludeOccupied = false;
+		bool includeOccupied = false;
+		bool air = false;
+
+		void include(std::vector<Player> players);
+		void exclude(std::vector<Player> players);
+		void include(std::vector<TileType> types);
+		void exclude(std::vector<TileType> types);
+
+		bool operator<(const Filter& other) const;
+	};
+
 	using PathingFI::PathingFI;
 
+	TileFloodfill(const Bible& bible, Board& board, const Filter& filter);
+
 private:
-	std::vector<Player> _players;
-	std::vector<TileType> _types;
-	bool _excludePlayers = true;
-	bool _excludeTypes = true;
-	bool _excludeOccupied = false;
-	bool _includeOccupied = false;
+	Filter _filter;
 
 	friend PathingFI;
 
-	void map(Cell index);
+	void map();
 
 public:
 	void include(std::vector<Player> players);
@@ -104,26 +133,47 @@ public:
 	void exclude(std::vector<TileType> types);
 	void excludeOccupied(bool exclude = true);
 	void includeOccupied(bool include = true);
+
+	Filter filter() const;
 };
 
 class UnitFloodfill : public PathingFI<UnitFloodfill>
 {
 public:
+	// The Filter determines which units are sources of the floodfill.
+	// Two floodfills on the same board with equal filters are identical.
+	struct Filter
+	{
+		std::vector<Player> players;
+		std::vector<UnitType> types;
+		bool excludePlayers = true;
+		bool excludeTypes = true;
+		bool air = false;
+
+		void include(std::vector<Player> players);
+		void exclude(std::vector<Player> players);
+		void include(std::vector<UnitType> types);
+		void exclude(std::vector<UnitType> types);
+
+		bool operator<(const Filter& other) const;
+	};
+
 	using PathingFI::PathingFI;
 
+	UnitFloodfill(const Bible& bible, Board& board, const Filter& filter);
+
 private:
-	std::vector<Player> _players;
-	std::vector<UnitType> _types;
-	bool _excludePlayers = true;
-	bool _excludeTypes = true;
+	Filter _filter;
 
 	friend PathingFI;
 
-	void map(Cell index);
+	void map();
 
 public:
 	void include(std::vector<Player> players);
 	void exclude(std::vector<Player> players);
 	void include(std::vector<UnitType> types);
 	void exclude(std::vector<UnitType> types);
+
+	Filter filter() const;
 };
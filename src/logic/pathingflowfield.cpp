@@ -25,12 +25,13 @@
 #include "source.hpp"
 
 #include "bible.hpp"
+#include "randomness.hpp"
 
 
 void PathingFlowfield::flood(Cell from)
 {
 	std::vector<Move> moves = {Move::E, Move::S, Move::W, Move::N};
-	std::random_shuffle(moves.begin(), moves.end());
+	Randomness::shuffle(moves.begin(), moves.end());
 	for (const Move& move : moves)
 	{
 		Cell to = from + move;
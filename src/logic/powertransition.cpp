@@ -28,6 +28,7 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
 
 
 constexpr PowerTransition::Stage PowerTransition::stages[];
@@ -54,6 +55,8 @@ PowerTransition::PowerTransition(const Bible& bible, Board& board,
 
 void PowerTransition::execute()
 {
+	PROFILE_ZONE("PowerTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -28,6 +28,7 @@
 #include "changeset.hpp"
 #include "randomizer.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
 
 
 RadiationTransition::RadiationTransition(Board& board, ChangeSet& changeset) :
@@ -38,6 +39,8 @@ RadiationTransition::RadiationTransition(Board& board, ChangeSet& changeset) :
 
 void RadiationTransition::execute()
 {
+	PROFILE_ZONE("RadiationTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -34,6 +34,7 @@
 
 
 static std::mutex _recordingsmutex;
+static std::mutex _localtimemutex;
 
 std::string Recording::_recordingsfolder = "recordings/";
 std::string Recording::_historyfilename = "recordings/history.list";
@@ -72,6 +73,11 @@ std::string Recording::filename(const std::string& name)
 	return _recordingsfolder + name + ".rec";
 }
 
+std::string Recording::indexfilename(const std::string& name)
+{
+	return _recordingsfolder + name + ".rix";
+}
+
 void Recording::start()
 {
 	static uint64_t counter = EpochClock::milliseconds();
@@ -112,7 +118,12 @@ void Recording::addMetadata(Json::Value& metadata)
 
 	time_t currenttime;
 	std::time(&currenttime);
-	std::string timestamp = std::asctime(std::localtime(&currenttime));
+	std::string timestamp;
+	{
+		// Both functions return a pointer to a buffer shared by all threads.
+		std::lock_guard<std::mutex> lock(_localtimemutex);
+		timestamp = std::asctime(std::localtime(&currenttime));
+	}
 	timestamp.resize(timestamp.size() - 1);
 	metadata["localtime"] = timestamp;
 }
@@ -49,6 +49,7 @@ public:
 	const std::string& filename() const { return _filename; }
 
 	static std::string filename(const std::string& name);
+	static std::string indexfilename(const std::string& name);
 
 	explicit operator bool() const { return !_name.empty(); }
 
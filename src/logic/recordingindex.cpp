@@ -0,0 +1,180 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "recordingindex.hpp"
+#include "source.hpp"
+
+#include "recording.hpp"
+#include "system.hpp"
+
+
+/*
+The index file has the following layout, with all integers little endian:
+
+	u8 VERSION, u32 interval, u64 recordingsize, u32 count,
+	count times { u32 round, u32 linenumber, u64 offset, u32 length,
+		length bytes of binary changeset }
+
+The size of the recording is stored so that we can detect and discard an
+index that was made while the recording was still being written.
+*/
+
+static constexpr uint8_t RECORDINGINDEX_VERSION = 1;
+
+template <typename T>
+static void putIndexInteger(std::string& buffer, T value)
+{
+	for (size_t i = 0; i < sizeof(T); i++)
+	{
+		buffer.push_back((char) ((value >> (8 * i)) & 0xFF));
+	}
+}
+
+template <typename T>
+static bool takeIndexInteger(const std::string& buffer, size_t& cursor,
+	T& value)
+{
+	if (cursor + sizeof(T) > buffer.size()) return false;
+	value = 0;
+	for (size_t i = 0; i < sizeof(T); i++)
+	{
+		value |= ((T) (uint8_t) buffer[cursor + i]) << (8 * i);
+	}
+	cursor += sizeof(T);
+	return true;
+}
+
+RecordingIndex::RecordingIndex(uint32_t interval) :
+	_interval(interval)
+{}
+
+uint64_t RecordingIndex::sizeOf(const Recording& recording)
+{
+	std::ifstream file = System::ifstream(recording.filename(),
+		std::ifstream::in | std::ifstream::binary);
+	if (!file) return 0;
+	file.seekg(0, std::ifstream::end);
+	return file.tellg();
+}
+
+void RecordingIndex::add(Entry entry)
+{
+	DEBUG_ASSERT(_entries.empty() || _entries.back().round < entry.round);
+	_entries.emplace_back(std::move(entry));
+}
+
+const RecordingIndex::Entry* RecordingIndex::find(uint32_t round) const
+{
+	// The entries are sorted by round.
+	auto iter = std::upper_bound(_entries.begin(), _entries.end(), round,
+		[](uint32_t r, const Entry& entry) {
+
+		return r < entry.round;
+	});
+	if (iter == _entries.begin()) return nullptr;
+	return &*(iter - 1);
+}
+
+bool RecordingIndex::load(const Recording& recording)
+{
+	std::string filename = Recording::indexfilename(recording.name());
+	std::ifstream file = System::ifstream(filename,
+		std::ifstream::in | std::ifstream::binary);
+	if (!file) return false;
+
+	std::string buffer((std::istreambuf_iterator<char>(file)),
+		std::istreambuf_iterator<char>());
+	size_t cursor = 0;
+
+	uint8_t version;
+	uint32_t count;
+	if (!takeIndexInteger(buffer, cursor, version)
+		|| version != RECORDINGINDEX_VERSION
+		|| !takeIndexInteger(buffer, cursor, _interval)
+		|| !takeIndexInteger(buffer, cursor, _recordingsize)
+		|| !takeIndexInteger(buffer, cursor, count))
+	{
+		LOGW << "Failed to parse '" << filename << "'";
+		_entries.clear();
+		return false;
+	}
+
+	if (_recordingsize != sizeOf(recording))
+	{
+		LOGW << "Ignoring outdated '" << filename << "'";
+		_entries.clear();
+		return false;
+	}
+
+	_entries.clear();
+	_entries.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		Entry entry;
+		uint32_t length;
+		if (!takeIndexInteger(buffer, cursor, entry.round)
+			|| !takeIndexInteger(buffer, cursor, entry.linenumber)
+			|| !takeIndexInteger(buffer, cursor, entry.offset)
+			|| !takeIndexInteger(buffer, cursor, length)
+			|| cursor + length > buffer.size())
+		{
+			LOGW << "Failed to parse '" << filename << "'";
+			_entries.clear();
+			return false;
+		}
+		entry.snapshot = buffer.substr(cursor, length);
+		cursor += length;
+		_entries.emplace_back(std::move(entry));
+	}
+
+	return true;
+}
+
+bool RecordingIndex::save(const Recording& recording)
+{
+	_recordingsize = sizeOf(recording);
+
+	std::string buffer;
+	putIndexInteger(buffer, RECORDINGINDEX_VERSION);
+	putIndexInteger(buffer, _interval);
+	putIndexInteger(buffer, _recordingsize);
+	putIndexInteger(buffer, (uint32_t) _entries.size());
+	for (const Entry& entry : _entries)
+	{
+		putIndexInteger(buffer, entry.round);
+		putIndexInteger(buffer, entry.linenumber);
+		putIndexInteger(buffer, entry.offset);
+		putIndexInteger(buffer, (uint32_t) entry.snapshot.size());
+		buffer.append(entry.snapshot);
+	}
+
+	std::string filename = Recording::indexfilename(recording.name());
+	std::ofstream file = System::ofstream(filename,
+		std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+	if (!file || !file.write(buffer.data(), buffer.size()))
+	{
+		LOGW << "Failed to write '" << filename << "'";
+		return false;
+	}
+	return true;
+}
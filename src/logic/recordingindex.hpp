@@ -0,0 +1,74 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+class Recording;
+
+
+// A sidecar file next to a recording that allows replays to jump to a round
+// without reenacting every changeset before it. Every so many rounds it
+// stores a snapshot of the game state (as a binary changeset that recreates
+// that state when enacted on an empty board) and the position in the
+// recording of the changeset that follows it.
+class RecordingIndex
+{
+public:
+	struct Entry
+	{
+		uint32_t round;
+		uint32_t linenumber;
+		uint64_t offset;
+		std::string snapshot;
+	};
+
+	RecordingIndex() = default;
+	explicit RecordingIndex(uint32_t interval);
+
+	RecordingIndex(const RecordingIndex&) = delete;
+	RecordingIndex(RecordingIndex&&) = default;
+	RecordingIndex& operator=(const RecordingIndex&) = delete;
+	RecordingIndex& operator=(RecordingIndex&&) = default;
+	~RecordingIndex() = default;
+
+private:
+	uint32_t _interval = 0;
+	uint64_t _recordingsize = 0;
+	std::vector<Entry> _entries;
+
+	static uint64_t sizeOf(const Recording& recording);
+
+public:
+	uint32_t interval() const { return _interval; }
+
+	bool empty() const { return _entries.empty(); }
+
+	void add(Entry entry);
+
+	// The last entry at or before the given round, or nullptr if none.
+	const Entry* find(uint32_t round) const;
+
+	bool load(const Recording& recording);
+	bool save(const Recording& recording);
+};
@@ -25,6 +25,7 @@
 #include "source.hpp"
 
 #include "recording.hpp"
+#include "binarychangeset.hpp"
 #include "system.hpp"
 
 
@@ -32,8 +33,18 @@ RecordingIterator::RecordingIterator(
 		const TypeNamer& typenamer, const Recording& recording) :
 	_typenamer(typenamer),
 	_name(recording.name()),
-	_file(System::ifstream(recording.filename())),
-	_linenumber(0)
+	_filename(recording.filename()),
+	// Binary mode, because we need exact offsets for seek() and because the
+	// metadata line might be followed by binary frames.
+	_file(System::ifstream(_filename,
+		std::ifstream::in | std::ifstream::binary)),
+	_linenumber(0),
+	_offset(0),
+	_valid(false),
+	_prehistoric(false),
+	_binary(false),
+	_bufferstart(0),
+	_cursor(0)
 {
 	if (!_file) return;
 
@@ -44,11 +55,24 @@ RecordingIterator::RecordingIterator(
 		return;
 	}
 
+	_valid = true;
+
 	// Pre-historic recording?
 	if (!_json.isObject())
 	{
+		_prehistoric = true;
 		_changeset = ChangeSet(_typenamer, _json);
 	}
+	else if (_json["changeset-format"].isString()
+		&& _json["changeset-format"].asString() == "binary")
+	{
+		_bufferstart = _file.tellg();
+		_buffer.assign(std::istreambuf_iterator<char>(_file),
+			std::istreambuf_iterator<char>());
+		_file.close();
+		_binary = true;
+		++(*this);
+	}
 	else
 	{
 		++(*this);
@@ -59,12 +83,55 @@ RecordingIterator::~RecordingIterator() = default;
 
 RecordingIterator& RecordingIterator::operator++()
 {
-	if (!_file) return *this;
+	if (!_valid) return *this;
+
+	if (_binary)
+	{
+		_offset = _bufferstart + _cursor;
+
+		if (_cursor + 4 > _buffer.size())
+		{
+			_valid = false;
+			return *this;
+		}
+
+		const uint8_t* header = (const uint8_t*) _buffer.data() + _cursor;
+		size_t length = ((uint32_t) header[0])
+			| (((uint32_t) header[1]) << 8)
+			| (((uint32_t) header[2]) << 16)
+			| (((uint32_t) header[3]) << 24);
+		if (_cursor + 4 + length > _buffer.size())
+		{
+			LOGW << "Truncated frame in binary recording " << _name;
+			_valid = false;
+			return *this;
+		}
+
+		BinaryChangeSet::Reader reader(_buffer.data() + _cursor + 4, length);
+		if (!reader.collect(_changeset))
+		{
+			LOGW << "Malformed frame in binary recording " << _name;
+			_valid = false;
+			return *this;
+		}
+
+		_cursor += 4 + length;
+		++_linenumber;
+		return *this;
+	}
+
+	if (!_file || _prehistoric)
+	{
+		_valid = false;
+		return *this;
+	}
+
+	_offset = _file.tellg();
 
 	if (!std::getline(_file, _line) || !_reader.parse(_line, _json)
 		|| !_json.isArray())
 	{
-		_file.close();
+		_valid = false;
 		return *this;
 	}
 
@@ -73,3 +140,33 @@ RecordingIterator& RecordingIterator::operator++()
 
 	return *this;
 }
+
+bool RecordingIterator::seek(size_t offset, size_t linenumber)
+{
+	if (_prehistoric || linenumber == 0) return false;
+
+	if (_binary)
+	{
+		if (offset < _bufferstart || offset > _bufferstart + _buffer.size())
+		{
+			return false;
+		}
+		_cursor = offset - _bufferstart;
+	}
+	else
+	{
+		if (!_file.is_open())
+		{
+			_file = System::ifstream(_filename,
+				std::ifstream::in | std::ifstream::binary);
+		}
+		// The previous read might have hit the end of the file.
+		_file.clear();
+		if (!_file.seekg(offset)) return false;
+	}
+
+	_valid = true;
+	_linenumber = linenumber - 1;
+	++(*this);
+	return _valid;
+}
@@ -46,13 +46,24 @@ public:
 private:
 	const TypeNamer& _typenamer;
 	std::string _name;
+	std::string _filename;
 	std::ifstream _file;
 	size_t _linenumber;
+	size_t _offset;
+	bool _valid;
+	bool _prehistoric;
 
 	Json::Reader _reader;
 	Json::Value _json;
 	std::string _line;
 
+	// Binary recordings are read into memory in their entirety after the
+	// metadata line, and then decoded one frame at a time.
+	bool _binary;
+	std::string _buffer;
+	size_t _bufferstart; // (the offset of the buffer in the file)
+	size_t _cursor; // (the position of the next frame in the buffer)
+
 	ChangeSet _changeset;
 
 public:
@@ -63,10 +74,17 @@ public:
 
 	explicit operator bool() const
 	{
-		return _file.is_open();
+		return _valid;
 	}
 
 	RecordingIterator& operator++();
 
 	size_t linenumber() const { return _linenumber; }
+
+	// The offset in the file at which the current changeset starts.
+	size_t offset() const { return _offset; }
+
+	// Continue from a changeset whose offset and linenumber were obtained
+	// from an earlier iterator over the same recording.
+	bool seek(size_t offset, size_t linenumber);
 };
@@ -51,18 +51,6 @@ private:
 
 	Position _position;
 
-	int8_t _temperature = 0;
-	int8_t _humidity = 0;
-	int8_t _chaos = 0;
-	int8_t _gas = 0;
-	int8_t _radiation = 0;
-
-	bool _snow = false;
-	bool _frostbite = false;
-	bool _firestorm = false;
-	bool _bonedrought = false;
-	bool _death = false;
-
 	TileTokenWithId _tile;
 	UnitTokenWithId _ground;
 	UnitTokenWithId _air;
@@ -76,30 +64,6 @@ public:
 
 	const Position& position() const { return _position; }
 
-	int8_t temperature() const { return _temperature; }
-	int8_t humidity()    const { return _humidity;    }
-	int8_t chaos()       const { return _chaos;       }
-	int8_t gas()         const { return _gas;         }
-	int8_t radiation()   const { return _radiation;   }
-
-	int8_t& temperature() { return _temperature; }
-	int8_t& humidity()    { return _humidity;    }
-	int8_t& chaos()       { return _chaos;       }
-	int8_t& gas()         { return _gas;         }
-	int8_t& radiation()   { return _radiation;   }
-
-	bool snow()        const { return _snow;        }
-	bool frostbite()   const { return _frostbite;   }
-	bool firestorm()   const { return _firestorm;   }
-	bool bonedrought() const { return _bonedrought; }
-	bool death()       const { return _death;       }
-
-	bool& snow()        { return _snow;        }
-	bool& frostbite()   { return _frostbite;   }
-	bool& firestorm()   { return _firestorm;   }
-	bool& bonedrought() { return _bonedrought; }
-	bool& death()       { return _death;       }
-
 	const TileTokenWithId& tile()   const { return _tile;   }
 	const UnitTokenWithId& ground() const { return _ground; }
 	const UnitTokenWithId& air()    const { return _air;    }
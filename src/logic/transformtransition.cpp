@@ -28,6 +28,8 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
+#include "randomness.hpp"
 
 
 TransformTransition::TransformTransition(const Bible& bible, Board& board,
@@ -48,6 +50,8 @@ TransformTransition::TransformTransition(const Bible& bible, Board& board,
 
 void TransformTransition::execute()
 {
+	PROFILE_ZONE("TransformTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
@@ -106,7 +110,8 @@ void TransformTransition::map(Cell index)
 		{
 			// Probability 50%.
 			int divisor = _bible.tileRegrowthProbabilityDivisor(tiletype);
-			if (divisor >= 0 && (divisor <= 1 || (rand() % divisor) == 0))
+			if (divisor >= 0
+				&& (divisor <= 1 || (Randomness::next() % divisor) == 0))
 			{
 				TileToken newtoken = tiletoken;
 				int amount = _bible.tileRegrowthAmount(tiletype);
@@ -121,7 +126,8 @@ void TransformTransition::map(Cell index)
 	{
 		// Probability 50%.
 		int divisor = _bible.tileRegrowthProbabilityDivisor(tiletype);
-		if (divisor >= 0 && (divisor <= 1 || (rand() % divisor) == 0))
+		if (divisor >= 0
+			&& (divisor <= 1 || (Randomness::next() % divisor) == 0))
 		{
 			TileToken newtoken;
 			newtoken.type = regrowntype;
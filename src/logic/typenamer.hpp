@@ -105,6 +105,22 @@ public:
 	{
 		return {(uint8_t) 1, (uint8_t) (_unittype_max + 1)};
 	}
+
+	// Whether the raw indices of tile and unit types mean the same thing.
+	bool sameTypesAs(const TypeNamer& other) const
+	{
+		if (_tiletype_max != other._tiletype_max) return false;
+		if (_unittype_max != other._unittype_max) return false;
+		for (size_t i = 1; i <= _tiletype_max; i++)
+		{
+			if (_tiletypes[i] != other._tiletypes[i]) return false;
+		}
+		for (size_t i = 1; i <= _unittype_max; i++)
+		{
+			if (_unittypes[i] != other._unittypes[i]) return false;
+		}
+		return true;
+	}
 };
 
 class TypeEncoder
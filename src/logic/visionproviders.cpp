@@ -0,0 +1,116 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "visionproviders.hpp"
+#include "source.hpp"
+
+#include "bible.hpp"
+#include "board.hpp"
+#include "tiletoken.hpp"
+#include "unittoken.hpp"
+
+
+void VisionProviders::reset()
+{
+	_providers.clear();
+	_counts.clear();
+}
+
+VisionProviders::Provider VisionProviders::provider(const Bible& bible,
+	const TileToken& tile)
+{
+	Provider result;
+	if (tile)
+	{
+		result.owner = tile.owner;
+		result.range = bible.tileVision(tile.type);
+	}
+	return result;
+}
+
+VisionProviders::Provider VisionProviders::provider(const Bible& bible,
+	const UnitToken& unit)
+{
+	Provider result;
+	if (unit)
+	{
+		result.owner = unit.owner;
+		result.range = bible.unitVision(unit.type);
+	}
+	return result;
+}
+
+void VisionProviders::paint(const Board& board, Cell from,
+	const Provider& provider, int delta)
+{
+	// Uncontrolled tiles and units do not give vision.
+	if (provider.owner == Player::NONE) return;
+
+	size_t owner = (size_t) provider.owner;
+	for (Cell to : board.area(from, 0, provider.range))
+	{
+		_counts[to.ix()][owner] += delta;
+	}
+}
+
+void VisionProviders::update(const Bible& bible, const Board& board,
+	Cell index)
+{
+	if (_providers.empty())
+	{
+		// The board has been resized, so we start counting from scratch.
+		size_t size = board.end().ix();
+		_providers.resize(size);
+		_counts.resize(size);
+	}
+
+	std::array<Provider, 4> current = {{
+		provider(bible, board.tile(index)),
+		provider(bible, board.ground(index)),
+		provider(bible, board.air(index)),
+		provider(bible, board.bypass(index)),
+	}};
+
+	std::array<Provider, 4>& recorded = _providers[index.ix()];
+	for (size_t i = 0; i < 4; i++)
+	{
+		if (current[i] == recorded[i]) continue;
+
+		paint(board, index, recorded[i], -1);
+		paint(board, index, current[i], +1);
+		recorded[i] = current[i];
+	}
+}
+
+Vision VisionProviders::vision(Cell index) const
+{
+	Vision vision = Vision::none();
+	if (_counts.empty()) return vision;
+
+	const std::array<uint16_t, PLAYER_SIZE>& counts = _counts[index.ix()];
+	for (size_t i = 0; i < PLAYER_SIZE; i++)
+	{
+		if (counts[i] > 0) vision.add((Player) i);
+	}
+	return vision;
+}
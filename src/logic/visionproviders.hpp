@@ -0,0 +1,80 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "cell.hpp"
+#include "player.hpp"
+#include "vision.hpp"
+
+class Bible;
+class Board;
+struct TileToken;
+struct UnitToken;
+
+
+// Keeps track of how many tiles and units provide vision of each cell to each
+// player, so that VisionTransition only has to repaint the vision areas of
+// providers that have appeared, moved, died or changed owner.
+class VisionProviders
+{
+public:
+	VisionProviders() = default;
+	VisionProviders(const VisionProviders&) = delete;
+	VisionProviders(VisionProviders&&) = delete;
+	VisionProviders& operator=(const VisionProviders&) = delete;
+	VisionProviders& operator=(VisionProviders&&) = delete;
+	~VisionProviders() = default;
+
+private:
+	struct Provider
+	{
+		Player owner = Player::NONE;
+		int8_t range = 0;
+
+		bool operator==(const Provider& other) const
+		{
+			return owner == other.owner && range == other.range;
+		}
+	};
+
+	// The providers in the tile, ground, air and bypass slots of each cell
+	// as they were when the counts were last updated.
+	std::vector<std::array<Provider, 4>> _providers;
+	std::vector<std::array<uint16_t, PLAYER_SIZE>> _counts;
+
+	static Provider provider(const Bible& bible, const TileToken& tile);
+	static Provider provider(const Bible& bible, const UnitToken& unit);
+
+	void paint(const Board& board, Cell from, const Provider& provider,
+		int delta);
+
+public:
+	void reset();
+
+	// Brings the counts up to date with the tile and units in this cell.
+	void update(const Bible& bible, const Board& board, Cell index);
+
+	Vision vision(Cell index) const;
+};
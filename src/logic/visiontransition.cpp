@@ -31,6 +31,7 @@
 #include "changeset.hpp"
 #include "tiletoken.hpp"
 #include "unittoken.hpp"
+#include "profiler.hpp"
 
  // windows.h is being annoying
 #undef near
@@ -43,13 +44,14 @@ VisionTMRI<This>::VisionTMRI(const Bible& bible, Board& board,
 	_bible(bible),
 	_board(board),
 	_info(info),
-	_changeset(changeset),
-	_results(_board.end().ix())
+	_changeset(changeset)
 {}
 
 template <class This>
 void VisionTMRI<This>::execute()
 {
+	_results.assign(_board.end().ix(), Vision::none());
+
 	// Map.
 	for (Cell index : _board)
 	{
@@ -64,7 +66,7 @@ void VisionTMRI<This>::execute()
 }
 
 template <class This>
-void VisionTMRI<This>::executeAround(Cell near, int range)
+int VisionTMRI<This>::mapRange(int range) const
 {
 	// We have a range R and a vision radius V. We want to calculate a value M
 	// such that d(a, b) <= M iff exists c with d(a, c) <= R and d(c, b) <= V
@@ -78,10 +80,16 @@ void VisionTMRI<This>::executeAround(Cell near, int range)
 	// which gives M = R + V + 2 * max(R, V).
 	// Also see Automaton::processMove for more algebra.
 	const int vmax = _bible.unitVisionMax();
-	const int emrange = range + vmax + 2 * std::max(range, vmax);
+	return range + vmax + 2 * std::max(range, vmax);
+}
+
+template <class This>
+void VisionTMRI<This>::executeAround(Cell near, int range)
+{
+	_results.assign(_board.end().ix(), Vision::none());
 
 	// Map.
-	for (Cell index : _board.area(near, 0, emrange))
+	for (Cell index : _board.area(near, 0, mapRange(range)))
 	{
 		map(index);
 	}
@@ -137,13 +145,51 @@ void VisionTMRI<This>::provider(Cell from, const UnitToken& unit)
 	}
 }
 
+void VisionTransition::execute()
+{
+	PROFILE_ZONE("VisionTransition::execute");
+
+	VisionProviders& providers = _board.visionProviders();
+
+	// Update the provider counts.
+	for (Cell index : _board)
+	{
+		providers.update(_bible, _board, index);
+	}
+
+	// Reduce.
+	for (Cell index : _board)
+	{
+		reduce(index);
+	}
+}
+
+void VisionTransition::executeAround(Cell near, int range)
+{
+	VisionProviders& providers = _board.visionProviders();
+
+	// Update the provider counts of every cell that might provide vision of
+	// the cells in range. Only providers that have changed since the last
+	// update are repainted.
+	for (Cell index : _board.area(near, 0, mapRange(range)))
+	{
+		providers.update(_bible, _board, index);
+	}
+
+	// Reduce.
+	for (Cell index : _board.area(near, 0, range))
+	{
+		reduce(index);
+	}
+}
+
 void VisionTransition::reduce(Cell index)
 {
 	// We will determine which players have vision of this space.
 	Vision sees = Vision::none();
 
 	// Get the players that have vision of this space.
-	sees.add(_results[index.ix()]);
+	sees.add(_board.visionProviders().vision(index));
 
 	// We reveal all tiles to all visionaries.
 	for (const Player& visionary : _info._visionaries)
@@ -52,6 +52,8 @@ protected:
 	ChangeSet& _changeset;
 	std::vector<Vision> _results;
 
+	int mapRange(int range) const;
+
 	void map(Cell index);
 	void reduce(Cell index)
 	{
@@ -66,6 +68,8 @@ public:
 	void executeAround(Cell near, int range);
 };
 
+// Unlike the other two, this realization does not map providers itself but
+// uses the provider counts kept by the Board, which it updates incrementally.
 class VisionTransition : public VisionTMRI<VisionTransition>
 {
 public:
@@ -75,6 +79,11 @@ private:
 	friend VisionTMRI;
 
 	void reduce(Cell index);
+
+public:
+	// hiding VisionTMRI::execute() and ::executeAround()
+	void execute();
+	void executeAround(Cell near, int range);
 };
 
 class InitialVisionTransition : public VisionTMRI<InitialVisionTransition>
@@ -29,6 +29,7 @@
 #include "board.hpp"
 #include "changeset.hpp"
 #include "cell.hpp"
+#include "profiler.hpp"
 
 
 WaterTransition::WaterTransition(const Bible& bible, Board& board,
@@ -45,6 +46,8 @@ WaterTransition::WaterTransition(const Bible& bible, Board& board,
 
 void WaterTransition::execute()
 {
+	PROFILE_ZONE("WaterTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
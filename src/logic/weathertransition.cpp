@@ -29,6 +29,7 @@
 #include "changeset.hpp"
 #include "cycle.hpp"
 #include "randomizer.hpp"
+#include "profiler.hpp"
 
 
 WeatherTransition::WeatherTransition(const Bible& bible, Board& board,
@@ -43,7 +44,9 @@ WeatherTransition::WeatherTransition(const Bible& bible, Board& board,
 		&& !_bible.counterBasedWeather()),
 	_emissions(0),
 	_gain(_board.end().ix(), 0),
-	_loss(_board.end().ix(), 0)
+	_loss(_board.end().ix(), 0),
+	_humidity(_board.end().ix(), 0),
+	_temperature(_board.end().ix(), 0)
 {
 	for (Cell index : _board)
 	{
@@ -104,11 +107,37 @@ WeatherTransition::WeatherTransition(const Bible& bible, Board& board,
 
 void WeatherTransition::execute()
 {
+	PROFILE_ZONE("WeatherTransition::execute");
+
 	for (Cell index : _board)
 	{
 		map(index);
 	}
 
+	// Neither change made in reduce() affects the other, so the humidity and
+	// temperature of all cells can be calculated in advance.
+	const Climate& climate = _board.climate();
+	size_t count = _board.end().ix();
+	Climate::moisten(climate.humidity.data(), _gain.data(), _loss.data(),
+		count, _bible.humidityMin(), _bible.humidityMax(),
+		_humidity.data());
+	if (!_bible.counterBasedWeather())
+	{
+		// Temperature gain is a combination of seasonal swing and global
+		// warming, both new chaos-based and old emission-based.
+		int base = _bible.seasonTemperatureSwing(_season);
+		int8_t factor = _bible.seasonGlobalWarmingFactor(_season);
+		if (_emissionbased)
+		{
+			int globalwarming = _emissions / _bible.emissionDivisor();
+			base += globalwarming * factor;
+		}
+		Climate::warm(climate.temperature.data(), climate.chaos.data(),
+			count, base, factor,
+			_bible.temperatureMin(), _bible.temperatureMax(),
+			_temperature.data());
+	}
+
 	for (Cell index : _board)
 	{
 		reduce(index);
@@ -198,16 +227,8 @@ void WeatherTransition::map(Cell index)
 
 void WeatherTransition::reduce(Cell index)
 {
-	// Calculate the humidity change.
-	int8_t humgain = _gain[index.ix()] - _loss[index.ix()];
-
-	// Make sure the humidity does not go out of bounds.
-	int8_t targethum = std::max((int) _bible.humidityMin(),
-		std::min((int) _board.humidity(index) + humgain,
-			(int) _bible.humidityMax()));
-	humgain = targethum - _board.humidity(index);
-
 	// Change the humidity unless trivial.
+	int8_t humgain = _humidity[index.ix()] - _board.humidity(index);
 	if (humgain)
 	{
 		Change change(Change::Type::HUMIDITY,
@@ -219,30 +240,8 @@ void WeatherTransition::reduce(Cell index)
 
 	if (_bible.counterBasedWeather()) return;
 
-	// Temperature gain is a combination of seasonal swing and global warming.
-	int tempgain = _bible.seasonTemperatureSwing(_season);
-
-	// New chaos-based global warming.
-	if (_board.chaos(index))
-	{
-		int chaos = _board.chaos(index);
-		tempgain += chaos * _bible.seasonGlobalWarmingFactor(_season);
-	}
-
-	// Old emission-based global warming.
-	if (_emissionbased)
-	{
-		int globalwarming = _emissions / _bible.emissionDivisor();
-		tempgain += globalwarming * _bible.seasonGlobalWarmingFactor(_season);
-	}
-
-	// Make sure the temperature does not go out of bounds.
-	int8_t targettemp = std::max((int) _bible.temperatureMin(),
-		std::min((int) _board.temperature(index) + tempgain,
-			(int) _bible.temperatureMax()));
-	tempgain =  targettemp - _board.temperature(index);
-
 	// Change the temperature unless trivial.
+	int8_t tempgain = _temperature[index.ix()] - _board.temperature(index);
 	if (tempgain)
 	{
 		Change change(Change::Type::TEMPERATURE,
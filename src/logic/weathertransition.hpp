@@ -54,6 +54,10 @@ private:
 	std::vector<uint8_t> _gain;
 	std::vector<uint8_t> _loss;
 
+	// The humidity and temperature that each cell will end up with.
+	std::vector<int8_t> _humidity;
+	std::vector<int8_t> _temperature;
+
 	void map(Cell index);
 	void reduce(Cell index);
 
@@ -32,9 +32,11 @@
 #include "cycle.hpp"
 #include "map.hpp"
 #include "aichallenge.hpp"
+#include "settings.hpp"
+#include "clock.hpp"
 
 
-HostedGame::HostedGame(Client& client,
+HostedGame::HostedGame(Client& client, const Settings& settings,
 		std::shared_ptr<Challenge> challenge,
 		const std::vector<Player>& colors,
 		const std::vector<VisionType>& visiontypes,
@@ -46,7 +48,9 @@ HostedGame::HostedGame(Client& client,
 	_automaton(colors, rulesetname),
 	_usernames(usernames),
 	_hasObservers(hasObservers),
-	_phase(Phase::GROWTH)
+	_phase(Phase::GROWTH),
+	_botdeadline(std::max(0, settings.botDeadline.value())),
+	_ordersdue(0)
 {
 	Json::Value metadata = Map::loadMetadata(mapname);
 	metadata["map"] = mapname;
@@ -94,7 +98,8 @@ HostedGame::HostedGame(Client& client,
 				json["authors"] = ai->authors();
 				metadata["bots"].append(json);
 			}
-			_bots.emplace_back(std::move(ai));
+			_bots.emplace_back();
+			_bots.back().ai = std::move(ai);
 		}
 	}
 
@@ -116,14 +121,29 @@ HostedGame::HostedGame(Client& client,
 
 	bool shufflePlayers = !challenge;
 	_automaton.load(mapname, shufflePlayers);
+	if (settings.changesetFormat.defined())
+	{
+		metadata["changeset-format"] = settings.changesetFormat.value();
+	}
 	_automaton.startRecording(metadata);
 }
 
 void HostedGame::broadcast(const ChangeSet& changeset)
 {
-	for (auto& ai : _bots)
+	for (HostedBot& bot : _bots)
 	{
-		ai->receiveChanges(changeset.get(ai->player()));
+		if (isPlanning(bot))
+		{
+			bot.backlog.emplace_back(changeset.get(bot.ai->player()));
+			continue;
+		}
+
+		for (const auto& changes : bot.backlog)
+		{
+			bot.ai->receiveChanges(changes);
+		}
+		bot.backlog.clear();
+		bot.ai->receiveChanges(changeset.get(bot.ai->player()));
 	}
 
 	for (const Player& player : _usernamecolors)
@@ -131,7 +151,7 @@ void HostedGame::broadcast(const ChangeSet& changeset)
 		Json::Value forwarding = Json::objectValue;
 		forwarding["player"] = ::stringify(player);
 		_client.send(Message::change(_automaton.bible(),
-			changeset.get(player), forwarding));
+			changeset.view(player), forwarding));
 	}
 
 	if (_hasObservers)
@@ -140,7 +160,7 @@ void HostedGame::broadcast(const ChangeSet& changeset)
 		Json::Value forwarding = Json::objectValue;
 		forwarding["player"] = ::stringify(player);
 		_client.send(Message::change(_automaton.bible(),
-			changeset.get(player), forwarding));
+			changeset.view(player), forwarding));
 	}
 }
 
@@ -197,17 +217,8 @@ void HostedGame::sync()
 			_phase = Phase::PLANNING;
 			LOGV << "Entered " << _phase << " phase";
 
-			// Allow the bots to calculate their next move.
-			// Do this right after we have synced with the server, because
-			// we want to minimize the delay between when the server decides
-			// that the planning phase has ended and us confirming it.
-			for (auto& ai : _bots)
-			{
-				if (!_automaton.defeated(ai->player()))
-				{
-					ai->prepareOrders();
-				}
-			}
+			// Allow the bots to calculate their next move in the background.
+			startPlanning();
 		}
 		break;
 		case Phase::PLANNING:
@@ -220,21 +231,19 @@ void HostedGame::sync()
 			_phase = Phase::STAGING;
 			LOGV << "Entered " << _phase << " phase";
 
-			// Lock in the bots' orders.
-			// Do this right after we have synced with the server, because
-			// we want to minimize the delay between when the server decides
-			// that the staging phase has ended and us confirming it.
-			for (auto& ai : _bots)
-			{
-				if (!_automaton.defeated(ai->player()))
-				{
-					_automaton.receive(ai->player(), ai->orders());
-				}
-			}
+			// Lock in the bots' orders as they come in during update().
+			// Do not wait for them here, because we want to minimize the
+			// delay between when the server decides that the staging phase
+			// has ended and us confirming it.
+			_ordersdue = SteadyClock::milliseconds() + _botdeadline;
+			collectOrders(false);
 		}
 		break;
 		case Phase::STAGING:
 		{
+			// Bots that are still planning have run out of time.
+			collectOrders(true);
+
 			broadcast(_automaton.prepare());
 
 			_client.send(Message::host_sync());
@@ -253,11 +262,85 @@ void HostedGame::sync()
 	}
 }
 
-void HostedGame::receiveOrders(const Json::Value& json,
-	const Json::Value& forwarding)
+bool HostedGame::isPlanning(HostedBot& bot)
+{
+	if (!bot.planning.valid()) return false;
+
+	if (bot.planning.wait_for(std::chrono::seconds(0))
+		!= std::future_status::ready)
+	{
+		return true;
+	}
+
+	// This rethrows any exception that was thrown while planning.
+	bot.planning.get();
+	return false;
+}
+
+void HostedGame::startPlanning()
+{
+	for (HostedBot& bot : _bots)
+	{
+		if (_automaton.defeated(bot.ai->player())) continue;
+
+		if (isPlanning(bot))
+		{
+			LOGW << "Bot " << bot.ai->player() << " is still planning"
+				" the previous turn";
+			continue;
+		}
+
+		// The backlog has to be received before the bot starts planning.
+		for (const auto& changes : bot.backlog)
+		{
+			bot.ai->receiveChanges(changes);
+		}
+		bot.backlog.clear();
+
+		AICommander* ai = bot.ai.get();
+		bot.planning = std::async(std::launch::async, [ai]() {
+
+			ai->prepareOrders();
+		});
+		bot.planned = true;
+	}
+}
+
+void HostedGame::update()
+{
+	if (_phase == Phase::STAGING)
+	{
+		collectOrders(SteadyClock::milliseconds() >= _ordersdue);
+	}
+}
+
+void HostedGame::collectOrders(bool overdue)
+{
+	for (HostedBot& bot : _bots)
+	{
+		if (!bot.planned) continue;
+
+		if (isPlanning(bot))
+		{
+			if (!overdue) continue;
+
+			// The bot keeps planning in the background, but anything it
+			// comes up with from now on is too late for this turn.
+			LOGW << "Bot " << bot.ai->player() << " missed the deadline";
+			_automaton.receive(bot.ai->player(), bot.ai->bestSoFar());
+			bot.planned = false;
+			continue;
+		}
+
+		_automaton.receive(bot.ai->player(), bot.ai->orders());
+		bot.planned = false;
+	}
+}
+
+void HostedGame::receiveOrders(const ParsedMessage& message)
 {
-	Player player = ::parsePlayer(forwarding["player"].asString());
-	_automaton.receive(player, Order::parseOrders(_automaton.bible(), json));
+	Player player = ::parsePlayer(message.metadata()["player"].asString());
+	_automaton.receive(player, message.orders(_automaton.bible()));
 }
 
 void HostedGame::handleResign(const std::string& username)
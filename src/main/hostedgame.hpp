@@ -24,11 +24,14 @@
 #pragma once
 #include "header.hpp"
 
+#include <future>
+
 #include "bot.hpp"
 #include "automaton.hpp"
 
 class Settings;
 class Client;
+class ParsedMessage;
 enum class Player : uint8_t;
 enum class VisionType : uint8_t;
 enum class Phase : uint8_t;
@@ -38,7 +41,7 @@ class Challenge;
 class HostedGame
 {
 public:
-	HostedGame(Client& client,
+	HostedGame(Client& client, const Settings& settings,
 		std::shared_ptr<Challenge> challenge,
 		const std::vector<Player>& colors,
 		const std::vector<VisionType>& visiontypes,
@@ -53,21 +56,42 @@ public:
 	virtual ~HostedGame() = default;
 
 protected:
+	struct HostedBot
+	{
+		std::unique_ptr<AICommander> ai;
+
+		// The bot plans in the background; changes that are broadcast while
+		// it is busy are kept in the backlog until it is done.
+		std::future<void> planning;
+		bool planned = false;
+		std::vector<std::vector<Change>> backlog;
+	};
+
 	Client& _client;
 
 	Automaton _automaton;
 	std::vector<std::string> _usernames; // (married)
 	std::vector<Player> _usernamecolors; // (married)
-	std::vector<std::unique_ptr<AICommander>> _bots;
+	std::vector<HostedBot> _bots;
 	bool _hasObservers;
 	Phase _phase;
+	uint32_t _botdeadline; // ms
+	uint64_t _ordersdue; // ms
 
 	void broadcast(const ChangeSet& changeset);
 
+	static bool isPlanning(HostedBot& bot);
+	void startPlanning();
+	void collectOrders(bool overdue);
+
 public:
 	void sync();
 
-	void receiveOrders(const Json::Value& orders, const Json::Value& metadata);
+	// Collect the orders of bots that have finished planning, or their best
+	// orders so far once they have missed the deadline, without waiting.
+	void update();
+
+	void receiveOrders(const ParsedMessage& message);
 	void handleResign(const std::string& username);
 	void handleRejoin(const std::string& username, const Player& vision);
 };
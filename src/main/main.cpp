@@ -658,7 +658,7 @@ std::weak_ptr<HostedGame> Main::hostGame(
 		bool hasObservers,
 		const std::string& mapname, const std::string& rulesetname)
 {
-	_hosted = new HostedGame(_client,
+	_hosted = new HostedGame(_client, _settings,
 		challenge,
 		playercolors, visiontypes, usernames, bots, hasObservers,
 		mapname, rulesetname);
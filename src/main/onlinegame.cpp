@@ -278,9 +278,9 @@ void OnlineGame::outLobby()
 	disconnected();
 }
 
-void OnlineGame::receiveChanges(const Json::Value& json)
+void OnlineGame::receiveChanges(const ParsedMessage& message)
 {
-	_commander.receiveChanges(Change::parseChanges(_commander.bible(), json));
+	_commander.receiveChanges(message.changes(_commander.bible()));
 }
 
 void OnlineGame::sync(uint32_t time)
@@ -96,7 +96,7 @@ protected:
 	virtual void outLobby() override;
 
 public:
-	virtual void receiveChanges(const Json::Value& json) override;
+	virtual void receiveChanges(const ParsedMessage& message) override;
 	virtual void sync(uint32_t time) override;
 	virtual void setAnimation(bool animate) override;
 };
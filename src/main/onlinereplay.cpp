@@ -242,9 +242,9 @@ void OnlineReplay::outLobby()
 	disconnected();
 }
 
-void OnlineReplay::receiveChanges(const Json::Value& json)
+void OnlineReplay::receiveChanges(const ParsedMessage& message)
 {
-	_observer.receiveChanges(Change::parseChanges(_observer.bible(), json));
+	_observer.receiveChanges(message.changes(_observer.bible()));
 }
 
 void OnlineReplay::sync(uint32_t time)
@@ -1,3 +1,5 @@
+#include "elementdecoder.cpp"
+#include "jsonscanner.cpp"
 #include "message.cpp"
 #include "ranking.cpp"
 #include "target.cpp"
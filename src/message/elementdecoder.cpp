@@ -0,0 +1,849 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "elementdecoder.hpp"
+#include "source.hpp"
+
+#include "parseerror.hpp"
+#include "change.hpp"
+#include "order.hpp"
+#include "typenamer.hpp"
+#include "notice.hpp"
+#include "cycle.hpp"
+
+
+// The members of a change can come in any order, but which of them are used
+// depends on its type, so they are collected before the change is built.
+struct ElementDecoderChange
+{
+	bool hasType = false;
+	bool hasSubject = false;
+	bool hasTarget = false;
+	bool hasAttacker = false;
+	bool hasBombarder = false;
+	bool hasPlayer = false;
+	bool hasNotice = false;
+	bool hasSeason = false;
+	bool hasDaytime = false;
+	bool hasPhase = false;
+	bool hasOrder = false;
+	bool hasDead = false;
+
+	Change::Type type = Change::Type::NONE;
+	Descriptor subject;
+	Descriptor target;
+	TileToken tile;
+	UnitToken unit;
+	Attacker attacker;
+	Bombarder bombarder;
+	Player player = Player::NONE;
+	Notice notice = Notice::NONE;
+	Season season = Season();
+	Daytime daytime = Daytime();
+	Phase phase = Phase();
+	Order order;
+	Vision vision;
+
+	int figure = 0;
+	int stacks = 0;
+	int power = 0;
+	int level = 0;
+	int year = 0;
+	int initiative = 0;
+	int money = 0;
+	int score = 0;
+	int gas = 0;
+	int radiation = 0;
+	int temperature = 0;
+	int humidity = 0;
+	int chaos = 0;
+
+	bool snow = false;
+	bool frostbite = false;
+	bool firestorm = false;
+	bool bonedrought = false;
+	bool death = false;
+	bool dead = false;
+	bool powered = false;
+	bool killed = false;
+	bool depowered = false;
+};
+
+static void elementdecoder_require(bool present, const char* key)
+{
+	if (!present)
+	{
+		throw ParseError(std::string("Missing '") + key + "'");
+	}
+}
+
+ElementDecoder::ElementDecoder(const TypeNamer& namer) :
+	_namer(namer)
+{}
+
+Descriptor ElementDecoder::descriptor(const JsonScanner::Span& span)
+{
+	bool hasType = false;
+	Descriptor::Type type = Descriptor::Type::NONE;
+	int row = 0;
+	int col = 0;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "type")
+		{
+			scanner.readString(_str);
+			type = Descriptor::parseType(_str);
+			hasType = true;
+		}
+		else if (_key == "row") row = scanner.readInt();
+		else if (_key == "col") col = scanner.readInt();
+		else scanner.skipValue();
+	}
+
+	elementdecoder_require(hasType, "type");
+	return Descriptor(type, Position(row, col));
+}
+
+Position ElementDecoder::position(const JsonScanner::Span& span)
+{
+	int row = 0;
+	int col = 0;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "row") row = scanner.readInt();
+		else if (_key == "col") col = scanner.readInt();
+		else scanner.skipValue();
+	}
+
+	return Position(row, col);
+}
+
+TileToken ElementDecoder::tile(const JsonScanner::Span& span)
+{
+	TileToken token;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "type")
+		{
+			scanner.readString(_str);
+			token.type = parseTileType(_namer, _str);
+		}
+		else if (_key == "owner")
+		{
+			scanner.readString(_str);
+			token.owner = parsePlayer(_str);
+		}
+		else if (_key == "stacks") token.stacks = scanner.readInt();
+		else if (_key == "power") token.power = scanner.readInt();
+		else scanner.skipValue();
+	}
+
+	return token;
+}
+
+UnitToken ElementDecoder::unit(const JsonScanner::Span& span)
+{
+	UnitToken token;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "type")
+		{
+			scanner.readString(_str);
+			token.type = parseUnitType(_namer, _str);
+		}
+		else if (_key == "owner")
+		{
+			scanner.readString(_str);
+			token.owner = parsePlayer(_str);
+		}
+		else if (_key == "stacks") token.stacks = scanner.readInt();
+		else scanner.skipValue();
+	}
+
+	return token;
+}
+
+Attacker ElementDecoder::attacker(const JsonScanner::Span& span)
+{
+	bool hasUnittype = false;
+	UnitType unittype = UnitType::NONE;
+	Position at;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "unittype")
+		{
+			scanner.readString(_str);
+			unittype = parseUnitType(_namer, _str);
+			hasUnittype = true;
+		}
+		else if (_key == "position") at = position(scanner.skipValue());
+		else scanner.skipValue();
+	}
+
+	elementdecoder_require(hasUnittype, "unittype");
+	return Attacker(unittype, at);
+}
+
+Bombarder ElementDecoder::bombarder(const JsonScanner::Span& span)
+{
+	bool hasUnittype = false;
+	UnitType unittype = UnitType::NONE;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		if (scanner.readNull()) continue;
+		else if (_key == "unittype")
+		{
+			scanner.readString(_str);
+			unittype = parseUnitType(_namer, _str);
+			hasUnittype = true;
+		}
+		else scanner.skipValue();
+	}
+
+	elementdecoder_require(hasUnittype, "unittype");
+	return Bombarder(unittype);
+}
+
+Vision ElementDecoder::vision(const JsonScanner::Span& span)
+{
+	Vision result;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterArray();
+	while (scanner.nextElement())
+	{
+		scanner.readString(_str);
+		result.add(parsePlayer(_str));
+	}
+
+	return result;
+}
+
+void ElementDecoder::moves(const JsonScanner::Span& span, MoveList& moves)
+{
+	moves.clear();
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterArray();
+	while (scanner.nextElement())
+	{
+		if (moves.size() >= Order::MAX_MOVES)
+		{
+			throw ParseError("Too many moves in order");
+		}
+		scanner.readString(_str);
+		moves.emplace_back(parseMove(_str));
+	}
+}
+
+void ElementDecoder::decode(const JsonScanner::Span& span, Change& change)
+{
+	ElementDecoderChange d;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		// Like the Json::Value constructor, treat null as absent.
+		if (scanner.readNull()) continue;
+		else if (_key == "type")
+		{
+			scanner.readString(_str);
+			d.type = Change::parseType(_str);
+			d.hasType = true;
+		}
+		else if (_key == "subject")
+		{
+			d.subject = descriptor(scanner.skipValue());
+			d.hasSubject = true;
+		}
+		else if (_key == "target")
+		{
+			d.target = descriptor(scanner.skipValue());
+			d.hasTarget = true;
+		}
+		else if (_key == "tile") d.tile = tile(scanner.skipValue());
+		else if (_key == "unit") d.unit = unit(scanner.skipValue());
+		else if (_key == "attacker")
+		{
+			d.attacker = attacker(scanner.skipValue());
+			d.hasAttacker = true;
+		}
+		else if (_key == "bombarder")
+		{
+			d.bombarder = bombarder(scanner.skipValue());
+			d.hasBombarder = true;
+		}
+		else if (_key == "player")
+		{
+			scanner.readString(_str);
+			d.player = parsePlayer(_str);
+			d.hasPlayer = true;
+		}
+		else if (_key == "notice")
+		{
+			scanner.readString(_str);
+			d.notice = parseNotice(_str);
+			d.hasNotice = true;
+		}
+		else if (_key == "season")
+		{
+			scanner.readString(_str);
+			d.season = parseSeason(_str);
+			d.hasSeason = true;
+		}
+		else if (_key == "daytime")
+		{
+			scanner.readString(_str);
+			d.daytime = parseDaytime(_str);
+			d.hasDaytime = true;
+		}
+		else if (_key == "phase")
+		{
+			scanner.readString(_str);
+			d.phase = parsePhase(_str);
+			d.hasPhase = true;
+		}
+		else if (_key == "order")
+		{
+			decode(scanner.skipValue(), d.order);
+			d.hasOrder = true;
+		}
+		else if (_key == "vision") d.vision = vision(scanner.skipValue());
+		else if (_key == "figure") d.figure = scanner.readInt();
+		else if (_key == "stacks") d.stacks = scanner.readInt();
+		else if (_key == "power") d.power = scanner.readInt();
+		else if (_key == "level") d.level = scanner.readInt();
+		else if (_key == "year") d.year = scanner.readInt();
+		else if (_key == "initiative") d.initiative = scanner.readInt();
+		else if (_key == "money") d.money = scanner.readInt();
+		else if (_key == "score") d.score = scanner.readInt();
+		else if (_key == "gas") d.gas = scanner.readInt();
+		else if (_key == "radiation") d.radiation = scanner.readInt();
+		else if (_key == "temperature") d.temperature = scanner.readInt();
+		else if (_key == "humidity") d.humidity = scanner.readInt();
+		else if (_key == "chaos") d.chaos = scanner.readInt();
+		else if (_key == "snow") d.snow = scanner.readBool();
+		else if (_key == "frostbite") d.frostbite = scanner.readBool();
+		else if (_key == "firestorm") d.firestorm = scanner.readBool();
+		else if (_key == "bonedrought") d.bonedrought = scanner.readBool();
+		else if (_key == "death") d.death = scanner.readBool();
+		else if (_key == "dead")
+		{
+			d.dead = scanner.readBool();
+			d.hasDead = true;
+		}
+		else if (_key == "powered") d.powered = scanner.readBool();
+		else if (_key == "killed") d.killed = scanner.readBool();
+		else if (_key == "depowered") d.depowered = scanner.readBool();
+		else scanner.skipValue();
+	}
+
+	elementdecoder_require(d.hasType, "type");
+	change = Change(d.type);
+
+	// Every type of change except these is about a subject.
+	switch (d.type)
+	{
+		case Change::Type::CHAOSREPORT:
+		case Change::Type::YEAR:
+		case Change::Type::SEASON:
+		case Change::Type::DAYTIME:
+		case Change::Type::PHASE:
+		case Change::Type::INITIATIVE:
+		case Change::Type::FUNDS:
+		case Change::Type::SLEEPING:
+		case Change::Type::BORDER:
+		case Change::Type::DEFEAT:
+		case Change::Type::VICTORY:
+		case Change::Type::GAMEOVER:
+		case Change::Type::AWARD:
+		break;
+
+		default:
+		{
+			elementdecoder_require(d.hasSubject, "subject");
+			change.subject = d.subject;
+		}
+		break;
+	}
+
+	switch (d.type)
+	{
+		case Change::Type::NONE:
+		case Change::Type::AIMS:
+		{
+			if (d.type == Change::Type::AIMS)
+			{
+				elementdecoder_require(d.hasTarget, "target");
+			}
+			change.target = d.target;
+			change.notice = d.notice;
+		}
+		break;
+
+		case Change::Type::STARTS:
+		case Change::Type::MOVES:
+		{
+			elementdecoder_require(d.hasTarget, "target");
+			change.target = d.target;
+		}
+		break;
+
+		case Change::Type::REVEAL:
+		{
+			change.tile = d.tile;
+			change.snow = d.snow;
+			change.frostbite = d.frostbite;
+			change.firestorm = d.firestorm;
+			change.bonedrought = d.bonedrought;
+			change.death = d.death;
+			change.gas = d.gas;
+			change.radiation = d.radiation;
+			change.temperature = d.temperature;
+			change.humidity = d.humidity;
+			change.chaos = d.chaos;
+		}
+		break;
+
+		case Change::Type::TRANSFORMED:
+		case Change::Type::CONSUMED:
+		case Change::Type::SHAPED:
+		case Change::Type::SETTLED:
+		case Change::Type::EXPANDED:
+		case Change::Type::UPGRADED:
+		case Change::Type::CULTIVATED:
+		case Change::Type::DESTROYED:
+		{
+			change.tile = d.tile;
+		}
+		break;
+
+		case Change::Type::EXPANDS:
+		{
+			elementdecoder_require(d.hasTarget, "target");
+			change.target = d.target;
+			change.power = d.power;
+		}
+		break;
+
+		case Change::Type::UPGRADES:
+		case Change::Type::CULTIVATES:
+		case Change::Type::PRODUCES:
+		{
+			change.power = d.power;
+		}
+		break;
+
+		case Change::Type::CAPTURED:
+		{
+			elementdecoder_require(d.hasPlayer, "player");
+			change.player = d.player;
+		}
+		break;
+
+		case Change::Type::PRODUCED:
+		case Change::Type::ENTERED:
+		{
+			change.unit = d.unit;
+		}
+		break;
+
+		case Change::Type::ATTACKS:
+		case Change::Type::SHELLS:
+		{
+			elementdecoder_require(d.hasTarget, "target");
+			change.target = d.target;
+			change.figure = d.figure;
+		}
+		break;
+
+		case Change::Type::TRAMPLES:
+		case Change::Type::BOMBARDS:
+		case Change::Type::BOMBS:
+		{
+			change.figure = d.figure;
+		}
+		break;
+
+		case Change::Type::ATTACKED:
+		case Change::Type::SHELLED:
+		case Change::Type::TRAMPLED:
+		case Change::Type::BOMBARDED:
+		case Change::Type::BOMBED:
+		case Change::Type::FROSTBITTEN:
+		case Change::Type::BURNED:
+		case Change::Type::GASSED:
+		case Change::Type::IRRADIATED:
+		{
+			if (d.type == Change::Type::ATTACKED
+				|| d.type == Change::Type::SHELLED)
+			{
+				elementdecoder_require(d.hasAttacker, "attacker");
+				change.attacker = d.attacker;
+			}
+			else if (d.type == Change::Type::TRAMPLED
+				|| d.type == Change::Type::BOMBARDED
+				|| d.type == Change::Type::BOMBED)
+			{
+				elementdecoder_require(d.hasBombarder, "bombarder");
+				change.bombarder = d.bombarder;
+			}
+			change.figure = d.figure;
+
+			// Backwards compatibility: v0.1.0
+			if (d.hasDead)
+			{
+				change.killed = d.dead;
+				if (d.type == Change::Type::ATTACKED
+					&& change.subject.type != Descriptor::Type::TILE)
+				{
+					change.killed = false;
+				}
+				change.depowered = d.dead && d.powered;
+			}
+			else
+			{
+				change.killed = d.killed;
+				change.depowered = d.depowered;
+			}
+		}
+		break;
+
+		case Change::Type::GROWS:
+		{
+			change.stacks = d.stacks;
+			change.power = d.power;
+		}
+		break;
+
+		case Change::Type::SNOW:
+		{
+			change.snow = d.snow;
+		}
+		break;
+
+		case Change::Type::FROSTBITE:
+		{
+			change.frostbite = d.frostbite;
+		}
+		break;
+
+		case Change::Type::FIRESTORM:
+		{
+			change.firestorm = d.firestorm;
+		}
+		break;
+
+		case Change::Type::BONEDROUGHT:
+		{
+			change.bonedrought = d.bonedrought;
+		}
+		break;
+
+		case Change::Type::DEATH:
+		{
+			change.death = d.death;
+		}
+		break;
+
+		case Change::Type::GAS:
+		{
+			change.gas = d.gas;
+		}
+		break;
+
+		case Change::Type::RADIATION:
+		{
+			change.radiation = d.radiation;
+		}
+		break;
+
+		case Change::Type::TEMPERATURE:
+		{
+			change.temperature = d.temperature;
+		}
+		break;
+
+		case Change::Type::HUMIDITY:
+		{
+			change.humidity = d.humidity;
+		}
+		break;
+
+		case Change::Type::CHAOS:
+		{
+			change.chaos = d.chaos;
+		}
+		break;
+
+		case Change::Type::CHAOSREPORT:
+		{
+			change.level = d.level;
+		}
+		break;
+
+		case Change::Type::YEAR:
+		{
+			change.year = d.year;
+		}
+		break;
+
+		case Change::Type::SEASON:
+		{
+			elementdecoder_require(d.hasSeason, "season");
+			change.season = d.season;
+		}
+		break;
+
+		case Change::Type::DAYTIME:
+		{
+			elementdecoder_require(d.hasDaytime, "daytime");
+			change.daytime = d.daytime;
+		}
+		break;
+
+		case Change::Type::PHASE:
+		{
+			elementdecoder_require(d.hasPhase, "phase");
+			change.phase = d.phase;
+		}
+		break;
+
+		case Change::Type::INITIATIVE:
+		{
+			change.player = d.player;
+			change.initiative = d.initiative;
+		}
+		break;
+
+		case Change::Type::FUNDS:
+		case Change::Type::INCOME:
+		case Change::Type::EXPENDITURE:
+		{
+			change.player = d.player;
+			change.money = d.money;
+		}
+		break;
+
+		case Change::Type::SLEEPING:
+		{
+			change.player = d.player;
+		}
+		break;
+
+		case Change::Type::POSTPONED:
+		case Change::Type::UNFINISHED:
+		case Change::Type::ORDERED:
+		{
+			elementdecoder_require(d.hasOrder, "order");
+			change.player = d.player;
+			change.order = std::move(d.order);
+		}
+		break;
+
+		case Change::Type::VISION:
+		{
+			change.vision = d.vision;
+		}
+		break;
+
+		case Change::Type::SCORED:
+		case Change::Type::DEFEAT:
+		case Change::Type::VICTORY:
+		{
+			elementdecoder_require(d.hasPlayer, "player");
+			change.player = d.player;
+			change.score = d.score;
+			if (d.type == Change::Type::DEFEAT) change.notice = d.notice;
+		}
+		break;
+
+		case Change::Type::GAMEOVER:
+		{
+			change.score = d.score;
+		}
+		break;
+
+		case Change::Type::AWARD:
+		{
+			elementdecoder_require(d.hasPlayer, "player");
+			change.player = d.player;
+			change.level = d.level;
+		}
+		break;
+
+		case Change::Type::OBSCURE:
+		case Change::Type::SHAPES:
+		case Change::Type::SETTLES:
+		case Change::Type::CAPTURES:
+		case Change::Type::EXITED:
+		case Change::Type::DIED:
+		case Change::Type::SURVIVED:
+		case Change::Type::ACTING:
+		case Change::Type::FINISHED:
+		case Change::Type::DISCARDED:
+		case Change::Type::CORNER:
+		case Change::Type::BORDER:
+		break;
+	}
+}
+
+void ElementDecoder::decode(const JsonScanner::Span& span, Order& order)
+{
+	bool hasType = false;
+	bool hasSubject = false;
+	bool hasTarget = false;
+	bool hasTiletype = false;
+	bool hasUnittype = false;
+	Order::Type type = Order::Type::NONE;
+	Descriptor subject;
+	Descriptor target;
+	TileType tiletype = TileType::NONE;
+	UnitType unittype = UnitType::NONE;
+	MoveList movelist;
+
+	JsonScanner scanner(span.begin, span.end);
+	scanner.enterObject();
+	while (scanner.nextKey(_key))
+	{
+		// Like the Json::Value constructor, treat null as absent.
+		if (scanner.readNull()) continue;
+		else if (_key == "type")
+		{
+			scanner.readString(_str);
+			type = Order::parseType(_str);
+			hasType = true;
+		}
+		else if (_key == "subject")
+		{
+			subject = descriptor(scanner.skipValue());
+			hasSubject = true;
+		}
+		else if (_key == "target")
+		{
+			target = descriptor(scanner.skipValue());
+			hasTarget = true;
+		}
+		else if (_key == "tiletype")
+		{
+			scanner.readString(_str);
+			tiletype = parseTileType(_namer, _str);
+			hasTiletype = true;
+		}
+		else if (_key == "unittype")
+		{
+			scanner.readString(_str);
+			unittype = parseUnitType(_namer, _str);
+			hasUnittype = true;
+		}
+		else if (_key == "moves") moves(scanner.skipValue(), movelist);
+		else scanner.skipValue();
+	}
+
+	elementdecoder_require(hasType, "type");
+	order = Order(type);
+	if (type == Order::Type::NONE) return;
+
+	elementdecoder_require(hasSubject, "subject");
+	order.subject = subject;
+
+	switch (type)
+	{
+		case Order::Type::MOVE:
+		{
+			elementdecoder_require(hasTarget, "target");
+			order.target = target;
+			order.moves = std::move(movelist);
+		}
+		break;
+
+		case Order::Type::GUARD:
+		case Order::Type::FOCUS:
+		case Order::Type::LOCKDOWN:
+		case Order::Type::SHELL:
+		case Order::Type::BOMBARD:
+		{
+			elementdecoder_require(hasTarget, "target");
+			order.target = target;
+		}
+		break;
+
+		case Order::Type::SHAPE:
+		case Order::Type::SETTLE:
+		case Order::Type::UPGRADE:
+		case Order::Type::CULTIVATE:
+		{
+			elementdecoder_require(hasTiletype, "tiletype");
+			order.tiletype = tiletype;
+		}
+		break;
+
+		case Order::Type::EXPAND:
+		{
+			elementdecoder_require(hasTarget, "target");
+			elementdecoder_require(hasTiletype, "tiletype");
+			order.target = target;
+			order.tiletype = tiletype;
+		}
+		break;
+
+		case Order::Type::PRODUCE:
+		{
+			if (hasTarget) order.target = target;
+			else order.target = Descriptor::cell(subject.position);
+			elementdecoder_require(hasUnittype, "unittype");
+			order.unittype = unittype;
+		}
+		break;
+
+		case Order::Type::BOMB:
+		case Order::Type::CAPTURE:
+		case Order::Type::HALT:
+		case Order::Type::NONE:
+		break;
+	}
+}
@@ -0,0 +1,77 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+#include "jsonscanner.hpp"
+
+struct Change;
+struct Order;
+struct Descriptor;
+struct Position;
+struct TileToken;
+struct UnitToken;
+struct Attacker;
+struct Bombarder;
+class Vision;
+class MoveList;
+class TypeNamer;
+
+
+// Decodes changes and orders straight from the text that a JsonScanner hands
+// out, without building a Json::Value for them. Given the output of the
+// writers, the result is the same as that of the Json::Value constructors of
+// Change and Order; members that the type of change or order does not use are
+// skipped. Throws a ParseError when the text is malformed.
+class ElementDecoder
+{
+public:
+	explicit ElementDecoder(const TypeNamer& namer);
+
+	ElementDecoder(const ElementDecoder&) = delete;
+	ElementDecoder(ElementDecoder&&) = delete;
+	ElementDecoder& operator=(const ElementDecoder&) = delete;
+	ElementDecoder& operator=(ElementDecoder&&) = delete;
+	~ElementDecoder() = default;
+
+private:
+	const TypeNamer& _namer;
+
+	// Reused for every key and string value to avoid allocations.
+	std::string _key;
+	std::string _str;
+
+	Descriptor descriptor(const JsonScanner::Span& span);
+	Position position(const JsonScanner::Span& span);
+	TileToken tile(const JsonScanner::Span& span);
+	UnitToken unit(const JsonScanner::Span& span);
+	Attacker attacker(const JsonScanner::Span& span);
+	Bombarder bombarder(const JsonScanner::Span& span);
+	Vision vision(const JsonScanner::Span& span);
+	void moves(const JsonScanner::Span& span, MoveList& moves);
+
+public:
+	void decode(const JsonScanner::Span& span, Change& change);
+	void decode(const JsonScanner::Span& span, Order& order);
+};
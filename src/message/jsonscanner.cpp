@@ -0,0 +1,258 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "jsonscanner.hpp"
+#include "source.hpp"
+
+#include <cstring>
+
+#include "libs/jsoncpp/json.h"
+
+#include "parseerror.hpp"
+
+
+JsonScanner::JsonScanner(const char* begin, const char* end) :
+	_cur(begin),
+	_end(end)
+{}
+
+void JsonScanner::skipWhitespace()
+{
+	while (_cur < _end
+		&& (*_cur == ' ' || *_cur == '\t' || *_cur == '\n' || *_cur == '\r'))
+	{
+		_cur++;
+	}
+}
+
+void JsonScanner::skipString()
+{
+	// The opening quote has already been checked.
+	for (_cur++; _cur < _end; _cur++)
+	{
+		if (*_cur == '\\') _cur++;
+		else if (*_cur == '\"')
+		{
+			_cur++;
+			return;
+		}
+	}
+	throw ParseError("Unterminated string");
+}
+
+void JsonScanner::takeString(std::string& str)
+{
+	skipWhitespace();
+	if (_cur >= _end || *_cur != '\"')
+	{
+		throw ParseError("Expected string");
+	}
+
+	const char* begin = _cur;
+	skipString();
+	if (std::find(begin, _cur, '\\') == _cur)
+	{
+		str.assign(begin + 1, _cur - 1);
+	}
+	else
+	{
+		// Strings with escape sequences are rare enough to leave to jsoncpp.
+		Json::Reader reader;
+		Json::Value json;
+		if (!reader.parse(begin, _cur, json, false) || !json.isString())
+		{
+			throw ParseError("Invalid string");
+		}
+		str = json.asString();
+	}
+}
+
+bool JsonScanner::takeLiteral(const char* literal)
+{
+	skipWhitespace();
+	size_t length = strlen(literal);
+	if ((size_t) (_end - _cur) < length
+		|| strncmp(_cur, literal, length) != 0)
+	{
+		return false;
+	}
+	_cur += length;
+	return true;
+}
+
+void JsonScanner::expect(char c)
+{
+	skipWhitespace();
+	if (_cur >= _end || *_cur != c)
+	{
+		throw ParseError(std::string("Expected '") + c + "'");
+	}
+	_cur++;
+}
+
+void JsonScanner::enterObject()
+{
+	expect('{');
+	_close = '}';
+	_first = true;
+}
+
+void JsonScanner::enterArray()
+{
+	expect('[');
+	_close = ']';
+	_first = true;
+}
+
+bool JsonScanner::next()
+{
+	if (_close == '\0')
+	{
+		throw ParseError("Scanned past the end");
+	}
+
+	skipWhitespace();
+	if (_cur < _end && *_cur == _close)
+	{
+		_cur++;
+		_close = '\0';
+		return false;
+	}
+
+	if (_first) _first = false;
+	else expect(',');
+	return true;
+}
+
+bool JsonScanner::nextKey(std::string& key)
+{
+	if (!next()) return false;
+
+	takeString(key);
+	expect(':');
+	return true;
+}
+
+bool JsonScanner::nextElement()
+{
+	return next();
+}
+
+JsonScanner::Span JsonScanner::skipValue()
+{
+	skipWhitespace();
+
+	Span span;
+	span.begin = _cur;
+	if (_cur >= _end)
+	{
+		throw ParseError("Expected value");
+	}
+	else if (*_cur == '\"')
+	{
+		skipString();
+	}
+	else if (*_cur == '{' || *_cur == '[')
+	{
+		size_t depth = 0;
+		while (_cur < _end)
+		{
+			switch (*_cur)
+			{
+				case '\"':
+				{
+					skipString();
+				}
+				continue;
+				case '{':
+				case '[':
+				{
+					depth++;
+				}
+				break;
+				case '}':
+				case ']':
+				{
+					depth--;
+				}
+				break;
+			}
+			_cur++;
+			if (depth == 0) break;
+		}
+		if (depth > 0)
+		{
+			throw ParseError("Unterminated value");
+		}
+	}
+	else
+	{
+		while (_cur < _end && *_cur != ',' && *_cur != _close
+			&& *_cur != ' ' && *_cur != '\t'
+			&& *_cur != '\n' && *_cur != '\r')
+		{
+			_cur++;
+		}
+	}
+	span.end = _cur;
+	return span;
+}
+
+void JsonScanner::readString(std::string& str)
+{
+	takeString(str);
+}
+
+int JsonScanner::readInt()
+{
+	skipWhitespace();
+	bool negative = (_cur < _end && *_cur == '-');
+	if (negative) _cur++;
+	if (_cur >= _end || *_cur < '0' || *_cur > '9')
+	{
+		throw ParseError("Expected integer");
+	}
+
+	int64_t value = 0;
+	for (; _cur < _end && *_cur >= '0' && *_cur <= '9'; _cur++)
+	{
+		value = 10 * value + (*_cur - '0');
+		if (value > INT32_MAX)
+		{
+			throw ParseError("Integer out of range");
+		}
+	}
+	return (int) (negative ? -value : value);
+}
+
+bool JsonScanner::readBool()
+{
+	if (takeLiteral("true")) return true;
+	else if (takeLiteral("false")) return false;
+	else throw ParseError("Expected boolean");
+}
+
+bool JsonScanner::readNull()
+{
+	return takeLiteral("null");
+}
@@ -0,0 +1,83 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+
+/*
+Walks over the members of a single JSON object or the elements of a single
+JSON array without decoding them. Each value is returned as the span of text
+that it occupies, so the caller can decide which values are worth parsing.
+Values are only checked for balanced brackets and terminated strings; the
+actual validation is left to whoever parses a span, or to the read methods
+below for scalar values. Throws a ParseError when the text is cut off or not
+shaped like what was asked for.
+*/
+class JsonScanner
+{
+public:
+	struct Span
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		size_t length() const { return end - begin; }
+	};
+
+	JsonScanner(const char* begin, const char* end);
+
+private:
+	const char* _cur;
+	const char* _end;
+	char _close = '\0';
+	bool _first = true;
+
+	void skipWhitespace();
+	void skipString();
+	void takeString(std::string& str);
+	bool takeLiteral(const char* literal);
+	void expect(char c);
+	bool next();
+
+public:
+	void enterObject();
+	void enterArray();
+
+	// Reads the key of the next member, or returns false after the closing
+	// brace. The value of that member must be skipped before continuing.
+	bool nextKey(std::string& key);
+
+	// Moves to the next element, or returns false after the closing bracket.
+	bool nextElement();
+
+	Span skipValue();
+
+	// These read the next value, which must be of the requested kind.
+	void readString(std::string& str);
+	int readInt();
+	bool readBool();
+
+	// Skips the next value if it is null.
+	bool readNull();
+};
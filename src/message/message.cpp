@@ -25,6 +25,8 @@
 #include "source.hpp"
 
 #include "writer.hpp"
+#include "jsonscanner.hpp"
+#include "elementdecoder.hpp"
 #include "parseerror.hpp"
 #include "typenamer.hpp"
 #include "change.hpp"
@@ -1103,6 +1105,31 @@ StreamedMessage Message::change(
 	return message;
 }
 
+StreamedMessage Message::change(
+		const TypeNamer& typenamer,
+		const ChangeSet::View& changes,
+		const Json::Value& metadata)
+{
+	StreamedMessage message;
+	message._type = Message::Type::CHANGE;
+	std::stringstream strm;
+	strm << "{\"type\":\"change\"";
+	strm << ",\"metadata\":" << Writer::write(metadata);
+	strm << ",\"changes\":[";
+	strm << TypeEncoder(&typenamer);
+	bool empty = true;
+	for (auto& change : changes)
+	{
+		if (empty) empty = false;
+		else strm << ",";
+		strm << change;
+	}
+	strm << "]";
+	strm << "}";
+	message._str = strm.str();
+	return message;
+}
+
 StreamedMessage Message::order_old(
 		const TypeNamer& typenamer,
 		const std::vector<Order>& orders)
@@ -1502,15 +1529,68 @@ std::ostream& operator<<(std::ostream& os, const StreamedMessage& message)
 	return os << message._str;
 }
 
+static bool isStreamedType(const Message::Type& type)
+{
+	switch (type)
+	{
+		case Message::Type::CHANGE:
+		case Message::Type::ORDER_OLD:
+		case Message::Type::ORDER_NEW:
+		case Message::Type::SYNC:
+		case Message::Type::HOST_SYNC:
+		case Message::Type::HOST_REJOIN_CHANGES:
+		return true;
+
+		default:
+		return false;
+	}
+}
+
 ParsedMessage Message::parse(const char* buffer, uint32_t length)
 {
 	Json::Reader reader;
 	Json::Value json;
-	if (!reader.parse(std::string(buffer, length), json))
+
+	// Changes and orders make up most of the traffic during a game. Rather
+	// than building one tree for the entire message, the members are
+	// scanned one by one and the changes or orders are left as text.
+	JsonScanner scanner(buffer, buffer + length);
+	scanner.enterObject();
+	ParsedMessage::Span changes;
+	ParsedMessage::Span orders;
+	std::string key;
+	while (scanner.nextKey(key))
 	{
-		throw ParseError("Invalid json");
+		JsonScanner::Span span = scanner.skipValue();
+		if (key == "changes" && *span.begin == '[')
+		{
+			changes.offset = span.begin - buffer;
+			changes.length = span.length();
+		}
+		else if (key == "orders" && *span.begin == '[')
+		{
+			orders.offset = span.begin - buffer;
+			orders.length = span.length();
+		}
+		else if (!reader.parse(span.begin, span.end, json[key], false))
+		{
+			throw ParseError("Invalid json");
+		}
+		else if (key == "type" && json.size() == 1 && json[key].isString()
+			&& !isStreamedType(parseMessageType(json[key].asString())))
+		{
+			// Other messages are rare and small, so parse them in one go.
+			json = Json::Value();
+			if (!reader.parse(buffer, buffer + length, json))
+			{
+				throw ParseError("Invalid json");
+			}
+			return ParsedMessage(std::move(json));
+		}
 	}
-	return ParsedMessage(std::move(json));
+
+	return ParsedMessage(std::move(json), std::string(buffer, length),
+		changes, orders);
 }
 
 ParsedMessage::ParsedMessage() :
@@ -1519,8 +1599,16 @@ ParsedMessage::ParsedMessage() :
 {}
 
 ParsedMessage::ParsedMessage(Json::Value&& json) :
+	ParsedMessage(std::move(json), std::string(), Span(), Span())
+{}
+
+ParsedMessage::ParsedMessage(Json::Value&& json, std::string&& raw,
+		const Span& changes, const Span& orders) :
 	_json(json),
-	_type(parseMessageType(json["type"].asString()))
+	_type(parseMessageType(json["type"].asString())),
+	_raw(std::move(raw)),
+	_changes(changes),
+	_orders(orders)
 {
 	switch (_type)
 	{
@@ -1890,7 +1978,7 @@ ParsedMessage::ParsedMessage(Json::Value&& json) :
 		break;
 		case Type::CHANGE:
 		{
-			if (!_json["changes"].isArray())
+			if (!_changes.length && !_json["changes"].isArray())
 			{
 				throw ParseError("No changes array");
 			}
@@ -1899,7 +1987,7 @@ ParsedMessage::ParsedMessage(Json::Value&& json) :
 		case Type::ORDER_OLD:
 		case Type::ORDER_NEW:
 		{
-			if (!_json["orders"].isArray())
+			if (!_orders.length && !_json["orders"].isArray())
 			{
 				throw ParseError("No orders array");
 			}
@@ -1937,7 +2025,7 @@ ParsedMessage::ParsedMessage(Json::Value&& json) :
 			{
 				_content = _json["content"].asString();
 			}
-			if (!_json["changes"].isArray())
+			if (!_changes.length && !_json["changes"].isArray())
 			{
 				throw ParseError("No changes array");
 			}
@@ -2068,23 +2156,73 @@ const Json::Value& ParsedMessage::metadata() const
 	return _json["metadata"];
 }
 
-const Json::Value& ParsedMessage::changes() const
+const Json::Value& ParsedMessage::data() const
+{
+	return _json["data"];
+}
+
+template <typename T>
+static std::vector<T> parseElements(const TypeNamer& typenamer,
+	const char* begin, const char* end, const char* what)
 {
-	return _json["changes"];
+	std::vector<T> elements;
+	try
+	{
+		ElementDecoder decoder(typenamer);
+		JsonScanner scanner(begin, end);
+		scanner.enterArray();
+		while (scanner.nextElement())
+		{
+			elements.emplace_back();
+			decoder.decode(scanner.skipValue(), elements.back());
+		}
+	}
+	catch (const ParseError& error)
+	{
+		LOGE << "Error while parsing " << what << ": "
+			<< "\'" << std::string(begin, end) << "\'"
+			<< ", error "
+			<< error.what();
+		RETHROW_IF_DEV();
+	}
+	catch (const Json::Exception& error)
+	{
+		LOGE << "Error while parsing " << what << ": "
+			<< "\'" << std::string(begin, end) << "\'"
+			<< ", error "
+			<< error.what();
+		RETHROW_IF_DEV();
+	}
+	return elements;
 }
 
-const Json::Value& ParsedMessage::orders() const
+std::vector<Change> ParsedMessage::changes(const TypeNamer& typenamer) const
 {
-	return _json["orders"];
+	if (!_changes.length)
+	{
+		return Change::parseChanges(typenamer, _json["changes"]);
+	}
+
+	const char* begin = _raw.data() + _changes.offset;
+	return parseElements<Change>(typenamer,
+		begin, begin + _changes.length, "changes");
 }
 
-const Json::Value& ParsedMessage::data() const
+std::vector<Order> ParsedMessage::orders(const TypeNamer& typenamer) const
 {
-	return _json["data"];
+	if (!_orders.length)
+	{
+		return Order::parseOrders(typenamer, _json["orders"]);
+	}
+
+	const char* begin = _raw.data() + _orders.offset;
+	return parseElements<Order>(typenamer,
+		begin, begin + _orders.length, "orders");
 }
 
 std::ostream& operator<<(std::ostream& os, const ParsedMessage& message)
 {
+	if (!message._raw.empty()) return os << message._raw;
 	return os << Writer::write(message._json);
 }
 
@@ -33,6 +33,7 @@
 #include "difficulty.hpp"
 #include "version.hpp"
 #include "responsestatus.hpp"
+#include "changeset.hpp"
 
 class TypeNamer;
 struct Change;
@@ -320,6 +321,10 @@ public:
 		const TypeNamer& typenamer,
 		const std::vector<Change>& changes,
 		const Json::Value& metadata);
+	static StreamedMessage change(
+		const TypeNamer& typenamer,
+		const ChangeSet::View& changes,
+		const Json::Value& metadata);
 
 	static StreamedMessage order_old(
 		const TypeNamer& typenamer,
@@ -422,6 +427,19 @@ public:
 
 class ParsedMessage : private Message
 {
+private:
+	friend Message;
+
+	// The location of an array within _raw that has not been parsed yet.
+	struct Span
+	{
+		size_t offset = 0;
+		size_t length = 0;
+	};
+
+	explicit ParsedMessage(Json::Value&& json, std::string&& raw,
+		const Span& changes, const Span& orders);
+
 public:
 	explicit ParsedMessage();
 	explicit ParsedMessage(Json::Value&& json);
@@ -431,6 +449,12 @@ private:
 
 	Type _type;
 
+	// Messages that carry changes or orders keep their original text, so
+	// that those arrays can be decoded straight from it.
+	std::string _raw;
+	Span _changes;
+	Span _orders;
+
 	std::string _content;
 	std::string _sender;
 	uint32_t _time = 0;
@@ -458,10 +482,11 @@ public:
 	const ResponseStatus& status() const       { return _status;     }
 
 	const Json::Value& metadata() const;
-	const Json::Value& changes() const;
-	const Json::Value& orders() const;
 	const Json::Value& data() const;
 
+	std::vector<Change> changes(const TypeNamer& typenamer) const;
+	std::vector<Order> orders(const TypeNamer& typenamer) const;
+
 	friend std::ostream& operator<<(std::ostream& os,
 		const ParsedMessage& message);
 };
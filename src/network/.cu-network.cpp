@@ -4,6 +4,7 @@
 #include "curlguard.cpp"
 #include "discordapi.cpp"
 #include "download.cpp"
+#include "framereader.cpp"
 #include "patch.cpp"
 #include "platform.cpp"
 #include "slackapi.cpp"
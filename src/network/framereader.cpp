@@ -0,0 +1,200 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#include "framereader.hpp"
+#include "source.hpp"
+
+#include <cstring>
+#include <streambuf>
+
+#include "libs/SDL2/SDL_net.h"
+
+#include "limits.hpp"
+
+
+class FrameReader::ScratchBuffer : public std::streambuf
+{
+public:
+	std::vector<char> data;
+
+protected:
+	virtual int_type overflow(int_type c) override
+	{
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			data.push_back(traits_type::to_char_type(c));
+		}
+		return traits_type::not_eof(c);
+	}
+
+	virtual std::streamsize xsputn(const char* s, std::streamsize n) override
+	{
+		data.insert(data.end(), s, s + n);
+		return n;
+	}
+};
+
+FrameReader::FrameReader() :
+	_scratch(new ScratchBuffer()),
+	_scratchstream(new std::ostream(_scratch.get()))
+{}
+
+FrameReader::~FrameReader()
+{
+	detach();
+	if (_socketset)
+	{
+		SDLNet_FreeSocketSet(_socketset);
+	}
+}
+
+bool FrameReader::attach(TCPsocket socket)
+{
+	if (socket == _socket) return true;
+
+	detach();
+
+	if (!_socketset)
+	{
+		_socketset = SDLNet_AllocSocketSet(1);
+		if (!_socketset) return false;
+	}
+	if (SDLNet_TCP_AddSocket(_socketset, socket) < 0) return false;
+
+	_socket = socket;
+	return true;
+}
+
+void FrameReader::detach()
+{
+	if (_socket)
+	{
+		SDLNet_TCP_DelSocket(_socketset, _socket);
+		_socket = nullptr;
+	}
+	_begin = 0;
+	_end = 0;
+}
+
+int FrameReader::check(uint32_t timeout)
+{
+	if (_end - _begin >= 4 && _end - _begin >= 4 + size_t(pendingLength()))
+	{
+		return 1;
+	}
+	if (!_socket) return 0;
+
+	return SDLNet_CheckSockets(_socketset, timeout);
+}
+
+uint32_t FrameReader::pendingLength() const
+{
+	// The length is sent as a big-endian 32-bit unsigned integer.
+	const uint8_t* bytes = (const uint8_t*) _buffer.data() + _begin;
+	return (uint32_t(bytes[0]) << 24)
+		| (uint32_t(bytes[1]) << 16)
+		| (uint32_t(bytes[2]) << 8)
+		| (uint32_t(bytes[3]));
+}
+
+FrameReader::Status FrameReader::next(Frame& frame)
+{
+	while (true)
+	{
+		size_t available = _end - _begin;
+		if (available >= 4)
+		{
+			uint32_t length = pendingLength();
+			if (length >= MESSAGE_SIZE_LIMIT)
+			{
+				frame.data = nullptr;
+				frame.length = length;
+				return Status::OVERSIZED;
+			}
+			else if (available >= 4 + size_t(length))
+			{
+				frame.data = _buffer.data() + _begin + 4;
+				frame.length = length;
+				_begin += 4 + size_t(length);
+				return Status::FRAME;
+			}
+		}
+
+		if (!_socket) return Status::CLOSED;
+
+		// Only receive bytes that have already arrived, so that we never
+		// have to wait for the rest of a frame.
+		int active = SDLNet_CheckSockets(_socketset, 0);
+		if (active < 0) return Status::FAILED;
+		else if (active == 0) return Status::PENDING;
+
+		makeRoom();
+		int received = SDLNet_TCP_Recv(_socket, _buffer.data() + _end,
+			_buffer.size() - _end);
+		if (received <= 0) return Status::CLOSED;
+		_end += received;
+	}
+}
+
+void FrameReader::makeRoom()
+{
+	// Frames that have been handed out are no longer needed, so move the
+	// remaining bytes to the front.
+	if (_begin > 0)
+	{
+		if (_end > _begin)
+		{
+			std::memmove(_buffer.data(), _buffer.data() + _begin,
+				_end - _begin);
+		}
+		_end -= _begin;
+		_begin = 0;
+	}
+
+	// Make room for the rest of the pending frame, if it is large.
+	constexpr size_t CHUNK_SIZE = 4096;
+	size_t wanted = _end + CHUNK_SIZE;
+	if (_end >= 4)
+	{
+		wanted = std::max(wanted, 4 + size_t(pendingLength()));
+	}
+	if (_buffer.size() < wanted)
+	{
+		_buffer.resize(wanted);
+	}
+}
+
+std::ostream& FrameReader::scratch()
+{
+	_scratch->data.clear();
+	_scratchstream->clear();
+	return *_scratchstream;
+}
+
+FrameReader::Frame FrameReader::scratched() const
+{
+	Frame frame;
+	frame.data = _scratch->data.data();
+	frame.length = (uint32_t) _scratch->data.size();
+	return frame;
+}
@@ -0,0 +1,102 @@
+/**
+ * Part of Epicinium
+ * developed by A Bunch of Hacks.
+ *
+ * Copyright (c) 2017-2020 A Bunch of Hacks
+ *
+ * Epicinium is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Epicinium is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * [authors:]
+ * Sander in 't Veld (sander@abunchofhacks.coop)
+ * Daan Mulder (daan@abunchofhacks.coop)
+ */
+#pragma once
+#include "header.hpp"
+
+typedef struct _TCPsocket* TCPsocket;
+typedef struct _SDLNet_SocketSet* SDLNet_SocketSet;
+
+
+/*
+Splits the bytes received on a socket into length-prefixed frames without
+blocking. Bytes are only received when the socket has some available, and
+they are kept until their frame is complete, so a slow sender cannot stall
+the caller. The socket set and the buffers are reused between calls.
+*/
+class FrameReader
+{
+public:
+	enum class Status : uint8_t
+	{
+		// A complete frame was extracted.
+		FRAME,
+		// The next frame has not fully arrived yet.
+		PENDING,
+		// The connection was closed or broken.
+		CLOSED,
+		// The next frame is too large to receive.
+		OVERSIZED,
+		// The socket could not be checked for activity.
+		FAILED,
+	};
+
+	struct Frame
+	{
+		const char* data = nullptr;
+		uint32_t length = 0;
+	};
+
+	FrameReader();
+	~FrameReader();
+
+	FrameReader(const FrameReader&) = delete;
+	FrameReader(FrameReader&&) = delete;
+	FrameReader& operator=(const FrameReader&) = delete;
+	FrameReader& operator=(FrameReader&&) = delete;
+
+private:
+	class ScratchBuffer;
+
+	TCPsocket _socket = nullptr;
+	SDLNet_SocketSet _socketset = nullptr;
+	std::vector<char> _buffer;
+	size_t _begin = 0;
+	size_t _end = 0;
+
+	std::unique_ptr<ScratchBuffer> _scratch;
+	std::unique_ptr<std::ostream> _scratchstream;
+
+public:
+	// Returns false if the socket could not be added to the socket set.
+	bool attach(TCPsocket socket);
+	// Must be called before the socket is closed.
+	void detach();
+
+	// Like SDLNet_CheckSockets(), but a complete frame that has already been
+	// received also counts as activity.
+	int check(uint32_t timeout);
+
+	// On FRAME, the frame stays valid until the next call to next().
+	// On OVERSIZED, only the length of the frame is set.
+	Status next(Frame& frame);
+
+	// Returns an empty stream that writes into a buffer that is reused,
+	// for instance to decompress a frame into.
+	std::ostream& scratch();
+	Frame scratched() const;
+
+private:
+	uint32_t pendingLength() const;
+	void makeRoom();
+};
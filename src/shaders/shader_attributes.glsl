@@ -0,0 +1,15 @@
+R"(
+
+	// Sprites are drawn in batches, so the values that differ per sprite are
+	// passed as texture coordinates rather than as uniforms. They are the same
+	// for every vertex of a sprite, so rounding errors from the interpolation
+	// are the only reason not to compare the flags exactly.
+	float obscured = gl_TexCoord[3].x;
+	float shine = gl_TexCoord[3].y;
+	float theta = gl_TexCoord[3].z;
+	bool masked = (mod(gl_TexCoord[3].w + 0.5, 2.0) >= 1.0);
+	bool border = (gl_TexCoord[3].w >= 1.5);
+	vec3 shinecolor = gl_TexCoord[4].rgb;
+	float grayed = gl_TexCoord[4].a;
+
+)"
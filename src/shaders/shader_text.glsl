@@ -4,6 +4,8 @@ R"(
 
 uniform sampler2D texture;
 uniform float alpha;
+uniform vec4 glyphchannel;
+uniform vec4 glyphcolor;
 
 void main()
 {
@@ -14,6 +16,13 @@ void main()
 	// Get the color that the texture gives for this position.
 	vec4 color = texture2D(texture, pos);
 
+	// A glyph atlas only stores coverage, in the channel given by the mask.
+	// Texts that are not drawn from an atlas leave the mask at zero.
+	if (glyphchannel != vec4(0.0))
+	{
+		color = vec4(glyphcolor.rgb, glyphcolor.a * dot(color, glyphchannel));
+	}
+
 	// Grayed is used for text transparency.
 	color.a *= alpha;
 
@@ -82,6 +82,26 @@ static std::string _discordUsername;
 static std::string _discordDiscriminator;
 #endif
 
+#if FEMTOZIP_ENABLED
+// Bytes that are only formatted as hexadecimal if they are actually logged.
+struct ClientHexDump
+{
+	const char* data;
+	size_t length;
+};
+
+static std::ostream& operator<<(std::ostream& os, const ClientHexDump& dump)
+{
+	char buffer[3];
+	for (size_t i = 0; i < dump.length; i++)
+	{
+		snprintf(buffer, sizeof(buffer), "%02x", (uint8_t) dump.data[i]);
+		os << " " << buffer;
+	}
+	return os;
+}
+#endif
+
 Client::Client(ClientHandler& owner, GameOwner& gameowner, Settings& settings,
 		Firewall* firewall) :
 	_owner(owner),
@@ -216,18 +236,9 @@ void Client::send(const std::string& jsonString, bool compressible)
 	std::string zipped = zipstrm.str();
 	uint32_t ziplen = (uint32_t) zipped.length();
 
-	{
-		std::stringstream hash;
-		hash << "=";
-		hash << std::hex << std::setfill('0');
-		for (size_t i = 0; i < ziplen; i++)
-		{
-			hash << " " << std::setw(2)
-				<< (unsigned int) (uint8_t) zipped[i];
-		}
-		LOGD << "Compressed message length " << (1 + ziplen);
-		LOGD << "Compressed message: \'" << hash.str() << "\'";
-	}
+	LOGD << "Compressed message length " << (1 + ziplen);
+	LOGD << "Compressed message:"
+		" \'=" << ClientHexDump{zipped.data(), ziplen} << "\'";
 
 	return send(zipped.data(), ziplen);
 #endif
@@ -884,7 +895,7 @@ void Client::handleMessage(const ParsedMessage& message)
 		{
 			if (auto game = _game.lock())
 			{
-				game->receiveChanges(message.changes());
+				game->receiveChanges(message);
 			}
 			else LOGW << "Received change while not in a game or replay";
 		}
@@ -922,7 +933,7 @@ void Client::handleMessage(const ParsedMessage& message)
 		{
 			if (auto hosted = _hosted.lock())
 			{
-				hosted->receiveOrders(message.orders(), message.metadata());
+				hosted->receiveOrders(message);
 			}
 			else LOGW << "Received orders while not in a hosted game";
 		}
@@ -1993,67 +2004,26 @@ void Client::checkSteamAccountMergeToken()
 	}
 }
 
-int Client::safelyReceive(char* buffer, uint32_t length)
-{
-	uint32_t receivedTotal = 0;
-	while (receivedTotal < length)
-	{
-		int received = SDLNet_TCP_Recv(_socket, buffer + receivedTotal,
-			length - receivedTotal);
-		if (received <= 0)
-		{
-			LOGW << "Received too few bytes,"
-				" expected " << length << ", received " << receivedTotal;
-			return received;
-		}
-		receivedTotal += received;
-	}
-	return receivedTotal;
-}
-
 void Client::checkForNewMessages()
 {
 	if (!_socket) return;
-	SDLNet_SocketSet set = SDLNet_AllocSocketSet(1);
-	if (!set || SDLNet_TCP_AddSocket(set, _socket) < 0)
+	if (!_reader.attach(_socket))
 	{
 		LOGW << "Not enough memory to allocate socket set or add socket";
 		disconnect();
 		return;
 	}
 
-	int active = 0;
-	while (_socket && (active = SDLNet_CheckSockets(set, 0)) > 0)
+	FrameReader::Frame frame;
+	FrameReader::Status status = FrameReader::Status::PENDING;
+	while (_socket
+		&& (status = _reader.next(frame)) == FrameReader::Status::FRAME)
 	{
-		if (!SDLNet_SocketReady(_socket)) return disconnect();
-
-		// Get the network order (big-endian) byte representation of the length.
-		uint8_t length_be_bytes[4] = {0, 0, 0, 0};
-		int received = safelyReceive((char*) length_be_bytes, 4);
-		if (received <= 0)
+		const char* data = frame.data;
+		uint32_t length = frame.length;
+		if (length >= MESSAGE_SIZE_WARNING_LIMIT)
 		{
-			LOGW << "Error while safely receiving length,"
-				" last received was " << received;
-			disconnect();
-			_resetting = true;
-			return;
-		}
-
-		uint32_t length = (uint32_t(length_be_bytes[0]) << 24)
-			| (uint32_t(length_be_bytes[1]) << 16)
-			| (uint32_t(length_be_bytes[2]) << 8)
-			| (uint32_t(length_be_bytes[3]));
-		if (length >= MESSAGE_SIZE_LIMIT)
-		{
-			LOGW << "Receiving very large message of length " << length;
-			LOGW << "Refusing to receive message of length " << length;
-			disconnect();
-			_resetting = true;
-			return;
-		}
-		else if (length >= MESSAGE_SIZE_WARNING_LIMIT)
-		{
-			LOGW << "Receiving very large message of length " << length;
+			LOGW << "Received very large message of length " << length;
 		}
 		else if (length == 0)
 		{
@@ -2066,77 +2036,71 @@ void Client::checkForNewMessages()
 			continue /*onto the next message*/;
 		}
 
-		LOGD << "Receiving message of length " << length;
-
-		std::vector<char> buffer;
-		buffer.resize(length);
-		received = safelyReceive(buffer.data(), length);
-		if (received <= 0)
-		{
-			LOGW << "Error while safely receiving message,"
-				" last received was " << received;
-			disconnect();
-			_resetting = true;
-			return;
-		}
+		LOGD << "Received message of length " << length;
 
 		// Reset the last receive time so we know we are still connected.
 		_lastreceivetime = (double) SDL_GetTicks() * 0.001;
 
 #if FEMTOZIP_ENABLED
-		if (length > 0 && buffer[0] == '=')
+		if (length > 0 && data[0] == '=')
 		{
-			{
-				std::stringstream hash;
-				hash << "=";
-				hash << std::hex << std::setfill('0');
-				for (size_t i = 1; i < length; i++)
-				{
-					hash << " " << std::setw(2)
-						<< (unsigned int) (uint8_t) buffer[i];
-				}
-				LOGD << "Compressed message: \'" << hash.str() << "\'";
-			}
+			LOGD << "Compressed message:"
+				" \'=" << ClientHexDump{data + 1, length - 1} << "\'";
 
 			auto model = _compressionModel;
 			if (!model)
 			{
-				std::stringstream hash;
-				hash << "=";
-				hash << std::hex << std::setfill('0');
-				for (size_t i = 1; i < length; i++)
-				{
-					hash << " " << std::setw(2)
-						<< (unsigned int) (uint8_t) buffer[i];
-				}
 				LOGE << "Cannot decompress message"
-					" \'" << hash.str() << "\'"
-					" without model";
+					" \'=" << ClientHexDump{data + 1, length - 1}
+					<< "\' without model";
 				DEBUG_ASSERT(false);
 				continue /*onto the next message*/;
 			}
 
-			std::ostringstream strm;
-			model->decompress(buffer.data() + 1, length - 1, strm);
-			std::string str = strm.str();
-			buffer = std::vector<char>(str.begin(), str.end());
-			length = str.length();
+			model->decompress(data + 1, length - 1, _reader.scratch());
+			frame = _reader.scratched();
+			data = frame.data;
+			length = frame.length;
 			LOGD << "Uncompressed message length " << (length);
 		}
 #endif
 
 		LOGD << "Received message:"
-			" \'" << std::string(buffer.data(), length) << "\'";
+			" \'" << std::string(data, length) << "\'";
 
-		receiveMessage(buffer.data(), length);
+		receiveMessage(data, length);
 	}
-	SDLNet_FreeSocketSet(set);
-	if (active < 0)
+
+	// We might have been disconnected while handling a message.
+	if (!_socket) return;
+
+	switch (status)
 	{
-		LOGW << "Error while checking for new messages,"
-			" " << active << " active sockets";
-		disconnect();
-		_resetting = true;
+		case FrameReader::Status::FRAME:
+		case FrameReader::Status::PENDING:
+		break;
+		case FrameReader::Status::OVERSIZED:
+		{
+			LOGW << "Receiving very large message of length " << frame.length;
+			LOGW << "Refusing to receive message of length " << frame.length;
+			disconnect();
+			_resetting = true;
+		}
+		break;
+		case FrameReader::Status::CLOSED:
+		{
+			LOGW << "Error while receiving message";
+			disconnect();
+			_resetting = true;
+		}
+		break;
+		case FrameReader::Status::FAILED:
+		{
+			LOGW << "Error while checking for new messages";
+			disconnect();
+			_resetting = true;
+		}
+		break;
 	}
 }
 
@@ -2655,6 +2619,7 @@ void Client::disconnect(bool sendMessage)
 		send(Message::quit());
 		waitForClosure();
 	}
+	_reader.detach();
 	SDLNet_TCP_Close(_socket);
 	_socket = nullptr;
 	_lobbyID = "";
@@ -3284,6 +3249,9 @@ void Client::update()
 		_resetting = true;
 	}
 
+	// Check whether the bots in a game we are hosting have finished planning.
+	if (auto hosted = _hosted.lock()) hosted->update();
+
 	// Check if the connection is still healthy.
 	checkVitals();
 
@@ -36,6 +36,7 @@ namespace femtozip
 #include "account.hpp"
 #include "responsestatus.hpp"
 #include "response.hpp"
+#include "framereader.hpp"
 
 class Settings;
 class Game;
@@ -92,6 +93,7 @@ private:
 	Settings& _settings;
 	Account _account;
 	TCPsocket _socket = nullptr;
+	FrameReader _reader;
 	std::string _lobbyID = "";
 	std::weak_ptr<Game> _game;
 	std::weak_ptr<HostedGame> _hosted;
@@ -149,7 +151,6 @@ private:
 	std::future<Response> _futureLeaderboard;
 
 	void handleMessage(const ParsedMessage& message);
-	int safelyReceive(char* buffer, uint32_t length);
 	void checkForNewMessages();
 	void receiveMessage(const char* buffer, uint32_t length);
 	void invalidateSession(uint32_t accountId, const std::string& sessionToken);